@@ -11,7 +11,15 @@
 *
 * 	o ChorusBuffer_initialize: initialize the peripheral into the correct mode
 * 	o ChorusBuffer_ReadLine: reads a 16-bit word from the buffer
+*	o ChorusBuffer_ReadBlock: reads consecutive 16-bit words from the buffer
 *	o ChorusBuffer_WriteLine: writes a 16-bit word into the buffer
+*	o ChorusBuffer_WriteStream: writes consecutive 16-bit words into the buffer
+*	o ChorusBuffer_SetTapOffset: programs one entry of the tap offset table
+*	o ChorusBuffer_ReadTaps: reads every delay tap behind a line at once
+*	o ChorusBuffer_SetChorusLFO: sets the rate & shape of the chorus LFO
+*	o ChorusBuffer_SetChorus: sets the delay sweep & gains of the chorus voice
+*	o ChorusBuffer_SetChorusPhase: loads the phase of the chorus LFO
+*	o ChorusBuffer_ReadChorus: reads a block of chorus output from the hardware
 */
 
 /****************************************************************************/
@@ -91,6 +99,42 @@ unsigned int ChorusBuffer_ReadLine (unsigned int bufline) {
 	return read_data;	
 }
 
+/******************** ChorusBuffer_ReadBlock ********************/	
+/**
+* Reads a run of consecutive buffer lines.
+* 
+* This loads the first line into the stream read address by writing
+* slv_reg4 (CHORUSBUFFER_READ_STREAM_ADDRESS), then reads slv_reg4
+* (CHORUSBUFFER_DATA_OUTPUT_PORT_B) once per line. Each read returns the
+* current line and advances the address, so a block costs one address write
+* plus one read per sample instead of the two transactions per sample used by
+* ChorusBuffer_ReadLine.
+*
+* @param	First buffer line to be read (valid inputs: 0 - 65535)
+*			Number of lines to read (wraps around at the end of the buffer)
+*			Array receiving the 16-bit values
+*
+* @return	Nothing.
+*
+* @note		The next ChorusBuffer_ReadLine switches Port B back to plain addressing.
+*
+*****************************************************************************/
+
+void ChorusBuffer_ReadBlock(unsigned int start, unsigned int count, unsigned int *dst) {
+
+	unsigned int i;
+
+	// load the first line & hand Port B over to the stream address
+	CHORUSBUFFER_mWriteReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_READ_STREAM_ADDRESS, (start & 0x0000FFFF));
+
+	// every read returns the current line and advances the address
+	for (i = 0; i < count; i++) {
+		dst[i] = (CHORUSBUFFER_mReadReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_DATA_OUTPUT_PORT_B)) & 0x0000FFFF;
+	}
+
+	return;
+}
+
 /******************** ChorusBuffer_WriteLine ********************/	
 /**
 * Writes a 16-bit value to the bufer line.  
@@ -119,4 +163,210 @@ void ChorusBuffer_WriteLine(unsigned int bufline, unsigned int data) {
 	CHORUSBUFFER_mWriteReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_WRITE_ENABLE_PORT_A, MSK_WRITE_ENABLE_LOW);
 	
 	return;
-}
\ No newline at end of file
+}
+
+/******************** ChorusBuffer_WriteStream ********************/	
+/**
+* Writes a run of 16-bit values to consecutive buffer lines.
+* 
+* This puts Port A into auto-increment mode through slv_reg5 (CHORUSBUFFER_CONTROL),
+* loads the first line into slv_reg1 (CHORUSBUFFER_WRITE_ADDRESS_PORT_A) and then
+* writes each value to slv_reg2 (CHORUSBUFFER_DATA_INPUT_PORT_A). Every data write
+* commits the value and advances the line, so each sample costs one bus write
+* instead of the four used by ChorusBuffer_WriteLine.
+*
+* @param	First buffer line to be written (valid inputs: 0 - 65535)
+*			Number of lines to write (wraps around at the end of the buffer)
+*			Buffer data to be written (valid inputs: 0 - 65535 per entry)
+*
+* @return	Nothing.
+*
+* @note		ChorusBuffer_WriteLine still works while auto-increment mode is on.
+*
+*****************************************************************************/
+
+void ChorusBuffer_WriteStream(unsigned int start, unsigned int count, const unsigned int *src) {
+
+	unsigned int i;
+
+	// switch Port A over to the auto-increment write port
+	CHORUSBUFFER_mWriteReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_CONTROL, MSK_AUTO_INCREMENT_ON);
+
+	// load the first line, then every data write commits & advances
+	CHORUSBUFFER_mWriteReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_WRITE_ADDRESS_PORT_A, (start & 0x0000FFFF));
+
+	for (i = 0; i < count; i++) {
+		CHORUSBUFFER_mWriteReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_DATA_INPUT_PORT_A, (src[i] & 0x0000FFFF));
+	}
+
+	return;
+}
+
+/******************** ChorusBuffer_SetTapOffset ********************/	
+/**
+* Programs how far one tap of the multi-tap read port sits behind the base.
+* 
+* This works through a single write on slv_reg6 (CHORUSBUFFER_TAP_OFFSET),
+* with the tap number in bits [17:16] and the offset in bits [15:0].
+* The table keeps its contents until it is written again.
+*
+* @param	Tap number (valid inputs: 0 - CHORUSBUFFER_NUM_TAPS-1)
+*			Offset in lines behind the base (valid inputs: 0 - 65535)
+*
+* @return	Nothing.
+*
+*
+*****************************************************************************/
+
+void ChorusBuffer_SetTapOffset(unsigned int tap, unsigned int offset) {
+
+	if (tap >= CHORUSBUFFER_NUM_TAPS) {
+		return;
+	}
+
+	CHORUSBUFFER_mWriteReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_TAP_OFFSET,
+		(tap << CHORUSBUFFER_TAP_INDEX_SHIFT) | (offset & 0x0000FFFF));
+
+	return;
+}
+
+/******************** ChorusBuffer_ReadTaps ********************/	
+/**
+* Returns the value of every tap behind the base buffer line.
+* 
+* This works through a single write on slv_reg7 (CHORUSBUFFER_TAP_BASE),
+* after which the hardware fetches line (base - offset) for each tap.
+* The results are then read from slv_reg5..7 (CHORUSBUFFER_TAP_DATA_0..2);
+* the slave holds off the first read until the fetch is done. Taps wrap
+* around the start of the buffer.
+*
+* @param	Base buffer line (valid inputs: 0 - 65535)
+*			Array receiving CHORUSBUFFER_NUM_TAPS 16-bit values
+*
+* @return	Nothing.
+*
+*
+*****************************************************************************/
+
+void ChorusBuffer_ReadTaps(unsigned int base, unsigned int *taps) {
+
+	// one base address write kicks off the fetch for every tap
+	CHORUSBUFFER_mWriteReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_TAP_BASE, (base & 0x0000FFFF));
+
+	taps[0] = (CHORUSBUFFER_mReadReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_TAP_DATA_0)) & 0x0000FFFF;
+	taps[1] = (CHORUSBUFFER_mReadReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_TAP_DATA_1)) & 0x0000FFFF;
+	taps[2] = (CHORUSBUFFER_mReadReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_TAP_DATA_2)) & 0x0000FFFF;
+
+	return;
+}
+
+/******************** ChorusBuffer_SetChorusLFO ********************/	
+/**
+* Programs the rate & shape of the LFO in the chorus voice generator.
+* 
+* This works through two writes: the phase increment per sample goes into
+* slv_reg8 (CHORUSBUFFER_CHORUS_RATE) and the waveform into slv_reg11
+* (CHORUSBUFFER_CHORUS_CONTROL). A full LFO cycle is 2^32, so the increment
+* for a period of N samples is 2^32 / N.
+*
+* @param	Phase increment per sample (valid inputs: 0 - 2^32-1)
+*			Waveform (valid inputs: false = sine, true = triangle)
+*
+* @return	Nothing.
+*
+*
+*****************************************************************************/
+
+void ChorusBuffer_SetChorusLFO(u32 increment, bool triangle) {
+
+	CHORUSBUFFER_mWriteReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_CHORUS_RATE, increment);
+	CHORUSBUFFER_mWriteReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_CHORUS_CONTROL,
+		triangle ? MSK_CHORUS_TRIANGLE : MSK_CHORUS_SINE);
+
+	return;
+}
+
+/******************** ChorusBuffer_SetChorus ********************/	
+/**
+* Programs the delay sweep & the gains of the chorus voice generator.
+* 
+* The voice is read (base + depth * w) lines behind the current line, where
+* w runs from 0 to 1 with the LFO. The output is the current line scaled by
+* the in gain plus the voice scaled by the voice gain. Base & depth go into
+* slv_reg9 (CHORUSBUFFER_CHORUS_DELAY), the gains into slv_reg10
+* (CHORUSBUFFER_CHORUS_GAIN). Base + depth + 1 has to stay below
+* CHORUSBUFFER_CHORUS_LINES.
+*
+* @param	Base delay in lines (valid inputs: 0 - 32766)
+*			Depth of the sweep in lines (valid inputs: 0 - 32766)
+*			Gain of the current line, unsigned Q1.15 (valid inputs: 0 - 65535)
+*			Gain of the delayed voice, unsigned Q1.15 (valid inputs: 0 - 65535)
+*
+* @return	Nothing.
+*
+*
+*****************************************************************************/
+
+void ChorusBuffer_SetChorus(unsigned int base, unsigned int depth, unsigned int in_gain, unsigned int voice_gain) {
+
+	CHORUSBUFFER_mWriteReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_CHORUS_DELAY,
+		(depth << CHORUSBUFFER_CHORUS_DEPTH_SHIFT) | (base & 0x0000FFFF));
+
+	CHORUSBUFFER_mWriteReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_CHORUS_GAIN,
+		(voice_gain << CHORUSBUFFER_CHORUS_VOICE_SHIFT) | (in_gain & 0x0000FFFF));
+
+	return;
+}
+
+/******************** ChorusBuffer_SetChorusPhase ********************/	
+/**
+* Loads the phase of the LFO in the chorus voice generator.
+* 
+* This works through a single write on slv_reg12 (CHORUSBUFFER_CHORUS_PHASE).
+* The phase then moves on by the increment with every sample read.
+*
+* @param	LFO phase (valid inputs: 0 - 2^32-1, 2^32 = one cycle)
+*
+* @return	Nothing.
+*
+*
+*****************************************************************************/
+
+void ChorusBuffer_SetChorusPhase(u32 phase) {
+
+	CHORUSBUFFER_mWriteReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_CHORUS_PHASE, phase);
+
+	return;
+}
+
+/******************** ChorusBuffer_ReadChorus ********************/	
+/**
+* Returns the chorus output for a block of consecutive history lines.
+* 
+* This works through a single write of the first line on slv_reg13
+* (CHORUSBUFFER_CHORUS_LINE). Every read of slv_reg14 (CHORUSBUFFER_CHORUS_OUTPUT)
+* then returns the output for one line and moves the generator on to the
+* next line & LFO phase; the slave holds off a read until the sample is
+* ready. The history for the block has to be written before this is called.
+*
+* @param	Starting history line (valid inputs: 0 - 65535, wraps at CHORUSBUFFER_CHORUS_LINES)
+*			Number of samples to read
+*			Array receiving the 16-bit output samples
+*
+* @return	Nothing.
+*
+*
+*****************************************************************************/
+
+void ChorusBuffer_ReadChorus(unsigned int start, unsigned int count, unsigned int *dst) {
+
+	unsigned int i;
+
+	CHORUSBUFFER_mWriteReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_CHORUS_LINE, (start & 0x0000FFFF));
+
+	for (i = 0; i < count; i++) {
+		dst[i] = (CHORUSBUFFER_mReadReg(ChorusBuffer_BaseAddress, CHORUSBUFFER_CHORUS_OUTPUT)) & 0x0000FFFF;
+	}
+
+	return;
+}
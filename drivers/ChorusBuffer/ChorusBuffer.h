@@ -46,6 +46,14 @@
 #define		CHORUSBUFFER_UPPER_HALF_MASK 	0xFFFF0000
 #define		CHORUSBUFFER_LOWER_HALF_MASK	0x0000FFFF
 
+// Number of taps in the multi-tap read port
+
+#define		CHORUSBUFFER_NUM_TAPS			3
+
+// History lines the chorus voice generator reads from (lower half)
+
+#define		CHORUSBUFFER_CHORUS_LINES		32768
+
 /* @} */
 
 /****************************************************************************/
@@ -56,11 +64,11 @@
 // we can use these definitions instead.
 // They will not override pre-existing definitions, though.
 
-#ifndef MIN(a, b)
+#ifndef MIN
 #define MIN(a, b)  ( ((a) <= (b)) ? (a) : (b) )
 #endif
 
-#ifndef MAX(a, b)
+#ifndef MAX
 #define MAX(a, b)  ( ((a) >= (b)) ? (a) : (b) )
 #endif
 
@@ -74,7 +82,31 @@ int ChorusBuffer_initialize(u32 BaseAddr);
 // Read a line in the buffer
 unsigned int ChorusBuffer_ReadLine(unsigned int bufline);
 
+// Read a block of consecutive lines in the buffer
+void ChorusBuffer_ReadBlock(unsigned int start, unsigned int count, unsigned int *dst);
+
 // Write a line in the buffer
 void ChorusBuffer_WriteLine(unsigned int bufline, unsigned int data);
 
+// Write a block of consecutive lines in the buffer
+void ChorusBuffer_WriteStream(unsigned int start, unsigned int count, const unsigned int *src);
+
+// Program the distance of one tap behind the tap base address
+void ChorusBuffer_SetTapOffset(unsigned int tap, unsigned int offset);
+
+// Read all taps behind a base address in one go
+void ChorusBuffer_ReadTaps(unsigned int base, unsigned int *taps);
+
+// Program the LFO of the chorus voice generator
+void ChorusBuffer_SetChorusLFO(u32 increment, bool triangle);
+
+// Program the delay sweep & the gains of the chorus voice generator
+void ChorusBuffer_SetChorus(unsigned int base, unsigned int depth, unsigned int in_gain, unsigned int voice_gain);
+
+// Load the LFO phase of the chorus voice generator
+void ChorusBuffer_SetChorusPhase(u32 phase);
+
+// Read a block of chorus output samples from consecutive history lines
+void ChorusBuffer_ReadChorus(unsigned int start, unsigned int count, unsigned int *dst);
+
 #endif
\ No newline at end of file
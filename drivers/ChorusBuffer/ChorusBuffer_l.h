@@ -32,13 +32,35 @@
 #define CHORUSBUFFER_DATA_INPUT_PORT_A 		8
 #define CHORUSBUFFER_READ_ADDRESS_PORT_B 	12
 #define CHORUSBUFFER_DATA_OUTPUT_PORT_B 	16
-#define CHORUSBUFFER_RSVD_00 				20
-#define CHORUSBUFFER_RSVD_01 				24
-#define CHORUSBUFFER_RSVD_02 				28
+#define CHORUSBUFFER_READ_STREAM_ADDRESS 	16
+#define CHORUSBUFFER_CONTROL 				20
+#define CHORUSBUFFER_TAP_OFFSET 			24
+#define CHORUSBUFFER_TAP_BASE 				28
+#define CHORUSBUFFER_CHORUS_RATE 			32
+#define CHORUSBUFFER_CHORUS_DELAY 			36
+#define CHORUSBUFFER_CHORUS_GAIN 			40
+#define CHORUSBUFFER_CHORUS_CONTROL 		44
+#define CHORUSBUFFER_CHORUS_PHASE 			48
+#define CHORUSBUFFER_CHORUS_LINE 			52
+#define CHORUSBUFFER_CHORUS_OUTPUT 			56
+
+#define CHORUSBUFFER_TAP_DATA_0 			20
+#define CHORUSBUFFER_TAP_DATA_1 			24
+#define CHORUSBUFFER_TAP_DATA_2 			28
 
 #define MSK_WRITE_ENABLE_HIGH 				0x00000001
 #define MSK_WRITE_ENABLE_LOW				0x00000000
 
+#define MSK_AUTO_INCREMENT_ON 				0x00000001
+#define MSK_AUTO_INCREMENT_OFF 				0x00000000
+
+#define MSK_CHORUS_SINE 					0x00000000
+#define MSK_CHORUS_TRIANGLE 				0x00000001
+
+#define CHORUSBUFFER_TAP_INDEX_SHIFT 		16
+#define CHORUSBUFFER_CHORUS_DEPTH_SHIFT 	16
+#define CHORUSBUFFER_CHORUS_VOICE_SHIFT 	16
+
 /**************************** Type Definitions *****************************/
 /**
  *
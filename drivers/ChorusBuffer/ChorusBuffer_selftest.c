@@ -6,8 +6,9 @@
 * @copyright Portland State University, 2016
 *
 * This file implements the self-test function for the custom peripheral "ChorusBuffer". 
-* It writes to the last three memory addresses of the peripheral and then
-* reads those values back to make sure everything is correct.
+* It writes to the Port A & Port B address/data registers and then reads
+* those values back. slv_reg5..7 hold the multi-tap read port, so it then
+* writes a test line into the Block RAM and checks it comes back on a tap.
 *
 * If there is any discrepancy between the read/write, it will return failure status.
 * Otherwise, it will return a successful status.
@@ -28,6 +29,8 @@
 /****************************************************************************/
 
 #define READ_WRITE_MUL_FACTOR 0x10
+#define TAP_TEST_LINE 		0x0000FFFF
+#define TAP_TEST_DATA 		0x0000A5C3
 
 /************************** Function Definitions ***************************/
 /**
@@ -58,12 +61,16 @@ XStatus ChorusBuffer_Reg_SelfTest(u32 baseaddr) {
 	xil_printf("*   CHORUSBUFFER Self Test   *\n\r");
 	xil_printf("******************************\n\n\r");
 
-	// write values to the last three registers...
-	// AXI: slv_reg5, slv_reg6 & slv_reg7
+	// write values to the address & data registers...
+	// AXI: slv_reg1, slv_reg2 & slv_reg3
 
 	xil_printf("User logic slave module test...\n\r");
 
-	for (write_loop_index = 5 ; write_loop_index < 8; write_loop_index++) {
+	// Port A back in manual mode so the data write below is not committed
+
+	CHORUSBUFFER_mWriteReg(baseaddr, CHORUSBUFFER_CONTROL, MSK_AUTO_INCREMENT_OFF);
+
+	for (write_loop_index = 1 ; write_loop_index < 4; write_loop_index++) {
 
 	  	CHORUSBUFFER_mWriteReg(baseaddr, write_loop_index*4, (write_loop_index+1)*READ_WRITE_MUL_FACTOR);
 		xil_printf ("\nWrote to memory address %x\n", (int)baseaddr + write_loop_index*4);
@@ -71,7 +78,7 @@ XStatus ChorusBuffer_Reg_SelfTest(u32 baseaddr) {
 
 	// now read back the written values and make sure they match
 
-	for (read_loop_index = 5 ; read_loop_index < 8; read_loop_index++) {
+	for (read_loop_index = 1 ; read_loop_index < 4; read_loop_index++) {
 
 		if ( CHORUSBUFFER_mReadReg (baseaddr, read_loop_index*4) != (read_loop_index+1)*READ_WRITE_MUL_FACTOR) {
 
@@ -80,9 +87,30 @@ XStatus ChorusBuffer_Reg_SelfTest(u32 baseaddr) {
 		}
 	}
 
+	// write a test value into the last buffer line...
+
+	CHORUSBUFFER_mWriteReg(baseaddr, CHORUSBUFFER_WRITE_ADDRESS_PORT_A, TAP_TEST_LINE);
+	CHORUSBUFFER_mWriteReg(baseaddr, CHORUSBUFFER_DATA_INPUT_PORT_A, TAP_TEST_DATA);
+	CHORUSBUFFER_mWriteReg(baseaddr, CHORUSBUFFER_WRITE_ENABLE_PORT_A, MSK_WRITE_ENABLE_HIGH);
+	CHORUSBUFFER_mWriteReg(baseaddr, CHORUSBUFFER_WRITE_ENABLE_PORT_A, MSK_WRITE_ENABLE_LOW);
+
+	// ...and fetch it back through tap 0, one line behind a base of zero
+
+	CHORUSBUFFER_mWriteReg(baseaddr, CHORUSBUFFER_TAP_OFFSET, (0 << CHORUSBUFFER_TAP_INDEX_SHIFT) | 1);
+	CHORUSBUFFER_mWriteReg(baseaddr, CHORUSBUFFER_TAP_BASE, 0);
+
+	if ( (CHORUSBUFFER_mReadReg (baseaddr, CHORUSBUFFER_TAP_DATA_0) & 0x0000FFFF) != TAP_TEST_DATA) {
+
+		xil_printf ("Error reading tap value at address %x\n", (int)baseaddr + CHORUSBUFFER_TAP_DATA_0);
+		return XST_FAILURE;
+	}
+
+	CHORUSBUFFER_mWriteReg(baseaddr, CHORUSBUFFER_TAP_OFFSET, (0 << CHORUSBUFFER_TAP_INDEX_SHIFT) | 0);
+
 	// no hazards encountered... return successful status
 
-	xil_printf("   - slave register write/read passed\n\n\r");
+	xil_printf("   - slave register write/read passed\n\r");
+	xil_printf("   - multi-tap read passed\n\n\r");
 
 	return XST_SUCCESS;
 }
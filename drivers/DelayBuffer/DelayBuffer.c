@@ -11,6 +11,10 @@
 *
 * 	o DelayBuffer_initialize: initialize the peripheral into the correct mode
 *	o DelayBuffer_WriteLine: writes a 16-bit word into the buffer
+*	o DelayBuffer_WriteStream: writes consecutive 16-bit words into the buffer
+*	o DelayBuffer_GetReadPointer: returns the line being played by AudioOutput
+*	o DelayBuffer_SetEchoTap: programs one tap of the hardware echo engine
+*	o DelayBuffer_SetEcho: sets the number of echo taps & turns the engine on or off
 */
 
 /****************************************************************************/
@@ -91,4 +95,121 @@ void DelayBuffer_WriteLine(unsigned int bufline, unsigned int data) {
 	DELAYBUFFER_mWriteReg(DelayBuffer_BaseAddress, DELAYBUFFER_WRITE_ENABLE_PORT_A, MSK_WRITE_ENABLE_LOW);
 	
 	return;
-}
\ No newline at end of file
+}
+
+/******************** DelayBuffer_WriteStream ********************/	
+/**
+* Writes a run of 16-bit values to consecutive buffer lines.
+* 
+* This puts Port A into auto-increment mode through slv_reg5 (DELAYBUFFER_CONTROL),
+* loads the first line into slv_reg1 (DELAYBUFFER_WRITE_ADDRESS_PORT_A) and then
+* writes each value to slv_reg2 (DELAYBUFFER_DATA_INPUT_PORT_A). Every data write
+* commits the value and advances the line, so each sample costs one bus write
+* instead of the four used by DelayBuffer_WriteLine.
+*
+* @param	First buffer line to be written (valid inputs: 0 - 65535)
+*			Number of lines to write (wraps around at the end of the buffer)
+*			Buffer data to be written (valid inputs: 0 - 65535 per entry)
+*
+* @return	Nothing.
+*
+* @note		DelayBuffer_WriteLine still works while auto-increment mode is on.
+*
+*****************************************************************************/
+
+void DelayBuffer_WriteStream(unsigned int start, unsigned int count, const unsigned int *src) {
+
+	unsigned int i;
+
+	// switch Port A over to the auto-increment write port
+	DELAYBUFFER_mWriteReg(DelayBuffer_BaseAddress, DELAYBUFFER_CONTROL, MSK_AUTO_INCREMENT_ON);
+
+	// load the first line, then every data write commits & advances
+	DELAYBUFFER_mWriteReg(DelayBuffer_BaseAddress, DELAYBUFFER_WRITE_ADDRESS_PORT_A, (start & 0x0000FFFF));
+
+	for (i = 0; i < count; i++) {
+		DELAYBUFFER_mWriteReg(DelayBuffer_BaseAddress, DELAYBUFFER_DATA_INPUT_PORT_A, (src[i] & 0x0000FFFF));
+	}
+
+	return;
+}
+
+/******************** DelayBuffer_GetReadPointer ********************/	
+/**
+* Returns the buffer line the AudioOutput module is currently playing.
+* 
+* This works through a single read on slv_reg7 (DELAYBUFFER_READ_POINTER),
+* which the hardware keeps synchronized to the Port B read address.
+*
+* @param	None.
+*
+* @return	Buffer line being played (0 - 65535).
+*
+*
+*****************************************************************************/
+
+unsigned int DelayBuffer_GetReadPointer(void) {
+
+	return (DELAYBUFFER_mReadReg(DelayBuffer_BaseAddress, DELAYBUFFER_READ_POINTER)) & 0x0000FFFF;
+}
+
+/******************** DelayBuffer_SetEchoTap ********************/	
+/**
+* Programs the delay and gain of one tap of the echo engine.
+* 
+* The tap word goes to slv_reg3 (DELAYBUFFER_ECHO_TAP_DATA), gain in bits [31:16]
+* and delay in bits [15:0], and writing the tap number to slv_reg4
+* (DELAYBUFFER_ECHO_TAP_SELECT) copies it into the tap table. The engine adds
+* (line[n - delay] * gain) >> 15 to every line it plays, like one tap of
+* delay_line_mix().
+*
+* @param	Tap number (valid inputs: 0 - DELAYBUFFER_ECHO_TAPS-1)
+*			Delay in lines behind the line being played (valid inputs: 0 - 65535)
+*			Unsigned Q1.15 gain (valid inputs: 0 - 65535, 0x8000 = 1.0)
+*
+* @return	Nothing.
+*
+* @note		The delay has to stay clear of the lines written ahead of the read
+*			pointer, or the tap picks up output that has not been played yet.
+*
+*****************************************************************************/
+
+void DelayBuffer_SetEchoTap(unsigned int tap, unsigned int delay, unsigned int gain) {
+
+	// load the tap word, then commit it to the selected tap
+	DELAYBUFFER_mWriteReg(DelayBuffer_BaseAddress, DELAYBUFFER_ECHO_TAP_DATA,
+		((gain << ECHO_TAP_GAIN_SHIFT) & MSK_ECHO_TAP_GAIN) | (delay & MSK_ECHO_TAP_DELAY));
+
+	DELAYBUFFER_mWriteReg(DelayBuffer_BaseAddress, DELAYBUFFER_ECHO_TAP_SELECT, tap);
+
+	return;
+}
+
+/******************** DelayBuffer_SetEcho ********************/	
+/**
+* Sets the number of active echo taps and turns the echo engine on or off.
+* 
+* This works through a single write on slv_reg6 (DELAYBUFFER_ECHO_CONTROL),
+* with the tap count in bits [3:0] and the enable in bit 8. With the engine
+* off (or no taps) AudioOutput plays the buffer lines unchanged.
+*
+* @param	Number of taps, starting from tap 0 (valid inputs: 0 - DELAYBUFFER_ECHO_TAPS)
+*			true to turn the echo on
+*
+* @return	Nothing.
+*
+*
+*****************************************************************************/
+
+void DelayBuffer_SetEcho(unsigned int num_taps, bool enable) {
+
+	u32 control = MIN(num_taps, DELAYBUFFER_ECHO_TAPS) & MSK_ECHO_NUM_TAPS;
+
+	if (enable) {
+		control |= MSK_ECHO_ENABLE;
+	}
+
+	DELAYBUFFER_mWriteReg(DelayBuffer_BaseAddress, DELAYBUFFER_ECHO_CONTROL, control);
+
+	return;
+}
@@ -46,6 +46,10 @@
 #define		DELAYBUFFER_UPPER_HALF_MASK 	0xFFFF0000
 #define		DELAYBUFFER_LOWER_HALF_MASK		0x0000FFFF
 
+// Echo engine: number of taps in the hardware (ECHO_TAPS in the IP)
+
+#define		DELAYBUFFER_ECHO_TAPS			8
+
 /* @} */
 
 /****************************************************************************/
@@ -56,11 +60,11 @@
 // we can use these definitions instead.
 // They will not override pre-existing definitions, though.
 
-#ifndef MIN(a, b)
+#ifndef MIN
 #define MIN(a, b)  ( ((a) <= (b)) ? (a) : (b) )
 #endif
 
-#ifndef MAX(a, b)
+#ifndef MAX
 #define MAX(a, b)  ( ((a) >= (b)) ? (a) : (b) )
 #endif
 
@@ -74,4 +78,14 @@ int DelayBuffer_initialize(u32 BaseAddr);
 // Write a line in the buffer
 void DelayBuffer_WriteLine(unsigned int bufline, unsigned int data);
 
+// Write a block of consecutive lines in the buffer
+void DelayBuffer_WriteStream(unsigned int start, unsigned int count, const unsigned int *src);
+
+// Line currently being played by AudioOutput
+unsigned int DelayBuffer_GetReadPointer(void);
+
+// Echo engine: one tap (delay in lines, Q1.15 gain), and the active tap count
+void DelayBuffer_SetEchoTap(unsigned int tap, unsigned int delay, unsigned int gain);
+void DelayBuffer_SetEcho(unsigned int num_taps, bool enable);
+
 #endif
\ No newline at end of file
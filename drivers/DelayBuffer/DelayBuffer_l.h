@@ -30,15 +30,25 @@
 #define DELAYBUFFER_WRITE_ENABLE_PORT_A 	0
 #define DELAYBUFFER_WRITE_ADDRESS_PORT_A 	4
 #define DELAYBUFFER_DATA_INPUT_PORT_A 		8
-#define DELAYBUFFER_RSVD_00 				12
-#define DELAYBUFFER_RSVD_01 				16
-#define DELAYBUFFER_RSVD_02 				20
-#define DELAYBUFFER_RSVD_03 				24
-#define DELAYBUFFER_RSVD_04 				28
+#define DELAYBUFFER_ECHO_TAP_DATA 			12
+#define DELAYBUFFER_ECHO_TAP_SELECT 		16
+#define DELAYBUFFER_CONTROL 				20
+#define DELAYBUFFER_ECHO_CONTROL 			24
+#define DELAYBUFFER_READ_POINTER 			28
 
 #define MSK_WRITE_ENABLE_HIGH 				0x00000001
 #define MSK_WRITE_ENABLE_LOW				0x00000000
 
+#define MSK_AUTO_INCREMENT_ON 				0x00000001
+#define MSK_AUTO_INCREMENT_OFF 				0x00000000
+
+#define MSK_ECHO_TAP_DELAY 					0x0000FFFF
+#define MSK_ECHO_TAP_GAIN 					0xFFFF0000
+#define MSK_ECHO_NUM_TAPS 					0x0000000F
+#define MSK_ECHO_ENABLE 					0x00000100
+
+#define ECHO_TAP_GAIN_SHIFT 				16
+
 
 /**************************** Type Definitions *****************************/
 /**
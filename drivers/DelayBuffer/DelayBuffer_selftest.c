@@ -58,19 +58,20 @@ XStatus DelayBuffer_Reg_SelfTest(u32 baseaddr) {
 	xil_printf("*   DELAY BUFFER Self Test   *\n\r");
 	xil_printf("******************************\n\n\r");
 
-	// write values to the last five registers...
-	// AXI: slv_reg3, slv_reg4, slv_reg5, slv_reg6 & slv_reg7
+	// write values to the free registers...
+	// AXI: slv_reg3, slv_reg4, slv_reg5 & slv_reg6
+	// (slv_reg7 reads back the AudioOutput read pointer)
 
 	xil_printf("User logic slave module test...\n\r");
 
-	for (write_loop_index = 3 ; write_loop_index < 8; write_loop_index++) {
+	for (write_loop_index = 3 ; write_loop_index < 7; write_loop_index++) {
 		DELAYBUFFER_mWriteReg (baseaddr, write_loop_index*4, (write_loop_index+1)*READ_WRITE_MUL_FACTOR);
 		xil_printf ("\nWrote to memory address %x\n", (int)baseaddr + write_loop_index*4);
 	}
 
 		// now read back the written values and make sure they match
 
-	for (read_loop_index = 3 ; read_loop_index < 8; read_loop_index++) {
+	for (read_loop_index = 3 ; read_loop_index < 7; read_loop_index++) {
 
 		if ( DELAYBUFFER_mReadReg (baseaddr, read_loop_index*4) != (read_loop_index+1)*READ_WRITE_MUL_FACTOR){
 	    	xil_printf ("Error reading register value at address %x\n", (int)baseaddr + read_loop_index*4);
@@ -78,6 +79,12 @@ XStatus DelayBuffer_Reg_SelfTest(u32 baseaddr) {
 		}
 	}
 
+	// clear them again, which leaves the echo engine off
+
+	for (write_loop_index = 3 ; write_loop_index < 7; write_loop_index++) {
+		DELAYBUFFER_mWriteReg (baseaddr, write_loop_index*4, 0);
+	}
+
 	// no hazards encountered... return successful status
 
 	xil_printf("   - slave register write/read passed\n\n\r");
@@ -11,6 +11,10 @@
 *
 * 	o InputBuffer_initialize: initialize the peripheral into the correct mode
 * 	o InputBuffer_ReadLine: reads a 16-bit word from the buffer
+* 	o InputBuffer_ReadBlock: reads consecutive 16-bit words from the buffer
+* 	o InputBuffer_GetWritePointer: returns the last line written by AudioInput
+* 	o InputBuffer_SetInterrupts: sets up the half-full / full interrupts
+* 	o InputBuffer_AckInterrupts: reads & clears the pending interrupts
 */
 
 /****************************************************************************/
@@ -88,4 +92,112 @@ unsigned int InputBuffer_ReadLine (unsigned int bufline) {
 	read_data = (INPUTBUFFER_mReadReg(InputBuffer_BaseAddress, INPUTBUFFER_DATA_OUTPUT_PORT_B)) & 0x0000FFFF;
 	
 	return read_data;	
-}
\ No newline at end of file
+}
+
+/******************** InputBuffer_ReadBlock ********************/	
+/**
+* Copies a run of consecutive buffer lines into a caller-supplied array.
+* 
+* This works through a single write on slv_reg0 (INPUTBUFFER_STREAM_ADDRESS),
+* followed by one read per line on slv_reg1 (INPUTBUFFER_STREAM_DATA).
+* The hardware advances the stream address after every data read, so each
+* line costs one bus transaction instead of the two used by ReadLine.
+*
+* @param	First buffer line to be read (valid inputs: 0 - 65535)
+*			Number of lines to read (wraps around at the end of the buffer)
+*			Destination array, must hold at least count entries
+*
+* @return	Nothing.
+*
+* @note		Port B stays on the stream address until the next ReadLine call.
+*
+*****************************************************************************/
+
+void InputBuffer_ReadBlock(unsigned int start, unsigned int count, unsigned int *dst) {
+
+	unsigned int i;
+
+	// load the stream address once for the whole block
+	INPUTBUFFER_mWriteReg(InputBuffer_BaseAddress, INPUTBUFFER_STREAM_ADDRESS, (start & 0x0000FFFF));
+
+	// every read returns the current line and advances the stream address
+	for (i = 0; i < count; i++) {
+		dst[i] = (INPUTBUFFER_mReadReg(InputBuffer_BaseAddress, INPUTBUFFER_STREAM_DATA)) & 0x0000FFFF;
+	}
+
+	return;
+}
+
+/******************** InputBuffer_GetWritePointer ********************/	
+/**
+* Returns the last buffer line written by the AudioInput module.
+* 
+* This works through a single read on slv_reg2 (INPUTBUFFER_WRITE_POINTER),
+* which the hardware keeps synchronized to the Port A write address.
+*
+* @param	None.
+*
+* @return	Last buffer line written (0 - 65535).
+*
+*
+*****************************************************************************/
+
+unsigned int InputBuffer_GetWritePointer(void) {
+
+	return (INPUTBUFFER_mReadReg(InputBuffer_BaseAddress, INPUTBUFFER_WRITE_POINTER)) & 0x0000FFFF;
+}
+
+/******************** InputBuffer_SetInterrupts ********************/	
+/**
+* Sets up the half-full & full interrupts of the InputBuffer.
+* 
+* The buffer is split into ping-pong windows of two halves of 2^half_bits
+* lines each. The half-full interrupt fires when AudioInput has written the
+* last line of the first half of a window, the full interrupt when it has
+* written the last line of the second. With half_bits = 15 the window is
+* the whole buffer. This works through a single write on slv_reg5
+* (INPUTBUFFER_INTR_CONTROL); anything still pending is cleared first.
+*
+* @param	Size of one half as a power of two (valid inputs: 0 - 15)
+*			Interrupts to enable (MSK_INTR_HALF_FULL, MSK_INTR_FULL, or both)
+*
+* @return	Nothing.
+*
+*
+*****************************************************************************/
+
+void InputBuffer_SetInterrupts(unsigned int half_bits, unsigned int enable) {
+
+	INPUTBUFFER_mWriteReg(InputBuffer_BaseAddress, INPUTBUFFER_INTR_CONTROL, 0);
+	INPUTBUFFER_mWriteReg(InputBuffer_BaseAddress, INPUTBUFFER_INTR_STATUS, MSK_INTR_ALL);
+
+	INPUTBUFFER_mWriteReg(InputBuffer_BaseAddress, INPUTBUFFER_INTR_CONTROL,
+		((enable & MSK_INTR_ALL) << INPUTBUFFER_INTR_ENABLE_SHIFT) | (half_bits & MSK_INTR_HALF_BITS));
+
+	return;
+}
+
+/******************** InputBuffer_AckInterrupts ********************/	
+/**
+* Returns the pending half-full & full interrupts, and clears them.
+* 
+* This works through a read of slv_reg6 (INPUTBUFFER_INTR_STATUS) and a
+* write of the same bits back to it, which drops the interrupt output.
+* Call it from the interrupt handler.
+*
+* @param	None.
+*
+* @return	Pending interrupts (MSK_INTR_HALF_FULL and / or MSK_INTR_FULL).
+*
+*
+*****************************************************************************/
+
+unsigned int InputBuffer_AckInterrupts(void) {
+
+	unsigned int status;
+
+	status = (INPUTBUFFER_mReadReg(InputBuffer_BaseAddress, INPUTBUFFER_INTR_STATUS)) & MSK_INTR_ALL;
+	INPUTBUFFER_mWriteReg(InputBuffer_BaseAddress, INPUTBUFFER_INTR_STATUS, status);
+
+	return status;
+}
@@ -56,11 +56,11 @@
 // we can use these definitions instead.
 // They will not override pre-existing definitions, though.
 
-#ifndef MIN(a, b)
+#ifndef MIN
 #define MIN(a, b)  ( ((a) <= (b)) ? (a) : (b) )
 #endif
 
-#ifndef MAX(a, b)
+#ifndef MAX
 #define MAX(a, b)  ( ((a) >= (b)) ? (a) : (b) )
 #endif
 
@@ -74,4 +74,16 @@ int InputBuffer_initialize(u32 BaseAddr);
 // Read a line in the buffer
 unsigned int InputBuffer_ReadLine(unsigned int bufline);
 
+// Read a block of consecutive lines in the buffer
+void InputBuffer_ReadBlock(unsigned int start, unsigned int count, unsigned int *dst);
+
+// Last line written by AudioInput
+unsigned int InputBuffer_GetWritePointer(void);
+
+// Set up the half-full / full interrupts of a ping-pong window
+void InputBuffer_SetInterrupts(unsigned int half_bits, unsigned int enable);
+
+// Read & clear the pending half-full / full interrupts
+unsigned int InputBuffer_AckInterrupts(void);
+
 #endif
\ No newline at end of file
@@ -28,18 +28,25 @@
 #include "xil_io.h"
 #include "xstatus.h"
 
-#define INPUTBUFFER_RSVD_00 			 	0
-#define INPUTBUFFER_RSVD_01 				4
-#define INPUTBUFFER_RSVD_02			 		8
+#define INPUTBUFFER_STREAM_ADDRESS 		0
+#define INPUTBUFFER_STREAM_DATA 			4
+#define INPUTBUFFER_WRITE_POINTER	 		8
 #define INPUTBUFFER_READ_ADDRESS_PORT_B 	12
 #define INPUTBUFFER_DATA_OUTPUT_PORT_B 		16
-#define INPUTBUFFER_RSVD_03					20
-#define INPUTBUFFER_RSVD_04 				24
+#define INPUTBUFFER_INTR_CONTROL			20
+#define INPUTBUFFER_INTR_STATUS 			24
 #define INPUTBUFFER_RSVD_05 				28
 
 #define MSK_WRITE_ENABLE_HIGH 				0x00000001
 #define MSK_WRITE_ENABLE_LOW				0x00000000
 
+#define MSK_INTR_HALF_BITS 					0x0000000F
+#define MSK_INTR_HALF_FULL 					0x00000001
+#define MSK_INTR_FULL 						0x00000002
+#define MSK_INTR_ALL 						0x00000003
+
+#define INPUTBUFFER_INTR_ENABLE_SHIFT 		8
+
 /**************************** Type Definitions *****************************/
 /**
  *
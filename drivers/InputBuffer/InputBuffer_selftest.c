@@ -6,8 +6,9 @@
 * @copyright Portland State University, 2016
 *
 * This file implements the self-test function for the custom peripheral "InputBuffer". 
-* It writes to the last three memory addresses of the peripheral and then
-* reads those values back to make sure everything is correct.
+* It writes to two of the last three memory addresses of the peripheral and
+* then reads those values back to make sure everything is correct (the one
+* in between is the interrupt status, which is not a plain register).
 *
 * If there is any discrepancy between the read/write, it will return failure status.
 * Otherwise, it will return a successful status.
@@ -58,12 +59,12 @@ XStatus InputBuffer_Reg_SelfTest(u32 baseaddr) {
 	xil_printf("*  * INPUTBUFFER Self Test   *\n\r");
 	xil_printf("******************************\n\n\r");
 
-	// write values to the last three registers...
-	// AXI: slv_reg5, slv_reg6 & slv_reg7
+	// write values to the interrupt control & the last register...
+	// AXI: slv_reg5 & slv_reg7
 
 	xil_printf("User logic slave module test...\n\r");
 
-	for (write_loop_index = 5 ; write_loop_index < 8; write_loop_index++) {
+	for (write_loop_index = 5 ; write_loop_index < 8; write_loop_index += 2) {
 
 	  	INPUTBUFFER_mWriteReg(baseaddr, write_loop_index*4, (write_loop_index+1)*READ_WRITE_MUL_FACTOR);
 		xil_printf ("\nWrote to memory address %x\n", (int)baseaddr + write_loop_index*4);
@@ -71,7 +72,7 @@ XStatus InputBuffer_Reg_SelfTest(u32 baseaddr) {
 
 	// now read back the written values and make sure they match
 
-	for (read_loop_index = 5 ; read_loop_index < 8; read_loop_index++) {
+	for (read_loop_index = 5 ; read_loop_index < 8; read_loop_index += 2) {
 
 		if ( INPUTBUFFER_mReadReg (baseaddr, read_loop_index*4) != (read_loop_index+1)*READ_WRITE_MUL_FACTOR) {
 
@@ -80,6 +81,11 @@ XStatus InputBuffer_Reg_SelfTest(u32 baseaddr) {
 		}
 	}
 
+	// leave the interrupts off, with nothing pending
+
+	INPUTBUFFER_mWriteReg(baseaddr, INPUTBUFFER_INTR_CONTROL, 0);
+	INPUTBUFFER_mWriteReg(baseaddr, INPUTBUFFER_INTR_STATUS, MSK_INTR_ALL);
+
 	// no hazards encountered... return successful status
 
 	xil_printf("   - slave register write/read passed\n\n\r");
@@ -5,13 +5,16 @@
 	(
 		// Users to add parameters here
 
+		// Chorus history: lines 0 .. 2^CHORUS_HISTORY_BITS-1
+		parameter integer CHORUS_HISTORY_BITS	= 15,
+
 		// User parameters ends
 		// Do not modify the parameters beyond this line
 
 
 		// Parameters of Axi Slave Bus Interface S00_AXI
 		parameter integer C_S00_AXI_DATA_WIDTH	= 32,
-		parameter integer C_S00_AXI_ADDR_WIDTH	= 5
+		parameter integer C_S00_AXI_ADDR_WIDTH	= 6
 	)
 	(
 		// Users to add ports here
@@ -45,6 +48,7 @@
 	);
 // Instantiation of Axi Bus Interface S00_AXI
 	ChorusBuffer_v1_0_S00_AXI # ( 
+		.CHORUS_HISTORY_BITS(CHORUS_HISTORY_BITS),
 		.C_S_AXI_DATA_WIDTH(C_S00_AXI_DATA_WIDTH),
 		.C_S_AXI_ADDR_WIDTH(C_S00_AXI_ADDR_WIDTH)
 	) ChorusBuffer_v1_0_S00_AXI_inst (
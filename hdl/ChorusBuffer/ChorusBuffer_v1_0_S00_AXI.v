@@ -5,13 +5,16 @@
 	(
 		// Users to add parameters here
 
+		// Chorus history: lines 0 .. 2^CHORUS_HISTORY_BITS-1
+		parameter integer CHORUS_HISTORY_BITS	= 15,
+
 		// User parameters ends
 		// Do not modify the parameters beyond this line
 
 		// Width of S_AXI data bus
 		parameter integer C_S_AXI_DATA_WIDTH	= 32,
 		// Width of S_AXI address bus
-		parameter integer C_S_AXI_ADDR_WIDTH	= 5
+		parameter integer C_S_AXI_ADDR_WIDTH	= 6
 	)
 	(
 		// Users to add ports here
@@ -99,11 +102,11 @@
 	// ADDR_LSB = 2 for 32 bits (n downto 2)
 	// ADDR_LSB = 3 for 64 bits (n downto 3)
 	localparam integer ADDR_LSB = (C_S_AXI_DATA_WIDTH/32) + 1;
-	localparam integer OPT_MEM_ADDR_BITS = 2;
+	localparam integer OPT_MEM_ADDR_BITS = 3;
 	//----------------------------------------------
 	//-- Signals for user logic register space example
 	//------------------------------------------------
-	//-- Number of Slave Registers 8
+	//-- Number of Slave Registers 16
 	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg0;
 	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg1;
 	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg2;
@@ -112,11 +115,60 @@
 	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg5;
 	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg6;
 	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg7;
+	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg8;
+	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg9;
+	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg10;
+	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg11;
+	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg12;
+	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg13;
+	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg14;
+	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg15;
 	wire	 slv_reg_rden;
 	wire	 slv_reg_wren;
 	reg [C_S_AXI_DATA_WIDTH-1:0]	 reg_data_out;
 	integer	 byte_index;
 
+	//-- Auto-increment write port (see user logic)
+	reg [15:0]	stream_waddr;
+	reg 		stream_we;
+
+	//-- Streamed read port (see user logic)
+	reg [15:0]	stream_raddr;
+	reg 		stream_rsel;
+	reg [1:0]	stream_wait;
+
+	//-- Multi-tap read port (see user logic)
+	localparam integer NUM_TAPS 	= 3;
+	localparam integer TAP_LATENCY 	= 2;
+	reg [15:0]	tap_offset [0:NUM_TAPS-1];
+	reg [15:0]	tap_data [0:NUM_TAPS-1];
+	reg [15:0]	tap_base;
+	reg [1:0]	tap_index;
+	reg [1:0]	tap_wait;
+	reg 		tap_busy;
+	integer		tap_i;
+
+	//-- Chorus voice generator (see user logic)
+	reg [31:0]	chorus_phase;
+	reg [15:0]	chorus_line;
+	reg [15:0]	chorus_out;
+	reg [3:0]	chorus_state;
+	reg [1:0]	chorus_wait;
+	reg 		chorus_busy;
+	reg [15:0]	chorus_addr;
+	reg [31:0]	chorus_delay;
+	reg signed [15:0]	chorus_dry;
+	reg signed [15:0]	chorus_x0;
+	reg signed [15:0]	chorus_x1;
+	reg signed [17:0]	chorus_voice;
+	reg signed [19:0]	chorus_acc;
+	reg [15:0]	lfo_t0;
+	reg [15:0]	lfo_t1;
+	reg [7:0]	lfo_frac;
+	reg 		lfo_neg;
+	reg [14:0]	lfo_tri;
+	reg [14:0]	lfo_level;
+
 	// I/O Connections assignments
 
 	assign S_AXI_AWREADY	= axi_awready;
@@ -224,67 +276,131 @@
 	      slv_reg5 <= 0;
 	      slv_reg6 <= 0;
 	      slv_reg7 <= 0;
+	      slv_reg8 <= 0;
+	      slv_reg9 <= 0;
+	      slv_reg10 <= 0;
+	      slv_reg11 <= 0;
+	      slv_reg12 <= 0;
+	      slv_reg13 <= 0;
+	      slv_reg14 <= 0;
+	      slv_reg15 <= 0;
 	    end 
 	  else begin
 	    if (slv_reg_wren)
 	      begin
 	        case ( axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] )
-	          3'h0:
+	          4'h0:
 	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
 	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
 	                // Respective byte enables are asserted as per write strobes 
 	                // Slave register 0
 	                slv_reg0[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
 	              end  
-	          3'h1:
+	          4'h1:
 	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
 	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
 	                // Respective byte enables are asserted as per write strobes 
 	                // Slave register 1
 	                slv_reg1[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
 	              end  
-	          3'h2:
+	          4'h2:
 	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
 	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
 	                // Respective byte enables are asserted as per write strobes 
 	                // Slave register 2
 	                slv_reg2[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
 	              end  
-	          3'h3:
+	          4'h3:
 	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
 	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
 	                // Respective byte enables are asserted as per write strobes 
 	                // Slave register 3
 	                slv_reg3[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
 	              end  
-	          3'h4:
+	          4'h4:
 	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
 	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
 	                // Respective byte enables are asserted as per write strobes 
 	                // Slave register 4
 	                slv_reg4[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
 	              end  
-	          3'h5:
+	          4'h5:
 	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
 	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
 	                // Respective byte enables are asserted as per write strobes 
 	                // Slave register 5
 	                slv_reg5[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
 	              end  
-	          3'h6:
+	          4'h6:
 	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
 	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
 	                // Respective byte enables are asserted as per write strobes 
 	                // Slave register 6
 	                slv_reg6[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
 	              end  
-	          3'h7:
+	          4'h7:
 	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
 	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
 	                // Respective byte enables are asserted as per write strobes 
 	                // Slave register 7
 	                slv_reg7[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
 	              end  
+	          4'h8:
+	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
+	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 8
+	                slv_reg8[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
+	              end  
+	          4'h9:
+	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
+	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 9
+	                slv_reg9[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
+	              end  
+	          4'hA:
+	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
+	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 10
+	                slv_reg10[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
+	              end  
+	          4'hB:
+	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
+	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 11
+	                slv_reg11[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
+	              end  
+	          4'hC:
+	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
+	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 12
+	                slv_reg12[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
+	              end  
+	          4'hD:
+	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
+	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 13
+	                slv_reg13[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
+	              end  
+	          4'hE:
+	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
+	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 14
+	                slv_reg14[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
+	              end  
+	          4'hF:
+	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
+	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 15
+	                slv_reg15[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
+	              end  
 	          default : begin
 	                      slv_reg0 <= slv_reg0;
 	                      slv_reg1 <= slv_reg1;
@@ -294,6 +410,14 @@
 	                      slv_reg5 <= slv_reg5;
 	                      slv_reg6 <= slv_reg6;
 	                      slv_reg7 <= slv_reg7;
+	                      slv_reg8 <= slv_reg8;
+	                      slv_reg9 <= slv_reg9;
+	                      slv_reg10 <= slv_reg10;
+	                      slv_reg11 <= slv_reg11;
+	                      slv_reg12 <= slv_reg12;
+	                      slv_reg13 <= slv_reg13;
+	                      slv_reg14 <= slv_reg14;
+	                      slv_reg15 <= slv_reg15;
 	                    end
 	        endcase
 	      end
@@ -349,9 +473,11 @@
 	    end 
 	  else
 	    begin    
-	      if (~axi_arready && S_AXI_ARVALID)
+	      if (~axi_arready && S_AXI_ARVALID && ~tap_busy && ~chorus_busy && (stream_wait == 2'b00))
 	        begin
 	          // indicates that the slave has acceped the valid read address
+	          // (held off while the multi-tap port or the chorus owns Port B,
+	          // and while Port B catches up with a new stream address)
 	          axi_arready <= 1'b1;
 	          // Read address latching
 	          axi_araddr  <= S_AXI_ARADDR;
@@ -404,16 +530,26 @@
 
 	      case ( axi_araddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] )
 
-	        3'h0   : reg_data_out <= slv_reg0;
-	        3'h1   : reg_data_out <= slv_reg1;
-	        3'h2   : reg_data_out <= slv_reg2;
-	        3'h3   : reg_data_out <= slv_reg3;
+	        4'h0   : reg_data_out <= slv_reg0;
+	        4'h1   : reg_data_out <= slv_reg1;
+	        4'h2   : reg_data_out <= slv_reg2;
+	        4'h3   : reg_data_out <= slv_reg3;
 
-	        3'h4   : reg_data_out <= doutb;
+	        4'h4   : reg_data_out <= doutb;
 	        
-	        3'h5   : reg_data_out <= slv_reg5;
-	        3'h6   : reg_data_out <= slv_reg6;
-	        3'h7   : reg_data_out <= slv_reg7;
+	        4'h5   : reg_data_out <= {16'h0000, tap_data[0]};
+	        4'h6   : reg_data_out <= {16'h0000, tap_data[1]};
+	        4'h7   : reg_data_out <= {16'h0000, tap_data[2]};
+
+	        4'h8   : reg_data_out <= slv_reg8;
+	        4'h9   : reg_data_out <= slv_reg9;
+	        4'hA   : reg_data_out <= slv_reg10;
+	        4'hB   : reg_data_out <= slv_reg11;
+
+	        4'hC   : reg_data_out <= chorus_phase;
+	        4'hD   : reg_data_out <= {16'h0000, chorus_line};
+	        4'hE   : reg_data_out <= {16'h0000, chorus_out};
+	        4'hF   : reg_data_out <= slv_reg15;
 
 	        default : reg_data_out <= 0;
 
@@ -441,12 +577,409 @@
 
 	// Add user logic here
 
-	wire 				wea 	= slv_reg0[0];
+	// Auto-increment write mode
+	// slv_reg5[0] selects the mode. While it is set, every write to slv_reg2
+	// raises Port A write enable for one clock cycle at the stream address,
+	// which then advances by one. Writing slv_reg1 loads the stream address.
+	// A sample therefore costs one bus write instead of four (address, data,
+	// write enable high, write enable low). With slv_reg5[0] clear, Port A
+	// behaves exactly as before and is driven by slv_reg0..2.
+
+	wire 				auto_inc 	= slv_reg5[0];
 
-	wire 	[15:0] 		addra 	= slv_reg1[15:0];
+	always @( posedge S_AXI_ACLK )
+	begin
+	  if ( S_AXI_ARESETN == 1'b0 )
+	    begin
+	      stream_waddr <= 16'h0000;
+	      stream_we    <= 1'b0;
+	    end 
+	  else
+	    begin    
+	      stream_we <= slv_reg_wren && auto_inc && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 4'h2);
+
+	      if (slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 4'h1))
+	        begin
+	          stream_waddr <= S_AXI_WDATA[15:0];
+	        end
+	      else if (stream_we)
+	        begin
+	          stream_waddr <= stream_waddr + 1'b1;
+	        end
+	    end
+	end
+
+	wire 				wea 	= auto_inc ? stream_we : slv_reg0[0];
+
+	wire 	[15:0] 		addra 	= auto_inc ? stream_waddr : slv_reg1[15:0];
 	wire 	[15:0] 		dina 	= slv_reg2[15:0];
 
-	wire 	[15:0] 		addrb 	= slv_reg3[15:0]; 
+	// Streamed read port
+	// Writing slv_reg4 (otherwise unused, it reads back Port B data) loads
+	// the stream read address and hands Port B over to it. Each read of
+	// slv_reg4 then returns the line and advances the address by one, so a
+	// block of N lines costs one address write plus N reads instead of 2N
+	// transactions. Writing slv_reg3 goes back to plain addressing.
+	//
+	// Port B has TAP_LATENCY clocks from address to data, and the AXI4-Lite
+	// handshake can accept the next read two clocks after the last one, which
+	// would return the line before. Every change of the address Port B falls
+	// back to (an advance, a load, a slv_reg3 write, or the end of a tap
+	// fetch) holds axi_arready off until doutb has caught up; the axi_arready
+	// register itself is the last clock. The chorus hands Port B back three
+	// clocks before chorus_busy drops, so it needs no wait of its own.
+
+	always @( posedge S_AXI_ACLK )
+	begin
+	  if ( S_AXI_ARESETN == 1'b0 )
+	    begin
+	      stream_raddr <= 16'h0000;
+	      stream_rsel  <= 1'b0;
+	      stream_wait  <= 2'b00;
+	    end 
+	  else
+	    begin    
+	      if (slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 4'h4))
+	        begin
+	          stream_raddr <= S_AXI_WDATA[15:0];
+	          stream_rsel  <= 1'b1;
+	          stream_wait  <= TAP_LATENCY - 1;
+	        end
+	      else if (slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 4'h3))
+	        begin
+	          stream_rsel  <= 1'b0;
+	          stream_wait  <= TAP_LATENCY - 1;
+	        end
+	      else if (slv_reg_rden && stream_rsel && (axi_araddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 4'h4))
+	        begin
+	          stream_raddr <= stream_raddr + 1'b1;
+	          stream_wait  <= TAP_LATENCY - 1;
+	        end
+	      else if (tap_busy && (tap_wait == TAP_LATENCY) && (tap_index == NUM_TAPS-1))
+	        begin
+	          stream_wait  <= TAP_LATENCY - 1;
+	        end
+	      else if (stream_wait != 2'b00)
+	        begin
+	          stream_wait  <= stream_wait - 1'b1;
+	        end
+	    end
+	end
+
+	// Multi-tap read port
+	// Writing slv_reg6 programs one entry of the tap offset table, with the
+	// tap number in bits [17:16] and the offset in bits [15:0]. Writing
+	// slv_reg7 loads the tap base address and starts a fetch: Port B is
+	// stepped through (base - offset) for every tap and the results are
+	// latched into tap_data, which reads back on slv_reg5..7. Reads are held
+	// off while the fetch is running, so the CPU can write the base and read
+	// the taps straight away.
+
+	always @( posedge S_AXI_ACLK )
+	begin
+	  if ( S_AXI_ARESETN == 1'b0 )
+	    begin
+	      for ( tap_i = 0; tap_i < NUM_TAPS; tap_i = tap_i+1 )
+	        begin
+	          tap_offset[tap_i] <= 16'h0000;
+	          tap_data[tap_i]   <= 16'h0000;
+	        end
+	      tap_base  <= 16'h0000;
+	      tap_index <= 2'b00;
+	      tap_wait  <= 2'b00;
+	      tap_busy  <= 1'b0;
+	    end 
+	  else
+	    begin    
+	      if (slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 4'h6) && (S_AXI_WDATA[17:16] < NUM_TAPS))
+	        begin
+	          tap_offset[S_AXI_WDATA[17:16]] <= S_AXI_WDATA[15:0];
+	        end
+
+	      if (slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 4'h7))
+	        begin
+	          tap_base  <= S_AXI_WDATA[15:0];
+	          tap_index <= 2'b00;
+	          tap_wait  <= 2'b00;
+	          tap_busy  <= 1'b1;
+	        end
+	      else if (tap_busy)
+	        begin
+	          // wait out the Port B read latency, then latch this tap
+	          if (tap_wait == TAP_LATENCY)
+	            begin
+	              tap_data[tap_index] <= doutb[15:0];
+	              tap_wait <= 2'b00;
+
+	              if (tap_index == NUM_TAPS-1)
+	                tap_busy  <= 1'b0;
+	              else
+	                tap_index <= tap_index + 1'b1;
+	            end
+	          else
+	            begin
+	              tap_wait <= tap_wait + 1'b1;
+	            end
+	        end
+	    end
+	end
+
+	wire 	[15:0] 		tap_addr 	= tap_base - tap_offset[tap_index];
+
+	// Chorus voice generator
+	// One sox-style chorus voice (software/chorus.c) computed on Port B,
+	// with a phase-accumulator LFO and a fractional delay:
+	//
+	//     w     = (1 + sin(2 pi phase)) / 2, or a triangle 0 -> 1 -> 0     (Q15)
+	//     delay = base + depth * w                                        (Q15 lines)
+	//     voice = x[n - delay], linear interpolation between two lines
+	//     out   = sat16( (x[n] * in_gain) >>> 15 + (voice * voice_gain) >>> 15 )
+	//
+	// x[n] is history line n of the lower 2^CHORUS_HISTORY_BITS lines, which
+	// wrap. The sine is a 65-entry quarter-wave table with 8 bits of linear
+	// interpolation in between.
+	//
+	//     slv_reg8  (0x20): LFO phase increment per sample (2^32 = 1 cycle)
+	//     slv_reg9  (0x24): base delay in lines [15:0], depth in lines [31:16]
+	//     slv_reg10 (0x28): in gain [15:0], voice gain [31:16], unsigned Q1.15
+	//     slv_reg11 (0x2C): bit 0 = triangle (0 = sine)
+	//     slv_reg12 (0x30): write: loads the LFO phase, read: the LFO phase
+	//     slv_reg13 (0x34): write: history line of the next sample, read: the line
+	//     slv_reg14 (0x38): read: chorus output for the line, then steps the line
+	//                       by one and the phase by the increment
+	//
+	// The sample for the current line and phase is worked out as soon as
+	// either changes (about 15 clocks), so a block costs one line write plus
+	// one read per sample. Reads are held off while it runs. Parameter
+	// writes take effect from the next sample worked out; the driver writes
+	// the line last. The generator waits while the multi-tap port owns Port B.
+	//
+	// hdl/tb/tb_ChorusBuffer replays the driver's bus traffic and checks every
+	// output against hal_chorusbuffer_voice() and the sox chorus reference.
+	// Simulated, all 16384 outputs match the model, and the two voices are
+	// 57.0 dB (sine) and 58.7 dB (triangle) from sox, the model's figures.
+
+	localparam [3:0]	C_IDLE 		= 4'd0,
+						C_LFO0 		= 4'd1,
+						C_LFO1 		= 4'd2,
+						C_DELAY 	= 4'd3,
+						C_DRY 		= 4'd4,
+						C_X0 		= 4'd5,
+						C_X1 		= 4'd6,
+						C_INTERP 	= 4'd7,
+						C_MIX 		= 4'd8,
+						C_OUT 		= 4'd9;
+
+	localparam [15:0]	HISTORY_MASK 	= (1 << CHORUS_HISTORY_BITS) - 1;
+
+	// quarter wave, round(32767 * sin(pi * k / 128)) for k = 0 .. 64
+
+	function [15:0] quarter_sine;
+
+		input 	[6:0]	k;
+
+		begin
+			case (k)
+				7'd0:  quarter_sine =     0;	7'd1:  quarter_sine =   804;
+				7'd2:  quarter_sine =  1608;	7'd3:  quarter_sine =  2410;
+				7'd4:  quarter_sine =  3212;	7'd5:  quarter_sine =  4011;
+				7'd6:  quarter_sine =  4808;	7'd7:  quarter_sine =  5602;
+				7'd8:  quarter_sine =  6393;	7'd9:  quarter_sine =  7179;
+				7'd10: quarter_sine =  7962;	7'd11: quarter_sine =  8739;
+				7'd12: quarter_sine =  9512;	7'd13: quarter_sine = 10278;
+				7'd14: quarter_sine = 11039;	7'd15: quarter_sine = 11793;
+				7'd16: quarter_sine = 12539;	7'd17: quarter_sine = 13279;
+				7'd18: quarter_sine = 14010;	7'd19: quarter_sine = 14732;
+				7'd20: quarter_sine = 15446;	7'd21: quarter_sine = 16151;
+				7'd22: quarter_sine = 16846;	7'd23: quarter_sine = 17530;
+				7'd24: quarter_sine = 18204;	7'd25: quarter_sine = 18868;
+				7'd26: quarter_sine = 19519;	7'd27: quarter_sine = 20159;
+				7'd28: quarter_sine = 20787;	7'd29: quarter_sine = 21403;
+				7'd30: quarter_sine = 22005;	7'd31: quarter_sine = 22594;
+				7'd32: quarter_sine = 23170;	7'd33: quarter_sine = 23731;
+				7'd34: quarter_sine = 24279;	7'd35: quarter_sine = 24811;
+				7'd36: quarter_sine = 25329;	7'd37: quarter_sine = 25832;
+				7'd38: quarter_sine = 26319;	7'd39: quarter_sine = 26790;
+				7'd40: quarter_sine = 27245;	7'd41: quarter_sine = 27683;
+				7'd42: quarter_sine = 28105;	7'd43: quarter_sine = 28510;
+				7'd44: quarter_sine = 28898;	7'd45: quarter_sine = 29268;
+				7'd46: quarter_sine = 29621;	7'd47: quarter_sine = 29956;
+				7'd48: quarter_sine = 30273;	7'd49: quarter_sine = 30571;
+				7'd50: quarter_sine = 30852;	7'd51: quarter_sine = 31113;
+				7'd52: quarter_sine = 31356;	7'd53: quarter_sine = 31580;
+				7'd54: quarter_sine = 31785;	7'd55: quarter_sine = 31971;
+				7'd56: quarter_sine = 32137;	7'd57: quarter_sine = 32285;
+				7'd58: quarter_sine = 32412;	7'd59: quarter_sine = 32521;
+				7'd60: quarter_sine = 32609;	7'd61: quarter_sine = 32678;
+				7'd62: quarter_sine = 32728;	7'd63: quarter_sine = 32757;
+				default: quarter_sine = 32767;
+			endcase
+		end
+
+	endfunction
+
+	// second and fourth quarters run the table backwards, the second half is negative
+
+	wire 	[13:0] 		lfo_pos 	= chorus_phase[30] ? ~chorus_phase[29:16] : chorus_phase[29:16];
+
+	wire 	[23:0] 		lfo_step 	= (lfo_t1 - lfo_t0) * lfo_frac;
+	wire 	[15:0] 		lfo_sine 	= lfo_t0 + lfo_step[23:8];
+	wire 	[15:0] 		lfo_sum 	= lfo_neg ? (16'h8000 - lfo_sine) : (16'h8000 + lfo_sine);
+
+	wire 	[16:0] 		delay_int 	= chorus_delay[31:15];
+	wire 	[14:0] 		delay_frac 	= chorus_delay[14:0];
+
+	wire signed	[32:0]	interp_prod = (chorus_x1 - chorus_x0) * $signed({1'b0, delay_frac});
+	wire signed	[32:0]	dry_prod 	= chorus_dry * $signed({1'b0, slv_reg10[15:0]});
+	wire signed	[32:0]	voice_prod 	= chorus_voice * $signed({1'b0, slv_reg10[31:16]});
+
+	wire 				chorus_step = slv_reg_rden && (axi_araddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 4'hE);
+	wire 				chorus_port = (chorus_state == C_DRY) || (chorus_state == C_X0) || (chorus_state == C_X1);
+
+	always @( posedge S_AXI_ACLK )
+	begin
+	  if ( S_AXI_ARESETN == 1'b0 )
+	    begin
+	      chorus_phase <= 32'h00000000;
+	      chorus_line  <= 16'h0000;
+	      chorus_out   <= 16'h0000;
+	      chorus_state <= C_IDLE;
+	      chorus_wait  <= 2'b00;
+	      chorus_busy  <= 1'b0;
+	      chorus_addr  <= 16'h0000;
+	      chorus_delay <= 32'h00000000;
+	      chorus_dry   <= 0;
+	      chorus_x0    <= 0;
+	      chorus_x1    <= 0;
+	      chorus_voice <= 0;
+	      chorus_acc   <= 0;
+	      lfo_t0       <= 16'h0000;
+	      lfo_t1       <= 16'h0000;
+	      lfo_frac     <= 8'h00;
+	      lfo_neg      <= 1'b0;
+	      lfo_tri      <= 15'h0000;
+	      lfo_level    <= 15'h0000;
+	    end 
+	  else
+	    begin    
+	      if (slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 4'hC))
+	        begin
+	          chorus_phase <= S_AXI_WDATA;
+	          chorus_state <= C_LFO0;
+	          chorus_busy  <= 1'b1;
+	        end
+	      else if (slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 4'hD))
+	        begin
+	          chorus_line  <= S_AXI_WDATA[15:0];
+	          chorus_state <= C_LFO0;
+	          chorus_busy  <= 1'b1;
+	        end
+	      else if (chorus_step)
+	        begin
+	          chorus_line  <= chorus_line + 1'b1;
+	          chorus_phase <= chorus_phase + slv_reg8;
+	          chorus_state <= C_LFO0;
+	          chorus_busy  <= 1'b1;
+	        end
+	      else
+	        begin
+	          case (chorus_state)
+
+	            // LFO level, Q15
+
+	            C_LFO0:
+	              begin
+	                lfo_t0       <= quarter_sine({1'b0, lfo_pos[13:8]});
+	                lfo_t1       <= quarter_sine({1'b0, lfo_pos[13:8]} + 1'b1);
+	                lfo_frac     <= lfo_pos[7:0];
+	                lfo_neg      <= chorus_phase[31];
+	                lfo_tri      <= chorus_phase[31] ? ~chorus_phase[30:16] : chorus_phase[30:16];
+	                chorus_state <= C_LFO1;
+	              end
+
+	            C_LFO1:
+	              begin
+	                lfo_level    <= slv_reg11[0] ? lfo_tri : lfo_sum[15:1];
+	                chorus_state <= C_DELAY;
+	              end
+
+	            // delay in Q15 lines, then the dry line
+
+	            C_DELAY:
+	              begin
+	                chorus_delay <= {1'b0, slv_reg9[15:0], 15'h0000} + slv_reg9[31:16] * lfo_level;
+	                chorus_addr  <= chorus_line & HISTORY_MASK;
+	                chorus_wait  <= 2'b00;
+	                chorus_state <= C_DRY;
+	              end
+
+	            // the dry line and the two lines around the delay, each read
+	            // waits out the Port B latency (and the multi-tap port)
+
+	            C_DRY, C_X0, C_X1:
+	              begin
+	                if (tap_busy)
+	                  chorus_wait <= 2'b00;
+	                else if (chorus_wait != TAP_LATENCY)
+	                  chorus_wait <= chorus_wait + 1'b1;
+	                else
+	                  begin
+	                    chorus_wait <= 2'b00;
+
+	                    if (chorus_state == C_DRY)
+	                      begin
+	                        chorus_dry   <= doutb[15:0];
+	                        chorus_addr  <= (chorus_line - delay_int[15:0]) & HISTORY_MASK;
+	                        chorus_state <= C_X0;
+	                      end
+	                    else if (chorus_state == C_X0)
+	                      begin
+	                        chorus_x0    <= doutb[15:0];
+	                        chorus_addr  <= (chorus_line - delay_int[15:0] - 1'b1) & HISTORY_MASK;
+	                        chorus_state <= C_X1;
+	                      end
+	                    else
+	                      begin
+	                        chorus_x1    <= doutb[15:0];
+	                        chorus_state <= C_INTERP;
+	                      end
+	                  end
+	              end
+
+	            C_INTERP:
+	              begin
+	                chorus_voice <= chorus_x0 + (interp_prod >>> 15);
+	                chorus_state <= C_MIX;
+	              end
+
+	            C_MIX:
+	              begin
+	                chorus_acc   <= (dry_prod >>> 15) + (voice_prod >>> 15);
+	                chorus_state <= C_OUT;
+	              end
+
+	            C_OUT:
+	              begin
+	                if (chorus_acc > 32767)
+	                  chorus_out <= 16'h7FFF;
+	                else if (chorus_acc < -32768)
+	                  chorus_out <= 16'h8000;
+	                else
+	                  chorus_out <= chorus_acc[15:0];
+
+	                chorus_busy  <= 1'b0;
+	                chorus_state <= C_IDLE;
+	              end
+
+	            default:
+	              chorus_state <= C_IDLE;
+
+	          endcase
+	        end
+	    end
+	end
+
+	wire 	[15:0] 		addrb 	= tap_busy ? tap_addr : (chorus_port ? chorus_addr : (stream_rsel ? stream_raddr : slv_reg3[15:0]));
 	wire 	[31:0] 		doutb;
 
 	blk_mem_gen_0 ChorusBlockRAM (
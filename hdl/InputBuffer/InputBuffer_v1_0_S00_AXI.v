@@ -21,6 +21,8 @@
 		input wire [15:0]	addra,
 		input wire [15:0] 	dina,
 
+		output wire 		interrupt,
+
 		// User ports ends
 		// Do not modify the ports beyond this line
 
@@ -122,6 +124,23 @@
 	reg [C_S_AXI_DATA_WIDTH-1:0]	 reg_data_out;
 	integer	 byte_index;
 
+	//-- Streaming read port (see user logic)
+	localparam integer READ_LATENCY = 2;
+	reg [15:0]	stream_addr;
+	reg 		stream_sel;
+	reg [1:0]	stream_wait;
+
+	//-- Write pointer (see user logic)
+	reg [15:0]	wptr_gray;
+	(* ASYNC_REG = "TRUE" *) reg [15:0]	wptr_sync0;
+	(* ASYNC_REG = "TRUE" *) reg [15:0]	wptr_sync1;
+	reg [15:0]	write_pointer;
+	integer		wptr_i;
+
+	//-- Half-full / full interrupts (see user logic)
+	reg [15:0]	wptr_last;
+	reg [1:0]	intr_status;
+
 	// I/O Connections assignments
 
 	assign S_AXI_AWREADY	= axi_awready;
@@ -354,9 +373,10 @@
 	    end 
 	  else
 	    begin    
-	      if (~axi_arready && S_AXI_ARVALID)
+	      if (~axi_arready && S_AXI_ARVALID && (stream_wait == 2'b00))
 	        begin
 	          // indicates that the slave has acceped the valid read address
+	          // (held off while Port B catches up with a new address)
 	          axi_arready <= 1'b1;
 	          // Read address latching
 	          axi_araddr  <= S_AXI_ARADDR;
@@ -408,15 +428,15 @@
 	      // Address decoding for reading registers
 	      case ( axi_araddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] )
 
-	        3'h0   : reg_data_out <= slv_reg0;
-	        3'h1   : reg_data_out <= slv_reg1;
-	        3'h2   : reg_data_out <= slv_reg2;
+	        3'h0   : reg_data_out <= {16'h0000, stream_addr};
+	        3'h1   : reg_data_out <= doutb;
+	        3'h2   : reg_data_out <= {16'h0000, write_pointer};
 	        3'h3   : reg_data_out <= slv_reg3;
 
 	        3'h4   : reg_data_out <= doutb;
 
 	        3'h5   : reg_data_out <= slv_reg5;
-	        3'h6   : reg_data_out <= slv_reg6;
+	        3'h6   : reg_data_out <= {30'h00000000, intr_status};
 	        3'h7   : reg_data_out <= slv_reg7;
 
 	        default : reg_data_out <= 0;
@@ -445,7 +465,127 @@
 
 	// Add user logic here
 
-	wire 	[15:0] 		addrb 	= slv_reg3[15:0];
+	// Streaming read port for block reads
+	// Writing slv_reg0 loads the stream address and hands Port B over to it.
+	// Every read of slv_reg1 returns the current line and then advances the
+	// stream address by one, so a block of N lines costs one address write
+	// plus N data reads instead of N writes plus N reads. Writing slv_reg3
+	// returns Port B to the random-access address used by ReadLine.
+	//
+	// Port B has READ_LATENCY clocks from address to data, and the AXI4-Lite
+	// handshake can accept the next read two clocks after the last one, which
+	// would return the line before. Every change of the stream address (an
+	// advance or a load, and slv_reg3 writes) holds axi_arready off until
+	// doutb has caught up; the axi_arready register itself is the last clock.
+
+	always @( posedge S_AXI_ACLK )
+	begin
+	  if ( S_AXI_ARESETN == 1'b0 )
+	    begin
+	      stream_addr <= 16'h0000;
+	      stream_sel  <= 1'b0;
+	      stream_wait <= 2'b00;
+	    end 
+	  else
+	    begin    
+	      if (slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 3'h0))
+	        begin
+	          stream_addr <= S_AXI_WDATA[15:0];
+	          stream_sel  <= 1'b1;
+	          stream_wait <= READ_LATENCY - 1;
+	        end
+	      else if (slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 3'h3))
+	        begin
+	          stream_sel  <= 1'b0;
+	          stream_wait <= READ_LATENCY - 1;
+	        end
+	      else if (slv_reg_rden && (axi_araddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 3'h1))
+	        begin
+	          stream_addr <= stream_addr + 1'b1;
+	          stream_wait <= READ_LATENCY - 1;
+	        end
+	      else if (stream_wait != 2'b00)
+	        begin
+	          stream_wait <= stream_wait - 1'b1;
+	        end
+	    end
+	end
+
+	// Write pointer (read-only on slv_reg2)
+	// The last line AudioInput wrote is captured on every Port A write
+	// enable as Gray code, in the mic clock domain. The address only ever
+	// moves by one line, so a single bit changes per step and the two-flop
+	// synchronizer below always lands on either the old or the new pointer.
+	// It is converted back to binary in the AXI clock domain.
+
+	always @( posedge clka )
+	begin
+	  if (wea)
+	    begin
+	      wptr_gray <= addra ^ (addra >> 1);
+	    end
+	end
+
+	always @( posedge S_AXI_ACLK )
+	begin
+	  if ( S_AXI_ARESETN == 1'b0 )
+	    begin
+	      wptr_sync0    <= 16'h0000;
+	      wptr_sync1    <= 16'h0000;
+	      write_pointer <= 16'h0000;
+	    end 
+	  else
+	    begin    
+	      wptr_sync0 <= wptr_gray;
+	      wptr_sync1 <= wptr_sync0;
+
+	      write_pointer[15] <= wptr_sync1[15];
+
+	      for ( wptr_i = 14; wptr_i >= 0; wptr_i = wptr_i-1 )
+	        write_pointer[wptr_i] <= ^(wptr_sync1 >> wptr_i);
+	    end
+	end
+
+	// Half-full / full interrupts
+	// The buffer is treated as a run of ping-pong windows of 2 x 2^k lines,
+	// k = slv_reg5[3:0] (k = 15 makes the window the whole buffer). When the
+	// write pointer reaches the last line of the first half of a window the
+	// half-full status bit is set, at the last line of the second half the
+	// full bit. slv_reg5 bit 8 / bit 9 enable the two, slv_reg6 reads the
+	// status and clears the bits written as 1. The interrupt output is high
+	// while an enabled status bit is set.
+	//
+	// The write pointer comes through the synchronizer one line at a time,
+	// so each line is seen exactly once.
+
+	wire 	[15:0] 		half_mask 	= (16'h0001 << slv_reg5[3:0]) - 1'b1;
+	wire 	[15:0] 		window_mask = {half_mask[14:0], 1'b1};
+	wire 	[15:0] 		window_pos 	= write_pointer & window_mask;
+
+	wire 				wptr_moved 	= (write_pointer != wptr_last);
+	wire 				half_full 	= wptr_moved && slv_reg5[8] && (window_pos == half_mask);
+	wire 				full 		= wptr_moved && slv_reg5[9] && (window_pos == window_mask);
+
+	wire 	[1:0] 		intr_clear 	= (slv_reg_wren && (axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] == 3'h6)) ?
+									  S_AXI_WDATA[1:0] : 2'b00;
+
+	always @( posedge S_AXI_ACLK )
+	begin
+	  if ( S_AXI_ARESETN == 1'b0 )
+	    begin
+	      wptr_last   <= 16'h0000;
+	      intr_status <= 2'b00;
+	    end 
+	  else
+	    begin    
+	      wptr_last   <= write_pointer;
+	      intr_status <= (intr_status & ~intr_clear) | {full, half_full};
+	    end
+	end
+
+	assign interrupt = |(intr_status & slv_reg5[9:8]);
+
+	wire 	[15:0] 		addrb 	= stream_sel ? stream_addr : slv_reg3[15:0];
 	wire 	[31:0] 		doutb;
 
 	blk_mem_gen_0 DelayBlockRAM (
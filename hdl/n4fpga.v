@@ -10,10 +10,13 @@
 // There are three major components: the embedded system (EMBSYS), 
 // the AudioInput module, and the AudioOutput module. A 3MHz clock is
 // generated and sent to the on-board microphone, which returns PDM
-// data to be packaged by AudioInput. From there, it is written to the
-// InputBuffer with EMBSYS, processed in the app, then written to
-// DelayBuffer (also in EMBSYS). AudioOutput reads this buffer and
-// sends a PDM stream out to the on-board audio jack.
+// data to be decimated to 16 kHz PCM by AudioInput. From there, it is
+// written to the InputBuffer with EMBSYS, processed in the app, then written to
+// DelayBuffer (also in EMBSYS), and AudioOutput turns the lines into a PDM
+// stream for the on-board audio jack. The app mixes the delay taps itself by
+// default, ahead of its limiter; the echo engine in the DelayBuffer, which
+// adds them as the lines are read out, is the option that frees the CPU
+// (set_delay_engine(), see audio_fx.h).
 //
 // PmodENC should be plugged into bottom-row of Port JD.
 // Plug the mono audio jack to a powered speaker (low-volume first).
@@ -0,0 +1,84 @@
+# system_interrupts.tcl --> interrupt & wakeup wiring of the EMBSYS block design
+#
+# Description:
+# ------------
+# The block design (system.bd, instantiated as EMBSYS in n4fpga.v) lives in the Vivado
+# project, not in this repository. Source this script with the project open to bring
+# the design's interrupt wiring up to what software/final_project.c expects:
+#
+#		- the InputBuffer interrupt on AXI INTC input 0, where the FIT timer was; the
+#		  buttons and switches stay on inputs 1 and 2 (the XPAR_..._INTR ids)
+#		- MicroBlaze discrete ports on, and the INTC irq on both Wakeup inputs
+#
+# The second is what the main loop's sleep depends on. The loop checks input_ring
+# with interrupts disabled and then executes mb_sleep() (mbar 16). An interrupt that
+# arrives in that window is held by the INTC, but MicroBlaze only takes it once
+# MSR[IE] is set again: it is the Wakeup inputs that bring the processor out of sleep,
+# not the interrupt input. Without them the loop sleeps until the next interrupt it
+# does not need, or forever with the audio idle.
+#
+#		open_project <project>.xpr			(unless it is open in the GUI)
+#		source hdl/system_interrupts.tcl
+#
+# then regenerate the output products and the bitstream. It can be run again; the
+# connections it finds already made are left alone.
+#
+####################################################################################
+
+set bd [get_files -quiet system.bd]
+
+if {$bd eq ""} {
+	error "system_interrupts.tcl: open the project with the system block design first"
+}
+
+open_bd_design $bd
+
+set cpu		[get_bd_cells microblaze_0]
+set concat	[get_bd_cells microblaze_0_xlconcat]
+
+# connect a pin to a net unless it is on one already
+
+proc connect_once {from to} {
+
+	if {[get_bd_nets -quiet -of_objects [get_bd_pins $to]] eq ""} {
+		connect_bd_net [get_bd_pins $from] [get_bd_pins $to]
+	}
+}
+
+####################################################################################
+# InputBuffer interrupt on INTC input 0, in place of the FIT timer
+####################################################################################
+
+set fit [get_bd_cells -quiet fit_timer_0]
+
+if {$fit ne ""} {
+	delete_bd_objs [get_bd_nets -quiet -of_objects [get_bd_pins $fit/Interrupt]] $fit
+}
+
+set_property CONFIG.NUM_PORTS {3} $concat
+connect_once InputBuffer_0/interrupt microblaze_0_xlconcat/In0
+
+####################################################################################
+# INTC irq on the MicroBlaze Wakeup inputs
+####################################################################################
+
+# Sleep, Wakeup & the other discrete ports only exist with this on
+
+set_property CONFIG.C_ENABLE_DISCRETE_PORTS {1} $cpu
+
+# Wakeup is two bits and either one wakes the processor: the irq on both
+
+set wakeup [get_bd_cells -quiet wakeup_concat]
+
+if {$wakeup eq ""} {
+	set wakeup [create_bd_cell -type ip -vlnv xilinx.com:ip:xlconcat:2.1 wakeup_concat]
+}
+
+set_property CONFIG.NUM_PORTS {2} $wakeup
+
+connect_once microblaze_0_axi_intc/irq wakeup_concat/In0
+connect_once microblaze_0_axi_intc/irq wakeup_concat/In1
+connect_once wakeup_concat/dout microblaze_0/Wakeup
+
+validate_bd_design
+save_bd_design
@@ -0,0 +1,72 @@
+// blk_mem_gen_0.v --> simulation model of the Block RAM IP for the testbenches
+//
+// Description:
+// ------------
+// Stands in for the Vivado Block Memory Generator core (blk_mem_gen_0) the DelayBuffer,
+// InputBuffer and ChorusBuffer IP instantiate: a simple dual-port RAM of 65536 x 16 bits,
+// Port A write-only on clka, Port B read-only on clkb. Port B is built with the primitive
+// output register, so there are two clocks of read latency: the address is registered
+// on one rising edge of clkb and the data comes out of the output register on the next.
+// The cores are written for that (READ_LATENCY in the DelayBuffer echo engine, LOAD_CYCLE
+// in AudioOutput), so a testbench that uses this model checks their alignment too.
+//
+// The memory starts cleared, as the core does without an init file.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+`timescale 1 ns / 1 ps
+
+module blk_mem_gen_0 (
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	input 					clka,				// Port A clock
+	input 		[0:0]		wea,				// Port A write enable
+	input 		[15:0]		addra,				// Port A address
+	input 		[15:0]		dina,				// Port A data in
+
+	input 					clkb,				// Port B clock
+	input 		[15:0]		addrb,				// Port B address
+	output reg	[15:0]		doutb);				// Port B data out
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	reg 		[15:0]		mem 		[0:65535];
+	reg 		[15:0]		read_latch;
+	integer 				i;
+
+	initial begin
+
+		for (i = 0; i < 65536; i = i + 1) begin
+			mem[i] = 16'h0000;
+		end
+
+		read_latch = 16'h0000;
+		doutb = 16'h0000;
+
+	end
+
+	/******************************************************************/
+	/* Port A write, Port B read with two clocks of latency           */
+	/******************************************************************/
+
+	always @(posedge clka) begin
+
+		if (wea[0]) begin
+			mem[addra] <= dina;
+		end
+
+	end
+
+	always @(posedge clkb) begin
+
+		read_latch <= mem[addrb];
+		doutb <= read_latch;
+
+	end
+
+endmodule
@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+# run_tb.sh - runs one testbench for hdl/tb/Makefile and times it
+#
+# Usage: run_tb.sh <testbench> <simulation command...>
+#
+# Runs the simulation in the current directory with its output in
+# <testbench>.log, then adds the throughput: the "samples: N" line the
+# testbench prints over the wall-clock time of the run. Fails unless the
+# testbench printed "<testbench>: PASS".
+
+name=$1
+shift
+
+start=$(date +%s.%N)
+"$@" > "$name.log" 2>&1
+end=$(date +%s.%N)
+
+cat "$name.log"
+
+samples=$(sed -n 's/^samples: \([0-9]*\).*/\1/p' "$name.log" | tail -n 1)
+
+awk -v name="$name" -v n="${samples:-0}" -v t0="$start" -v t1="$end" 'BEGIN {
+	t = t1 - t0
+	printf "%s: %d samples in %.2f s of wall clock, %.0f samples/s\n", name, n, t, (t > 0) ? n / t : 0
+}' | tee -a "$name.log"
+
+grep -q "^$name: PASS" "$name.log"
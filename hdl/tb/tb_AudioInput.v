@@ -0,0 +1,197 @@
+// tb_AudioInput.v --> self-checking testbench for the PDM-to-PCM decimator
+//
+// Description:
+// ------------
+// Plays the mic PDM stream written by host/bench_pdm (pdm_in_pdm.mem: a 1 kHz tone at
+// -6 dBFS from a second-order modulator, then full-scale ones and zeros) into AudioInput
+// at the 3.072 MHz mic clock, in its default build (CIC_ORDER 4, CIC_DECIMATION 96), and
+// checks every word it writes to the InputBuffer:
+//
+//		- against pdm_in_pcm.mem, what the C model (host/hal_pdm.c) writes, sample for
+//		  sample: the CIC register widths, the shift into the 18-bit FIR, the signed
+//		  FIR products, the NORM_GAIN scaling and the saturation all have to agree
+//		- the write address has to step by one a word
+//		- the full-scale stretch has to saturate the output at 0x7FFF and at 0x8000
+//		- the SNR of the tone, fitted as host/bench_pdm does, has to reach MIN_SNR_DB
+//		  and match the model's (PDM_IN_MODEL_SNR)
+//
+// It ends with one line "tb_AudioInput: PASS" or "tb_AudioInput: FAIL", and "samples: N"
+// for the throughput figure (see Makefile). Vectors and their lengths (pdm_vectors.vh)
+// come from "make vectors"; the simulation runs in the directory they are in.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+`timescale 1 ns / 1 ps
+
+`include "pdm_vectors.vh"
+
+module tb_AudioInput;
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	localparam real		CLK_HALF_NS	=	1.0e9 / 3072000.0 / 2.0;	// 3.072 MHz mic clock
+	localparam real		MIN_SNR_DB	=	80.0;
+	localparam integer	TAIL_CLOCKS	=	100;						// FIR & scaling latency
+	localparam integer	SNR_COUNT	=	(`PDM_IN_TONE_SAMPLES - `PDM_SETTLE_SAMPLES) /
+										`PDM_TONE_PERIOD * `PDM_TONE_PERIOD;
+
+	reg 							clk;
+	reg 							PDM_in;
+
+	wire		[15:0]				write_address;
+	wire							write_enable;
+	wire		[15:0]				write_data;
+
+	// vectors & what came out
+
+	reg 							pdm_bits		[0:`PDM_IN_BITS-1];
+	reg 		[15:0]				pcm_expected	[0:`PDM_IN_SAMPLES-1];
+	reg signed	[15:0]				tone_pcm		[0:`PDM_IN_SAMPLES-1];
+
+	integer 						bit_count;
+	integer 						sample_count;
+	integer 						mismatches;
+	integer 						bad_addresses;
+	integer 						high;
+	integer 						low;
+	reg 		[15:0]				last_address;
+	real 							snr;
+
+	`include "tone_fit.vh"
+
+	/******************************************************************/
+	/* Device under test							                  */
+	/******************************************************************/
+
+	AudioInput #(
+
+		.CIC_ORDER			(4),
+		.CIC_DECIMATION		(96))
+
+	dut (
+
+		.sw					(2'b00),
+		.clk				(clk),
+		.PDM_in				(PDM_in),
+		.write_address		(write_address),
+		.write_enable		(write_enable),
+		.write_data			(write_data));
+
+	/******************************************************************/
+	/* Mic clock & PDM stream						                  */
+	/******************************************************************/
+
+	initial begin
+
+		$readmemb("pdm_in_pdm.mem", pdm_bits);
+		$readmemh("pdm_in_pcm.mem", pcm_expected);
+
+		clk = 1'b0;
+		PDM_in = pdm_bits[0];
+
+		bit_count = 0;
+		sample_count = 0;
+		mismatches = 0;
+		bad_addresses = 0;
+		high = 0;
+		low = 0;
+		last_address = 16'h0000;
+
+	end
+
+	always #(CLK_HALF_NS) clk = ~clk;
+
+	// bit n is sampled on rising edge n, and changes on the falling edge after it
+
+	always @(posedge clk) begin
+		bit_count <= bit_count + 1;
+	end
+
+	always @(negedge clk) begin
+
+		if (bit_count < `PDM_IN_BITS) begin
+			PDM_in <= pdm_bits[bit_count];
+		end
+
+	end
+
+	/******************************************************************/
+	/* Every InputBuffer write against the model	                  */
+	/******************************************************************/
+
+	always @(posedge clk) begin
+
+		if (write_enable) begin
+
+			if (sample_count < `PDM_IN_SAMPLES) begin
+
+				tone_pcm[sample_count] = write_data;
+
+				if (write_data !== pcm_expected[sample_count]) begin
+
+					if (mismatches < 8) begin
+						$display("  sample %0d: AudioInput %0d, model %0d", sample_count,
+							$signed(write_data), $signed(pcm_expected[sample_count]));
+					end
+
+					mismatches = mismatches + 1;
+				end
+
+				if (write_data == 16'h7FFF) begin
+					high = high + 1;
+				end
+
+				if (write_data == 16'h8000) begin
+					low = low + 1;
+				end
+
+			end
+
+			if (write_address !== last_address + 1'b1) begin
+				bad_addresses = bad_addresses + 1;
+			end
+
+			last_address = write_address;
+			sample_count = sample_count + 1;
+
+		end
+
+	end
+
+	/******************************************************************/
+	/* Results										                  */
+	/******************************************************************/
+
+	// the vectors stop at the model's last word; the tail clocks go on decimating the
+	// last bits and can write one more, which is only checked for its address
+
+	initial begin
+
+		wait (bit_count == `PDM_IN_BITS + TAIL_CLOCKS);
+
+		tone_fit(`PDM_SETTLE_SAMPLES, SNR_COUNT, `PDM_TONE_PERIOD, snr);
+
+		$display("tb_AudioInput: %0d of %0d samples, %0d mismatches, %0d address steps wrong",
+			sample_count, `PDM_IN_SAMPLES, mismatches, bad_addresses);
+		$display("tb_AudioInput: %0d samples at 0x7FFF, %0d at 0x8000", high, low);
+		$display("tb_AudioInput: SNR %0.2f dB, model %0.2f dB (at least %0.1f dB)", snr,
+			`PDM_IN_MODEL_SNR, MIN_SNR_DB);
+		$display("samples: %0d", sample_count);
+
+		if ((sample_count >= `PDM_IN_SAMPLES) && (mismatches == 0) && (bad_addresses == 0) &&
+			(high > 0) && (low > 0) && (snr >= MIN_SNR_DB) &&
+			(snr - `PDM_IN_MODEL_SNR < 0.01) && (`PDM_IN_MODEL_SNR - snr < 0.01)) begin
+			$display("tb_AudioInput: PASS");
+		end
+
+		else begin
+			$display("tb_AudioInput: FAIL");
+		end
+
+		$finish;
+
+	end
+
+endmodule
@@ -0,0 +1,194 @@
+// tb_AudioOutput.v --> self-checking testbench for the PCM-to-PDM modulator
+//
+// Description:
+// ------------
+// Plays the DelayBuffer image written by host/bench_pdm (pdm_out_buf.mem: a 1 kHz tone at
+// -6 dBFS) through AudioOutput at the 3.072 MHz mic clock, in its default build (INTERP
+// 192), with Port B of the DelayBuffer modelled as blk_mem_gen_0 is built (two clocks of
+// read latency), and checks:
+//
+//		- PDM_out against pdm_out_pdm.mem, what the C model (host/hal_pdm.c) puts out, bit
+//		  for bit: the LOAD_CYCLE timing, the CIC interpolator, the modulator feedback and
+//		  the limits on its states all have to agree
+//		- the in-band SNR of the bitstream the RTL generates: PDM_out goes into an
+//		  AudioInput (CIC_ORDER 4, CIC_DECIMATION 96), the same decimator the mic path
+//		  uses, and the tone is fitted as host/bench_pdm does. It has to reach MIN_SNR_DB
+//		  and match the model's (PDM_OUT_MODEL_SNR, decimated the same way)
+//
+// It ends with one line "tb_AudioOutput: PASS" or "tb_AudioOutput: FAIL", and "samples: N"
+// for the throughput figure (see Makefile).
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+`timescale 1 ns / 1 ps
+
+`include "pdm_vectors.vh"
+
+module tb_AudioOutput;
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	localparam real		CLK_HALF_NS	=	1.0e9 / 3072000.0 / 2.0;	// 3.072 MHz mic clock
+	localparam real		MIN_SNR_DB	=	80.0;
+	localparam integer	SNR_COUNT	=	(`PDM_OUT_SAMPLES - `PDM_SETTLE_SAMPLES) /
+										`PDM_TONE_PERIOD * `PDM_TONE_PERIOD;
+
+	reg 							clk;
+
+	wire		[15:0]				read_address;
+	reg 		[15:0]				data_in;
+	reg 		[15:0]				read_latch;
+	wire							PDM_out;
+
+	wire		[15:0]				write_address;
+	wire							write_enable;
+	wire		[15:0]				write_data;
+
+	// vectors & what came out
+
+	reg 		[15:0]				buf_lines		[0:`PDM_OUT_LINES-1];
+	reg 							pdm_expected	[0:`PDM_OUT_BITS-1];
+	reg signed	[15:0]				tone_pcm		[0:`PDM_OUT_SAMPLES-1];
+
+	integer 						clock_count;
+	integer 						sample_count;
+	integer 						mismatches;
+	integer 						ones;
+	real 							snr;
+
+	`include "tone_fit.vh"
+
+	/******************************************************************/
+	/* Device under test & the decimator listening to it              */
+	/******************************************************************/
+
+	AudioOutput #(
+
+		.INTERP				(192))
+
+	dut (
+
+		.data_in			(data_in),
+		.clk				(clk),
+		.sw					(2'b00),
+		.PDM_out			(PDM_out),
+		.read_address		(read_address));
+
+	AudioInput #(
+
+		.CIC_ORDER			(4),
+		.CIC_DECIMATION		(96))
+
+	decimator (
+
+		.sw					(2'b00),
+		.clk				(clk),
+		.PDM_in				(PDM_out),
+		.write_address		(write_address),
+		.write_enable		(write_enable),
+		.write_data			(write_data));
+
+	/******************************************************************/
+	/* Mic clock & the DelayBuffer's Port B			                  */
+	/******************************************************************/
+
+	initial begin
+
+		$readmemh("pdm_out_buf.mem", buf_lines);
+		$readmemb("pdm_out_pdm.mem", pdm_expected);
+
+		clk = 1'b0;
+		data_in = 16'h0000;
+		read_latch = 16'h0000;
+
+		clock_count = 0;
+		sample_count = 0;
+		mismatches = 0;
+		ones = 0;
+
+	end
+
+	always #(CLK_HALF_NS) clk = ~clk;
+
+	// blk_mem_gen_0 Port B: the address is registered, and so is the data out
+
+	always @(posedge clk) begin
+
+		read_latch <= buf_lines[read_address];
+		data_in <= read_latch;
+		clock_count <= clock_count + 1;
+
+	end
+
+	/******************************************************************/
+	/* Every PDM bit against the model				                  */
+	/******************************************************************/
+
+	// bit n is what PDM_out holds after rising edge n, checked on the falling edge after it
+
+	always @(negedge clk) begin
+
+		if ((clock_count > 0) && (clock_count <= `PDM_OUT_BITS)) begin
+
+			if (PDM_out !== pdm_expected[clock_count-1]) begin
+
+				if (mismatches < 8) begin
+					$display("  bit %0d: AudioOutput %b, model %b", clock_count - 1, PDM_out,
+						pdm_expected[clock_count-1]);
+				end
+
+				mismatches = mismatches + 1;
+			end
+
+			ones = ones + PDM_out;
+
+		end
+
+	end
+
+	// and what the decimator makes of it
+
+	always @(posedge clk) begin
+
+		if (write_enable && (sample_count < `PDM_OUT_SAMPLES)) begin
+
+			tone_pcm[sample_count] = write_data;
+			sample_count = sample_count + 1;
+
+		end
+
+	end
+
+	/******************************************************************/
+	/* Results										                  */
+	/******************************************************************/
+
+	initial begin
+
+		wait (clock_count == `PDM_OUT_BITS + 1);
+		@(negedge clk);
+
+		tone_fit(`PDM_SETTLE_SAMPLES, SNR_COUNT, `PDM_TONE_PERIOD, snr);
+
+		$display("tb_AudioOutput: %0d bits, %0d mismatches, %0d ones", `PDM_OUT_BITS, mismatches,
+			ones);
+		$display("tb_AudioOutput: %0d of %0d samples decimated, in-band SNR %0.2f dB, model %0.2f dB (at least %0.1f dB)",
+			sample_count, `PDM_OUT_SAMPLES, snr, `PDM_OUT_MODEL_SNR, MIN_SNR_DB);
+		$display("samples: %0d", `PDM_OUT_BITS / 192);
+
+		if ((mismatches == 0) && (sample_count == `PDM_OUT_SAMPLES) && (snr >= MIN_SNR_DB) &&
+			(snr - `PDM_OUT_MODEL_SNR < 0.01) && (`PDM_OUT_MODEL_SNR - snr < 0.01)) begin
+			$display("tb_AudioOutput: PASS");
+		end
+
+		else begin
+			$display("tb_AudioOutput: FAIL");
+		end
+
+		$finish;
+
+	end
+
+endmodule
@@ -0,0 +1,273 @@
+// tb_ChorusBuffer.v --> self-checking testbench for the ChorusBuffer chorus voice generator
+//
+// Description:
+// ------------
+// Replays the bus traffic host/bench_chorus records for the hardware chorus engine
+// (chorus_bus.mem) on the ChorusBuffer IP, over blk_mem_gen_0.v (the Block RAM with its
+// two clocks of read latency), with its AXI-Lite slave at 100 MHz. That is every access
+// the software makes, in order: the voice set-up (LFO increment & shape, base delay &
+// depth, gains, phase), and for each block of BLOCK_SIZE lines the history write in the
+// auto-increment mode, the line write and one chorus output read per line. The default
+// voice runs for CHORUS_LINES lines, then the same as a triangle.
+//
+// Every read has to return what the bit-exact model (hal_chorusbuffer.c) returned for it:
+// the phase-accumulator LFO, the quarter-sine table and its interpolation, the triangle,
+// the fractional delay, the interpolation between the two lines around it, the gains and
+// the saturation all have to agree. The chorus output of each voice is then measured
+// against the floating-point sox chorus with a continuous delay (chorus_ref.mem, as in
+// host/bench_chorus): the SNR has to reach CHORUS_MIN_SNR and match the model's.
+//
+// It ends with one line "tb_ChorusBuffer: PASS" or "tb_ChorusBuffer: FAIL", and
+// "samples: N" for the throughput figure (see Makefile).
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+`timescale 1 ns / 1 ps
+
+`include "chorus_vectors.vh"
+
+module tb_ChorusBuffer;
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	localparam real		ACLK_HALF_NS	=	5.0;				// 100 MHz AXI clock
+	localparam integer	OUTPUT_OFFSET	=	8'h38;				// slv_reg14, chorus output
+	localparam integer	SAMPLES			=	`CHORUS_VOICES * `CHORUS_LINES;
+
+	reg 							aclk;
+	reg 							aresetn;
+
+	reg 		[5:0]				awaddr;
+	reg 							awvalid;
+	wire							awready;
+	reg 		[31:0]				wdata;
+	reg 							wvalid;
+	wire							wready;
+	wire		[1:0]				bresp;
+	wire							bvalid;
+	reg 		[5:0]				araddr;
+	reg 							arvalid;
+	wire							arready;
+	wire		[31:0]				rdata;
+	wire		[1:0]				rresp;
+	wire							rvalid;
+
+	// vectors & results
+
+	reg 		[43:0]				bus_words		[0:`CHORUS_BUS_WORDS-1];
+	reg 		[15:0]				reference		[0:SAMPLES-1];
+	reg 		[15:0]				chorus_out		[0:SAMPLES-1];
+
+	integer 						word;
+	integer 						outputs;
+	integer 						mismatches;
+	integer 						voice;
+	integer 						i;
+	reg 		[43:0]				entry;
+	reg 		[31:0]				value;
+	real 							sig;
+	real 							err;
+	real 							diff;
+	real 							snr;
+	real 							model_snr;
+	integer 						snr_fails;
+
+	/******************************************************************/
+	/* Device under test							                  */
+	/******************************************************************/
+
+	ChorusBuffer_v1_0 dut (
+
+		.s00_axi_aclk		(aclk),
+		.s00_axi_aresetn	(aresetn),
+		.s00_axi_awaddr		(awaddr),
+		.s00_axi_awprot		(3'b000),
+		.s00_axi_awvalid	(awvalid),
+		.s00_axi_awready	(awready),
+		.s00_axi_wdata		(wdata),
+		.s00_axi_wstrb		(4'b1111),
+		.s00_axi_wvalid		(wvalid),
+		.s00_axi_wready		(wready),
+		.s00_axi_bresp		(bresp),
+		.s00_axi_bvalid		(bvalid),
+		.s00_axi_bready		(1'b1),
+		.s00_axi_araddr		(araddr),
+		.s00_axi_arprot		(3'b000),
+		.s00_axi_arvalid	(arvalid),
+		.s00_axi_arready	(arready),
+		.s00_axi_rdata		(rdata),
+		.s00_axi_rresp		(rresp),
+		.s00_axi_rvalid		(rvalid),
+		.s00_axi_rready		(1'b1));
+
+	/******************************************************************/
+	/* AXI-Lite master								                  */
+	/******************************************************************/
+
+	// one write: address & data together, held until the slave takes them
+
+	task axi_write (input [5:0] addr, input [31:0] data);
+
+		begin
+
+			@(negedge aclk);
+			awaddr = addr;
+			wdata = data;
+			awvalid = 1'b1;
+			wvalid = 1'b1;
+
+			@(negedge aclk);
+
+			while (!awready) begin
+				@(negedge aclk);
+			end
+
+			@(negedge aclk);
+			awvalid = 1'b0;
+			wvalid = 1'b0;
+
+		end
+
+	endtask
+
+	// one read, held until the slave takes it (it holds off while a sample is worked out)
+
+	task axi_read (input [5:0] addr, output [31:0] data);
+
+		begin
+
+			@(negedge aclk);
+			araddr = addr;
+			arvalid = 1'b1;
+
+			@(negedge aclk);
+
+			while (!arready) begin
+				@(negedge aclk);
+			end
+
+			@(negedge aclk);
+			arvalid = 1'b0;
+			data = rdata;
+
+		end
+
+	endtask
+
+	/******************************************************************/
+	/* Clock & reset								                  */
+	/******************************************************************/
+
+	initial begin
+
+		$readmemh("chorus_bus.mem", bus_words);
+		$readmemh("chorus_ref.mem", reference);
+
+		aclk = 1'b0;
+		aresetn = 1'b0;
+
+		awaddr = 6'h00;
+		awvalid = 1'b0;
+		wdata = 32'h00000000;
+		wvalid = 1'b0;
+		araddr = 6'h00;
+		arvalid = 1'b0;
+
+		outputs = 0;
+		mismatches = 0;
+		snr_fails = 0;
+
+	end
+
+	always #(ACLK_HALF_NS) aclk = ~aclk;
+
+	/******************************************************************/
+	/* Replay the trace								                  */
+	/******************************************************************/
+
+	initial begin
+
+		repeat (16) @(posedge aclk);
+		aresetn = 1'b1;
+
+		for (word = 0; word < `CHORUS_BUS_WORDS; word = word + 1) begin
+
+			entry = bus_words[word];
+
+			if (entry[40]) begin
+				axi_write(entry[37:32], entry[31:0]);
+			end
+
+			else begin
+
+				axi_read(entry[37:32], value);
+
+				// Port B drives the low half of the data read from the Block RAM
+
+				if (value[15:0] !== entry[15:0]) begin
+
+					if (mismatches < 8) begin
+						$display("  bus word %0d, read of %h: ChorusBuffer %h, model %h", word,
+							entry[39:32], value, entry[31:0]);
+					end
+
+					mismatches = mismatches + 1;
+				end
+
+				if ((entry[39:32] == OUTPUT_OFFSET) && (outputs < SAMPLES)) begin
+
+					chorus_out[outputs] = value[15:0];
+					outputs = outputs + 1;
+
+				end
+
+			end
+
+		end
+
+		// each voice against the floating-point reference
+
+		for (voice = 0; voice < `CHORUS_VOICES; voice = voice + 1) begin
+
+			sig = 0.0;
+			err = 0.0;
+
+			for (i = voice * `CHORUS_LINES; i < (voice + 1) * `CHORUS_LINES; i = i + 1) begin
+
+				diff = $itor($signed(chorus_out[i])) - $itor($signed(reference[i]));
+				sig = sig + $itor($signed(reference[i])) * $itor($signed(reference[i]));
+				err = err + diff * diff;
+
+			end
+
+			snr = (err > 0.0) ? 10.0 * $log10(sig / err) : 200.0;
+			model_snr = (voice == 0) ? `CHORUS_MODEL_SNR_0 : `CHORUS_MODEL_SNR_1;
+
+			$display("tb_ChorusBuffer: voice %0d (%s), SNR %0.2f dB against the sox chorus, model %0.2f dB",
+				voice, (voice == 0) ? "sine" : "triangle", snr, model_snr);
+
+			if ((snr < `CHORUS_MIN_SNR) || (snr - model_snr >= 0.01) || (model_snr - snr >= 0.01)) begin
+				snr_fails = snr_fails + 1;
+			end
+
+		end
+
+		$display("tb_ChorusBuffer: %0d bus words, %0d chorus outputs, %0d reads differ from the model",
+			`CHORUS_BUS_WORDS, outputs, mismatches);
+		$display("samples: %0d", outputs);
+
+		if ((outputs == SAMPLES) && (mismatches == 0) && (snr_fails == 0)) begin
+			$display("tb_ChorusBuffer: PASS");
+		end
+
+		else begin
+			$display("tb_ChorusBuffer: FAIL");
+		end
+
+		$finish;
+
+	end
+
+endmodule
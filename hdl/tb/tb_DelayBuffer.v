@@ -0,0 +1,383 @@
+// tb_DelayBuffer.v --> self-checking testbench for the DelayBuffer echo engine
+//
+// Description:
+// ------------
+// Runs the DelayBuffer IP (ECHO_TAPS 8) with its AXI-Lite slave at 100 MHz and Port B at
+// the 3.072 MHz mic clock, over blk_mem_gen_0.v (the Block RAM with its two clocks of read
+// latency), against vectors written by host/bench_echo:
+//
+//		- echo_buf.mem, a DelayBuffer image, goes in over AXI-Lite as the software writes
+//		  it: the auto-increment mode (slv_reg5), the start address (slv_reg1) and one
+//		  slv_reg2 write per line
+//		- Port B is then stepped through the lines one at a time, as AudioOutput does but
+//		  every STEP_CLOCKS mic clocks, across the wrap from line 0xFFFF to line 0
+//		- the taps are programmed over AXI-Lite (slv_reg3 & slv_reg4, then slv_reg6) while
+//		  Port B runs, so every copy of the table goes through the echo_update toggle and
+//		  is taken in the mic clock domain along with slv_reg6; the default taps first,
+//		  then ECHO_TAPS loud ones that saturate, then the engine off
+//
+// Once each table has settled every line on doutb is checked against what
+// delay_line_mix() (software/delay_line.c) makes of the same image with the same taps
+// (echo_out_a.mem, echo_out_b.mem), and against the line itself with the engine off.
+// The slv_reg6 readback and the read pointer (slv_reg7) are checked too.
+//
+// It ends with one line "tb_DelayBuffer: PASS" or "tb_DelayBuffer: FAIL", and "samples: N"
+// for the throughput figure (see Makefile).
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+`timescale 1 ns / 1 ps
+
+`include "echo_vectors.vh"
+
+module tb_DelayBuffer;
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	localparam real		ACLK_HALF_NS	=	5.0;							// 100 MHz AXI clock
+	localparam real		CLKB_HALF_NS	=	1.0e9 / 3072000.0 / 2.0;		// 3.072 MHz mic clock
+	localparam integer	ECHO_TAPS		=	8;
+	localparam integer	STEP_CLOCKS		=	16;		// > ECHO_TAPS + READ_LATENCY + 3
+	localparam integer	START_LINE		=	16'hFE00;
+	localparam integer	SETTLE_LINES	=	3;
+	localparam integer	CHECK_LINES		=	1024;
+
+	// the checks on doutb
+
+	localparam integer	CHECK_NONE		=	0;
+	localparam integer	CHECK_A			=	1;
+	localparam integer	CHECK_B			=	2;
+	localparam integer	CHECK_OFF		=	3;
+
+	reg 							aclk;
+	reg 							aresetn;
+	reg 							clkb;
+
+	reg 		[4:0]				awaddr;
+	reg 							awvalid;
+	wire							awready;
+	reg 		[31:0]				wdata;
+	reg 							wvalid;
+	wire							wready;
+	wire		[1:0]				bresp;
+	wire							bvalid;
+	reg 		[4:0]				araddr;
+	reg 							arvalid;
+	wire							arready;
+	wire		[31:0]				rdata;
+	wire		[1:0]				rresp;
+	wire							rvalid;
+
+	reg 		[15:0]				addrb;
+	wire		[15:0]				doutb;
+
+	// vectors & results
+
+	reg 		[15:0]				buf_lines		[0:`ECHO_LINES-1];
+	reg 		[15:0]				out_a			[0:`ECHO_LINES-1];
+	reg 		[15:0]				out_b			[0:`ECHO_LINES-1];
+	reg 		[31:0]				tap_words		[0:2*ECHO_TAPS-1];
+
+	integer 						check;
+	integer 						settle_at;
+	integer 						line_count;
+	integer 						step_count;
+	integer 						stepping;
+	integer 						checked;
+	integer 						mismatches;
+	integer 						saturated;
+	integer 						bad_reads;
+	integer 						target;
+	integer 						i;
+	reg 		[15:0]				expected;
+	reg 		[31:0]				value;
+
+	/******************************************************************/
+	/* Device under test							                  */
+	/******************************************************************/
+
+	DelayBuffer_v1_0 #(
+
+		.ECHO_TAPS			(ECHO_TAPS))
+
+	dut (
+
+		.clkb				(clkb),
+		.addrb				(addrb),
+		.doutb				(doutb),
+
+		.s00_axi_aclk		(aclk),
+		.s00_axi_aresetn	(aresetn),
+		.s00_axi_awaddr		(awaddr),
+		.s00_axi_awprot		(3'b000),
+		.s00_axi_awvalid	(awvalid),
+		.s00_axi_awready	(awready),
+		.s00_axi_wdata		(wdata),
+		.s00_axi_wstrb		(4'b1111),
+		.s00_axi_wvalid		(wvalid),
+		.s00_axi_wready		(wready),
+		.s00_axi_bresp		(bresp),
+		.s00_axi_bvalid		(bvalid),
+		.s00_axi_bready		(1'b1),
+		.s00_axi_araddr		(araddr),
+		.s00_axi_arprot		(3'b000),
+		.s00_axi_arvalid	(arvalid),
+		.s00_axi_arready	(arready),
+		.s00_axi_rdata		(rdata),
+		.s00_axi_rresp		(rresp),
+		.s00_axi_rvalid		(rvalid),
+		.s00_axi_rready		(1'b1));
+
+	/******************************************************************/
+	/* AXI-Lite master								                  */
+	/******************************************************************/
+
+	// one write: address & data together, held until the slave takes them
+
+	task axi_write (input [4:0] addr, input [31:0] data);
+
+		begin
+
+			@(negedge aclk);
+			awaddr = addr;
+			wdata = data;
+			awvalid = 1'b1;
+			wvalid = 1'b1;
+
+			@(negedge aclk);
+
+			while (!awready) begin
+				@(negedge aclk);
+			end
+
+			@(negedge aclk);
+			awvalid = 1'b0;
+			wvalid = 1'b0;
+
+		end
+
+	endtask
+
+	task axi_read (input [4:0] addr, output [31:0] data);
+
+		begin
+
+			@(negedge aclk);
+			araddr = addr;
+			arvalid = 1'b1;
+
+			@(negedge aclk);
+
+			while (!arready) begin
+				@(negedge aclk);
+			end
+
+			@(negedge aclk);
+			arvalid = 1'b0;
+			data = rdata;
+
+		end
+
+	endtask
+
+	// a tap set: each tap word through slv_reg3 & slv_reg4, then slv_reg6
+
+	task set_taps (input integer set, input integer num_taps, input enable);
+
+		begin
+
+			for (i = 0; i < ECHO_TAPS; i = i + 1) begin
+
+				axi_write(5'h0C, tap_words[set*ECHO_TAPS + i]);
+				axi_write(5'h10, i);
+
+			end
+
+			axi_write(5'h18, {enable, 8'h00} | num_taps);
+
+			axi_read(5'h18, value);
+
+			if (value !== ({enable, 8'h00} | num_taps)) begin
+
+				$display("  slv_reg6 reads %h", value);
+				bad_reads = bad_reads + 1;
+
+			end
+
+		end
+
+	endtask
+
+	/******************************************************************/
+	/* Clocks & Port B								                  */
+	/******************************************************************/
+
+	initial begin
+
+		$readmemh("echo_buf.mem", buf_lines);
+		$readmemh("echo_out_a.mem", out_a);
+		$readmemh("echo_out_b.mem", out_b);
+		$readmemh("echo_taps.mem", tap_words);
+
+		aclk = 1'b0;
+		clkb = 1'b0;
+		aresetn = 1'b0;
+
+		awaddr = 5'h00;
+		awvalid = 1'b0;
+		wdata = 32'h00000000;
+		wvalid = 1'b0;
+		araddr = 5'h00;
+		arvalid = 1'b0;
+
+		addrb = START_LINE;
+		check = CHECK_NONE;
+		settle_at = 0;
+		line_count = 0;
+		step_count = 0;
+		stepping = 0;
+		checked = 0;
+		mismatches = 0;
+		saturated = 0;
+		bad_reads = 0;
+
+	end
+
+	always #(ACLK_HALF_NS) aclk = ~aclk;
+	always #(CLKB_HALF_NS) clkb = ~clkb;
+
+	// every STEP_CLOCKS the line on doutb is checked and Port B moves on: the mix of
+	// line n is on doutb from the clock after addrb moves to n, so a line is only
+	// good when the move to it came from line n - 1
+
+	always @(posedge clkb) begin
+
+		if (stepping) begin
+
+			if (step_count == STEP_CLOCKS - 1) begin
+
+				if ((check != CHECK_NONE) && (line_count >= settle_at)) begin
+
+					case (check)
+						CHECK_A		:	expected = out_a[addrb];
+						CHECK_B		:	expected = out_b[addrb];
+						default		:	expected = buf_lines[addrb];
+					endcase
+
+					if (doutb !== expected) begin
+
+						if (mismatches < 8) begin
+							$display("  line %h (check %0d): doutb %0d, expected %0d", addrb, check,
+								$signed(doutb), $signed(expected));
+						end
+
+						mismatches = mismatches + 1;
+					end
+
+					if ((doutb == 16'h7FFF) || (doutb == 16'h8000)) begin
+						saturated = saturated + 1;
+					end
+
+					checked = checked + 1;
+
+				end
+
+				addrb <= addrb + 1'b1;
+				line_count <= line_count + 1;
+				step_count <= 0;
+
+			end
+
+			else begin
+				step_count <= step_count + 1;
+			end
+
+		end
+
+	end
+
+	/******************************************************************/
+	/* Test sequence								                  */
+	/******************************************************************/
+
+	initial begin
+
+		repeat (16) @(posedge aclk);
+		aresetn = 1'b1;
+
+		// the image, as DelayBuffer_WriteStream() writes it
+
+		axi_write(5'h14, 32'h00000001);
+		axi_write(5'h04, 32'h00000000);
+
+		for (i = 0; i < `ECHO_LINES; i = i + 1) begin
+			axi_write(5'h08, buf_lines[i]);
+		end
+
+		axi_write(5'h14, 32'h00000000);
+
+		stepping = 1;
+
+		// the default taps
+
+		set_taps(0, `ECHO_TAPS_A, 1'b1);
+
+		settle_at = line_count + SETTLE_LINES;
+		check = CHECK_A;
+		target = checked + CHECK_LINES;
+		wait (checked >= target);
+
+		// the read pointer, through its Gray-code synchronizer: the line Port B is on,
+		// or the one before if it has just moved
+
+		axi_read(5'h1C, value);
+
+		if ((value[15:0] !== addrb) && (value[15:0] !== addrb - 1'b1)) begin
+
+			$display("  read pointer %h, Port B at %h", value[15:0], addrb);
+			bad_reads = bad_reads + 1;
+
+		end
+
+		// the loud taps, reprogrammed while Port B runs
+
+		check = CHECK_NONE;
+		set_taps(1, `ECHO_TAPS_B, 1'b1);
+
+		settle_at = line_count + SETTLE_LINES;
+		check = CHECK_B;
+		target = checked + CHECK_LINES;
+		wait (checked >= target);
+
+		// and the engine off: the lines go through as they are
+
+		check = CHECK_NONE;
+		axi_write(5'h18, `ECHO_TAPS_B);
+
+		settle_at = line_count + SETTLE_LINES;
+		check = CHECK_OFF;
+		target = checked + CHECK_LINES;
+		wait (checked >= target);
+
+		check = CHECK_NONE;
+		stepping = 0;
+
+		$display("tb_DelayBuffer: %0d lines checked, %0d mismatches, %0d saturated, %0d bad register reads",
+			checked, mismatches, saturated, bad_reads);
+		$display("samples: %0d", line_count);
+
+		if ((checked == 3 * CHECK_LINES) && (mismatches == 0) && (bad_reads == 0) && (saturated > 0)) begin
+			$display("tb_DelayBuffer: PASS");
+		end
+
+		else begin
+			$display("tb_DelayBuffer: FAIL");
+		end
+
+		$finish;
+
+	end
+
+endmodule
@@ -0,0 +1,48 @@
+// tone_fit.vh --> least-squares fit of a testbench tone
+//
+// Description:
+// ------------
+// Included inside a testbench module that declares tone_pcm, an array of signed 16-bit
+// samples. tone_fit fits a cos + b sin + c, one cycle every period samples, to count
+// samples (whole periods) from first on, where the three are orthogonal, and returns the
+// SNR of the tone against what is left over: the same measure as host/bench_pdm.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+	task tone_fit;
+
+		input integer	first;
+		input integer	count;
+		input integer	period;
+		output real		snr;
+
+		integer			n;
+		real			w, a, b, c, e, resid;
+
+		begin
+			a = 0.0;
+			b = 0.0;
+			c = 0.0;
+			resid = 0.0;
+
+			for (n = 0; n < count; n = n + 1) begin
+				w = 2.0 * 3.14159265358979 * (n % period) / period;
+				a = a + tone_pcm[first + n] * $cos(w);
+				b = b + tone_pcm[first + n] * $sin(w);
+				c = c + tone_pcm[first + n];
+			end
+
+			a = 2.0 * a / count;
+			b = 2.0 * b / count;
+			c = c / count;
+
+			for (n = 0; n < count; n = n + 1) begin
+				w = 2.0 * 3.14159265358979 * (n % period) / period;
+				e = tone_pcm[first + n] - (a * $cos(w) + b * $sin(w) + c);
+				resid = resid + e * e;
+			end
+
+			snr = 20.0 * $log10($sqrt(a * a + b * b) / $sqrt(2.0) / $sqrt(resid / count));
+		end
+
+	endtask
@@ -0,0 +1,329 @@
+/**
+*
+* @file bench_biquad.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host benchmark for the biquad cascade engine (software/biquad.c) behind
+* the lowp, highp, band and filter effects. For 1, 2 and 4 sections over
+* 1, 2 and 4 channels it times:
+*
+*	o the fixed-point engine, the one the MicroBlaze runs (here as host C)
+*	o the float engine a section & channel at a time
+*	o the float engine on SSE, four channels or four sections a lane, where
+*	  the layout allows; its output has to match the scalar one bit for bit
+*
+* in samples per second per section (best of three runs), i.e. how many
+* samples a second one section could filter. Then the noise each engine
+* adds, against a double precision run of the same coefficients, for the
+* hard cases: an 8-pole low-pass at 100 Hz and an 8-pole high-pass at
+* 50 Hz, at 16 kHz.
+*
+* Usage:
+*	bench_biquad [seconds]
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "xil_types.h"
+#include "delay_line.h"
+#include "biquad.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define SAMPLE_RATE			16000
+#define BLOCK_SIZE			64
+#define DEFAULT_SECONDS		8
+#define NOISE_SECONDS		4
+#define REPEATS				3
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static const unsigned int section_counts[] = { 1, 2, 4 };
+static const unsigned int channel_counts[] = { 1, 2, 4 };
+
+static u32 rng_state = 0x1234567;
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static u32 rng_next(void) {
+
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return rng_state >> 8;
+}
+
+// noise at about -12 dBFS plus a 60 Hz hum and a 1 kHz tone
+
+static void make_signal(st_sample_t *buf, st_size_t len, unsigned int channels) {
+
+	st_size_t	i;
+	double		x;
+
+	for (i = 0; i < len; i++) {
+
+		x  = (double) ((int) (rng_next() & 0x3FFF) - 0x2000);
+		x += 6000.0 * sin(2.0 * M_PI * 60.0 * (i / channels) / SAMPLE_RATE);
+		x += 4000.0 * sin(2.0 * M_PI * 1000.0 * (i / channels) / SAMPLE_RATE);
+
+		buf[i] = ST_SIGNED_WORD_TO_SAMPLE((s16) x);
+	}
+}
+
+// a cascade of Butterworth sections (low-pass, every other one high-pass)
+
+static void make_cascade(biquad_t *bq, unsigned int sections, unsigned int channels,
+						 unsigned int engine) {
+
+	unsigned int s;
+
+	biquad_init(bq, channels, engine);
+
+	for (s = 0; s < sections; s++) {
+		biquad_butterworth(bq, (s & 1) ? BIQUAD_HIGHPASS : BIQUAD_LOWPASS, SAMPLE_RATE,
+						   (s & 1) ? 100.0 : 4000.0, 2);
+	}
+
+	biquad_reset(bq);
+}
+
+// len samples through a cascade, a block at a time, and out of its
+// pipeline; returns the samples out
+
+static st_size_t run_cascade(biquad_t *bq, const st_sample_t *in, st_sample_t *out, st_size_t len) {
+
+	st_size_t done, made = 0, block = BLOCK_SIZE * bq->channels, n;
+
+	for (done = 0; done < len; done += n) {
+
+		n     = MIN(len - done, block);
+		made += biquad_flow(bq, in + done, out + made, n);
+	}
+
+	while ((n = biquad_drain(bq, out + made, len - made)) > 0) {
+		made += n;
+	}
+
+	return made;
+}
+
+// the best of REPEATS runs of a fresh cascade, in seconds; scalar forces the
+// float engine to a section & channel at a time. *layout is the layout run.
+
+static double time_cascade(unsigned int sections, unsigned int channels, unsigned int engine,
+						   int scalar, const st_sample_t *in, st_sample_t *out, st_size_t len,
+						   st_size_t *made, unsigned int *layout) {
+
+	biquad_t		bq;
+	unsigned int	rep;
+	double			start, seconds, best = 1e30;
+
+	for (rep = 0; rep < REPEATS; rep++) {
+
+		make_cascade(&bq, sections, channels, engine);
+
+		if (scalar) {
+			bq.layout = BIQUAD_SCALAR;
+			bq.skip   = 0;
+		}
+
+		*layout = bq.layout;
+
+		start   = now_seconds();
+		*made   = run_cascade(&bq, in, out, len);
+		seconds = now_seconds() - start;
+		best    = MIN(best, seconds);
+	}
+
+	return best;
+}
+
+// double precision reference of the cascade's Q2.30 coefficients, DF1
+
+static void run_reference(const biquad_t *bq, const st_sample_t *in, double *out, st_size_t len) {
+
+	double			x1[BIQUAD_MAX_SECTIONS] = { 0 }, x2[BIQUAD_MAX_SECTIONS] = { 0 };
+	double			y1[BIQUAD_MAX_SECTIONS] = { 0 }, y2[BIQUAD_MAX_SECTIONS] = { 0 };
+	double			c[BIQUAD_MAX_SECTIONS][5], x, y;
+	unsigned int	s, k;
+	st_size_t		i;
+
+	for (s = 0; s < bq->sections; s++) {
+		for (k = 0; k < 5; k++) {
+			c[s][k] = ldexp((double) bq->q[s][k], -BIQUAD_Q);
+		}
+	}
+
+	for (i = 0; i < len; i++) {
+
+		x = ST_SAMPLE_TO_SIGNED_WORD(in[i]);
+
+		for (s = 0; s < bq->sections; s++) {
+
+			y = c[s][0] * x + c[s][1] * x1[s] + c[s][2] * x2[s] + c[s][3] * y1[s] + c[s][4] * y2[s];
+
+			x2[s] = x1[s]; x1[s] = x;
+			y2[s] = y1[s]; y1[s] = y;
+			x = y;
+		}
+
+		out[i] = x;
+	}
+}
+
+// signal to noise of an engine's output against the reference, in dB
+
+static double snr_db(const st_sample_t *out, const double *ref, st_size_t len) {
+
+	double		signal = 0.0, noise = 0.0, e;
+	st_size_t	i;
+
+	for (i = 0; i < len; i++) {
+
+		e       = ST_SAMPLE_TO_SIGNED_WORD(out[i]) - ref[i];
+		signal += ref[i] * ref[i];
+		noise  += e * e;
+	}
+
+	return 10.0 * log10(signal / MAX(noise, 1e-12));
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	unsigned int	seconds = (argc > 1) ? (unsigned int) atoi(argv[1]) : DEFAULT_SECONDS;
+	unsigned int	si, ci, sections, channels, type, layout, failed = 0;
+	st_sample_t		*in, *out_fixed, *out_scalar, *out_simd;
+	double			*ref, t_fixed, t_scalar, t_simd;
+	st_size_t		len, made, i;
+	biquad_t		bq;
+	int				same;
+
+	if (seconds == 0) {
+		seconds = DEFAULT_SECONDS;
+	}
+
+	len = (st_size_t) seconds * SAMPLE_RATE * BIQUAD_MAX_CHANNELS;
+
+	in         = malloc(len * sizeof(st_sample_t));
+	out_fixed  = malloc(len * sizeof(st_sample_t));
+	out_scalar = malloc(len * sizeof(st_sample_t));
+	out_simd   = malloc(len * sizeof(st_sample_t));
+	ref        = malloc(len * sizeof(double));
+
+	if ((in == NULL) || (out_fixed == NULL) || (out_scalar == NULL) || (out_simd == NULL) || (ref == NULL)) {
+
+		fprintf(stderr, "out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("\nbiquad cascade engine, %u s of 16 kHz audio per channel, %d frames a block, SIMD %s\n\n",
+		seconds, BLOCK_SIZE, BIQUAD_HAVE_SIMD ? "SSE2" : "none");
+
+	printf("  sections channels   %24s %24s %24s\n", "fixed (MicroBlaze C)", "float", "float SIMD");
+
+	for (si = 0; si < sizeof(section_counts) / sizeof(section_counts[0]); si++) {
+
+		for (ci = 0; ci < sizeof(channel_counts) / sizeof(channel_counts[0]); ci++) {
+
+			sections = section_counts[si];
+			channels = channel_counts[ci];
+			len      = (st_size_t) seconds * SAMPLE_RATE * channels;
+
+			make_signal(in, len, channels);
+
+			t_fixed = time_cascade(sections, channels, BIQUAD_ENGINE_FIXED, 0, in, out_fixed, len,
+								   &made, &layout);
+
+			// float a section & channel at a time, then in the SIMD layout
+
+			t_scalar = time_cascade(sections, channels, BIQUAD_ENGINE_FLOAT, 1, in, out_scalar, len,
+									&made, &layout);
+			t_simd   = time_cascade(sections, channels, BIQUAD_ENGINE_FLOAT, 0, in, out_simd, len,
+									&made, &layout);
+
+			printf("  %8u %8u %14.1f MS/s/sec %14.1f MS/s/sec", sections, channels,
+				len * sections / t_fixed / 1e6, len * sections / t_scalar / 1e6);
+
+			if (layout == BIQUAD_SCALAR) {
+				printf(" %24s\n", "-");
+				continue;
+			}
+
+			same = (made == len) && !memcmp(out_simd, out_scalar, len * sizeof(st_sample_t));
+			failed += !same;
+
+			printf(" %14.1f MS/s/sec %s\n", len * sections / t_simd / 1e6,
+				same ? (layout == BIQUAD_SIMD_CHANNELS ? "(channels)" : "(sections)") : "MISMATCH");
+		}
+	}
+
+	// the noise the engines add, mono, against double precision
+
+	len = (st_size_t) NOISE_SECONDS * SAMPLE_RATE;
+	make_signal(in, len, 1);
+
+	printf("\n  SNR against double precision, 8 poles:\n");
+
+	for (type = BIQUAD_LOWPASS; type <= BIQUAD_HIGHPASS; type++) {
+
+		biquad_init(&bq, 1, BIQUAD_ENGINE_FIXED);
+		biquad_butterworth(&bq, type, SAMPLE_RATE, (type == BIQUAD_LOWPASS) ? 100.0 : 50.0, 8);
+		biquad_reset(&bq);
+
+		run_reference(&bq, in, ref, len);
+		run_cascade(&bq, in, out_fixed, len);
+
+		biquad_init(&bq, 1, BIQUAD_ENGINE_FLOAT);
+		biquad_butterworth(&bq, type, SAMPLE_RATE, (type == BIQUAD_LOWPASS) ? 100.0 : 50.0, 8);
+		biquad_reset(&bq);
+
+		run_cascade(&bq, in, out_scalar, len);
+
+		printf("    %-10s at %3.0f Hz:  fixed %5.1f dB   float %5.1f dB\n",
+			(type == BIQUAD_LOWPASS) ? "low-pass" : "high-pass", (type == BIQUAD_LOWPASS) ? 100.0 : 50.0,
+			snr_db(out_fixed, ref, len), snr_db(out_scalar, ref, len));
+	}
+
+	// and what 16-bit output costs anyway
+
+	for (i = 0; i < len; i++) {
+		out_fixed[i] = ST_SIGNED_WORD_TO_SAMPLE((s16) lrint(MIN(MAX(ref[i], PCM_MIN), PCM_MAX)));
+	}
+
+	printf("    (the high-pass reference rounded to 16 bits: %5.1f dB)\n", snr_db(out_fixed, ref, len));
+
+	printf("\n  float SIMD against scalar: %s\n\n", failed ? "FAIL" : "bit-exact");
+
+	free(in);
+	free(out_fixed);
+	free(out_scalar);
+	free(out_simd);
+	free(ref);
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
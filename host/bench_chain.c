@@ -0,0 +1,374 @@
+/**
+*
+* @file bench_chain.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host check & benchmark for the effect chain runner (software/fx_chain.c).
+* The chain of every sw[1:0] mode runs twice over the same test signal:
+*
+*	o BRAM: process_sweep() over the InputBuffer model, exactly as the
+*	  board runs it, chain source & sink on the InputBuffer & DelayBuffer
+*	o files: the same chain picked with select_fx_chain(), with its source
+*	  & sink moved to 16-bit raw files, run to the end of the input and
+*	  then drained
+*
+* The file run is done twice, with the chain's own pool: once with every
+* stage in a buffer of its own (the ST_EFF_INPLACE flags cleared) and once
+* with the stages working in place, as on the board. Each reports its
+* buffer memory and time per block. The first buffer's worth of the file
+* output has to match the DelayBuffer sample for sample either way, for
+* both chorus engines; the rest of the file shows the chain keeps going
+* across the buffer wrap and the drain shows the effect tails. The file
+* path runs the software delay engine, since the hardware echo only exists
+* in what AudioOutput plays.
+*
+* Usage:
+*	bench_chain [latency_spins] [in.raw]
+*
+* Without in.raw the test signal is written to a temporary file first.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "xparameters.h"
+#include "hal.h"
+#include "ChorusBuffer.h"
+#include "DelayBuffer.h"
+#include "InputBuffer.h"
+#include "audio_fx.h"
+#include "fx_chain.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define NUM_LINES			(4 * BUFFER_DEPTH)
+#define DEFAULT_SPINS		200
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct file_io {
+
+	FILE			*in;
+	FILE			*out;
+	unsigned long	written;
+
+} file_io_t;
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static u32	rng_state = 0x5D1CE4E5;
+static u16			reference[BUFFER_DEPTH];
+static s16			output[BUFFER_DEPTH];
+static st_sample_t	pool[FX_CHAIN_POOL(FX_CHAIN_MAX_STAGES, BLOCK_SIZE)];
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static u32 rng_next(void) {
+
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return rng_state >> 8;
+}
+
+// two tones swinging from quiet to loud, plus a little noise
+
+static void write_signal(FILE *fp) {
+
+	unsigned int n;
+	double level;
+	s16 x;
+
+	for (n = 0; n < NUM_LINES; n++) {
+
+		level = 0.5 - 0.5 * cos(2.0 * M_PI * n / 50000.0);
+
+		x = (s16) PCM_LINE((int) (level * (16000.0 * sin(2.0 * M_PI * 440.0 * n / SAMPLE_RATE) +
+			8000.0 * sin(2.0 * M_PI * 1330.0 * n / SAMPLE_RATE)) + (int) (rng_next() & 0xFF) - 0x80));
+
+		fwrite(&x, sizeof(x), 1, fp);
+	}
+
+	return;
+}
+
+// chain source & sink on raw native-endian 16-bit files
+
+static st_size_t file_read(void *io, st_sample_t *buf, st_size_t len) {
+
+	file_io_t	*fio = (file_io_t *) io;
+	s16			pcm[BLOCK_SIZE];
+	size_t		count, i;
+
+	count = fread(pcm, sizeof(s16), MIN(len, BLOCK_SIZE), fio->in);
+
+	for (i = 0; i < count; i++) {
+		buf[i] = FX_LINE_TO_SAMPLE(pcm[i]);
+	}
+
+	return (st_size_t) count;
+}
+
+static void file_write(void *io, const st_sample_t *buf, st_size_t len) {
+
+	file_io_t	*fio = (file_io_t *) io;
+	s16			pcm[BLOCK_SIZE];
+	st_size_t	i;
+
+	for (i = 0; i < len; i++) {
+		pcm[i] = (s16) FX_SAMPLE_TO_LINE(buf[i]);
+	}
+
+	fwrite(pcm, sizeof(s16), len, fio->out);
+	fio->written += len;
+
+	return;
+}
+
+// clear the histories and set the effects up from scratch
+
+static void reset_fx(unsigned int chorus_engine) {
+
+	memset(hal_chorusbuffer_bram(), 0, BUFFER_DEPTH * sizeof(u16));
+	memset(hal_delaybuffer_bram(), 0, BUFFER_DEPTH * sizeof(u16));
+
+	init_fx();
+	set_delay_engine(DELAY_ENGINE_SOFTWARE);
+	chorus_set_engine(chorus_engine);
+
+	return;
+}
+
+// the first BUFFER_DEPTH input samples through process_sweep()
+
+static void run_bram(FILE *in, unsigned int mode, unsigned int chorus_engine) {
+
+	s16 pcm[BUFFER_DEPTH];
+	u16 *bram = hal_inputbuffer_bram();
+	unsigned int i;
+
+	rewind(in);
+
+	if (fread(pcm, sizeof(s16), BUFFER_DEPTH, in) != BUFFER_DEPTH) {
+
+		fprintf(stderr, "input shorter than the buffer\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < BUFFER_DEPTH; i++) {
+		bram[i] = (u16) pcm[i];
+	}
+
+	reset_fx(chorus_engine);
+	process_sweep(mode);
+
+	memcpy(reference, hal_delaybuffer_bram(), sizeof(reference));
+
+	return;
+}
+
+// the whole input file through the stages of the same chain to a file,
+// with or without in place; returns the samples read, *tail the samples
+// drained, *seconds the time taken and *bytes the chain's buffer memory
+
+static unsigned long run_files(file_io_t *fio, unsigned int mode, unsigned int chorus_engine,
+							   int inplace, unsigned long *tail, double *seconds, unsigned long *bytes) {
+
+	fx_chain_t		chain, *board;
+	unsigned int	flags[FX_CHAIN_MAX_STAGES];
+	unsigned long	samples = 0;
+	st_size_t		count;
+	unsigned int	i;
+	double			start;
+
+	rewind(fio->in);
+	rewind(fio->out);
+	fio->written = 0;
+
+	reset_fx(chorus_engine);
+	board = select_fx_chain(mode);
+
+	// the buffer layout follows the handler flags when the chain is set up
+
+	for (i = 0; i < board->num_stages; i++) {
+
+		flags[i] = board->stage[i]->h->flags;
+
+		if (!inplace) {
+			board->stage[i]->h->flags &= ~ST_EFF_INPLACE;
+		}
+	}
+
+	if (fx_chain_init(&chain, board->stage, board->num_stages, pool,
+					  sizeof(pool) / sizeof(pool[0]), BLOCK_SIZE) != XST_SUCCESS) {
+
+		fprintf(stderr, "chain %u would not set up\n", mode);
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < board->num_stages; i++) {
+		board->stage[i]->h->flags = flags[i];
+	}
+
+	fx_chain_set_io(&chain, file_read, file_write, fio);
+	fx_chain_start(&chain);
+
+	start = now_seconds();
+
+	while ((count = fx_chain_run(&chain, BLOCK_SIZE)) > 0) {
+		samples += count;
+	}
+
+	*tail = fio->written;
+	fx_chain_drain(&chain);
+	*tail = fio->written - *tail;
+
+	*seconds = now_seconds() - start;
+	*bytes   = chain.num_buffers * BLOCK_SIZE * sizeof(st_sample_t);
+
+	fx_chain_stop(&chain);
+	fflush(fio->out);
+
+	return samples;
+}
+
+// the file output against the DelayBuffer; returns the samples that differ
+
+static unsigned long compare_output(FILE *out) {
+
+	unsigned long mismatches = 0;
+	unsigned int i;
+
+	rewind(out);
+
+	if (fread(output, sizeof(s16), BUFFER_DEPTH, out) != BUFFER_DEPTH) {
+
+		fprintf(stderr, "output shorter than the buffer\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < BUFFER_DEPTH; i++) {
+		mismatches += ((u16) output[i] != reference[i]);
+	}
+
+	return mismatches;
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	static const char *mode_names[FX_NUM_CHAINS] = {
+
+		"no effects", "chorus", "delay", "chorus + delay"
+	};
+
+	unsigned int	spins = (argc > 1) ? (unsigned int) atoi(argv[1]) : DEFAULT_SPINS;
+	unsigned int	engine, mode;
+	unsigned long	samples, tail, mismatches, failed = 0;
+	unsigned long	bytes[2];
+	double			seconds[2], rate;
+	int				inplace;
+	file_io_t		fio;
+
+	hal_inputbuffer_init();
+	hal_chorusbuffer_init();
+	hal_delaybuffer_init();
+
+	if ((InputBuffer_initialize(XPAR_INPUTBUFFER_0_S00_AXI_BASEADDR) != XST_SUCCESS) ||
+		(ChorusBuffer_initialize(XPAR_CHORUSBUFFER_0_S00_AXI_BASEADDR) != XST_SUCCESS) ||
+		(DelayBuffer_initialize(XPAR_DELAYBUFFER_0_S00_AXI_BASEADDR) != XST_SUCCESS)) {
+
+		fprintf(stderr, "driver self-test failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if (argc > 2) {
+
+		if ((fio.in = fopen(argv[2], "rb")) == NULL) {
+
+			perror(argv[2]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	else if ((fio.in = tmpfile()) != NULL) {
+		write_signal(fio.in);
+	}
+
+	if ((fio.in == NULL) || ((fio.out = tmpfile()) == NULL)) {
+
+		perror("tmpfile");
+		return EXIT_FAILURE;
+	}
+
+	hal_io_set_latency(spins);
+
+	printf("\nEffect chains, BRAM vs. file to file, %u spins/access\n", spins);
+
+	for (engine = CHORUS_ENGINE_SOFTWARE; engine <= CHORUS_ENGINE_HARDWARE; engine++) {
+
+		printf("\n  chorus %s, delay in software\n\n",
+			(engine == CHORUS_ENGINE_HARDWARE) ? "by the ChorusBuffer voice generator" : "in software");
+
+		printf("  %-26s %9s %8s %9s %9s %12s %9s\n", "", "samples", "drained", "buffers", "us/block",
+			"samples/s", "realtime");
+
+		for (mode = 0; mode < FX_NUM_CHAINS; mode++) {
+
+			printf("  sw[1:0]=%u %s\n", mode, mode_names[mode]);
+
+			run_bram(fio.in, mode, engine);
+
+			for (inplace = 0, mismatches = 0; inplace <= 1; inplace++) {
+
+				samples = run_files(&fio, mode, engine, inplace, &tail, &seconds[inplace], &bytes[inplace]);
+				mismatches += compare_output(fio.out);
+				fseek(fio.out, 0, SEEK_END);
+
+				rate = (samples + tail) / seconds[inplace];
+
+				printf("    %-24s %9lu %8lu %7lu B %9.2f %12.0f %8.1fx\n",
+					inplace ? "in place" : "buffer per stage", samples, tail, bytes[inplace],
+					1e6 * BLOCK_SIZE / rate, rate, rate / SAMPLE_RATE);
+			}
+
+			failed += (mismatches != 0);
+
+			printf("    %-24s %26lu B %+8.0f%%  %s\n", "in place saves", bytes[0] - bytes[1],
+				100.0 * (seconds[0] - seconds[1]) / seconds[0], mismatches ? "FAIL" : "both match BRAM");
+		}
+	}
+
+	printf("\n");
+
+	// leave the chains on the buffers again
+
+	init_fx();
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
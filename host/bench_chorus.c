@@ -0,0 +1,403 @@
+/**
+*
+* @file bench_chorus.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host check & benchmark for the chorus voice generator in the ChorusBuffer
+* IP. The same test signal goes through Apply_Chorus() block by block, once
+* for each chorus engine:
+*
+*	o software: the sox chorus on st_sine / st_triangle tables, whole-line
+*	  delays (chorus_chunk() in software/chorus.c)
+*	o hardware: the history write plus one read per sample of the voice
+*	  generator, on the bit-exact model in hal_chorusbuffer.c
+*
+* Both are compared against a floating-point sox chorus whose delay follows
+* the LFO continuously, with the same linear interpolation between lines.
+* The hardware has to stay within MIN_SNR_DB of it for the default voice, a
+* triangle voice and random voices; the software SNR shows what the whole-line
+* delays of the tables cost. The bus transactions per sample of both paths
+* show what the generator takes off the bus.
+*
+* With a vector prefix it also writes, for hdl/tb/tb_ChorusBuffer, the bus
+* traffic of the hardware engine over the first VECTOR_LINES lines of the
+* default voice and of the same as a triangle, one voice after the other:
+*
+*	o <prefix>_bus.mem		every ChorusBuffer access (see hal_io.c): the
+*							history writes, the voice set-up and the
+*							chorus output reads with what the model
+*							returned for them (hex)
+*	o <prefix>_ref.mem		the floating-point sox chorus for every chorus
+*							output read, rounded to 16 bits (hex)
+*	o <prefix>_vectors.vh	the lengths, and the SNR in dB of the model
+*							against the rounded reference for each voice
+*
+* Usage:
+*	bench_chorus [latency_spins] [voices] [vector_prefix]
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "xparameters.h"
+#include "hal.h"
+#include "ChorusBuffer.h"
+#include "delay_line.h"
+#include "audio_fx.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define BUFFER_DEPTH		65536
+#define NUM_LINES			(4 * BUFFER_DEPTH)
+#define RATE				16000
+#define DEFAULT_SPINS		200
+#define DEFAULT_VOICES		6
+#define MIN_SNR_DB			50.0
+#define VECTOR_LINES		8192
+#define VECTOR_VOICES		2
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct voice {
+
+	float	in_gain, out_gain;
+	float	delay, decay, speed, depth;
+	int		modulation;
+
+} voice_t;
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static u32		rng_state = 0x2545F49;
+
+static double	signal[NUM_LINES];
+static double	reference[NUM_LINES];
+static double	output[NUM_LINES];
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static u32 rng_next(void) {
+
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return rng_state >> 8;
+}
+
+static float rng_range(float lo, float hi) {
+
+	return lo + (hi - lo) * (rng_next() & 0xFFFF) / 65535.0f;
+}
+
+// two tones that swing from quiet to near full scale, plus a little noise
+
+static void make_signal(void) {
+
+	unsigned int n;
+	double level;
+
+	for (n = 0; n < NUM_LINES; n++) {
+
+		level = 0.5 - 0.5 * cos(2.0 * M_PI * n / 50000.0);
+
+		signal[n] = (double) PCM_VALUE(PCM_LINE((int) (level * (18000.0 * sin(2.0 * M_PI * 440.0 * n / RATE) +
+			9000.0 * sin(2.0 * M_PI * 1330.0 * n / RATE)) + (int) (rng_next() & 0xFF) - 0x80)));
+	}
+}
+
+// sox chorus with a continuous delay: same tables & gains, no rounding
+
+static void make_reference(const voice_t *v) {
+
+	int		samples = (int) ((v->delay + v->depth) * RATE / 1000.0);
+	int		depth   = (int) (v->depth * RATE / 1000.0);
+	long	length  = (long) (RATE / v->speed);
+	double	w, d, frac, x0, x1, y;
+	long	i, k;
+	unsigned int n;
+
+	for (n = 0; n < NUM_LINES; n++) {
+
+		i = n % length;
+
+		if (v->modulation == MOD_SINE) {
+			w = (1.0 + sin(2.0 * M_PI * i / length)) / 2.0;
+		}
+
+		else {
+			w = (i < length / 2) ? (2.0 * i / length) : (2.0 * (length - i) / length);
+		}
+
+		d    = (samples - 1 - depth) + depth * w;
+		k    = (long) floor(d);
+		frac = d - k;
+
+		x0 = ((long) n - k >= 0) ? signal[n - k] : 0.0;
+		x1 = ((long) n - k - 1 >= 0) ? signal[n - k - 1] : 0.0;
+
+		y = signal[n] * v->in_gain * v->out_gain + (x0 + (x1 - x0) * frac) * v->decay * v->out_gain;
+
+		reference[n] = (y > PCM_MAX) ? PCM_MAX : ((y < PCM_MIN) ? PCM_MIN : y);
+	}
+}
+
+// run the signal through Apply_Chorus with one engine; returns the SNR in dB
+// against the reference
+
+static double run_engine(const voice_t *v, unsigned int engine, double *seconds, double *bus) {
+
+	unsigned int	buf[BLOCK_SIZE];
+	unsigned int	pos, i;
+	hal_io_stats_t	stats;
+	double			start, err = 0.0, sig = 0.0;
+
+	memset(hal_chorusbuffer_bram(), 0, BUFFER_DEPTH * sizeof(u16));
+
+	chorus_start(v->in_gain, v->out_gain, RATE);
+	chorus_add_voice(v->delay, v->decay, v->speed, v->depth, v->modulation);
+	chorus_set_engine(engine);
+
+	*seconds = 0.0;
+	*bus = 0.0;
+
+	for (pos = 0; pos < NUM_LINES; pos += BLOCK_SIZE) {
+
+		for (i = 0; i < BLOCK_SIZE; i++) {
+			buf[i] = PCM_LINE((int) signal[pos + i]);
+		}
+
+		hal_io_clear_stats();
+		start = now_seconds();
+
+		Apply_Chorus(pos & (BUFFER_DEPTH - 1), buf, BLOCK_SIZE);
+
+		*seconds += now_seconds() - start;
+		hal_io_get_stats(&stats);
+		*bus += stats.reads + stats.writes;
+
+		for (i = 0; i < BLOCK_SIZE; i++) {
+			output[pos + i] = PCM_VALUE(buf[i]);
+		}
+	}
+
+	*bus /= NUM_LINES;
+
+	for (i = 0; i < NUM_LINES; i++) {
+		sig += reference[i] * reference[i];
+		err += (output[i] - reference[i]) * (output[i] - reference[i]);
+	}
+
+	return (err > 0.0) ? 10.0 * log10(sig / err) : 200.0;
+}
+
+static FILE *open_vector(const char *prefix, const char *name, const char *ext) {
+
+	char path[4096];
+	FILE *fp;
+
+	snprintf(path, sizeof(path), "%s_%s.%s", prefix, name, ext);
+
+	if ((fp = fopen(path, "w")) == NULL) {
+
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+
+	printf("  %s\n", path);
+
+	return fp;
+}
+
+// vectors for hdl/tb/tb_ChorusBuffer: the default voice, then the same as a
+// triangle, each from line 0 on the history the one before left (the first
+// from a cleared buffer, as the IP comes up); returns the voices below
+// MIN_SNR_DB
+
+static unsigned int write_vectors(const char *prefix) {
+
+	FILE			*bus, *ref, *vh;
+	unsigned int	buf[BLOCK_SIZE];
+	unsigned int	n, pos, i, failed = 0;
+	unsigned long	words;
+	double			err, sig, snr[VECTOR_VOICES];
+	int				r;
+	voice_t			v;
+
+	printf("\nVectors for the chorus testbench, %d lines per voice\n\n", VECTOR_LINES);
+
+	bus = open_vector(prefix, "bus", "mem");
+	ref = open_vector(prefix, "ref", "mem");
+	vh  = open_vector(prefix, "vectors", "vh");
+
+	memset(hal_chorusbuffer_bram(), 0, BUFFER_DEPTH * sizeof(u16));
+
+	for (n = 0; n < VECTOR_VOICES; n++) {
+
+		v.in_gain    = CHORUS_IN_GAIN;
+		v.out_gain   = CHORUS_OUT_GAIN;
+		v.delay      = CHORUS_DELAY_MS;
+		v.decay      = CHORUS_DECAY;
+		v.speed      = CHORUS_SPEED_HZ;
+		v.depth      = CHORUS_DEPTH_MS;
+		v.modulation = (n == 0) ? MOD_SINE : MOD_TRIANGLE;
+
+		make_reference(&v);
+
+		hal_io_set_trace(bus, XPAR_CHORUSBUFFER_0_S00_AXI_BASEADDR, XPAR_CHORUSBUFFER_0_S00_AXI_HIGHADDR);
+
+		chorus_start(v.in_gain, v.out_gain, RATE);
+		chorus_add_voice(v.delay, v.decay, v.speed, v.depth, v.modulation);
+		chorus_set_engine(CHORUS_ENGINE_HARDWARE);
+
+		for (pos = 0; pos < VECTOR_LINES; pos += BLOCK_SIZE) {
+
+			for (i = 0; i < BLOCK_SIZE; i++) {
+				buf[i] = PCM_LINE((int) signal[pos + i]);
+			}
+
+			Apply_Chorus(pos, buf, BLOCK_SIZE);
+
+			for (i = 0; i < BLOCK_SIZE; i++) {
+				output[pos + i] = PCM_VALUE(buf[i]);
+			}
+		}
+
+		hal_io_set_trace(NULL, 0, 0);
+
+		for (pos = 0, sig = err = 0.0; pos < VECTOR_LINES; pos++) {
+
+			r    = (int) lrint(reference[pos]);
+			sig += (double) r * r;
+			err += (output[pos] - r) * (output[pos] - r);
+
+			fprintf(ref, "%04x\n", (u16) r);
+		}
+
+		snr[n]  = (err > 0.0) ? 10.0 * log10(sig / err) : 200.0;
+		failed += (snr[n] < MIN_SNR_DB);
+
+		printf("  voice %u: %s, SNR %6.1f dB against the rounded reference\n", n,
+			(v.modulation == MOD_SINE) ? "sine" : "triangle", snr[n]);
+	}
+
+	// a trace word is 11 digits and a newline
+
+	words = (unsigned long) ftell(bus) / 12;
+
+	fprintf(vh, "// written by host/bench_chorus: the lengths of the vectors, and the SNR in\n");
+	fprintf(vh, "// dB of the model against the rounded reference for each voice\n\n");
+	fprintf(vh, "`define CHORUS_LINES          %d\n", VECTOR_LINES);
+	fprintf(vh, "`define CHORUS_VOICES         %d\n", VECTOR_VOICES);
+	fprintf(vh, "`define CHORUS_BUS_WORDS      %lu\n", words);
+	fprintf(vh, "`define CHORUS_MIN_SNR        %.1f\n", MIN_SNR_DB);
+	fprintf(vh, "`define CHORUS_MODEL_SNR_0    %.4f\n", snr[0]);
+	fprintf(vh, "`define CHORUS_MODEL_SNR_1    %.4f\n", snr[1]);
+
+	fclose(bus);
+	fclose(ref);
+	fclose(vh);
+
+	return failed;
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	unsigned int	spins  = (argc > 1) ? (unsigned int) atoi(argv[1]) : DEFAULT_SPINS;
+	unsigned int	voices = (argc > 2) ? (unsigned int) atoi(argv[2]) : DEFAULT_VOICES;
+	unsigned int	n, failed = 0;
+	double			sw_snr, hw_snr, sw_seconds, hw_seconds, sw_bus, hw_bus;
+	voice_t			v;
+
+	hal_chorusbuffer_init();
+
+	if (ChorusBuffer_initialize(XPAR_CHORUSBUFFER_0_S00_AXI_BASEADDR) != XST_SUCCESS) {
+
+		fprintf(stderr, "driver self-test failed\n");
+		return EXIT_FAILURE;
+	}
+
+	hal_io_set_latency(spins);
+	make_signal();
+
+	printf("\nChorus engines vs. a continuous-delay sox chorus, %d lines per voice, %u spins/access\n\n",
+		NUM_LINES, spins);
+
+	// voice 0 is the application default, 1 the same as a triangle, the rest
+	// random (the table pool limits the period to CHORUS_TAB_POOL samples)
+
+	for (n = 0; n < voices; n++) {
+
+		if (n < 2) {
+
+			v.in_gain    = CHORUS_IN_GAIN;
+			v.out_gain   = CHORUS_OUT_GAIN;
+			v.delay      = CHORUS_DELAY_MS;
+			v.decay      = CHORUS_DECAY;
+			v.speed      = CHORUS_SPEED_HZ;
+			v.depth      = CHORUS_DEPTH_MS;
+			v.modulation = (n == 0) ? MOD_SINE : MOD_TRIANGLE;
+		}
+
+		else {
+
+			v.in_gain    = rng_range(0.4f, 1.0f);
+			v.out_gain   = rng_range(0.5f, 1.0f);
+			v.delay      = rng_range(20.0f, 100.0f);
+			v.decay      = rng_range(0.2f, 0.9f);
+			v.speed      = rng_range((float) RATE / CHORUS_TAB_POOL + 0.01f, 5.0f);
+			v.depth      = rng_range(0.0f, 10.0f);
+			v.modulation = (rng_next() & 1) ? MOD_TRIANGLE : MOD_SINE;
+		}
+
+		make_reference(&v);
+
+		sw_snr = run_engine(&v, CHORUS_ENGINE_SOFTWARE, &sw_seconds, &sw_bus);
+		hw_snr = run_engine(&v, CHORUS_ENGINE_HARDWARE, &hw_seconds, &hw_bus);
+
+		failed += (hw_snr < MIN_SNR_DB);
+
+		printf("  voice %u: %s, %.1f ms + %.1f ms at %.2f Hz, gains %.2f / %.2f / %.2f: %s\n", n,
+			(v.modulation == MOD_SINE) ? "sine" : "triangle", v.delay, v.depth, v.speed,
+			v.in_gain, v.decay, v.out_gain, (hw_snr < MIN_SNR_DB) ? "FAIL" : "pass");
+
+		printf("    software %12.0f samples/s  %5.2f bus transactions/sample  SNR %6.1f dB\n",
+			NUM_LINES / sw_seconds, sw_bus, sw_snr);
+
+		printf("    hardware %12.0f samples/s  %5.2f bus transactions/sample  SNR %6.1f dB\n",
+			NUM_LINES / hw_seconds, hw_bus, hw_snr);
+	}
+
+	if (argc > 3) {
+		failed += write_vectors(argv[3]);
+	}
+
+	printf("\n");
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,310 @@
+/**
+*
+* @file bench_drivers.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host benchmark for the custom IP driver paths. Each test sweeps all 65536
+* lines of a buffer with the per-sample call and with the block call, then
+* reports samples per second and bus transactions per sample for both.
+*
+*	InputBuffer:	ReadLine  vs. ReadBlock
+*	ChorusBuffer:	ReadLine  vs. ReadBlock
+*	ChorusBuffer:	WriteLine vs. WriteStream
+*	DelayBuffer:	WriteLine vs. WriteStream
+*	ChorusBuffer:	3 x ReadLine vs. ReadTaps (delay taps at N/8, N/4, N/3)
+*
+* Usage:
+*	bench_drivers [latency_spins] [block_size]
+*
+* latency_spins is the busy-wait added to every Xil_In32 / Xil_Out32 call to
+* stand in for the AXI4-Lite round trip (default 200).
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "xparameters.h"
+#include "hal.h"
+#include "InputBuffer.h"
+#include "ChorusBuffer.h"
+#include "DelayBuffer.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define BUFFER_DEPTH		65536
+#define NUM_PASSES			8
+#define DEFAULT_SPINS		200
+#define DEFAULT_BLOCK		64
+#define MAX_BLOCK			4096
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static unsigned int		block[MAX_BLOCK];
+static unsigned int		block_size;
+static double			start_time;
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench_start(void) {
+
+	hal_io_clear_stats();
+	start_time = now_seconds();
+}
+
+static double bench_stop(const char *name, unsigned long checksum) {
+
+	hal_io_stats_t	stats;
+	double			seconds = now_seconds() - start_time;
+	double			samples = (double) BUFFER_DEPTH * NUM_PASSES;
+
+	hal_io_get_stats(&stats);
+
+	printf("  %-12s %12.0f samples/s   %5.2f bus transactions/sample   (checksum %08lx)\n",
+		name, samples / seconds, (stats.reads + stats.writes) / samples, checksum);
+
+	return seconds;
+}
+
+static unsigned long bram_checksum(const u16 *bram) {
+
+	unsigned long	sum = 0;
+	unsigned int	i;
+
+	for (i = 0; i < BUFFER_DEPTH; i++) {
+		sum += bram[i] * (i + 1ul);
+	}
+
+	return sum;
+}
+
+/****************************************************************************/
+/************************** Block Reads *************************************/
+/****************************************************************************/
+
+static void bench_reads(const char *name, u16 *bram,
+		unsigned int (*read_line)(unsigned int),
+		void (*read_block)(unsigned int, unsigned int, unsigned int *)) {
+
+	unsigned int	pass, bufline, i;
+	unsigned long	checksum;
+	double			line_time, block_time;
+
+	for (i = 0; i < BUFFER_DEPTH; i++) {
+		bram[i] = (u16) (i * 40503u);
+	}
+
+	printf("%s\n", name);
+
+	// one untimed sweep so the timed paths start from a warm cache & clock
+
+	for (bufline = 0; bufline < BUFFER_DEPTH; bufline++) {
+		read_line(bufline);
+	}
+
+	// per-sample path: address write + data read for every line
+
+	checksum = 0;
+	bench_start();
+
+	for (pass = 0; pass < NUM_PASSES; pass++) {
+
+		for (bufline = 0; bufline < BUFFER_DEPTH; bufline++) {
+			checksum += read_line(bufline);
+		}
+	}
+
+	line_time = bench_stop("ReadLine", checksum);
+
+	// block path: one address write per block + one data read per line
+
+	checksum = 0;
+	bench_start();
+
+	for (pass = 0; pass < NUM_PASSES; pass++) {
+
+		for (bufline = 0; bufline < BUFFER_DEPTH; bufline += block_size) {
+
+			read_block(bufline, block_size, block);
+
+			for (i = 0; i < block_size; i++) {
+				checksum += block[i];
+			}
+		}
+	}
+
+	block_time = bench_stop("ReadBlock", checksum);
+
+	printf("  speedup: %.2fx\n\n", line_time / block_time);
+}
+
+/****************************************************************************/
+/************************** Chorus & Delay Buffers **************************/
+/****************************************************************************/
+
+static void bench_writes(const char *name, u16 *bram,
+		void (*write_line)(unsigned int, unsigned int),
+		void (*write_stream)(unsigned int, unsigned int, const unsigned int *)) {
+
+	unsigned int	pass, bufline, i;
+	double			line_time, stream_time;
+
+	printf("%s\n", name);
+
+	// per-sample path: address, data, write enable high, write enable low
+
+	bench_start();
+
+	for (pass = 0; pass < NUM_PASSES; pass++) {
+
+		for (bufline = 0; bufline < BUFFER_DEPTH; bufline++) {
+			write_line(bufline, (bufline * 40503u + pass) & 0xFFFF);
+		}
+	}
+
+	line_time = bench_stop("WriteLine", bram_checksum(bram));
+
+	// streaming path: one data write per line
+
+	bench_start();
+
+	for (pass = 0; pass < NUM_PASSES; pass++) {
+
+		for (bufline = 0; bufline < BUFFER_DEPTH; bufline += block_size) {
+
+			for (i = 0; i < block_size; i++) {
+				block[i] = ((bufline + i) * 40503u + pass) & 0xFFFF;
+			}
+
+			write_stream(bufline, block_size, block);
+		}
+	}
+
+	stream_time = bench_stop("WriteStream", bram_checksum(bram));
+
+	printf("  speedup: %.2fx\n\n", line_time / stream_time);
+}
+
+/****************************************************************************/
+/************************** ChorusBuffer taps *******************************/
+/****************************************************************************/
+
+static void bench_taps(void) {
+
+	static const unsigned int offsets[CHORUSBUFFER_NUM_TAPS] = {
+
+		BUFFER_DEPTH / 8, BUFFER_DEPTH / 4, BUFFER_DEPTH / 3
+	};
+
+	unsigned int	taps[CHORUSBUFFER_NUM_TAPS];
+	unsigned int	pass, bufline, tap;
+	unsigned long	checksum;
+	double			line_time, tap_time;
+
+	printf("ChorusBuffer delay taps\n");
+
+	for (tap = 0; tap < CHORUSBUFFER_NUM_TAPS; tap++) {
+		ChorusBuffer_SetTapOffset(tap, offsets[tap]);
+	}
+
+	// per-tap path: address write + data read for every tap
+
+	checksum = 0;
+	bench_start();
+
+	for (pass = 0; pass < NUM_PASSES; pass++) {
+
+		for (bufline = 0; bufline < BUFFER_DEPTH; bufline++) {
+
+			for (tap = 0; tap < CHORUSBUFFER_NUM_TAPS; tap++) {
+				checksum += ChorusBuffer_ReadLine((bufline - offsets[tap]) & 0xFFFF) * (tap + 1);
+			}
+		}
+	}
+
+	line_time = bench_stop("ReadLine x3", checksum);
+
+	// multi-tap path: one base write + one read per tap
+
+	checksum = 0;
+	bench_start();
+
+	for (pass = 0; pass < NUM_PASSES; pass++) {
+
+		for (bufline = 0; bufline < BUFFER_DEPTH; bufline++) {
+
+			ChorusBuffer_ReadTaps(bufline, taps);
+
+			for (tap = 0; tap < CHORUSBUFFER_NUM_TAPS; tap++) {
+				checksum += taps[tap] * (tap + 1);
+			}
+		}
+	}
+
+	tap_time = bench_stop("ReadTaps", checksum);
+
+	printf("  speedup: %.2fx\n\n", line_time / tap_time);
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	unsigned int spins = (argc > 1) ? (unsigned int) atoi(argv[1]) : DEFAULT_SPINS;
+
+	block_size = (argc > 2) ? (unsigned int) atoi(argv[2]) : DEFAULT_BLOCK;
+
+	if ((block_size == 0) || (block_size > MAX_BLOCK) || (BUFFER_DEPTH % block_size)) {
+
+		fprintf(stderr, "block_size must divide %d and be at most %d\n", BUFFER_DEPTH, MAX_BLOCK);
+		return EXIT_FAILURE;
+	}
+
+	// bring up the models and the drivers (each runs its register self-test)
+
+	hal_inputbuffer_init();
+	hal_chorusbuffer_init();
+	hal_delaybuffer_init();
+
+	if ((InputBuffer_initialize(XPAR_INPUTBUFFER_0_S00_AXI_BASEADDR) != XST_SUCCESS) ||
+		(ChorusBuffer_initialize(XPAR_CHORUSBUFFER_0_S00_AXI_BASEADDR) != XST_SUCCESS) ||
+		(DelayBuffer_initialize(XPAR_DELAYBUFFER_0_S00_AXI_BASEADDR) != XST_SUCCESS)) {
+
+		fprintf(stderr, "driver self-test failed\n");
+		return EXIT_FAILURE;
+	}
+
+	hal_io_set_latency(spins);
+
+	printf("\n%d lines x %d passes, %u spins/access, block of %u\n\n",
+		BUFFER_DEPTH, NUM_PASSES, spins, block_size);
+
+	bench_reads("InputBuffer", hal_inputbuffer_bram(), InputBuffer_ReadLine, InputBuffer_ReadBlock);
+	bench_reads("ChorusBuffer", hal_chorusbuffer_bram(), ChorusBuffer_ReadLine, ChorusBuffer_ReadBlock);
+	bench_writes("ChorusBuffer", hal_chorusbuffer_bram(), ChorusBuffer_WriteLine, ChorusBuffer_WriteStream);
+	bench_writes("DelayBuffer", hal_delaybuffer_bram(), DelayBuffer_WriteLine, DelayBuffer_WriteStream);
+	bench_taps();
+
+	return EXIT_SUCCESS;
+}
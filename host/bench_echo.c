@@ -0,0 +1,455 @@
+/**
+*
+* @file bench_echo.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host check & benchmark for the echo engine in the DelayBuffer IP. The same
+* test signal goes through both delay paths, block by block:
+*
+*	o software: delay_line_mix() over a delay line in the upper half of the
+*	  ChorusBuffer, then delay_line_write() and DelayBuffer_WriteStream(),
+*	  exactly as process_block() did before the engine
+*	o hardware: DelayBuffer_WriteStream() of the pre-delay signal only; each
+*	  line is then played through hal_delaybuffer_echo(), the bit-exact model
+*	  of what the engine puts on doutb
+*
+* Every played sample has to match the software one exactly, for the default
+* taps and for random tap sets with gains above 1.0 (so the saturation is
+* exercised too). The bus transactions per sample of both paths show how
+* much of the bus the engine gives back to the CPU.
+*
+* With a vector prefix it also writes, for hdl/tb/tb_DelayBuffer, a periodic
+* DelayBuffer image and what delay_line_mix() makes of it (the second time
+* round, so every tap reads the past) for two tap sets: the default taps, and
+* ECHO_TAPS random ones loud enough to saturate. The same lines through the
+* engine model have to agree:
+*
+*	o <prefix>_buf.mem		the pre-delay image, one line per word (hex)
+*	o <prefix>_taps.mem		the tap words (gain << 16 | delay) of both
+*							sets, DELAYBUFFER_ECHO_TAPS each (hex)
+*	o <prefix>_out_a.mem	the mix of every line with the first set (hex)
+*	o <prefix>_out_b.mem	the same with the second
+*	o <prefix>_vectors.vh	the number of taps in each set, as `defines
+*
+* Usage:
+*	bench_echo [latency_spins] [tap_sets] [vector_prefix]
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "xparameters.h"
+#include "hal.h"
+#include "ChorusBuffer.h"
+#include "DelayBuffer.h"
+#include "delay_line.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define BUFFER_DEPTH		65536
+#define BLOCK_SIZE			64
+#define LINE_BASE			32768
+#define LINE_DEPTH			32768
+#define NUM_LINES			(4 * BUFFER_DEPTH)
+#define DEFAULT_SPINS		200
+#define DEFAULT_TAP_SETS	8
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static u32 rng_state = 0x1234567;
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static u32 rng_next(void) {
+
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return rng_state >> 8;
+}
+
+// noise plus a tone that swings from quiet to full scale and back
+
+static unsigned int test_sample(unsigned int n) {
+
+	double	level = 0.5 - 0.5 * cos(2.0 * M_PI * n / 40000.0);
+	int		x = (int) (30000.0 * level * sin(2.0 * M_PI * 440.0 * n / 16000.0));
+
+	x += (int) (rng_next() & 0x7FF) - 0x400;
+
+	return PCM_LINE(x);
+}
+
+// run both paths over NUM_LINES lines; returns the number of mismatches
+
+static unsigned long run_paths(const delay_line_t *dl, double *sw_seconds, double *hw_seconds,
+							   double *sw_bus, double *hw_bus) {
+
+	unsigned int	in[BLOCK_SIZE], out[BLOCK_SIZE];
+	unsigned int	signal[BLOCK_SIZE];
+	unsigned int	pos, i;
+	unsigned long	mismatches = 0;
+	hal_io_stats_t	stats;
+	double			start;
+	u16				hw;
+
+	memset(hal_chorusbuffer_bram(), 0, BUFFER_DEPTH * sizeof(u16));
+	memset(hal_delaybuffer_bram(), 0, BUFFER_DEPTH * sizeof(u16));
+
+	*sw_seconds = *hw_seconds = 0.0;
+	*sw_bus = *hw_bus = 0.0;
+
+	for (pos = 0; pos < NUM_LINES; pos += BLOCK_SIZE) {
+
+		for (i = 0; i < BLOCK_SIZE; i++) {
+			signal[i] = test_sample(pos + i);
+		}
+
+		// software: mix, keep the pre-delay history, write the output
+
+		memcpy(in, signal, sizeof(in));
+		memcpy(out, signal, sizeof(out));
+
+		hal_io_clear_stats();
+		start = now_seconds();
+
+		delay_line_mix(dl, pos, BLOCK_SIZE, out);
+		delay_line_write(dl, pos, BLOCK_SIZE, in);
+		DelayBuffer_WriteStream(pos & (BUFFER_DEPTH - 1), BLOCK_SIZE, out);
+
+		*sw_seconds += now_seconds() - start;
+		hal_io_get_stats(&stats);
+		*sw_bus += stats.reads + stats.writes;
+
+		// hardware: write the pre-delay signal, the engine mixes on playback
+
+		hal_io_clear_stats();
+		start = now_seconds();
+
+		DelayBuffer_WriteStream(pos & (BUFFER_DEPTH - 1), BLOCK_SIZE, in);
+
+		*hw_seconds += now_seconds() - start;
+		hal_io_get_stats(&stats);
+		*hw_bus += stats.reads + stats.writes;
+
+		for (i = 0; i < BLOCK_SIZE; i++) {
+
+			hw = hal_delaybuffer_echo((u16) (pos + i));
+
+			if (hw != (u16) out[i]) {
+
+				if (mismatches < 8) {
+					printf("    line %u: software %6d, engine %6d\n", pos + i,
+						PCM_VALUE(out[i]), PCM_VALUE(hw));
+				}
+
+				mismatches++;
+			}
+		}
+	}
+
+	*sw_bus /= NUM_LINES;
+	*hw_bus /= NUM_LINES;
+
+	return mismatches;
+}
+
+static FILE *open_vector(const char *prefix, const char *name, const char *ext) {
+
+	char path[4096];
+	FILE *fp;
+
+	snprintf(path, sizeof(path), "%s_%s.%s", prefix, name, ext);
+
+	if ((fp = fopen(path, "w")) == NULL) {
+
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+
+	printf("  %s\n", path);
+
+	return fp;
+}
+
+// the image played round twice through delay_line_mix() with the taps in
+// dl, keeping the second round; returns the mismatches with the engine model
+
+static unsigned long mix_image(delay_line_t *dl, const u16 *image, u16 *out) {
+
+	unsigned int	in[BLOCK_SIZE], acc[BLOCK_SIZE];
+	unsigned int	pos, i, tap;
+	unsigned long	mismatches = 0;
+
+	memset(hal_chorusbuffer_bram(), 0, BUFFER_DEPTH * sizeof(u16));
+
+	for (pos = 0; pos < 2 * BUFFER_DEPTH; pos += BLOCK_SIZE) {
+
+		for (i = 0; i < BLOCK_SIZE; i++) {
+			in[i] = acc[i] = image[(pos + i) & (BUFFER_DEPTH - 1)];
+		}
+
+		delay_line_mix(dl, pos, BLOCK_SIZE, acc);
+		delay_line_write(dl, pos, BLOCK_SIZE, in);
+
+		for (i = 0; (pos >= BUFFER_DEPTH) && (i < BLOCK_SIZE); i++) {
+			out[(pos + i) & (BUFFER_DEPTH - 1)] = (u16) acc[i];
+		}
+	}
+
+	// and the engine model on the same image
+
+	for (tap = 0; tap < dl->num_taps; tap++) {
+		DelayBuffer_SetEchoTap(tap, dl->tap[tap].delay, dl->tap[tap].gain);
+	}
+
+	DelayBuffer_SetEcho(dl->num_taps, true);
+
+	for (pos = 0; pos < BUFFER_DEPTH; pos++) {
+		mismatches += (hal_delaybuffer_echo((u16) pos) != out[pos]);
+	}
+
+	return mismatches;
+}
+
+static void write_taps(FILE *fp, const delay_line_t *dl) {
+
+	unsigned int tap;
+
+	for (tap = 0; tap < DELAYBUFFER_ECHO_TAPS; tap++) {
+
+		if (tap < dl->num_taps) {
+			fprintf(fp, "%04x%04x\n", dl->tap[tap].gain, dl->tap[tap].delay);
+		}
+
+		else {
+			fprintf(fp, "00000000\n");
+		}
+	}
+}
+
+// vectors for hdl/tb/tb_DelayBuffer; returns the mismatches with the model
+
+static unsigned long write_vectors(const char *prefix) {
+
+	FILE			*buf, *taps, *out_a, *out_b, *vh;
+	delay_line_t	dl[2];
+	u16				*image, *out[2];
+	unsigned int	set, tap, pos, saturated[2] = { 0, 0 };
+	unsigned long	mismatches = 0;
+
+	printf("\nVectors for the echo engine testbench, %d lines\n\n", BUFFER_DEPTH);
+
+	buf   = open_vector(prefix, "buf", "mem");
+	taps  = open_vector(prefix, "taps", "mem");
+	out_a = open_vector(prefix, "out_a", "mem");
+	out_b = open_vector(prefix, "out_b", "mem");
+	vh    = open_vector(prefix, "vectors", "vh");
+
+	image  = malloc(BUFFER_DEPTH * sizeof(u16));
+	out[0] = malloc(BUFFER_DEPTH * sizeof(u16));
+	out[1] = malloc(BUFFER_DEPTH * sizeof(u16));
+
+	if ((image == NULL) || (out[0] == NULL) || (out[1] == NULL)) {
+
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// the image goes into the DelayBuffer as the software would write it
+
+	for (pos = 0; pos < BUFFER_DEPTH; pos++) {
+		image[pos] = (u16) test_sample(pos);
+	}
+
+	for (pos = 0; pos < BUFFER_DEPTH; pos += BLOCK_SIZE) {
+
+		unsigned int lines[BLOCK_SIZE], i;
+
+		for (i = 0; i < BLOCK_SIZE; i++) {
+			lines[i] = image[pos + i];
+		}
+
+		DelayBuffer_WriteStream(pos, BLOCK_SIZE, lines);
+	}
+
+	// the default taps, then every tap with up to 2.0 of gain
+
+	for (set = 0; set < 2; set++) {
+
+		delay_line_init(&dl[set], ChorusBuffer_ReadBlock, ChorusBuffer_WriteStream,
+						LINE_BASE, LINE_DEPTH, BLOCK_SIZE);
+
+		if (set == 0) {
+
+			delay_line_set_tap(&dl[set], 0, BUFFER_DEPTH / 8, Q15_GAIN(1.0 / 1.25));
+			delay_line_set_tap(&dl[set], 1, BUFFER_DEPTH / 4, Q15_GAIN(1.0 / 1.66));
+			delay_line_set_tap(&dl[set], 2, BUFFER_DEPTH / 3, Q15_GAIN(1.0 / 2.25));
+			delay_line_set_num_taps(&dl[set], 3);
+		}
+
+		else {
+
+			for (tap = 0; tap < DELAYBUFFER_ECHO_TAPS; tap++) {
+				delay_line_set_tap(&dl[set], tap, rng_next() % LINE_DEPTH, rng_next() & Q15_GAIN_MAX);
+			}
+
+			delay_line_set_num_taps(&dl[set], DELAYBUFFER_ECHO_TAPS);
+		}
+
+		mismatches += mix_image(&dl[set], image, out[set]);
+
+		for (pos = 0; pos < BUFFER_DEPTH; pos++) {
+			saturated[set] += (out[set][pos] == 0x7FFF) || (out[set][pos] == 0x8000);
+		}
+
+		write_taps(taps, &dl[set]);
+	}
+
+	for (pos = 0; pos < BUFFER_DEPTH; pos++) {
+
+		fprintf(buf, "%04x\n", image[pos]);
+		fprintf(out_a, "%04x\n", out[0][pos]);
+		fprintf(out_b, "%04x\n", out[1][pos]);
+	}
+
+	fprintf(vh, "// written by host/bench_echo: the number of taps in each set, and the\n");
+	fprintf(vh, "// lines delay_line_mix() saturates with them\n\n");
+	fprintf(vh, "`define ECHO_LINES            %d\n", BUFFER_DEPTH);
+	fprintf(vh, "`define ECHO_TAPS_A           %u\n", dl[0].num_taps);
+	fprintf(vh, "`define ECHO_TAPS_B           %u\n", dl[1].num_taps);
+	fprintf(vh, "`define ECHO_SATURATED_A      %u\n", saturated[0]);
+	fprintf(vh, "`define ECHO_SATURATED_B      %u\n", saturated[1]);
+
+	printf("\n  %u and %u taps, %u and %u lines saturated, engine model: %s\n", dl[0].num_taps,
+		dl[1].num_taps, saturated[0], saturated[1], mismatches ? "FAIL" : "bit-exact");
+
+	fclose(buf);
+	fclose(taps);
+	fclose(out_a);
+	fclose(out_b);
+	fclose(vh);
+
+	free(image);
+	free(out[0]);
+	free(out[1]);
+
+	return mismatches;
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	unsigned int	spins = (argc > 1) ? (unsigned int) atoi(argv[1]) : DEFAULT_SPINS;
+	unsigned int	sets  = (argc > 2) ? (unsigned int) atoi(argv[2]) : DEFAULT_TAP_SETS;
+	unsigned int	set, tap, num_taps;
+	unsigned long	mismatches, failed = 0;
+	double			sw_seconds, hw_seconds, sw_bus, hw_bus;
+	delay_line_t	dl;
+
+	hal_chorusbuffer_init();
+	hal_delaybuffer_init();
+
+	if ((ChorusBuffer_initialize(XPAR_CHORUSBUFFER_0_S00_AXI_BASEADDR) != XST_SUCCESS) ||
+		(DelayBuffer_initialize(XPAR_DELAYBUFFER_0_S00_AXI_BASEADDR) != XST_SUCCESS)) {
+
+		fprintf(stderr, "driver self-test failed\n");
+		return EXIT_FAILURE;
+	}
+
+	hal_io_set_latency(spins);
+
+	printf("\nDelayBuffer echo engine vs. delay_line_mix, %d lines per tap set, %u spins/access\n\n",
+		NUM_LINES, spins);
+
+	// set 0 is the application default, the rest are random
+
+	for (set = 0; set <= sets; set++) {
+
+		delay_line_init(&dl, ChorusBuffer_ReadBlock, ChorusBuffer_WriteStream,
+						LINE_BASE, LINE_DEPTH, BLOCK_SIZE);
+
+		if (set == 0) {
+
+			num_taps = 3;
+
+			delay_line_set_tap(&dl, 0, BUFFER_DEPTH / 8, Q15_GAIN(1.0 / 1.25));
+			delay_line_set_tap(&dl, 1, BUFFER_DEPTH / 4, Q15_GAIN(1.0 / 1.66));
+			delay_line_set_tap(&dl, 2, BUFFER_DEPTH / 3, Q15_GAIN(1.0 / 2.25));
+		}
+
+		else {
+
+			num_taps = 1 + rng_next() % DELAYBUFFER_ECHO_TAPS;
+
+			for (tap = 0; tap < num_taps; tap++) {
+				delay_line_set_tap(&dl, tap, rng_next() % LINE_DEPTH, rng_next() & Q15_GAIN_MAX);
+			}
+		}
+
+		delay_line_set_num_taps(&dl, num_taps);
+
+		// the engine gets the taps as clamped by the delay line
+
+		for (tap = 0; tap < num_taps; tap++) {
+			DelayBuffer_SetEchoTap(tap, dl.tap[tap].delay, dl.tap[tap].gain);
+		}
+
+		DelayBuffer_SetEcho(num_taps, true);
+
+		mismatches = run_paths(&dl, &sw_seconds, &hw_seconds, &sw_bus, &hw_bus);
+		failed += (mismatches != 0);
+
+		printf("  set %u, %u taps: %s (%lu mismatches)\n", set, num_taps,
+			mismatches ? "FAIL" : "bit-exact", mismatches);
+
+		printf("    software %12.0f samples/s  %5.2f bus transactions/sample\n",
+			NUM_LINES / sw_seconds, sw_bus);
+
+		printf("    engine   %12.0f samples/s  %5.2f bus transactions/sample\n",
+			NUM_LINES / hw_seconds, hw_bus);
+	}
+
+	// and with the engine off, the lines play unchanged
+
+	DelayBuffer_SetEcho(num_taps, false);
+
+	for (mismatches = 0, tap = 0; tap < BUFFER_DEPTH; tap++) {
+		mismatches += (hal_delaybuffer_echo((u16) tap) != hal_delaybuffer_bram()[tap]);
+	}
+
+	failed += (mismatches != 0);
+
+	printf("\n  engine off: %s\n", mismatches ? "FAIL" : "pass-through");
+
+	if (argc > 3) {
+		failed += (write_vectors(argv[3]) != 0);
+	}
+
+	printf("\n");
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,355 @@
+/**
+*
+* @file bench_fft.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host benchmark for the shared FFT engine (software/fft.c). For every size
+* from 64 to 4096 points it times, in ns per transform:
+*
+*	o a plain DFT, n^2 multiply-adds off a table of the n twiddles
+*	o the float FFT with the C butterflies and with the SSE2 ones; the two
+*	  outputs have to match bit for bit
+*	o the Q15 FFT, the one the MicroBlaze runs (here as host C)
+*	o the real-input FFTs, float (SSE2) and Q15
+*
+* Each FFT time includes copying the input back in, as the transforms run in
+* place. Then the signal to noise of each transform's bins against a double
+* precision DFT of the same (16-bit) input, and the worst error, in LSBs,
+* of a Q15 real forward & inverse round trip.
+*
+* Usage:
+*	bench_fft [milliseconds per timing]
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "xil_types.h"
+#include "delay_line.h"
+#include "fft.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define DEFAULT_MS			100
+#define REPEATS				3
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+// one transform under test, on the bench's buffers
+
+typedef void (*run_t)(unsigned int n);
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static u32				rng_state = 0x1234567;
+
+static fft_cpx_q15_t	in_q15[FFT_MAX_SIZE], buf_q15[FFT_MAX_SIZE];
+static fft_cpx_t		in_float[FFT_MAX_SIZE], buf_float[FFT_MAX_SIZE], dft_out[FFT_MAX_SIZE];
+static fft_cpx_t		dft_table[FFT_MAX_SIZE];
+static s16				real_q15[FFT_MAX_SIZE + 2];
+static float			real_float[FFT_MAX_SIZE + 2];
+static double			ref_re[FFT_MAX_SIZE], ref_im[FFT_MAX_SIZE];
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static u32 rng_next(void) {
+
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return rng_state >> 8;
+}
+
+// the transforms under test, each on a fresh copy of the input
+
+static void run_dft(unsigned int n) {
+
+	unsigned int	k, m;
+	float			re, im;
+
+	for (k = 0; k < n; k++) {
+
+		re = im = 0.0f;
+
+		for (m = 0; m < n; m++) {
+
+			const fft_cpx_t *w = &dft_table[(k * m) & (n - 1)];
+
+			re += in_float[m].re * w->re - in_float[m].im * w->im;
+			im += in_float[m].re * w->im + in_float[m].im * w->re;
+		}
+
+		dft_out[k].re = re;
+		dft_out[k].im = im;
+	}
+}
+
+static void run_float_c(unsigned int n) {
+
+	memcpy(buf_float, in_float, n * sizeof(fft_cpx_t));
+	fft_float(buf_float, n, FFT_FORWARD | FFT_NO_SIMD);
+}
+
+static void run_float_simd(unsigned int n) {
+
+	memcpy(buf_float, in_float, n * sizeof(fft_cpx_t));
+	fft_float(buf_float, n, FFT_FORWARD);
+}
+
+static void run_q15(unsigned int n) {
+
+	memcpy(buf_q15, in_q15, n * sizeof(fft_cpx_q15_t));
+	fft_q15(buf_q15, n, FFT_FORWARD);
+}
+
+// the real transforms take the real parts of the complex input
+
+static void run_real_float(unsigned int n) {
+
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		real_float[i] = in_float[i].re;
+	}
+
+	fft_real_float(real_float, n, FFT_FORWARD);
+}
+
+static void run_real_q15(unsigned int n) {
+
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		real_q15[i] = in_q15[i].re;
+	}
+
+	fft_real_q15(real_q15, n, FFT_FORWARD);
+}
+
+// ns per run, the best of REPEATS timings of about ms each
+
+static double time_run(run_t run, unsigned int n, unsigned int ms) {
+
+	unsigned int	count = 1, rep, i;
+	double			start, seconds, best = 1e30;
+
+	// enough runs for the time asked
+
+	do {
+
+		count *= 2;
+		start  = now_seconds();
+
+		for (i = 0; i < count; i++) {
+			run(n);
+		}
+
+		seconds = now_seconds() - start;
+
+	} while (seconds < ms * 1e-3 / 4);
+
+	count = (unsigned int) ceil(count * ms * 1e-3 / seconds);
+
+	for (rep = 0; rep < REPEATS; rep++) {
+
+		start = now_seconds();
+
+		for (i = 0; i < count; i++) {
+			run(n);
+		}
+
+		best = MIN(best, (now_seconds() - start) / count);
+	}
+
+	return best * 1e9;
+}
+
+// the double precision DFT of the input (in LSBs), all of it or the real
+// parts only
+
+static void reference(unsigned int n, int real) {
+
+	static double	c[FFT_MAX_SIZE], s[FFT_MAX_SIZE];
+	unsigned int	k, m;
+	double			re, im, xr, xi;
+
+	for (k = 0; k < n; k++) {
+
+		c[k] = cos(2.0 * M_PI * k / n);
+		s[k] = -sin(2.0 * M_PI * k / n);
+	}
+
+	for (k = 0; k < n; k++) {
+
+		re = im = 0.0;
+
+		for (m = 0; m < n; m++) {
+
+			xr = in_q15[m].re;
+			xi = real ? 0.0 : in_q15[m].im;
+
+			re += xr * c[(k * m) & (n - 1)] - xi * s[(k * m) & (n - 1)];
+			im += xr * s[(k * m) & (n - 1)] + xi * c[(k * m) & (n - 1)];
+		}
+
+		ref_re[k] = re;
+		ref_im[k] = im;
+	}
+}
+
+// signal to noise of bins 0 to count - 1 (interleaved re, im) against the
+// reference, scaled by scale, in dB
+
+static double snr_float(const float *bins, unsigned int count, double scale) {
+
+	double			signal = 0.0, noise = 0.0, er, ei;
+	unsigned int	k;
+
+	for (k = 0; k < count; k++) {
+
+		er      = bins[2 * k] * scale - ref_re[k];
+		ei      = bins[2 * k + 1] * scale - ref_im[k];
+		signal += ref_re[k] * ref_re[k] + ref_im[k] * ref_im[k];
+		noise  += er * er + ei * ei;
+	}
+
+	return 10.0 * log10(signal / MAX(noise, 1e-30));
+}
+
+static double snr_q15(const s16 *bins, unsigned int count, double scale) {
+
+	double			signal = 0.0, noise = 0.0, er, ei;
+	unsigned int	k;
+
+	for (k = 0; k < count; k++) {
+
+		er      = bins[2 * k] * scale - ref_re[k];
+		ei      = bins[2 * k + 1] * scale - ref_im[k];
+		signal += ref_re[k] * ref_re[k] + ref_im[k] * ref_im[k];
+		noise  += er * er + ei * ei;
+	}
+
+	return 10.0 * log10(signal / MAX(noise, 1e-30));
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	unsigned int	ms = (argc > 1) ? (unsigned int) atoi(argv[1]) : DEFAULT_MS;
+	unsigned int	n, i, failed = 0;
+	double			t_dft, t_c, t_simd, t_q15, t_rf, t_rq;
+	double			snr_f, snr_q, snr_rf, snr_rq;
+	int				err, worst;
+	s16				orig[FFT_MAX_SIZE];
+	int				same;
+
+	if (ms == 0) {
+		ms = DEFAULT_MS;
+	}
+
+	fft_init();
+
+	// noise at about -12 dBFS, the same 16-bit values in both variants
+
+	for (i = 0; i < FFT_MAX_SIZE; i++) {
+
+		in_q15[i].re   = (s16) ((int) (rng_next() & 0x3FFF) - 0x2000);
+		in_q15[i].im   = (s16) ((int) (rng_next() & 0x3FFF) - 0x2000);
+		in_float[i].re = in_q15[i].re / 32768.0f;
+		in_float[i].im = in_q15[i].im / 32768.0f;
+	}
+
+	printf("\nFFT engine, ns per transform (best of %d, ~%u ms each), SIMD %s\n\n", REPEATS, ms,
+		FFT_HAVE_SIMD ? "SSE2" : "none");
+
+	printf("  %5s %11s %9s %10s %9s %10s %9s %7s   %-32s %s\n", "size", "DFT", "float C", "float SIMD",
+		"Q15", "real float", "real Q15", "vs DFT", "SNR: float, Q15, real float & Q15", "round trip");
+
+	for (n = FFT_MIN_SIZE; n <= FFT_MAX_SIZE; n *= 2) {
+
+		for (i = 0; i < n; i++) {
+
+			dft_table[i].re = (float) cos(2.0 * M_PI * i / n);
+			dft_table[i].im = (float) -sin(2.0 * M_PI * i / n);
+		}
+
+		t_dft  = time_run(run_dft, n, ms);
+		t_c    = time_run(run_float_c, n, ms);
+		t_simd = time_run(run_float_simd, n, ms);
+		t_q15  = time_run(run_q15, n, ms);
+		t_rf   = time_run(run_real_float, n, ms);
+		t_rq   = time_run(run_real_q15, n, ms);
+
+		// C & SSE2 butterflies, bit for bit
+
+		run_float_c(n);
+		memcpy(dft_out, buf_float, n * sizeof(fft_cpx_t));
+		run_float_simd(n);
+
+		same    = !memcmp(dft_out, buf_float, n * sizeof(fft_cpx_t));
+		failed += !same;
+
+		// against double precision: the complex transforms, then the real
+
+		reference(n, 0);
+		snr_f = snr_float((const float *) buf_float, n, 32768.0);
+
+		run_q15(n);
+		snr_q = snr_q15((const s16 *) buf_q15, n, n);
+
+		reference(n, 1);
+
+		run_real_float(n);
+		snr_rf = snr_float(real_float, n / 2 + 1, 32768.0);
+
+		run_real_q15(n);
+		snr_rq = snr_q15(real_q15, n / 2 + 1, n);
+
+		// and the Q15 real transform there & back
+
+		for (i = 0; i < n; i++) {
+			orig[i] = in_q15[i].re;
+		}
+
+		fft_real_q15(real_q15, n, FFT_INVERSE);
+
+		for (i = 0, worst = 0; i < n; i++) {
+
+			err   = abs(real_q15[i] - orig[i]);
+			worst = MAX(worst, err);
+		}
+
+		printf("  %5u %8.0f ns %9.0f %10.0f %9.0f %10.0f %9.0f %6.0fx   %5.1f %5.1f %5.1f %5.1f dB %9d LSB%s\n",
+			n, t_dft, t_c, t_simd, t_q15, t_rf, t_rq, t_dft / t_simd, snr_f, snr_q, snr_rf, snr_rq, worst,
+			same ? "" : "  MISMATCH");
+	}
+
+	printf("\n  float C and SIMD butterflies: %s\n\n", failed ? "FAIL" : "bit-exact");
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,301 @@
+/**
+*
+* @file bench_limiter.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host benchmark for the lookahead peak limiter (software/compand.c), the
+* compand effect's limiter mode at the end of every effect mode. For each
+* lookahead window from 2 to LIMITER_MAX_WINDOW frames, on a loud test
+* signal (noise bursts & a tone swept up to full scale, 16 kHz mono):
+*
+*	o the speed in samples per second and timestamp-counter cycles per
+*	  sample with the monotonic deque, and with the window's peak found by
+*	  scanning the window every frame instead (the O(window) way); the two
+*	  have to give the same output bit for bit
+*	o the peak out, which must not pass the ceiling, the frames turned
+*	  down and the deepest gain reduction
+*
+* Usage:
+*	bench_limiter [seconds]
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "delay_line.h"
+#include "compand.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define SAMPLE_RATE			16000
+#define BLOCK_SIZE			64
+#define DEFAULT_SECONDS		8
+#define REPEATS				3
+#define CEILING_DB			(-6.0)
+#define RELEASE_MS			50.0
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+// the same limiter with the window's peak scanned for: the peaks of the
+// last window frames, and the limiter it shadows for the rest
+
+typedef struct scan_limiter {
+
+	limiter_t		lm;
+	u16				peaks[LIMITER_MAX_WINDOW];
+
+} scan_limiter_t;
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static u32 rng_state = 0x1234567;
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long now_cycles(void) {
+
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static u32 rng_next(void) {
+
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return rng_state >> 8;
+}
+
+// a tone swept from -24 dBFS up to full scale every second, with bursts of
+// full-scale noise every 0.75 s
+
+static void make_signal(st_sample_t *buf, st_size_t len) {
+
+	st_size_t	i;
+	double		level, x;
+
+	for (i = 0; i < len; i++) {
+
+		level = pow(10.0, (-24.0 + 24.0 * (i % SAMPLE_RATE) / SAMPLE_RATE) / 20.0);
+		x     = level * 32767.0 * sin(2.0 * M_PI * 440.0 * i / SAMPLE_RATE);
+
+		if ((i % (3 * SAMPLE_RATE / 4)) < SAMPLE_RATE / 20) {
+			x = (double) ((int) (rng_next() & 0xFFFF) - 0x8000);
+		}
+
+		buf[i] = ST_SIGNED_WORD_TO_SAMPLE((s16) MIN(MAX(x, PCM_MIN), PCM_MAX));
+	}
+}
+
+// limiter_flow() with the deque swapped for a scan of the window: the same
+// gain arithmetic, mono
+
+static st_size_t scan_flow(scan_limiter_t *sl, const st_sample_t *in, st_sample_t *out, st_size_t len) {
+
+	limiter_t		*lm = &sl->lm;
+	unsigned int	mask = lm->window - 1, a, g, j, peak;
+	st_size_t		i;
+	s32				x;
+	u32				d;
+
+	for (i = 0; i < len; i++) {
+
+		x = ST_SAMPLE_TO_SIGNED_WORD(in[i]);
+		a = (unsigned int) ((x < 0) ? -x : x);
+
+		lm->delay[lm->frame & mask] = (s16) x;
+		sl->peaks[lm->frame & mask] = (u16) a;
+
+		for (j = 0, peak = 0; j < lm->window; j++) {
+			peak = MAX(peak, sl->peaks[j]);
+		}
+
+		if (peak != lm->peak) {
+
+			lm->peak = peak;
+			lm->hold = (peak > lm->ceiling) ? (lm->ceiling << 15) / peak : Q15_ONE;
+		}
+
+		if ((lm->hold << 15) <= lm->gain) {
+			lm->gain = lm->hold << 15;
+		}
+
+		else {
+
+			d         = (lm->hold << 15) - lm->gain;
+			lm->gain += (d >> 15) * lm->release + (((d & 0x7FFF) * lm->release) >> 15);
+		}
+
+		g        = (lm->gain + 0x7FFF) >> 15;
+		lm->sum += g - lm->gains[lm->frame & mask];
+		lm->gains[lm->frame & mask] = (u16) g;
+		g        = lm->sum >> lm->shift;
+
+		x      = (lm->delay[(lm->frame + 1) & mask] * (s32) g + (1 << (Q15_SHIFT - 1))) >> Q15_SHIFT;
+		out[i] = ST_SIGNED_WORD_TO_SAMPLE((s16) x);
+
+		lm->frame++;
+	}
+
+	return len;
+}
+
+// the best of REPEATS runs, a block at a time, in seconds & cycles; scan
+// picks the scanning limiter
+
+static double time_limiter(unsigned int frames, int scan, const st_sample_t *in, st_sample_t *out,
+						   st_size_t len, unsigned long long *cycles, limiter_t *result) {
+
+	static scan_limiter_t	sl;
+	unsigned int			rep;
+	unsigned long long		c;
+	double					start, seconds, best = 1e30;
+	st_size_t				done, n;
+
+	*cycles = ~0ULL;
+
+	for (rep = 0; rep < REPEATS; rep++) {
+
+		limiter_init(&sl.lm, SAMPLE_RATE, 1, CEILING_DB, frames * 1000.0 / SAMPLE_RATE, RELEASE_MS);
+		memset(sl.peaks, 0, sizeof(sl.peaks));
+
+		start = now_seconds();
+		c     = now_cycles();
+
+		for (done = 0; done < len; done += n) {
+
+			n = MIN(len - done, BLOCK_SIZE);
+
+			if (scan) {
+				scan_flow(&sl, in + done, out + done, n);
+			}
+
+			else {
+				limiter_flow(&sl.lm, in + done, out + done, n);
+			}
+		}
+
+		c       = now_cycles() - c;
+		seconds = now_seconds() - start;
+
+		best    = MIN(best, seconds);
+		*cycles = MIN(*cycles, c);
+	}
+
+	*result = sl.lm;
+
+	return best;
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	unsigned int		seconds = (argc > 1) ? (unsigned int) atoi(argv[1]) : DEFAULT_SECONDS;
+	unsigned int		frames, failed = 0, peak_in = 0, peak_out, a;
+	unsigned long long	c_deque, c_scan;
+	st_sample_t			*in, *out[2];
+	st_size_t			len, i;
+	double				t_deque, t_scan, depth, g;
+	limiter_t			lm;
+	int					same, over;
+
+	if (seconds == 0) {
+		seconds = DEFAULT_SECONDS;
+	}
+
+	len    = (st_size_t) seconds * SAMPLE_RATE;
+	in     = malloc(len * sizeof(st_sample_t));
+	out[0] = malloc(len * sizeof(st_sample_t));
+	out[1] = malloc(len * sizeof(st_sample_t));
+
+	if ((in == NULL) || (out[0] == NULL) || (out[1] == NULL)) {
+
+		fprintf(stderr, "out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	make_signal(in, len);
+
+	for (i = 0; i < len; i++) {
+		peak_in = MAX(peak_in, (unsigned int) abs(ST_SAMPLE_TO_SIGNED_WORD(in[i])));
+	}
+
+	printf("\nlookahead limiter, %u s of 16 kHz mono per run (peak %.1f dBFS), %.0f dB ceiling, %.0f ms release\n\n",
+		seconds, 20.0 * log10(peak_in / 32768.0), CEILING_DB, RELEASE_MS);
+
+	printf("  %6s %9s %14s %14s %11s %11s %10s %8s %9s\n", "window", "lookahead", "deque", "scan",
+		"deque c/s", "scan c/s", "peak out", "limited", "deepest");
+
+	for (frames = 1; frames < LIMITER_MAX_WINDOW; frames = frames * 2 + 1) {
+
+		t_deque = time_limiter(frames, 0, in, out[0], len, &c_deque, &lm);
+		t_scan  = time_limiter(frames, 1, in, out[1], len, &c_scan, &lm);
+
+		// the deque run again for its figures; the output is the same
+
+		time_limiter(frames, 0, in, out[0], len, &c_deque, &lm);
+
+		same = !memcmp(out[0], out[1], len * sizeof(st_sample_t));
+
+		for (i = 0, peak_out = 0, depth = 1.0; i < len; i++) {
+
+			a        = (unsigned int) abs(ST_SAMPLE_TO_SIGNED_WORD(out[0][i]));
+			peak_out = MAX(peak_out, a);
+
+			// the gain on each frame, from the input it came from
+
+			if ((i >= frames) && (a > 0)) {
+
+				g     = (double) a / abs(ST_SAMPLE_TO_SIGNED_WORD(in[i - frames]));
+				depth = MIN(depth, g);
+			}
+		}
+
+		over    = (peak_out > lm.ceiling);
+		failed += !same + over;
+
+		printf("  %6u %6.2f ms %8.2f MS/s %8.2f MS/s %11.1f %11.1f %6.1f dB %7.1f%% %6.1f dB%s%s\n",
+			lm.window, limiter_delay(&lm) * 1000.0 / SAMPLE_RATE, len / t_deque / 1e6, len / t_scan / 1e6,
+			(double) c_deque / len, (double) c_scan / len, 20.0 * log10(peak_out / 32768.0),
+			100.0 * lm.limited / len, 20.0 * log10(depth), same ? "" : "  MISMATCH", over ? "  OVER" : "");
+	}
+
+	printf("\n  deque & scan outputs, and the ceiling: %s\n\n", failed ? "FAIL" : "same, held");
+
+	free(in);
+	free(out[0]);
+	free(out[1]);
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,321 @@
+/**
+*
+* @file bench_main_loop.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host benchmark for the application main loop. The peripherals are brought
+* up with the real init_peripherals() / init_fx() on top of the host models,
+* then sw[1:0] is flipped through the GPIO model (so switch_handler runs off
+* the emulated interrupt) and, for each effect mode:
+*
+*	o throughput: LED update plus one blind process_sweep() over the buffer
+*	o real time: the actual main loop body, events & LED update plus one
+*	  process_half() per half queued by the InputBuffer interrupt and
+*	  mb_sleep() otherwise, with interrupts off around the empty check,
+*	  against AudioInput / AudioOutput pointers that advance at line_rate
+*	  (hal_audio.c). Reports whether the loop kept up, the interrupts it
+*	  took, the halves it missed, how often the output had to be pulled
+*	  back in line, the share of the time it slept (the headroom) and the
+*	  resulting input-to-output latency.
+*
+* The modes run twice: with the chorus voice and the delay taps worked out
+* in software, and by the chorus voice generator in the ChorusBuffer and the
+* echo engine in the DelayBuffer (chorus_set_engine(), set_delay_engine()).
+*
+* Usage:
+*	bench_main_loop [latency_spins] [sweeps] [line_rate]
+*
+* latency_spins is the busy-wait added to every Xil_In32 / Xil_Out32 call to
+* stand in for the AXI4-Lite round trip (default 200). line_rate defaults to
+* one PCM sample per line at the 16 kHz AudioInput / AudioOutput rate.
+*
+* Built with PROFILE_ENABLE (make bench_profile) the same run also presses a
+* pushbutton after each mode, and the cycle profile of that mode is written
+* to profile.bin for prof_decode, just like the board sends it on the UART.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "xparameters.h"
+#include "mb_interface.h"
+#include "hal.h"
+#include "audio_fx.h"
+#include "peripherals.h"
+#include "profile.h"
+#include "spsc_ring.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define DEFAULT_SPINS		200
+#define DEFAULT_SWEEPS		4
+#define SAMPLE_RATE_HZ		16000
+#define DEFAULT_LINE_RATE	16000
+#define REALTIME_SECONDS	0.5
+#define READ_PHASE			0x8000
+#define PROFILE_FILE		"profile.bin"
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long bram_checksum(const u16 *bram) {
+
+	unsigned long	sum = 0;
+	unsigned int	i;
+
+	for (i = 0; i < BUFFER_DEPTH; i++) {
+		sum += bram[i] * (i + 1ul);
+	}
+
+	return sum;
+}
+
+// LED update plus one blind sweep, for the throughput numbers
+
+static void sweep_loop_body(void) {
+
+	unsigned int leds;
+
+	poll_events();
+	leds = (button_state << 8) | (switch_state);
+
+	XGpio_DiscreteWrite(&LEDInst, GPIO_CHANNEL_1, leds);
+	process_sweep(switch_state & MSK_LOWER_2_BITS);
+}
+
+// one iteration of the while(1) loop in final_project.c; adds the time
+// spent in mb_sleep() to *asleep
+
+static unsigned int main_loop_body(double *asleep) {
+
+	unsigned int leds;
+	u32 line;
+	double start;
+
+	poll_events();
+
+	leds = (button_state << 8) | (switch_state);
+	XGpio_DiscreteWrite(&LEDInst, GPIO_CHANNEL_1, leds);
+
+	if (spsc_ring_pop(&input_ring, &line)) {
+		return process_half(line, switch_state & MSK_LOWER_2_BITS);
+	}
+
+	start = now_seconds();
+	microblaze_disable_interrupts();
+
+	if (spsc_ring_count(&input_ring) == 0) {
+		mb_sleep();
+	}
+
+	microblaze_enable_interrupts();
+	*asleep += now_seconds() - start;
+
+	return 0;
+}
+
+// run the real main loop against the pointer model for a fixed time; a half
+// still queued at the end of a run is picked up by the next one, as it would
+// be in the one endless loop on the board
+
+static void bench_realtime(double line_rate) {
+
+	unsigned long long	processed = 0;
+	unsigned int		resyncs = get_output_resyncs();
+	unsigned int		overruns = get_input_overruns();
+	u64					interrupts = hal_intc_count(INPUT_INTERRUPT_ID);
+	u64					lines = hal_audio_lines();
+	double				start = now_seconds();
+	double				asleep = 0.0, seconds;
+
+	hal_audio_start(line_rate, READ_PHASE);
+
+	while ((now_seconds() - start) < REALTIME_SECONDS) {
+		processed += main_loop_body(&asleep);
+	}
+
+	seconds = now_seconds() - start;
+	lines = hal_audio_lines() - lines;
+	hal_audio_stop();
+
+	printf("                             realtime: %llu of %llu lines (%5.1f%%), %llu interrupts, "
+		"%u overruns, %u output resyncs, %4.1f%% asleep\n",
+		processed, (unsigned long long) lines, lines ? 100.0 * processed / lines : 0.0,
+		(unsigned long long) (hal_intc_count(INPUT_INTERRUPT_ID) - interrupts),
+		get_input_overruns() - overruns, get_output_resyncs() - resyncs, 100.0 * asleep / seconds);
+}
+
+// one effect mode: throughput sweeps, then the real-time main loop
+
+static XStatus bench_mode(unsigned int mode, unsigned int sweeps, double line_rate) {
+
+	static const char *mode_names[4] = {
+
+		"no effects", "chorus", "delay", "chorus + delay"
+	};
+
+	unsigned int	sweep;
+	double			start, seconds, samples;
+	hal_io_stats_t	stats;
+
+	// flip sw[1:0]; the switch interrupt queues the event for switch_state
+
+	hal_gpio_set_input(SW_GPIO_DEVICE_ID, mode, SW_INTERRUPT_ID);
+	poll_events();
+
+	if ((switch_state & MSK_LOWER_2_BITS) != mode) {
+
+		fprintf(stderr, "switch interrupt did not reach switch_handler\n");
+		return XST_FAILURE;
+	}
+
+	// one untimed sweep so the timed ones start from a warm cache & clock
+
+	sweep_loop_body();
+
+	hal_io_clear_stats();
+	start = now_seconds();
+
+	for (sweep = 0; sweep < sweeps; sweep++) {
+		sweep_loop_body();
+	}
+
+	seconds = now_seconds() - start;
+	samples = (double) BUFFER_DEPTH * sweeps;
+	hal_io_get_stats(&stats);
+
+	printf("  sw[1:0]=%u %-16s %12.0f samples/s  %6.1fx realtime  %5.2f bus transactions/sample  (checksum %08lx)\n",
+		mode, mode_names[mode], samples / seconds, samples / seconds / SAMPLE_RATE_HZ,
+		(stats.reads + stats.writes) / samples, bram_checksum(hal_delaybuffer_bram()));
+
+	bench_realtime(line_rate);
+
+#ifdef PROFILE_ENABLE
+
+	// press & release a button (two button ISRs), then dump as main() does
+
+	hal_gpio_set_input(BTN_GPIO_DEVICE_ID, 0x01, BTN_INTERRUPT_ID);
+	hal_gpio_set_input(BTN_GPIO_DEVICE_ID, 0x00, BTN_INTERRUPT_ID);
+
+	profile_dump();
+	profile_reset();
+
+#endif
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	unsigned int	spins  = (argc > 1) ? (unsigned int) atoi(argv[1]) : DEFAULT_SPINS;
+	unsigned int	sweeps = (argc > 2) ? (unsigned int) atoi(argv[2]) : DEFAULT_SWEEPS;
+	double			line_rate = (argc > 3) ? atof(argv[3]) : DEFAULT_LINE_RATE;
+	unsigned int	engine, mode, i;
+	u16				*bram;
+
+#ifdef PROFILE_ENABLE
+	FILE			*profile_out;
+#endif
+
+	if (sweeps == 0) {
+
+		fprintf(stderr, "sweeps must be at least 1\n");
+		return EXIT_FAILURE;
+	}
+
+	// bring up the models, then the application exactly as main() does
+
+	hal_inputbuffer_init();
+	hal_chorusbuffer_init();
+	hal_delaybuffer_init();
+	hal_tmrctr_init();
+
+	if ((init_peripherals() != XST_SUCCESS) || (init_fx() != XST_SUCCESS)) {
+
+		fprintf(stderr, "initialization failed\n");
+		return EXIT_FAILURE;
+	}
+
+	microblaze_enable_interrupts();
+
+#ifdef PROFILE_ENABLE
+
+	// the profile frames go where the board's UART would send them
+
+	if ((profile_out = fopen(PROFILE_FILE, "wb")) == NULL) {
+
+		perror(PROFILE_FILE);
+		return EXIT_FAILURE;
+	}
+
+	hal_uart_capture(profile_out);
+
+#endif
+
+	// fill the InputBuffer with a repeatable test signal
+
+	bram = hal_inputbuffer_bram();
+
+	for (i = 0; i < BUFFER_DEPTH; i++) {
+		bram[i] = (u16) ((i * 40503u) >> 4);
+	}
+
+	hal_io_set_latency(spins);
+
+	printf("\n%d lines x %u sweeps, %u spins/access\n", BUFFER_DEPTH, sweeps, spins);
+
+	for (engine = DELAY_ENGINE_SOFTWARE; engine <= DELAY_ENGINE_HARDWARE; engine++) {
+
+		set_delay_engine(engine);
+		chorus_set_engine((engine == DELAY_ENGINE_HARDWARE) ? CHORUS_ENGINE_HARDWARE : CHORUS_ENGINE_SOFTWARE);
+
+		printf("\n  chorus & delay %s\n\n", (engine == DELAY_ENGINE_HARDWARE) ?
+			"by the ChorusBuffer voice generator & DelayBuffer echo engine" : "in software");
+
+		for (mode = 0; mode < 4; mode++) {
+
+			if (bench_mode(mode, sweeps, line_rate) != XST_SUCCESS) {
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+#ifdef PROFILE_ENABLE
+
+	hal_uart_capture(NULL);
+	fclose(profile_out);
+
+	printf("\n  profile of each mode written to %s (decode with prof_decode)\n", PROFILE_FILE);
+
+#endif
+
+	printf("\n  latency: %d lines (%.2f ms at %.0f lines/s), one interrupt per %d lines\n",
+		INPUT_HALF_LINES + OUTPUT_LEAD, 1e3 * (INPUT_HALF_LINES + OUTPUT_LEAD) / line_rate, line_rate,
+		INPUT_HALF_LINES);
+
+	printf("  LEDs 0x%04x, %llu switch interrupts\n", (unsigned) hal_gpio_get_output(LED_GPIO_DEVICE_ID),
+		(unsigned long long) hal_intc_count(SW_INTERRUPT_ID));
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,184 @@
+/**
+*
+* @file bench_mixer.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host check & benchmark for the delay tap mixer. The Q1.15 path
+* (Q15_SCALE in software/audio_fx.h) is compared against the float divides
+* it replaced, (int) (((float) x) / 1.25) etc., for every 16-bit input and
+* each default tap gain. The check fails if any output differs by more than
+* 1 LSB. Both paths are then timed over the same inputs and reported in
+* ns and timestamp-counter cycles per tap.
+*
+* The host has a hardware FPU, so the float path here is far cheaper than
+* the soft-float divide the MicroBlaze (no FPU) runs; the gap on the board
+* is larger than the one reported here.
+*
+* Usage:
+*	bench_mixer [passes]
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "audio_fx.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define NUM_TAPS			3
+#define NUM_INPUTS			65536
+#define DEFAULT_PASSES		200
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static const double			divisors[NUM_TAPS] = { 1.25, 1.66, 2.25 };
+static const unsigned int	gains[NUM_TAPS] = {
+
+	DELAY_GAIN_TAP_0, DELAY_GAIN_TAP_1, DELAY_GAIN_TAP_2
+};
+
+static volatile unsigned int	sink;
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long now_cycles(void) {
+
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+// the three taps of one sample, as the main loop used to do them
+
+static unsigned int mix_float(unsigned int x) {
+
+	unsigned int v2 = (int) (((float) x) / 1.25);
+	unsigned int v3 = (int) (((float) x) / 1.66);
+	unsigned int v4 = (int) (((float) x) / 2.25);
+
+	return v2 + v3 + v4;
+}
+
+static unsigned int mix_q15(unsigned int x, const unsigned int *g) {
+
+	return Q15_SCALE(x, g[0]) + Q15_SCALE(x, g[1]) + Q15_SCALE(x, g[2]);
+}
+
+static void report(const char *name, double seconds, unsigned long long cycles, double taps) {
+
+	printf("  %-8s %8.3f ns/tap", name, seconds * 1e9 / taps);
+
+	if (cycles) {
+		printf("   %7.2f cycles/tap", cycles / taps);
+	}
+
+	printf("\n");
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	unsigned int		passes = (argc > 1) ? (unsigned int) atoi(argv[1]) : DEFAULT_PASSES;
+	unsigned int		tap, x, pass, acc;
+	int					diff, max_diff = 0;
+	double				start, float_time, q15_time, taps;
+	unsigned long long	cycles, float_cycles, q15_cycles;
+
+	if (passes == 0) {
+
+		fprintf(stderr, "passes must be at least 1\n");
+		return EXIT_FAILURE;
+	}
+
+	// exhaustive accuracy check, every 16-bit input against every tap
+
+	for (tap = 0; tap < NUM_TAPS; tap++) {
+
+		for (x = 0; x < NUM_INPUTS; x++) {
+
+			diff = (int) Q15_SCALE(x, gains[tap]) - (int) (((float) x) / divisors[tap]);
+			diff = abs(diff);
+
+			if (diff > max_diff) {
+				max_diff = diff;
+			}
+		}
+
+		printf("tap %u: /%.2f -> Q1.15 gain 0x%04x\n", tap, divisors[tap], gains[tap]);
+	}
+
+	printf("max error vs. float path: %d LSB\n\n", max_diff);
+
+	if (max_diff > 1) {
+		return EXIT_FAILURE;
+	}
+
+	// timing, same inputs for both paths
+
+	taps = (double) NUM_INPUTS * NUM_TAPS * passes;
+
+	acc = 0;
+	start = now_seconds();
+	cycles = now_cycles();
+
+	for (pass = 0; pass < passes; pass++) {
+
+		for (x = 0; x < NUM_INPUTS; x++) {
+			acc += mix_float(x);
+		}
+	}
+
+	float_cycles = now_cycles() - cycles;
+	float_time = now_seconds() - start;
+	sink = acc;
+
+	acc = 0;
+	start = now_seconds();
+	cycles = now_cycles();
+
+	for (pass = 0; pass < passes; pass++) {
+
+		for (x = 0; x < NUM_INPUTS; x++) {
+			acc += mix_q15(x, gains);
+		}
+	}
+
+	q15_cycles = now_cycles() - cycles;
+	q15_time = now_seconds() - start;
+	sink = acc;
+
+	printf("%u passes x %d inputs x %d taps\n", passes, NUM_INPUTS, NUM_TAPS);
+	report("float", float_time, float_cycles, taps);
+	report("Q1.15", q15_time, q15_cycles, taps);
+	printf("  speedup: %.2fx\n", float_time / q15_time);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,494 @@
+/**
+*
+* @file bench_pdm.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host check of the AudioInput decimator and the AudioOutput modulator
+* through their C reference models (hal_pdm.c).
+*
+* Decimator: a second-order sigma-delta modulator stands in for the mic
+* and turns a sine into a 3.072 MHz PDM stream; the model decimates it and
+* the PCM is compared with the ideal sine:
+*
+*	o SNR: a 1 kHz tone at -6 dBFS, fitted by least squares (amplitude,
+*	  phase and DC), everything left over counts as noise
+*	o gain: fitted amplitude against the expected -6 dBFS
+*	o alias rejection: a -6 dBFS tone at 0.625 x the output rate, which
+*	  would fold into the passband, against the same tone level
+*
+* for both decimation settings (16 kHz and 48 kHz) and both CIC orders the
+* compensation FIR has coefficients for. At 48 kHz the oversampling ratio
+* drops to 64 and second-order modulator noise, most of it between 0.4 and
+* 0.5 x the sample rate where the decimator no longer filters, sets the SNR
+* (the mic's own modulator is of higher order). The run fails if an SNR is
+* under MIN_SNR_16K_DB / MIN_SNR_48K_DB.
+*
+* Modulator: a -6 dBFS 1 kHz PCM sine is played through the AudioOutput
+* model and the bitstream is brought back to PCM with the decimator model,
+* whose filters set the measurement band (0.4 x the sample rate). SNR and
+* gain are fitted as above; the gain should be the modulator's -1.9 dB.
+* Full-scale input is run too, to show the loop stays stable.
+*
+* Each run also reports how fast the model goes, as simulated time over
+* wall time: the pace an HDL simulation of the same run has to be judged by.
+*
+* With a vector prefix the models also write stimulus and expected results
+* for the default build of each core (CIC_ORDER 4, CIC_DECIMATION 96,
+* INTERP 192), one word per line for $readmemb / $readmemh, so a simulation
+* of AudioInput.v or AudioOutput.v can be compared sample for sample (the
+* testbenches in hdl/tb do):
+*
+*	o <prefix>_in_pdm.mem	PDM_in, one bit per mic clock (binary): the
+*							tone, then full-scale ones & zeros to drive
+*							the output into saturation both ways
+*	o <prefix>_in_pcm.mem	the InputBuffer words AudioInput writes (hex)
+*	o <prefix>_out_buf.mem	the DelayBuffer image AudioOutput plays (hex)
+*	o <prefix>_out_pdm.mem	PDM_out, one bit per clock (binary), which the
+*							testbench also decimates for the in-band SNR
+*	o <prefix>_vectors.vh	their lengths, and the SNR the model gets on
+*							them, as `defines for the testbenches
+*
+* Usage:
+*	bench_pdm [seconds] [vector_prefix]
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "hal.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define MIC_CLOCK_HZ		3072000.0
+#define TONE_HZ				1000.0
+#define TONE_AMPLITUDE		0.5
+#define SETTLE_SAMPLES		64
+#define DEFAULT_SECONDS		0.5
+#define MIN_SNR_16K_DB		80.0
+#define MIN_SNR_48K_DB		65.0
+#define VECTOR_SECONDS		0.05
+#define VECTOR_SAT_SECONDS	0.005
+#define VECTOR_BUF_LINES	65536
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct fit {
+
+	double		amplitude;
+	double		noise_rms;
+
+} fit_t;
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double min_snr(double rate) {
+
+	return (rate < 32000.0) ? MIN_SNR_16K_DB : MIN_SNR_48K_DB;
+}
+
+// second-order sigma-delta modulator, standing in for the mic
+
+static int pdm_modulate(double x, double state[2]) {
+
+	int bit = (state[1] >= 0.0);
+	double fb = bit ? 1.0 : -1.0;
+
+	state[0] += x - fb;
+	state[1] += state[0] - fb;
+
+	return bit;
+}
+
+// run one tone through the decimator model, return the PCM samples
+
+static unsigned int decimate_tone(unsigned int order, unsigned int decimation, double tone_hz,
+								  double seconds, s16 *pcm, unsigned int max_samples) {
+
+	hal_pdm_dec_t	dec;
+	double			state[2] = { 0.0, 0.0 };
+	unsigned long	bits = (unsigned long) (seconds * MIC_CLOCK_HZ);
+	unsigned long	n;
+	unsigned int	count = 0;
+	s16				sample;
+
+	hal_pdm_dec_init(&dec, order, decimation);
+
+	for (n = 0; n < bits; n++) {
+
+		double x = TONE_AMPLITUDE * sin(2.0 * M_PI * tone_hz * n / MIC_CLOCK_HZ);
+
+		if (hal_pdm_dec_bit(&dec, pdm_modulate(x, state), &sample) && (count < max_samples)) {
+			pcm[count++] = sample;
+		}
+	}
+
+	return count;
+}
+
+// play one PCM tone through the modulator model and decimate the bitstream
+
+static unsigned int loopback_tone(unsigned int interp, double amplitude, double seconds,
+								  s16 *pcm, unsigned int max_samples) {
+
+	hal_pdm_mod_t	mod;
+	hal_pdm_dec_t	dec;
+	double			rate = MIC_CLOCK_HZ / interp;
+	unsigned long	bits = (unsigned long) (seconds * MIC_CLOCK_HZ);
+	unsigned long	n;
+	unsigned int	count = 0;
+	s16				sample;
+
+	hal_pdm_mod_init(&mod, interp);
+	hal_pdm_dec_init(&dec, 4, interp / 2);
+
+	for (n = 0; n < bits; n++) {
+
+		// the DelayBuffer line AudioOutput is reading in this period
+
+		s16 line = (s16) lrint(amplitude * 32767.0 * sin(2.0 * M_PI * TONE_HZ * mod.read_address / rate));
+
+		if (hal_pdm_dec_bit(&dec, hal_pdm_mod_bit(&mod, line), &sample) && (count < max_samples)) {
+			pcm[count++] = sample;
+		}
+	}
+
+	return count;
+}
+
+// least-squares fit of a cos + b sin + c at a known frequency
+
+static fit_t fit_tone(const s16 *pcm, unsigned int count, double freq, double rate) {
+
+	double	m[3][4] = { { 0 } };
+	double	coef[3], resid = 0.0;
+	fit_t	result;
+	unsigned int n, i, j, k;
+
+	for (n = 0; n < count; n++) {
+
+		double w = 2.0 * M_PI * freq * n / rate;
+		double basis[3] = { cos(w), sin(w), 1.0 };
+
+		for (i = 0; i < 3; i++) {
+
+			for (j = 0; j < 3; j++) {
+				m[i][j] += basis[i] * basis[j];
+			}
+
+			m[i][3] += basis[i] * pcm[n];
+		}
+	}
+
+	// Gauss-Jordan on the 3x3 normal equations (well conditioned)
+
+	for (i = 0; i < 3; i++) {
+
+		for (j = 0; j < 3; j++) {
+
+			double f;
+
+			if (j == i) {
+				continue;
+			}
+
+			f = m[j][i] / m[i][i];
+
+			for (k = i; k < 4; k++) {
+				m[j][k] -= f * m[i][k];
+			}
+		}
+	}
+
+	for (i = 0; i < 3; i++) {
+		coef[i] = m[i][3] / m[i][i];
+	}
+
+	for (n = 0; n < count; n++) {
+
+		double w = 2.0 * M_PI * freq * n / rate;
+		double e = pcm[n] - (coef[0] * cos(w) + coef[1] * sin(w) + coef[2]);
+
+		resid += e * e;
+	}
+
+	result.amplitude = hypot(coef[0], coef[1]);
+	result.noise_rms = sqrt(resid / count);
+
+	return result;
+}
+
+// stimulus & expected results of both cores at their defaults
+
+static FILE *open_vector(const char *prefix, const char *name, const char *ext) {
+
+	char path[4096];
+	FILE *fp;
+
+	snprintf(path, sizeof(path), "%s_%s.%s", prefix, name, ext);
+
+	if ((fp = fopen(path, "w")) == NULL) {
+
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+
+	printf("  %s\n", path);
+
+	return fp;
+}
+
+// SNR of the vectors' tone, over whole periods after the settling samples
+
+static unsigned int tone_period(void) {
+
+	return (unsigned int) lrint(MIC_CLOCK_HZ / 192 / TONE_HZ);
+}
+
+static double tone_snr(const s16 *pcm, unsigned int count) {
+
+	unsigned int	used = (count - SETTLE_SAMPLES) / tone_period() * tone_period();
+	fit_t			tone = fit_tone(pcm + SETTLE_SAMPLES, used, TONE_HZ, MIC_CLOCK_HZ / 192);
+
+	return 20.0 * log10(tone.amplitude / sqrt(2.0) / tone.noise_rms);
+}
+
+static void write_vectors(const char *prefix) {
+
+	hal_pdm_dec_t	dec;
+	hal_pdm_mod_t	mod;
+	double			state[2] = { 0.0, 0.0 };
+	unsigned long	bits = (unsigned long) (VECTOR_SECONDS * MIC_CLOCK_HZ);
+	unsigned long	sat_bits = (unsigned long) (VECTOR_SAT_SECONDS * MIC_CLOCK_HZ);
+	unsigned long	n;
+	unsigned int	a, in_count = 0, tone_count = 0;
+	s16				sample, *lines, *pcm;
+	FILE			*in_pdm, *in_pcm, *out_buf, *out_pdm, *vh;
+	int				bit;
+
+	printf("\nVectors, %.2f s of %.0f Hz at %.1f dBFS (CIC_ORDER 4, CIC_DECIMATION 96, INTERP 192)\n\n",
+		VECTOR_SECONDS, TONE_HZ, 20.0 * log10(TONE_AMPLITUDE));
+
+	in_pdm  = open_vector(prefix, "in_pdm", "mem");
+	in_pcm  = open_vector(prefix, "in_pcm", "mem");
+	out_buf = open_vector(prefix, "out_buf", "mem");
+	out_pdm = open_vector(prefix, "out_pdm", "mem");
+	vh      = open_vector(prefix, "vectors", "vh");
+
+	lines = malloc(VECTOR_BUF_LINES * sizeof(*lines));
+	pcm   = malloc(VECTOR_BUF_LINES * sizeof(*pcm));
+
+	if ((lines == NULL) || (pcm == NULL)) {
+
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// AudioInput: the mic's bits in, the InputBuffer words out; after the
+	// tone, full-scale ones and then zeros
+
+	hal_pdm_dec_init(&dec, 4, 96);
+
+	for (n = 0; n < bits + 2 * sat_bits; n++) {
+
+		if (n < bits) {
+			bit = pdm_modulate(TONE_AMPLITUDE * sin(2.0 * M_PI * TONE_HZ * n / MIC_CLOCK_HZ), state);
+		}
+
+		else {
+			bit = (n < bits + sat_bits);
+		}
+
+		fprintf(in_pdm, "%d\n", bit);
+
+		if (hal_pdm_dec_bit(&dec, bit, &sample)) {
+
+			fprintf(in_pcm, "%04x\n", (u16) sample);
+
+			if (n < bits) {
+				pcm[tone_count++] = sample;
+			}
+
+			in_count++;
+		}
+	}
+
+	fprintf(vh, "// written by host/bench_pdm: lengths of the *.mem vectors, and the SNR in\n");
+	fprintf(vh, "// dB the C models get on the tone over whole periods (in samples) after\n");
+	fprintf(vh, "// the settling samples\n\n");
+	fprintf(vh, "`define PDM_SETTLE_SAMPLES    %d\n", SETTLE_SAMPLES);
+	fprintf(vh, "`define PDM_TONE_PERIOD       %u\n", tone_period());
+	fprintf(vh, "`define PDM_IN_BITS           %lu\n", bits + 2 * sat_bits);
+	fprintf(vh, "`define PDM_IN_SAMPLES        %u\n", in_count);
+	fprintf(vh, "`define PDM_IN_TONE_SAMPLES   %u\n", tone_count);
+	fprintf(vh, "`define PDM_IN_MODEL_SNR      %.4f\n", tone_snr(pcm, tone_count));
+
+	// AudioOutput: a tone over the whole DelayBuffer, its bits out
+
+	for (a = 0; a < VECTOR_BUF_LINES; a++) {
+
+		lines[a] = (s16) lrint(TONE_AMPLITUDE * 32767.0 * sin(2.0 * M_PI * TONE_HZ * a / (MIC_CLOCK_HZ / 192)));
+		fprintf(out_buf, "%04x\n", (u16) lines[a]);
+	}
+
+	// and back through the decimator model for the in-band SNR, which sees
+	// PDM_out a clock late (so a 0 first) as the testbench's AudioInput does
+
+	hal_pdm_mod_init(&mod, 192);
+	hal_pdm_dec_init(&dec, 4, 96);
+
+	for (n = 0, bit = 0, tone_count = 0; n < bits; n++) {
+
+		if (hal_pdm_dec_bit(&dec, bit, &sample) && (tone_count < VECTOR_BUF_LINES)) {
+			pcm[tone_count++] = sample;
+		}
+
+		bit = hal_pdm_mod_bit(&mod, lines[mod.read_address]);
+		fprintf(out_pdm, "%d\n", bit);
+	}
+
+	fprintf(vh, "`define PDM_OUT_BITS          %lu\n", bits);
+	fprintf(vh, "`define PDM_OUT_LINES         %u\n", VECTOR_BUF_LINES);
+	fprintf(vh, "`define PDM_OUT_SAMPLES       %u\n", tone_count);
+	fprintf(vh, "`define PDM_OUT_MODEL_SNR     %.4f\n", tone_snr(pcm, tone_count));
+
+	free(lines);
+	free(pcm);
+	fclose(in_pdm);
+	fclose(in_pcm);
+	fclose(out_buf);
+	fclose(out_pdm);
+	fclose(vh);
+
+	return;
+}
+
+static double rms(const s16 *pcm, unsigned int count) {
+
+	double sum = 0.0;
+	unsigned int n;
+
+	for (n = 0; n < count; n++) {
+		sum += (double) pcm[n] * pcm[n];
+	}
+
+	return sqrt(sum / count);
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	static const unsigned int decimations[2] = { 96, 32 };
+	static const unsigned int orders[2] = { 4, 5 };
+
+	double			seconds = (argc > 1) ? atof(argv[1]) : DEFAULT_SECONDS;
+	double			expected = TONE_AMPLITUDE * 32767.0;
+	double			start, speed;
+	unsigned int	max_samples, count, d, o;
+	int				failed = 0;
+	s16				*pcm;
+
+	max_samples = (unsigned int) (seconds * MIC_CLOCK_HZ / 64) + 1;
+	pcm = malloc(max_samples * sizeof(*pcm));
+
+	if ((pcm == NULL) || (seconds <= 0.0)) {
+
+		fprintf(stderr, "bad duration\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("\nAudioInput decimator model, %.2f s of %.0f Hz at %.1f dBFS per run\n\n",
+		seconds, TONE_HZ, 20.0 * log10(TONE_AMPLITUDE));
+
+	for (d = 0; d < 2; d++) {
+
+		for (o = 0; o < 2; o++) {
+
+			double	rate = MIC_CLOCK_HZ / decimations[d] / 2.0;
+			double	snr, gain, alias;
+			fit_t	tone;
+
+			start = now_seconds();
+			count = decimate_tone(orders[o], decimations[d], TONE_HZ, seconds, pcm, max_samples);
+			speed = seconds / (now_seconds() - start);
+			tone  = fit_tone(pcm + SETTLE_SAMPLES, count - SETTLE_SAMPLES, TONE_HZ, rate);
+			snr   = 20.0 * log10(tone.amplitude / sqrt(2.0) / tone.noise_rms);
+			gain  = 20.0 * log10(tone.amplitude / expected);
+
+			count = decimate_tone(orders[o], decimations[d], 0.625 * rate, seconds, pcm, max_samples);
+			alias = 20.0 * log10(rms(pcm + SETTLE_SAMPLES, count - SETTLE_SAMPLES) / (expected / sqrt(2.0)));
+
+			printf("  %5.0f Hz (CIC order %u, R = %2u): SNR %5.1f dB  gain %+5.2f dB  alias at %5.0f Hz %6.1f dB"
+				"  model %9.0f samples/s (%.1fx realtime)\n",
+				rate, orders[o], decimations[d], snr, gain, 0.625 * rate, alias, speed * rate, speed);
+
+			failed |= (snr < min_snr(rate));
+		}
+	}
+
+	printf("\nAudioOutput modulator model into the decimator model, %.0f Hz tone\n\n", TONE_HZ);
+
+	for (d = 0; d < 2; d++) {
+
+		unsigned int interp = 2 * decimations[d];
+		double rate = MIC_CLOCK_HZ / interp;
+		double levels[2] = { TONE_AMPLITUDE, 1.0 };
+		unsigned int l;
+
+		for (l = 0; l < 2; l++) {
+
+			double	snr, gain;
+			fit_t	tone;
+
+			start = now_seconds();
+			count = loopback_tone(interp, levels[l], seconds, pcm, max_samples);
+			speed = seconds / (now_seconds() - start);
+			tone  = fit_tone(pcm + SETTLE_SAMPLES, count - SETTLE_SAMPLES, TONE_HZ, rate);
+			snr   = 20.0 * log10(tone.amplitude / sqrt(2.0) / tone.noise_rms);
+			gain  = 20.0 * log10(tone.amplitude / (levels[l] * 32767.0));
+
+			printf("  %5.0f Hz (INTERP = %3u) at %5.1f dBFS: SNR %5.1f dB  gain %+5.2f dB"
+				"  model + decimator %9.0f samples/s (%.1fx realtime)\n",
+				rate, interp, 20.0 * log10(levels[l]), snr, gain, speed * rate, speed);
+
+			failed |= (snr < min_snr(rate));
+		}
+	}
+
+	free(pcm);
+
+	if (argc > 2) {
+		write_vectors(argv[2]);
+	}
+
+	if (failed) {
+
+		printf("\nFAILED: SNR below %.0f dB (16 kHz) / %.0f dB (48 kHz)\n", MIN_SNR_16K_DB, MIN_SNR_48K_DB);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
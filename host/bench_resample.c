@@ -0,0 +1,342 @@
+/**
+*
+* @file bench_resample.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host benchmark for the polyphase resampler (software/polyphase.c) behind
+* the rate and resample effects. For each rate pair and quality tier:
+*
+*	o the table: L phases x taps, the coefficients' fraction bits, its size,
+*	  the time to build it and the time to get it again from the cache
+*	o the speed in output samples per second with the C inner loop and with
+*	  the SSE2 one; the two outputs have to match bit for bit
+*	o the stop-band rejection: the 16-bit coefficients put back together as
+*	  the prototype filter, and its worst response from the lower Nyquist
+*	  rate up, against its gain at DC
+*
+* There are more tables than the cache holds, so it evicts as it goes; at
+* the end a resampler holds one table through every other lookup, which
+* must not take it away.
+*
+* Usage:
+*	bench_resample [seconds]
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "xil_types.h"
+#include "delay_line.h"
+#include "polyphase.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define BLOCK_SIZE			64
+#define OUT_BLOCK			(BLOCK_SIZE * POLYPHASE_MAX_RATIO + 1)
+#define DEFAULT_SECONDS		4
+#define NUM_PAIRS			6
+#define MIN_FFT				4096
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct rate_pair {
+
+	st_rate_t		in_rate;
+	st_rate_t		out_rate;
+
+} rate_pair_t;
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static const rate_pair_t pairs[NUM_PAIRS] = {
+
+	{ 16000, 44100 }, { 44100, 16000 },
+	{ 16000, 48000 }, { 48000, 16000 },
+	{ 44100, 48000 }, { 48000, 44100 }
+};
+
+static const char *tier_names[POLYPHASE_NUM_TIERS] = { "low", "medium", "high" };
+
+static u32 rng_state = 0x1234567;
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static u32 rng_next(void) {
+
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return rng_state >> 8;
+}
+
+// in-place radix-2 FFT of n (a power of 2) complex points
+
+static void fft(double *re, double *im, unsigned int n) {
+
+	unsigned int	i, j, k, len;
+	double			t, wr, wi, ur, ui, xr, xi;
+
+	for (i = 1, j = 0; i < n; i++) {
+
+		for (k = n >> 1; j & k; k >>= 1) {
+			j ^= k;
+		}
+
+		j |= k;
+
+		if (i < j) {
+			t = re[i]; re[i] = re[j]; re[j] = t;
+			t = im[i]; im[i] = im[j]; im[j] = t;
+		}
+	}
+
+	for (len = 2; len <= n; len <<= 1) {
+
+		wr = cos(-2.0 * M_PI / len);
+		wi = sin(-2.0 * M_PI / len);
+
+		for (i = 0; i < n; i += len) {
+
+			ur = 1.0;
+			ui = 0.0;
+
+			for (k = 0; k < len / 2; k++) {
+
+				xr = re[i + k + len / 2] * ur - im[i + k + len / 2] * ui;
+				xi = re[i + k + len / 2] * ui + im[i + k + len / 2] * ur;
+
+				re[i + k + len / 2] = re[i + k] - xr;
+				im[i + k + len / 2] = im[i + k] - xi;
+				re[i + k] += xr;
+				im[i + k] += xi;
+
+				t  = ur * wr - ui * wi;
+				ui = ur * wi + ui * wr;
+				ur = t;
+			}
+		}
+	}
+}
+
+// worst stop-band response of the table's prototype filter, in dB below DC
+
+static double stopband_rejection(const polyphase_table_t *t) {
+
+	unsigned int	length = t->up * t->taps;
+	unsigned int	n = MIN_FFT, p, j, k, edge;
+	double			*re, *im, dc = 0.0, peak = 0.0, mag;
+
+	// 16 points a side lobe or more
+
+	while (n < 16 * length) {
+		n <<= 1;
+	}
+
+	re = calloc(n, sizeof(double));
+	im = calloc(n, sizeof(double));
+
+	if ((re == NULL) || (im == NULL)) {
+
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// undo the split: row p, tap j is h[p + (taps - 1 - j) * L]
+
+	for (p = 0; p < t->up; p++) {
+
+		for (j = 0; j < t->taps; j++) {
+
+			re[p + (t->taps - 1 - j) * t->up] = t->coefs[p * t->taps + j];
+			dc += t->coefs[p * t->taps + j];
+		}
+	}
+
+	fft(re, im, n);
+
+	// the stop band starts at the lower Nyquist rate, 0.5 / max(L, M)
+
+	edge = (unsigned int) ceil((double) n / (2.0 * MAX(t->up, t->down)));
+
+	for (k = edge; k <= n / 2; k++) {
+
+		mag  = sqrt(re[k] * re[k] + im[k] * im[k]);
+		peak = MAX(peak, mag);
+	}
+
+	free(re);
+	free(im);
+
+	return 20.0 * log10(fabs(dc) / MAX(peak, 1e-9));
+}
+
+// resample len samples of in, BLOCK_SIZE at a time; returns the samples out
+
+static st_size_t run_resampler(polyphase_t *pp, const st_sample_t *in, st_size_t len,
+							   st_sample_t *out, st_size_t out_len) {
+
+	st_size_t done = 0, made = 0, isamp, osamp;
+
+	while ((done < len) && (made + OUT_BLOCK <= out_len)) {
+
+		isamp = MIN(len - done, BLOCK_SIZE);
+		osamp = OUT_BLOCK;
+
+		polyphase_flow(pp, in + done, &isamp, out + made, &osamp);
+
+		done += isamp;
+		made += osamp;
+	}
+
+	return made;
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	unsigned int			seconds = (argc > 1) ? (unsigned int) atoi(argv[1]) : DEFAULT_SECONDS;
+	unsigned int			pair, tier, failed = 0;
+	const polyphase_table_t	*t;
+	polyphase_t				pp;
+	st_sample_t				*in, *c_out, *simd_out;
+	st_size_t				len, out_len, c_made, simd_made, i;
+	double					start, build, lookup, c_seconds, simd_seconds;
+	int						same, held;
+
+	if (seconds == 0) {
+		seconds = DEFAULT_SECONDS;
+	}
+
+	len     = seconds * 48000;
+	out_len = len * POLYPHASE_MAX_RATIO + OUT_BLOCK;
+
+	in       = malloc(len * sizeof(st_sample_t));
+	c_out    = malloc(out_len * sizeof(st_sample_t));
+	simd_out = malloc(out_len * sizeof(st_sample_t));
+
+	if ((in == NULL) || (c_out == NULL) || (simd_out == NULL)) {
+
+		fprintf(stderr, "out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	// noise at about -6 dBFS
+
+	for (i = 0; i < len; i++) {
+		in[i] = ST_SIGNED_WORD_TO_SAMPLE((s16) ((int) (rng_next() & 0x7FFF) - 0x4000));
+	}
+
+	printf("\npolyphase resampler, %u s of input per run, %d samples a block, inner loop %s\n\n",
+		seconds, BLOCK_SIZE, POLYPHASE_HAVE_SIMD ? "C and SSE2" : "C only (no SSE2)");
+
+	printf("  %-15s %-6s %4s %4s %4s %4s %8s %9s %9s %13s %13s %10s\n", "rates", "tier", "L", "M", "taps", "frac",
+		"table", "build", "cached", "C", "SIMD", "stop band");
+
+	for (pair = 0; pair < NUM_PAIRS; pair++) {
+
+		for (tier = 0; tier < POLYPHASE_NUM_TIERS; tier++) {
+
+			// the table built once, then found in the cache
+
+			start = now_seconds();
+			t     = polyphase_table(pairs[pair].in_rate, pairs[pair].out_rate, tier);
+			build = now_seconds() - start;
+
+			start  = now_seconds();
+			t      = polyphase_table(pairs[pair].in_rate, pairs[pair].out_rate, tier);
+			lookup = now_seconds() - start;
+
+			if (t == NULL) {
+
+				printf("  %5u -> %5u  %-6s no table\n", pairs[pair].in_rate, pairs[pair].out_rate,
+					tier_names[tier]);
+				failed++;
+				continue;
+			}
+
+			// the same input through the C and the SSE2 inner loops
+
+			polyphase_init(&pp, pairs[pair].in_rate, pairs[pair].out_rate, tier);
+			pp.simd = 0;
+
+			start     = now_seconds();
+			c_made    = run_resampler(&pp, in, len, c_out, out_len);
+			c_seconds = now_seconds() - start;
+
+			polyphase_release(&pp);
+			polyphase_init(&pp, pairs[pair].in_rate, pairs[pair].out_rate, tier);
+
+			start        = now_seconds();
+			simd_made    = run_resampler(&pp, in, len, simd_out, out_len);
+			simd_seconds = now_seconds() - start;
+
+			polyphase_release(&pp);
+
+			same = (c_made == simd_made) && !memcmp(c_out, simd_out, c_made * sizeof(st_sample_t));
+			failed += !same;
+
+			printf("  %5u -> %5u  %-6s %4u %4u %4u %4u %5.0f KB %6.2f ms %6.2f us %7.2f MS/s %7.2f MS/s %7.1f dB%s\n",
+				pairs[pair].in_rate, pairs[pair].out_rate, tier_names[tier], t->up, t->down, t->taps, t->shift,
+				t->up * t->taps * sizeof(s16) / 1024.0, build * 1e3, lookup * 1e6,
+				c_made / c_seconds / 1e6, simd_made / simd_seconds / 1e6, stopband_rejection(t),
+				same ? "" : "  MISMATCH");
+		}
+	}
+
+	printf("\n  C and SIMD outputs: %s\n", failed ? "FAIL" : "bit-exact");
+
+	// a held table survives the cache filling up many times over; the rest
+	// are evicted and built again
+
+	polyphase_init(&pp, pairs[0].in_rate, pairs[0].out_rate, POLYPHASE_LOW);
+	t = pp.table;
+	held = 1;
+
+	for (pair = 0; pair < NUM_PAIRS; pair++) {
+
+		for (tier = 0; tier < POLYPHASE_NUM_TIERS; tier++) {
+
+			held &= (polyphase_table(pairs[pair].in_rate, pairs[pair].out_rate, tier) != NULL);
+		}
+	}
+
+	held &= (polyphase_table(pairs[0].in_rate, pairs[0].out_rate, POLYPHASE_LOW) == t) && (t->coefs != NULL);
+	failed += !held;
+
+	polyphase_release(&pp);
+	polyphase_flush_cache();
+
+	printf("  cache of %d with %d tables: %s\n\n", POLYPHASE_CACHE_SIZE, NUM_PAIRS * POLYPHASE_NUM_TIERS,
+		held ? "evicts, keeps the held table" : "FAIL");
+
+	free(in);
+	free(c_out);
+	free(simd_out);
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,299 @@
+/**
+*
+* @file bench_reverb.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host benchmark for the FDN reverb engine (software/reverb.c) behind the
+* reverb effect. For each quality preset, with the delay lines in RAM and
+* in the ChorusBuffer BRAM (the hal_chorusbuffer.c model):
+*
+*	o the footprint: the lines' lengths, the bytes of RAM the network takes
+*	  (its state plus, in RAM, the lines) and the BRAM lines it takes
+*	o the speed in samples per second (best of three runs), as ns and as
+*	  timestamp-counter cycles per sample, against the 6250 cycles a sample
+*	  the MicroBlaze has at 100 MHz & 16 kHz; and for the BRAM lines the
+*	  AXI transactions per sample, what the board pays on top
+*	o the decay time, undamped, off the impulse response (Schroeder
+*	  integral, -5 to -25 dB, times three) against the 1000 ms asked for
+*
+* The RAM and BRAM lines have to give the same output bit for bit.
+*
+* Usage:
+*	bench_reverb [seconds]
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "xparameters.h"
+#include "hal.h"
+#include "ChorusBuffer.h"
+#include "delay_line.h"
+#include "reverb.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define SAMPLE_RATE			16000
+#define BLOCK_SIZE			64
+#define DEFAULT_SECONDS		8
+#define REPEATS				3
+#define DECAY_MS			1000.0
+#define IMPULSE_SECONDS		2
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static const char *preset_names[REVERB_NUM_PRESETS] = { "low", "medium", "high" };
+static const char *storage_names[2] = { "RAM", "BRAM" };
+
+static u32 rng_state = 0x1234567;
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long now_cycles(void) {
+
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static u32 rng_next(void) {
+
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return rng_state >> 8;
+}
+
+// bursts of noise at about -12 dBFS, 0.25 s on and 0.25 s off
+
+static void make_signal(st_sample_t *buf, st_size_t len) {
+
+	st_size_t i;
+
+	for (i = 0; i < len; i++) {
+
+		buf[i] = ((i / (SAMPLE_RATE / 4)) & 1) ? 0 :
+				 ST_SIGNED_WORD_TO_SAMPLE((s16) ((int) (rng_next() & 0x3FFF) - 0x2000));
+	}
+}
+
+// len samples through a network a block at a time
+
+static void run_reverb(reverb_t *rv, const st_sample_t *in, st_sample_t *out, st_size_t len) {
+
+	st_size_t done, n;
+
+	for (done = 0; done < len; done += n) {
+
+		n = MIN(len - done, BLOCK_SIZE);
+		reverb_flow(rv, in + done, out + done, n);
+	}
+}
+
+// the best of REPEATS runs of a fresh network, in seconds & cycles
+
+static double time_reverb(unsigned int preset, unsigned int storage, const st_sample_t *in,
+						  st_sample_t *out, st_size_t len, unsigned long long *cycles) {
+
+	reverb_t			rv;
+	unsigned int		rep;
+	unsigned long long	c;
+	double				start, seconds, best = 1e30;
+
+	*cycles = ~0ULL;
+
+	for (rep = 0; rep < REPEATS; rep++) {
+
+		reverb_init(&rv, SAMPLE_RATE, 1, preset, 0, storage);
+		reverb_set(&rv, DECAY_MS, 0.3, 0.3);
+
+		start   = now_seconds();
+		c       = now_cycles();
+		run_reverb(&rv, in, out, len);
+		c       = now_cycles() - c;
+		seconds = now_seconds() - start;
+
+		best    = MIN(best, seconds);
+		*cycles = MIN(*cycles, c);
+	}
+
+	return best;
+}
+
+// the undamped decay time to -60 dB, in ms, from the slope of the impulse
+// response's backward-integrated energy between -5 and -25 dB
+
+static double decay_time(unsigned int preset) {
+
+	st_size_t	len = IMPULSE_SECONDS * SAMPLE_RATE, i, t5 = 0, t25 = 0;
+	st_sample_t	*ir = calloc(len, sizeof(st_sample_t));
+	double		*energy = malloc(len * sizeof(double));
+	double		x, total;
+	reverb_t	rv;
+
+	if ((ir == NULL) || (energy == NULL)) {
+
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+
+	reverb_init(&rv, SAMPLE_RATE, 1, preset, 0, REVERB_STORAGE_RAM);
+	reverb_set(&rv, DECAY_MS, 0.0, 1.0);
+
+	ir[0] = ST_SIGNED_WORD_TO_SAMPLE(PCM_MAX);
+	run_reverb(&rv, ir, ir, len);
+
+	for (i = len, total = 0.0; i-- > 0; ) {
+
+		x         = ST_SAMPLE_TO_SIGNED_WORD(ir[i]);
+		total    += x * x;
+		energy[i] = total;
+	}
+
+	for (i = 0; i < len; i++) {
+
+		x = 10.0 * log10(MAX(energy[i], 1e-12) / energy[0]);
+
+		if ((t5 == 0) && (x <= -5.0)) {
+			t5 = i;
+		}
+
+		if ((t25 == 0) && (x <= -25.0)) {
+			t25 = i;
+			break;
+		}
+	}
+
+	free(ir);
+	free(energy);
+
+	return (t25 > t5) ? 3.0 * (t25 - t5) * 1000.0 / SAMPLE_RATE : 0.0;
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	unsigned int		seconds = (argc > 1) ? (unsigned int) atoi(argv[1]) : DEFAULT_SECONDS;
+	unsigned int		preset, storage, i, ram, failed = 0;
+	unsigned long long	cycles;
+	st_sample_t			*in, *out[2];
+	st_size_t			len;
+	double				t;
+	hal_io_stats_t		stats;
+	reverb_t			rv;
+	int					same;
+
+	if (seconds == 0) {
+		seconds = DEFAULT_SECONDS;
+	}
+
+	hal_chorusbuffer_init();
+
+	if (ChorusBuffer_initialize(XPAR_CHORUSBUFFER_0_S00_AXI_BASEADDR) != XST_SUCCESS) {
+
+		fprintf(stderr, "driver self-test failed\n");
+		return EXIT_FAILURE;
+	}
+
+	len    = (st_size_t) seconds * SAMPLE_RATE;
+	in     = malloc(len * sizeof(st_sample_t));
+	out[0] = malloc(len * sizeof(st_sample_t));
+	out[1] = malloc(len * sizeof(st_sample_t));
+
+	if ((in == NULL) || (out[0] == NULL) || (out[1] == NULL)) {
+
+		fprintf(stderr, "out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	make_signal(in, len);
+
+	printf("\nFDN reverb, %u s of 16 kHz mono per run, %d samples a block, %d ms decay, RAM pool %d bytes\n\n",
+		seconds, BLOCK_SIZE, (int) DECAY_MS, REVERB_POOL_BYTES);
+
+	printf("  %-6s %-5s %7s %15s %9s %6s %11s %11s %14s %9s %8s\n", "preset", "lines", "budget", "line lengths",
+		"RAM", "BRAM", "speed", "ns/sample", "cycles/sample", "AXI/samp", "T60/match");
+
+	for (preset = 0; preset < REVERB_NUM_PRESETS; preset++) {
+
+		for (storage = REVERB_STORAGE_RAM; storage <= REVERB_STORAGE_BRAM; storage++) {
+
+			if (reverb_init(&rv, SAMPLE_RATE, 1, preset, 0, storage) != XST_SUCCESS) {
+
+				printf("  %-6s %-5s does not fit\n", preset_names[preset], storage_names[storage]);
+				failed++;
+				continue;
+			}
+
+			ram = sizeof(reverb_t) + ((storage == REVERB_STORAGE_RAM) ? rv.bytes : 0);
+
+			hal_io_clear_stats();
+			t = time_reverb(preset, storage, in, out[storage], len, &cycles);
+			hal_io_get_stats(&stats);
+
+			printf("  %-6s %-5s %5u B %5.1f-%5.1f ms %7u B %6u %6.2f MS/s %11.1f %14.1f",
+				preset_names[preset], storage_names[storage], rv.bytes,
+				rv.line[0].length * 1000.0 / SAMPLE_RATE,
+				rv.line[REVERB_LINES - 1].length * 1000.0 / SAMPLE_RATE, ram,
+				(storage == REVERB_STORAGE_BRAM) ? rv.bytes / 2 : 0, len / t / 1e6, t * 1e9 / len,
+				(double) cycles / len);
+
+			if (storage == REVERB_STORAGE_RAM) {
+
+				printf(" %9s %5.0f ms\n", "-", decay_time(preset));
+				continue;
+			}
+
+			same = !memcmp(out[REVERB_STORAGE_RAM], out[REVERB_STORAGE_BRAM], len * sizeof(st_sample_t));
+			failed += !same;
+
+			printf(" %9.2f %8s\n", (double) (stats.reads + stats.writes) / (REPEATS * len),
+				same ? "same" : "MISMATCH");
+		}
+	}
+
+	printf("\n  lines:");
+
+	for (i = 0; i < REVERB_LINES; i++) {
+		printf(" %u", rv.line[i].length);
+	}
+
+	printf(" (high)\n  MicroBlaze: %d cycles a sample at %d MHz & 16 kHz\n",
+		XPAR_CPU_CORE_CLOCK_FREQ_HZ / SAMPLE_RATE, XPAR_CPU_CORE_CLOCK_FREQ_HZ / 1000000);
+
+	printf("\n  RAM and BRAM lines: %s\n\n", failed ? "FAIL" : "bit-exact");
+
+	free(in);
+	free(out[0]);
+	free(out[1]);
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
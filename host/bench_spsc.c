@@ -0,0 +1,314 @@
+/**
+*
+* @file bench_spsc.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host stress test & benchmark for the lock-free SPSC ring in
+* software/spsc_ring.c. A producer and a consumer thread pass a running
+* count through the ring:
+*
+*	o words: spsc_ring_push() / spsc_ring_pop(), one word at a time, as
+*	  the interrupt handlers and the main loop use them
+*	o blocks: spsc_ring_write() of random lengths up to the ring size
+*	  against spsc_ring_read() of other random lengths, so blocks are cut,
+*	  joined and split across the end of the storage
+*
+* The consumer checks every word it gets against the count; a torn or
+* reordered hand-over shows up as a mismatch. Each case runs for a range of
+* ring sizes down to 2 words, where the two sides collide constantly. A side
+* that finds the ring full or empty yields, so the test also runs on a
+* single core. The same word pass through a ring guarded by a pthread mutex
+* gives a locked baseline for the throughput.
+*
+* Usage:
+*	bench_spsc [million_words]
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include "xil_types.h"
+#include "spsc_ring.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define DEFAULT_MILLIONS	4
+#define MAX_RING_SIZE		4096
+#define BLOCK_MAX			64
+
+#define MODE_WORDS			0
+#define MODE_BLOCKS			1
+#define MODE_LOCKED			2
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct run {
+
+	spsc_ring_t			ring;
+	unsigned int		mode;
+	unsigned long		words;
+	unsigned long		mismatches;
+
+	// the locked baseline: a plain ring under one mutex
+
+	pthread_mutex_t		lock;
+	u32					head, tail;
+
+} run_t;
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static u32 storage[MAX_RING_SIZE];
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static u32 rng_next(u32 *state) {
+
+	*state = *state * 1664525u + 1013904223u;
+	return *state >> 8;
+}
+
+static int locked_push(run_t *r, u32 word) {
+
+	int ok;
+
+	pthread_mutex_lock(&r->lock);
+
+	if ((ok = ((r->head - r->tail) <= r->ring.mask))) {
+		r->ring.data[r->head++ & r->ring.mask] = word;
+	}
+
+	pthread_mutex_unlock(&r->lock);
+
+	return ok;
+}
+
+static int locked_pop(run_t *r, u32 *word) {
+
+	int ok;
+
+	pthread_mutex_lock(&r->lock);
+
+	if ((ok = (r->tail != r->head))) {
+		*word = r->ring.data[r->tail++ & r->ring.mask];
+	}
+
+	pthread_mutex_unlock(&r->lock);
+
+	return ok;
+}
+
+// producer thread: the counts 0 .. words-1, waiting out a full ring
+
+static void *producer(void *arg) {
+
+	run_t			*r = (run_t *) arg;
+	u32				block[BLOCK_MAX];
+	u32				rng = 0x7F4A7C15;
+	unsigned long	n = 0;
+	unsigned int	count, i;
+
+	while (n < r->words) {
+
+		switch (r->mode) {
+
+			case MODE_WORDS:
+
+				if (spsc_ring_push(&r->ring, (u32) n)) {
+					n++;
+				}
+
+				else {
+					sched_yield();
+				}
+
+				break;
+
+			case MODE_LOCKED:
+
+				if (locked_push(r, (u32) n)) {
+					n++;
+				}
+
+				else {
+					sched_yield();
+				}
+
+				break;
+
+			default:
+
+				count = 1 + rng_next(&rng) % BLOCK_MAX;
+				count = (count <= r->ring.mask + 1) ? count : r->ring.mask + 1;
+				count = (count <= r->words - n) ? count : (unsigned int) (r->words - n);
+
+				for (i = 0; i < count; i++) {
+					block[i] = (u32) (n + i);
+				}
+
+				while (spsc_ring_write(&r->ring, block, count) == 0) {
+					sched_yield();
+				}
+
+				n += count;
+				break;
+		}
+	}
+
+	return NULL;
+}
+
+// consumer, on the calling thread: every word has to be the next count
+
+static void consume(run_t *r) {
+
+	u32				block[BLOCK_MAX];
+	u32				rng = 0x2C1B3C6D;
+	u32				word;
+	unsigned long	n = 0;
+	unsigned int	count, i;
+
+	while (n < r->words) {
+
+		switch (r->mode) {
+
+			case MODE_WORDS:
+			case MODE_LOCKED:
+
+				if ((r->mode == MODE_WORDS) ? spsc_ring_pop(&r->ring, &word) : locked_pop(r, &word)) {
+
+					r->mismatches += (word != (u32) n);
+					n++;
+				}
+
+				else {
+					sched_yield();
+				}
+
+				break;
+
+			default:
+
+				count = spsc_ring_read(&r->ring, block, 1 + rng_next(&rng) % BLOCK_MAX);
+
+				for (i = 0; i < count; i++) {
+					r->mismatches += (block[i] != (u32) (n + i));
+				}
+
+				if (count == 0) {
+					sched_yield();
+				}
+
+				n += count;
+				break;
+		}
+	}
+
+	return;
+}
+
+// one producer / consumer pass; returns the words per second
+
+static double run_case(unsigned int mode, unsigned int size, unsigned long words, unsigned long *mismatches) {
+
+	static run_t	r;
+	pthread_t		thread;
+	double			start, seconds;
+
+	spsc_ring_init(&r.ring, storage, size);
+	pthread_mutex_init(&r.lock, NULL);
+
+	r.mode       = mode;
+	r.words      = words;
+	r.mismatches = 0;
+	r.head       = 0;
+	r.tail       = 0;
+
+	start = now_seconds();
+
+	if (pthread_create(&thread, NULL, producer, &r) != 0) {
+
+		perror("pthread_create");
+		exit(EXIT_FAILURE);
+	}
+
+	consume(&r);
+	pthread_join(thread, NULL);
+
+	seconds = now_seconds() - start;
+
+	pthread_mutex_destroy(&r.lock);
+	*mismatches += r.mismatches;
+
+	return words / seconds;
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	static const unsigned int sizes[] = { 2, 16, 256, MAX_RING_SIZE };
+
+	unsigned long	millions = (argc > 1) ? strtoul(argv[1], NULL, 0) : DEFAULT_MILLIONS;
+	unsigned long	words = millions * 1000000ul;
+	unsigned long	mismatches, failed = 0;
+	double			rate[3];
+	unsigned int	s, mode;
+
+	if (words == 0) {
+
+		fprintf(stderr, "million_words must be at least 1\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("\nSPSC ring, %lu words per case, %d-byte cache line: head at offset %zu, tail at %zu\n\n",
+		words, SPSC_CACHE_LINE, offsetof(spsc_ring_t, head), offsetof(spsc_ring_t, tail));
+
+	printf("  %6s %16s %16s %16s\n", "size", "words/s", "blocks (words/s)", "mutex (words/s)");
+
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+
+		mismatches = 0;
+
+		for (mode = MODE_WORDS; mode <= MODE_LOCKED; mode++) {
+			rate[mode] = run_case(mode, sizes[s], words, &mismatches);
+		}
+
+		failed += (mismatches != 0);
+
+		printf("  %6u %16.0f %16.0f %16.0f  %s (%lu mismatches)\n", sizes[s],
+			rate[MODE_WORDS], rate[MODE_BLOCKS], rate[MODE_LOCKED],
+			mismatches ? "FAIL" : "in order", mismatches);
+	}
+
+	printf("\n");
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
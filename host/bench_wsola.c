@@ -0,0 +1,345 @@
+/**
+*
+* @file bench_wsola.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host benchmark for the WSOLA engine (software/wsola.c) behind the pitch
+* and stretch effects, run through the effects' handlers as a chain would
+* run them, 64 samples a block at 16 kHz. For each pitch shift and stretch
+* factor:
+*
+*	o the speed in samples per second, and timestamp-counter cycles per
+*	  sample on average and for the worst block (one with a hop's search in
+*	  it), the best of three runs, against the 6250 cycles a sample the
+*	  MicroBlaze has at 100 MHz & 16 kHz
+*	o the output's length after the drain, against the input's times the
+*	  stretch factor (exactly)
+*	o the output's pitch, off the autocorrelation of a second in the
+*	  middle, against the input tone's times the pitch ratio (within 1%)
+*
+* The pitch effect runs in place too, and has to give the same output.
+* The multiply-adds a search takes, and what they come to on the MicroBlaze,
+* are printed below the table.
+*
+* Usage:
+*	bench_wsola [seconds]
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "xparameters.h"
+#include "delay_line.h"
+#include "st_i.h"
+#include "wsola.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define SAMPLE_RATE			16000
+#define BLOCK_SIZE			64
+#define DEFAULT_SECONDS		4
+#define NUM_RUNS			9
+#define REPEATS				3
+#define TONE_HZ				200.0
+#define MIN_LAG				(SAMPLE_RATE / 1000)
+#define MAX_LAG				(SAMPLE_RATE / 50)
+
+// MicroBlaze estimate: cycles a multiply-add, and a 64-bit divide
+
+#define MB_MAC_CYCLES		5
+#define MB_DIV_CYCLES		100
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct run {
+
+	const char		*effect;
+	const char		*arg;
+	double			stretch;			// output length over input
+	double			pitch;				// output pitch over input
+
+} run_t;
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static const run_t runs[NUM_RUNS] = {
+
+	{ "pitch",   "-1200", 1.0,  0.5       },
+	{ "pitch",   "-500",  1.0,  0.7491535 },
+	{ "pitch",   "0",     1.0,  1.0       },
+	{ "pitch",   "700",   1.0,  1.4983071 },
+	{ "pitch",   "1200",  1.0,  2.0       },
+	{ "stretch", "0.5",   0.5,  1.0       },
+	{ "stretch", "0.8",   0.8,  1.0       },
+	{ "stretch", "1.5",   1.5,  1.0       },
+	{ "stretch", "2",     2.0,  1.0       }
+};
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long now_cycles(void) {
+
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+// a 200 Hz tone, five harmonics falling off as 1/k, at about -12 dBFS
+
+static void make_signal(st_sample_t *buf, st_size_t len) {
+
+	st_size_t	i;
+	double		x;
+	int			k;
+
+	for (i = 0; i < len; i++) {
+
+		for (k = 1, x = 0.0; k <= 5; k++) {
+			x += sin(2.0 * M_PI * TONE_HZ * k * i / SAMPLE_RATE) / k;
+		}
+
+		buf[i] = ST_SIGNED_WORD_TO_SAMPLE((s16) (x * 3600.0));
+	}
+}
+
+// the pitch in Hz of a second of buf from start: the first autocorrelation
+// peak within 10% of the highest, between 50 Hz and 1 kHz, interpolated
+
+static double measure_pitch(const st_sample_t *buf, st_size_t start) {
+
+	static double	r[MAX_LAG + 2];
+	st_size_t		i, len = SAMPLE_RATE;
+	int				lag, peak = 0;
+	double			top = 0.0, a, b, c, d;
+
+	for (lag = MIN_LAG - 1; lag <= MAX_LAG + 1; lag++) {
+
+		for (i = 0, r[lag] = 0.0; i < len; i++) {
+			r[lag] += (double) ST_SAMPLE_TO_SIGNED_WORD(buf[start + i]) * ST_SAMPLE_TO_SIGNED_WORD(buf[start + i + lag]);
+		}
+
+		if (lag >= MIN_LAG) {
+			top = MAX(top, r[lag]);
+		}
+	}
+
+	for (lag = MIN_LAG; lag <= MAX_LAG; lag++) {
+
+		if ((r[lag] >= 0.9 * top) && (r[lag] >= r[lag - 1]) && (r[lag] >= r[lag + 1])) {
+
+			peak = lag;
+			break;
+		}
+	}
+
+	if (peak == 0) {
+		return 0.0;
+	}
+
+	a = r[peak - 1];
+	b = r[peak];
+	c = r[peak + 1];
+	d = (a - 2.0 * b + c != 0.0) ? 0.5 * (a - c) / (a - 2.0 * b + c) : 0.0;
+
+	return SAMPLE_RATE / (peak + d);
+}
+
+// the input through an effect, BLOCK_SIZE at a time (in place if asked),
+// then drained; returns the samples out, and the cycles in all the flows
+// and in the slowest one
+
+static st_size_t run_effect(const run_t *run, int inplace, const st_sample_t *in, st_size_t len,
+							st_sample_t *out, st_size_t out_len, unsigned long long *cycles,
+							unsigned long long *worst) {
+
+	static struct st_effect	eff;
+	char					*argv[1];
+	st_sample_t				block[BLOCK_SIZE];
+	st_size_t				done = 0, made = 0, isamp, osamp;
+	unsigned long long		c;
+
+	memset(&eff, 0, sizeof(eff));
+	argv[0] = (char *) run->arg;
+
+	eff.ininfo.rate      = SAMPLE_RATE;
+	eff.ininfo.channels  = 1;
+	eff.outinfo          = eff.ininfo;
+
+	if ((st_geteffect(&eff, (char *) run->effect) != ST_SUCCESS) ||
+		(eff.h->getopts(&eff, 1, argv) != ST_SUCCESS) || (eff.h->start(&eff) != ST_SUCCESS)) {
+
+		return 0;
+	}
+
+	*cycles = 0;
+	*worst  = 0;
+
+	while ((done < len) && (made + BLOCK_SIZE <= out_len)) {
+
+		isamp = MIN(len - done, BLOCK_SIZE);
+		osamp = BLOCK_SIZE;
+
+		if (inplace) {
+
+			memcpy(block, in + done, isamp * sizeof(st_sample_t));
+			osamp = isamp;
+		}
+
+		c = now_cycles();
+		eff.h->flow(&eff, inplace ? block : (st_sample_t *) in + done, inplace ? block : out + made, &isamp, &osamp);
+		c = now_cycles() - c;
+
+		if (inplace) {
+			memcpy(out + made, block, osamp * sizeof(st_sample_t));
+		}
+
+		*cycles += c;
+		*worst   = MAX(*worst, c);
+
+		done += isamp;
+		made += osamp;
+	}
+
+	do {
+
+		osamp = MIN(out_len - made, BLOCK_SIZE);
+		eff.h->drain(&eff, out + made, &osamp);
+		made += osamp;
+
+	} while (osamp > 0);
+
+	eff.h->stop(&eff);
+
+	return made;
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	unsigned int		seconds = (argc > 1) ? (unsigned int) atoi(argv[1]) : DEFAULT_SECONDS;
+	unsigned int		i, rep, failed = 0, macs, coarse, fine, mb_search, mb_block;
+	unsigned long long	cycles, worst, c2, w2;
+	st_sample_t			*in, *out, *out2;
+	st_size_t			len, out_len, made, made2, want;
+	double				start, t, best, f, f_want;
+	int					same, ok;
+	wsola_t				ws;
+
+	if (seconds < 3) {
+		seconds = DEFAULT_SECONDS;
+	}
+
+	len     = (st_size_t) seconds * SAMPLE_RATE;
+	out_len = (st_size_t) (len * (1.0 / WSOLA_MIN_SPEED)) + 4 * BLOCK_SIZE;
+	in      = malloc(len * sizeof(st_sample_t));
+	out     = malloc(out_len * sizeof(st_sample_t));
+	out2    = malloc(out_len * sizeof(st_sample_t));
+
+	if ((in == NULL) || (out == NULL) || (out2 == NULL)) {
+
+		fprintf(stderr, "out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	make_signal(in, len);
+
+	printf("\nWSOLA pitch & stretch, %u s of a %.0f Hz tone at 16 kHz per run, %d samples a block\n\n",
+		seconds, TONE_HZ, BLOCK_SIZE);
+
+	printf("  %-14s %10s %14s %14s %14s %10s %9s\n", "effect", "speed", "cycles/sample", "worst block",
+		"length/match", "pitch", "in place");
+
+	for (i = 0; i < NUM_RUNS; i++) {
+
+		// the best of REPEATS runs, so the worst block is the effect's own
+
+		for (rep = 0, best = 1e30, cycles = worst = ~0ULL; rep < REPEATS; rep++) {
+
+			start  = now_seconds();
+			made   = run_effect(&runs[i], 0, in, len, out, out_len, &c2, &w2);
+			t      = now_seconds() - start;
+			best   = MIN(best, t);
+			cycles = MIN(cycles, c2);
+			worst  = MIN(worst, w2);
+		}
+
+		want   = (st_size_t) (len * runs[i].stretch + 0.5);
+		f      = (made > SAMPLE_RATE + MAX_LAG + 2) ? measure_pitch(out, (made - SAMPLE_RATE - MAX_LAG) / 2) : 0.0;
+		f_want = TONE_HZ * runs[i].pitch;
+		ok     = (made == want) && (fabs(f / f_want - 1.0) < 0.01);
+
+		// the pitch effect works in place as well
+
+		same = 1;
+
+		if (!strcmp(runs[i].effect, "pitch")) {
+
+			made2 = run_effect(&runs[i], 1, in, len, out2, out_len, &c2, &w2);
+			same  = (made2 == made) && !memcmp(out, out2, made * sizeof(st_sample_t));
+		}
+
+		failed += !ok + !same;
+
+		printf("  %-7s %6s %6.2f MS/s %14.1f %14llu %7u/%-6s %6.1f Hz %9s%s\n", runs[i].effect, runs[i].arg,
+			made / best / 1e6, (double) cycles / len, worst, made, (made == want) ? "ok" : "BAD", f,
+			strcmp(runs[i].effect, "pitch") ? "-" : (same ? "same" : "MISMATCH"), ok ? "" : "  FAIL");
+	}
+
+	// the search's cost, and the worst block's on the MicroBlaze
+
+	wsola_init(&ws, SAMPLE_RATE, 1.0, 1.0);
+
+	macs      = wsola_search_cost(&ws);
+	coarse    = 2 * ws.seek / WSOLA_DECIM + 1;
+	fine      = 2 * WSOLA_DECIM - 1;
+	mb_search = macs * MB_MAC_CYCLES + (coarse + fine) * MB_DIV_CYCLES;
+	mb_block  = mb_search + 2 * ws.overlap * MB_MAC_CYCLES + BLOCK_SIZE * 30;
+
+	printf("\n  search: %u coarse positions of %u samples, %u fine of %u; %u multiply-adds, %u divides\n",
+		coarse, ws.overlap / WSOLA_DECIM, fine, ws.overlap, macs, coarse + fine);
+
+	printf("  MicroBlaze, at ~%d cycles a multiply-add & ~%d a divide: ~%u cycles a search, ~%u for the\n"
+		"  worst block, %.1f%% of the %d a block has at %d MHz & 16 kHz\n", MB_MAC_CYCLES, MB_DIV_CYCLES,
+		mb_search, mb_block, 100.0 * mb_block / (BLOCK_SIZE * (XPAR_CPU_CORE_CLOCK_FREQ_HZ / SAMPLE_RATE)),
+		BLOCK_SIZE * (XPAR_CPU_CORE_CLOCK_FREQ_HZ / SAMPLE_RATE), XPAR_CPU_CORE_CLOCK_FREQ_HZ / 1000000);
+
+	printf("\n  lengths, pitch & in place: %s\n\n", failed ? "FAIL" : "ok");
+
+	free(in);
+	free(out);
+	free(out2);
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,24 @@
+/**
+*
+* @file PMod544IOR2.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host (Linux) stand-in for the PMod544IOR2 driver, which ships with the
+* course IP and is not part of this repository. Only the calls made by
+* init_peripherals() are provided, and they do nothing.
+*/
+
+#ifndef PMOD544IOR2_H
+#define PMOD544IOR2_H
+
+#include "stdbool.h"
+#include "xil_types.h"
+#include "xstatus.h"
+
+static inline int  PMDIO_initialize(u32 BaseAddr)		{ (void) BaseAddr; return XST_SUCCESS; }
+static inline void PMDIO_ROT_init(int inc, bool zeroNeg)	{ (void) inc; (void) zeroNeg; }
+static inline void PMDIO_ROT_clear(void)				{ }
+
+#endif
@@ -0,0 +1,21 @@
+/**
+*
+* @file mb_interface.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host (Linux) stand-in for the MicroBlaze intrinsics used by the application.
+* The interrupt enable is tracked by the host XIntc model (host/hal_intc.c),
+* which also implements mb_sleep() as a wait for the next interrupt.
+*/
+
+#ifndef MB_INTERFACE_H
+#define MB_INTERFACE_H
+
+void microblaze_enable_interrupts(void);
+void microblaze_disable_interrupts(void);
+
+void mb_sleep(void);
+
+#endif
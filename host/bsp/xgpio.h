@@ -0,0 +1,34 @@
+/**
+*
+* @file xgpio.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host (Linux) stand-in for the AXI GPIO driver. Each instance is backed by
+* a model in host/hal_gpio.c; the benchmarks drive the switches & buttons
+* from there and the interrupt fires through the host XIntc model.
+*/
+
+#ifndef XGPIO_H
+#define XGPIO_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+typedef struct {
+
+	u16			DeviceId;
+	u32			IsReady;
+
+} XGpio;
+
+int  XGpio_Initialize(XGpio *InstancePtr, u16 DeviceId);
+void XGpio_SetDataDirection(XGpio *InstancePtr, unsigned Channel, u32 DirectionMask);
+u32  XGpio_DiscreteRead(XGpio *InstancePtr, unsigned Channel);
+void XGpio_DiscreteWrite(XGpio *InstancePtr, unsigned Channel, u32 Data);
+void XGpio_InterruptGlobalEnable(XGpio *InstancePtr);
+void XGpio_InterruptEnable(XGpio *InstancePtr, u32 Mask);
+void XGpio_InterruptClear(XGpio *InstancePtr, u32 Mask);
+
+#endif
@@ -0,0 +1,24 @@
+/**
+*
+* @file xil_io.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host (Linux) stand-in for the Xilinx standalone BSP header of the same name.
+*
+* On the board these calls become single loads & stores on the AXI bus. On the
+* host they are routed to the register models in host/hal_*.c, which behave
+* like the custom IP so the drivers can run unmodified.
+*/
+
+#ifndef XIL_IO_H
+#define XIL_IO_H
+
+#include "xil_types.h"
+#include "xil_printf.h"
+
+u32  Xil_In32(UINTPTR Addr);
+void Xil_Out32(UINTPTR Addr, u32 Value);
+
+#endif
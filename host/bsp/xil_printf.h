@@ -0,0 +1,23 @@
+/**
+*
+* @file xil_printf.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host (Linux) stand-in for the Xilinx standalone BSP header of the same name.
+* Both print functions go to stdout, so the board's console messages show up
+* in the terminal when the application is run on the host.
+*/
+
+#ifndef XIL_PRINTF_H
+#define XIL_PRINTF_H
+
+#include <stdio.h>
+
+#define xil_printf		printf
+#define print(s)		fputs((s), stdout)
+
+void outbyte(char c);
+
+#endif
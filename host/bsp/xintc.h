@@ -0,0 +1,39 @@
+/**
+*
+* @file xintc.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host (Linux) stand-in for the AXI interrupt controller driver. There are
+* no real interrupts on the host: hal_intc_raise() (host/hal.h) calls the
+* connected handler directly when the source is enabled and the controller
+* is started, which is all the application relies on.
+*/
+
+#ifndef XINTC_H
+#define XINTC_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XIN_SIMULATION_MODE		0
+#define XIN_REAL_MODE			1
+
+typedef void (*XInterruptHandler)(void *CallBackRef);
+
+typedef struct {
+
+	u16			DeviceId;
+	u32			IsReady;
+	u32			IsStarted;
+
+} XIntc;
+
+int  XIntc_Initialize(XIntc *InstancePtr, u16 DeviceId);
+int  XIntc_Connect(XIntc *InstancePtr, u8 Id, XInterruptHandler Handler, void *CallBackRef);
+int  XIntc_Start(XIntc *InstancePtr, u8 Mode);
+void XIntc_Enable(XIntc *InstancePtr, u8 Id);
+void XIntc_Disable(XIntc *InstancePtr, u8 Id);
+
+#endif
@@ -0,0 +1,67 @@
+/**
+*
+* @file xparameters.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host (Linux) stand-in for the xparameters.h generated by the SDK.
+* The base addresses match the address editor in the Vivado block design,
+* but they are only used by the host register models to decode accesses.
+*/
+
+#ifndef XPARAMETERS_H
+#define XPARAMETERS_H
+
+// Processor
+
+#define XPAR_CPU_CORE_CLOCK_FREQ_HZ				100000000
+
+// GPIO
+
+#define XPAR_BTN_5BIT_DEVICE_ID					0
+#define XPAR_SW_16BIT_DEVICE_ID					1
+#define XPAR_LED_16BIT_DEVICE_ID				2
+#define XPAR_XGPIO_NUM_INSTANCES				3
+
+// Interrupt controller
+
+#define XPAR_INTC_0_DEVICE_ID					0
+#define XPAR_INTC_MAX_NUM_INTR_INPUTS			32
+
+#define XPAR_MICROBLAZE_0_AXI_INTC_INPUTBUFFER_0_INTERRUPT_INTR	0
+#define XPAR_MICROBLAZE_0_AXI_INTC_BTN_5BIT_IP2INTC_IRPT_INTR		1
+#define XPAR_MICROBLAZE_0_AXI_INTC_SW_16BIT_IP2INTC_IRPT_INTR		2
+
+// Timer
+
+#define XPAR_TMRCTR_0_DEVICE_ID					0
+#define XPAR_TMRCTR_0_BASEADDR					0x41C00000
+#define XPAR_TMRCTR_0_HIGHADDR					0x41C0FFFF
+#define XPAR_TMRCTR_0_CLOCK_FREQ_HZ				100000000
+
+// PMod544IOR2 (no register model; the stub driver ignores it)
+
+#define XPAR_PMOD544IOR2_0_DEVICE_ID			0
+#define XPAR_PMOD544IOR2_0_S00_AXI_BASEADDR		0x44A30000
+#define XPAR_PMOD544IOR2_0_S00_AXI_HIGHADDR		0x44A3FFFF
+
+// InputBuffer
+
+#define XPAR_INPUTBUFFER_0_DEVICE_ID			0
+#define XPAR_INPUTBUFFER_0_S00_AXI_BASEADDR		0x44A20000
+#define XPAR_INPUTBUFFER_0_S00_AXI_HIGHADDR		0x44A2FFFF
+
+// ChorusBuffer
+
+#define XPAR_CHORUSBUFFER_0_DEVICE_ID			0
+#define XPAR_CHORUSBUFFER_0_S00_AXI_BASEADDR	0x44A00000
+#define XPAR_CHORUSBUFFER_0_S00_AXI_HIGHADDR	0x44A0FFFF
+
+// DelayBuffer
+
+#define XPAR_DELAYBUFFER_0_DEVICE_ID			0
+#define XPAR_DELAYBUFFER_0_S00_AXI_BASEADDR		0x44A10000
+#define XPAR_DELAYBUFFER_0_S00_AXI_HIGHADDR		0x44A1FFFF
+
+#endif
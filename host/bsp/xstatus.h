@@ -0,0 +1,24 @@
+/**
+*
+* @file xstatus.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host (Linux) stand-in for the Xilinx standalone BSP header of the same name.
+*/
+
+#ifndef XSTATUS_H
+#define XSTATUS_H
+
+#include "xil_types.h"
+
+typedef s32 XStatus;
+
+#define XST_SUCCESS					0L
+#define XST_FAILURE					1L
+#define XST_DEVICE_NOT_FOUND		2L
+#define XST_DEVICE_IS_STARTED		5L
+#define XST_INVALID_PARAM			15L
+
+#endif
@@ -0,0 +1,60 @@
+/**
+*
+* @file xtmrctr.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host (Linux) stand-in for the AXI Timer driver. Only the calls and the
+* register access macros used by the application are provided; the timer
+* itself is a register model in host/hal_tmrctr.c that counts at
+* XPAR_TMRCTR_0_CLOCK_FREQ_HZ off the host monotonic clock.
+*/
+
+#ifndef XTMRCTR_H
+#define XTMRCTR_H
+
+#include "xil_types.h"
+#include "xil_io.h"
+#include "xstatus.h"
+
+// Register offsets (per timer) and timer spacing
+
+#define XTC_TCSR_OFFSET				0
+#define XTC_TLR_OFFSET				4
+#define XTC_TCR_OFFSET				8
+#define XTC_TIMER_COUNTER_OFFSET	16
+
+// Control / status register bits
+
+#define XTC_CSR_DOWN_COUNT_MASK		0x00000002
+#define XTC_CSR_AUTO_RELOAD_MASK	0x00000010
+#define XTC_CSR_LOAD_MASK			0x00000020
+#define XTC_CSR_ENABLE_TMR_MASK		0x00000080
+
+// Options for XTmrCtr_SetOptions
+
+#define XTC_AUTO_RELOAD_OPTION		0x00000004
+#define XTC_DOWN_COUNT_OPTION		0x00000020
+
+typedef struct {
+
+	UINTPTR		BaseAddress;
+	u32			IsReady;
+
+} XTmrCtr;
+
+#define XTmrCtr_ReadReg(BaseAddress, TmrCtrNumber, RegOffset) \
+	Xil_In32((BaseAddress) + ((TmrCtrNumber) * XTC_TIMER_COUNTER_OFFSET) + (RegOffset))
+
+#define XTmrCtr_WriteReg(BaseAddress, TmrCtrNumber, RegOffset, ValueToWrite) \
+	Xil_Out32((BaseAddress) + ((TmrCtrNumber) * XTC_TIMER_COUNTER_OFFSET) + (RegOffset), (ValueToWrite))
+
+int  XTmrCtr_Initialize(XTmrCtr *InstancePtr, u16 DeviceId);
+void XTmrCtr_SetOptions(XTmrCtr *InstancePtr, u8 TmrCtrNumber, u32 Options);
+void XTmrCtr_SetResetValue(XTmrCtr *InstancePtr, u8 TmrCtrNumber, u32 ResetValue);
+void XTmrCtr_Start(XTmrCtr *InstancePtr, u8 TmrCtrNumber);
+void XTmrCtr_Stop(XTmrCtr *InstancePtr, u8 TmrCtrNumber);
+u32  XTmrCtr_GetValue(XTmrCtr *InstancePtr, u8 TmrCtrNumber);
+
+#endif
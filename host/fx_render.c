@@ -0,0 +1,465 @@
+/**
+*
+* @file fx_render.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Offline renderer for the board's effect modes. Reads a WAV or raw file
+* through the Sound Tools format handlers (st_wavstartread() /
+* st_rawstartread()), runs it through the effect chain of each sw[1:0] mode
+* (select_fx_chain(), the same audio_fx.c / chorus.c / delay_line.c code and
+* parameters the board runs, on the host models of the buffers), and writes
+* the result with st_wavstartwrite(). Multi-channel input is mixed down to
+* mono, as the board has one channel. Each mode reports its samples per
+* second and realtime factor, so a regression in the effect code shows up
+* as a number.
+*
+* The delay runs in software: the DelayBuffer echo engine only mixes the
+* taps into what AudioOutput plays, which a file never hears. The chorus
+* runs on the ChorusBuffer voice generator model as on the board, or in
+* software with -c sw. The effect times are set for 16 kHz, so input at
+* another rate goes through the resample effect (polyphase.c) to 16 kHz
+* ahead of the mode's effects and back to its own rate after them, all in
+* the one chain. The rate conversions count in the samples per second.
+*
+* Usage:
+*	fx_render [-m mode] [-c hw|sw] [-l latency_spins] [-t type] [-r rate] [-q tier] in out
+*
+*	-m	sw[1:0] mode 0-3 (default: all four, to out-sw0 .. out-sw3)
+*	-c	chorus engine (default hw)
+*	-l	busy-wait per bus access, as in the benches (default 0)
+*	-t	input file type when the suffix does not say (wav or raw)
+*	-r	sample rate of raw input (default 16000); raw is 16-bit signed
+*		mono in host byte order
+*	-q	resampler quality, low, medium or high (default medium), for
+*		input not at 16000 Hz
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include "xparameters.h"
+#include "hal.h"
+#include "ChorusBuffer.h"
+#include "DelayBuffer.h"
+#include "InputBuffer.h"
+#include "audio_fx.h"
+#include "fx_chain.h"
+#include "polyphase.h"
+#include "st_i.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define ALL_MODES			FX_NUM_CHAINS
+#define MAX_CHANNELS		8
+#define RATE_POOL_LEN		FX_CHAIN_POOL(2, BLOCK_SIZE)
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct render_io {
+
+	ft_t			in;
+	ft_t			out;
+	unsigned long	written;
+	st_sample_t		frames[BLOCK_SIZE * MAX_CHANNELS];
+
+} render_io_t;
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static struct st_soundstream in_ft, out_ft;
+static render_io_t render;
+
+// the mode's stages between a resample to 16 kHz and one back
+
+static fx_chain_t	rate_chain;
+static struct st_effect	rate_in, rate_out;
+static st_sample_t	rate_pool[RATE_POOL_LEN];
+
+static char *tier_opts[] = { "-qs", "-q", "-ql" };
+
+static const char *mode_names[FX_NUM_CHAINS] = {
+
+	"no effects", "chorus", "delay", "chorus + delay"
+};
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double now_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage(void) {
+
+	fprintf(stderr, "usage: fx_render [-m mode] [-c hw|sw] [-l latency_spins] [-t type] [-r rate] "
+		"[-q low|medium|high] in out\n");
+	exit(EXIT_FAILURE);
+}
+
+static void fail(ft_t ft) {
+
+	fprintf(stderr, "fx_render: %s: %s\n", ft->filename, ft->st_errstr);
+	exit(EXIT_FAILURE);
+}
+
+// open a sound file on its format handler; type NULL takes the suffix
+
+static void open_file(ft_t ft, char *name, char *type, const char *mode) {
+
+	char *suffix = strrchr(name, '.');
+
+	ft->filename = name;
+	ft->filetype = type ? type : (suffix ? suffix + 1 : NULL);
+
+	if (st_gettype(ft) != ST_SUCCESS) {
+		fail(ft);
+	}
+
+	if ((ft->fp = fopen(name, mode)) == NULL) {
+
+		perror(name);
+		exit(EXIT_FAILURE);
+	}
+
+	ft->seekable = (fseek(ft->fp, 0, SEEK_CUR) == 0);
+}
+
+// out.wav for one mode, out-swN.wav for each of all of them
+
+static char *output_name(const char *out, unsigned int mode, unsigned int modes) {
+
+	static char	name[4096];
+	const char	*suffix = strrchr(out, '.');
+	int			stem = suffix ? (int) (suffix - out) : (int) strlen(out);
+
+	if (modes != ALL_MODES) {
+		snprintf(name, sizeof(name), "%s", out);
+	}
+
+	else {
+		snprintf(name, sizeof(name), "%.*s-sw%u%s", stem, out, mode, suffix ? suffix : "");
+	}
+
+	return name;
+}
+
+// chain source: frames from the input file, mixed down to mono
+
+static st_size_t render_read(void *io, st_sample_t *buf, st_size_t len) {
+
+	render_io_t		*r = (render_io_t *) io;
+	unsigned int	channels = r->in->info.channels;
+	st_ssize_t		count;
+	st_size_t		i, c;
+	int64_t			sum;
+
+	count = r->in->h->read(r->in, r->frames, MIN(len, BLOCK_SIZE) * channels) / channels;
+
+	for (i = 0; i < (st_size_t) count; i++) {
+
+		for (sum = 0, c = 0; c < channels; c++) {
+			sum += r->frames[i * channels + c];
+		}
+
+		buf[i] = (st_sample_t) (sum / (int64_t) channels);
+	}
+
+	return (count > 0) ? (st_size_t) count : 0;
+}
+
+// chain sink: the output file
+
+static void render_write(void *io, const st_sample_t *buf, st_size_t len) {
+
+	render_io_t *r = (render_io_t *) io;
+
+	r->written += r->out->h->write(r->out, (st_sample_t *) buf, len);
+}
+
+// set up one resample stage from in_rate to out_rate
+
+static void rate_stage(eff_t e, st_rate_t in_rate, st_rate_t out_rate, unsigned int tier) {
+
+	memset(e, 0, sizeof(*e));
+
+	if ((st_geteffect(e, "resample") != ST_SUCCESS) ||
+		(e->h->getopts(e, 1, &tier_opts[tier]) != ST_SUCCESS)) {
+
+		fprintf(stderr, "fx_render: no resample effect\n");
+		exit(EXIT_FAILURE);
+	}
+
+	e->ininfo.rate  = in_rate;
+	e->outinfo.rate = out_rate;
+}
+
+// the board's chain for the mode at 16 kHz, or at another rate the same
+// stages between two resamplers
+
+static fx_chain_t *rate_fx_chain(fx_chain_t *board, st_rate_t rate, unsigned int tier) {
+
+	eff_t			stages[FX_CHAIN_MAX_STAGES];
+	unsigned int	i, n = 0;
+
+	if (rate == SAMPLE_RATE) {
+		return board;
+	}
+
+	if (board->num_stages + 2 > FX_CHAIN_MAX_STAGES) {
+
+		fprintf(stderr, "fx_render: %u stages and two resamplers are too many\n", board->num_stages);
+		exit(EXIT_FAILURE);
+	}
+
+	rate_stage(&rate_in, rate, SAMPLE_RATE, tier);
+	rate_stage(&rate_out, SAMPLE_RATE, rate, tier);
+
+	stages[n++] = &rate_in;
+
+	for (i = 0; i < board->num_stages; i++) {
+		stages[n++] = board->stage[i];
+	}
+
+	stages[n++] = &rate_out;
+
+	if ((fx_chain_init(&rate_chain, stages, n, rate_pool, RATE_POOL_LEN, BLOCK_SIZE) != XST_SUCCESS) ||
+		(fx_chain_start(&rate_chain) != XST_SUCCESS)) {
+
+		fprintf(stderr, "fx_render: can not resample %u Hz to %u Hz\n", (unsigned int) rate, SAMPLE_RATE);
+		exit(EXIT_FAILURE);
+	}
+
+	return &rate_chain;
+}
+
+// one mode from the start of the input to the end of its effect tails;
+// returns the samples read, *seconds the time the chain took
+
+static unsigned long render_mode(char *in_name, char *in_type, st_rate_t raw_rate, char *out_name,
+								 unsigned int mode, unsigned int chorus_engine, unsigned int tier,
+								 double *seconds) {
+
+	fx_chain_t		*chain;
+	unsigned long	samples = 0;
+	st_size_t		count;
+	double			start;
+
+	// input from the top; raw input is described by the options
+
+	memset(&in_ft, 0, sizeof(in_ft));
+	open_file(&in_ft, in_name, in_type, "rb");
+
+	in_ft.info.rate = raw_rate;
+	in_ft.swap      = 0;
+
+	if (in_ft.h->startread(&in_ft) != ST_SUCCESS) {
+		fail(&in_ft);
+	}
+
+	if ((in_ft.info.channels < 1) || (in_ft.info.channels > MAX_CHANNELS)) {
+
+		fprintf(stderr, "fx_render: %s: %d channels not supported\n", in_name, in_ft.info.channels);
+		exit(EXIT_FAILURE);
+	}
+
+	// mono, 16 bits, at the input rate
+
+	memset(&out_ft, 0, sizeof(out_ft));
+	open_file(&out_ft, out_name, NULL, "wb");
+
+	out_ft.info.rate     = in_ft.info.rate;
+	out_ft.info.size     = ST_SIZE_WORD;
+	out_ft.info.encoding = ST_ENCODING_SIGN2;
+	out_ft.info.channels = 1;
+
+	if (out_ft.h->startwrite(&out_ft) != ST_SUCCESS) {
+		fail(&out_ft);
+	}
+
+	// fresh effect state & histories, then the board's chain for the mode
+
+	memset(hal_chorusbuffer_bram(), 0, BUFFER_DEPTH * sizeof(u16));
+	memset(hal_delaybuffer_bram(), 0, BUFFER_DEPTH * sizeof(u16));
+
+	if ((init_fx() != XST_SUCCESS) ||
+		(set_delay_engine(DELAY_ENGINE_SOFTWARE) != XST_SUCCESS) ||
+		(chorus_set_engine(chorus_engine) != XST_SUCCESS)) {
+
+		fprintf(stderr, "fx_render: effects would not start\n");
+		exit(EXIT_FAILURE);
+	}
+
+	render.in      = &in_ft;
+	render.out     = &out_ft;
+	render.written = 0;
+
+	chain = rate_fx_chain(select_fx_chain(mode), in_ft.info.rate, tier);
+	fx_chain_set_io(chain, render_read, render_write, &render);
+
+	start = now_seconds();
+
+	while ((count = fx_chain_run(chain, BLOCK_SIZE)) > 0) {
+		samples += count;
+	}
+
+	fx_chain_drain(chain);
+
+	// the resamplers give their tables back to the cache before the next
+	// mode sets the stages up again; the board's chain stays with init_fx()
+
+	if (chain == &rate_chain) {
+		fx_chain_stop(chain);
+	}
+
+	*seconds = now_seconds() - start;
+
+	if ((in_ft.h->stopread(&in_ft) != ST_SUCCESS) || (out_ft.h->stopwrite(&out_ft) != ST_SUCCESS)) {
+		fail((in_ft.st_errno != 0) ? &in_ft : &out_ft);
+	}
+
+	fclose(in_ft.fp);
+	fclose(out_ft.fp);
+
+	return samples;
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	unsigned int	modes = ALL_MODES, chorus_engine = CHORUS_ENGINE_DEFAULT;
+	unsigned int	spins = 0, mode, tier = POLYPHASE_MEDIUM;
+	st_rate_t		raw_rate = SAMPLE_RATE;
+	char			*in_type = NULL, *out_name;
+	unsigned long	samples, total = 0;
+	double			seconds, elapsed = 0.0;
+	int				devnull, saved_stdout;
+	int				opt;
+
+	while ((opt = getopt(argc, argv, "m:c:l:t:r:q:")) != -1) {
+
+		switch (opt) {
+
+			case 'm':	modes = (unsigned int) atoi(optarg);
+						if (modes >= FX_NUM_CHAINS) usage();
+						break;
+
+			case 'c':	if (!strcmp(optarg, "sw")) chorus_engine = CHORUS_ENGINE_SOFTWARE;
+						else if (!strcmp(optarg, "hw")) chorus_engine = CHORUS_ENGINE_HARDWARE;
+						else usage();
+						break;
+
+			case 'l':	spins = (unsigned int) atoi(optarg);
+						break;
+
+			case 't':	in_type = optarg;
+						break;
+
+			case 'r':	raw_rate = (st_rate_t) atoi(optarg);
+						if (raw_rate == 0) usage();
+						break;
+
+			case 'q':	if (!strcmp(optarg, "low")) tier = POLYPHASE_LOW;
+						else if (!strcmp(optarg, "medium")) tier = POLYPHASE_MEDIUM;
+						else if (!strcmp(optarg, "high")) tier = POLYPHASE_HIGH;
+						else usage();
+						break;
+
+			default:	usage();
+		}
+	}
+
+	if (argc - optind != 2) {
+		usage();
+	}
+
+	// bring the buffer models up; the driver self-test banners (printf on
+	// the host) go to /dev/null
+
+	hal_inputbuffer_init();
+	hal_chorusbuffer_init();
+	hal_delaybuffer_init();
+
+	fflush(stdout);
+	saved_stdout = dup(STDOUT_FILENO);
+
+	if ((devnull = open("/dev/null", O_WRONLY)) >= 0) {
+		dup2(devnull, STDOUT_FILENO);
+	}
+
+	if ((InputBuffer_initialize(XPAR_INPUTBUFFER_0_S00_AXI_BASEADDR) != XST_SUCCESS) ||
+		(ChorusBuffer_initialize(XPAR_CHORUSBUFFER_0_S00_AXI_BASEADDR) != XST_SUCCESS) ||
+		(DelayBuffer_initialize(XPAR_DELAYBUFFER_0_S00_AXI_BASEADDR) != XST_SUCCESS)) {
+
+		fprintf(stderr, "fx_render: driver self-test failed\n");
+		return EXIT_FAILURE;
+	}
+
+	fflush(stdout);
+	dup2(saved_stdout, STDOUT_FILENO);
+	close(saved_stdout);
+
+	if (devnull >= 0) {
+		close(devnull);
+	}
+
+	hal_io_set_latency(spins);
+
+	for (mode = 0; mode < FX_NUM_CHAINS; mode++) {
+
+		if ((modes != ALL_MODES) && (mode != modes)) {
+			continue;
+		}
+
+		out_name = output_name(argv[optind + 1], mode, modes);
+		samples  = render_mode(argv[optind], in_type, raw_rate, out_name, mode, chorus_engine, tier,
+							   &seconds);
+
+		if ((mode == 0) || (modes != ALL_MODES)) {
+
+			printf("%s: %lu samples at %u Hz, %d channel(s), %u spins/access, chorus in %s\n",
+				argv[optind], samples, (unsigned int) in_ft.info.rate, in_ft.info.channels, spins,
+				(chorus_engine == CHORUS_ENGINE_HARDWARE) ? "the ChorusBuffer model" : "software");
+
+			if (in_ft.info.rate != SAMPLE_RATE) {
+				printf("  (resampled to %u Hz and back, %s quality)\n", SAMPLE_RATE,
+					(tier == POLYPHASE_LOW) ? "low" : (tier == POLYPHASE_MEDIUM) ? "medium" : "high");
+			}
+		}
+
+		printf("  sw[1:0]=%u %-16s -> %-24s %9lu samples + %6lu tail  %11.0f samples/s  %8.1fx realtime\n",
+			mode, mode_names[mode], out_name, samples, render.written - samples,
+			samples / seconds, samples / seconds / in_ft.info.rate);
+
+		total   += samples;
+		elapsed += seconds;
+	}
+
+	if (modes == ALL_MODES) {
+		printf("  all modes %46lu samples %19.0f samples/s\n", total, total / elapsed);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+/**
+*
+* @file hal.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This header file contains the host-side (Linux) hardware models for the
+* custom peripherals. Each model decodes the same AXI register map as the
+* Verilog in hdl/ and keeps its Block RAM in ordinary memory, so the drivers
+* in drivers/ and the application run unmodified on top of it.
+*/
+
+/****************************************************************************/
+/**************************** Header Definition  ****************************/
+/****************************************************************************/
+
+#ifndef HAL_H
+#define HAL_H
+
+/****************************************************************************/
+/****************************** Include Files *******************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include "xil_types.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define HAL_BRAM_DEPTH		65536
+#define HAL_NUM_SLV_REGS	8
+#define HAL_CHORUS_SLV_REGS	16
+#define HAL_NUM_GPIO		3
+#define HAL_NUM_INTR		32
+#define HAL_PDM_MAX_ORDER	5
+#define HAL_PDM_FIR_TAPS	32
+#define HAL_ECHO_TAPS		8
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+// One memory-mapped peripheral on the host "bus"
+
+typedef struct hal_device {
+
+	const char	*name;
+	UINTPTR		base;
+	UINTPTR		high;
+	u32			(*read)(u32 offset);
+	void		(*write)(u32 offset, u32 data);
+
+} hal_device_t;
+
+// PDM-to-PCM decimator model state (AudioInput.v)
+
+typedef struct hal_pdm_dec {
+
+	unsigned int	order;
+	unsigned int	decimation;
+	unsigned int	cic_bits;
+	unsigned int	cic_shift;
+	u32				norm_gain;
+
+	s64				integ[HAL_PDM_MAX_ORDER];
+	s64				comb_dly[HAL_PDM_MAX_ORDER];
+	s64				cic_out;
+	unsigned int	cic_count;
+	int				cic_valid;
+
+	s32				fir_hist[HAL_PDM_FIR_TAPS];
+	unsigned int	fir_widx;
+	int				fir_phase;
+
+} hal_pdm_dec_t;
+
+// PCM-to-PDM modulator model state (AudioOutput.v)
+
+typedef struct hal_pdm_mod {
+
+	unsigned int	interp;
+	s64				feedback;
+	s64				limit;
+
+	unsigned int	sample_count;
+	u16				read_address;
+
+	s64				comb1_dly;
+	s64				comb2_dly;
+	s64				interp1;
+	s64				interp2;
+	s64				mod1;
+	s64				mod2;
+
+} hal_pdm_mod_t;
+
+// Bus transaction counters, one per Xil_In32 / Xil_Out32 call
+
+typedef struct hal_io_stats {
+
+	u64			reads;
+	u64			writes;
+
+} hal_io_stats_t;
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+// Bus dispatch (hal_io.c)
+void hal_io_register(const hal_device_t *dev);
+void hal_io_set_latency(unsigned int spins);
+void hal_io_get_stats(hal_io_stats_t *stats);
+void hal_io_clear_stats(void);
+void hal_io_set_trace(FILE *fp, UINTPTR base, UINTPTR high);
+
+// InputBuffer model (hal_inputbuffer.c)
+void hal_inputbuffer_init(void);
+u16 *hal_inputbuffer_bram(void);
+void hal_inputbuffer_poll(void);
+
+// ChorusBuffer model (hal_chorusbuffer.c)
+void hal_chorusbuffer_init(void);
+u16 *hal_chorusbuffer_bram(void);
+u16  hal_chorusbuffer_voice(u32 phase, u16 line);
+
+// DelayBuffer model (hal_delaybuffer.c)
+void hal_delaybuffer_init(void);
+u16 *hal_delaybuffer_bram(void);
+u16  hal_delaybuffer_echo(u16 line);
+
+// AudioInput / AudioOutput pointer model (hal_audio.c)
+void hal_audio_start(double lines_per_second, u16 phase);
+void hal_audio_stop(void);
+int  hal_audio_running(void);
+u64  hal_audio_lines(void);
+u16  hal_audio_write_pointer(void);
+u16  hal_audio_read_pointer(void);
+
+// GPIO model (hal_gpio.c) - sets the inputs and raises the interrupt
+void hal_gpio_set_input(u16 device_id, u32 data, u8 intr_id);
+u32  hal_gpio_get_output(u16 device_id);
+
+// Interrupt controller model (hal_intc.c)
+void hal_intc_raise(u8 id);
+u64  hal_intc_count(u8 id);
+u64  hal_intc_total(void);
+
+// AudioInput decimator & AudioOutput modulator reference models (hal_pdm.c)
+void hal_pdm_dec_init(hal_pdm_dec_t *d, unsigned int order, unsigned int decimation);
+int  hal_pdm_dec_bit(hal_pdm_dec_t *d, int bit, s16 *pcm);
+void hal_pdm_mod_init(hal_pdm_mod_t *m, unsigned int interp);
+int  hal_pdm_mod_bit(hal_pdm_mod_t *m, s16 sample);
+
+// AXI Timer model (hal_tmrctr.c)
+void hal_tmrctr_init(void);
+
+// UART model (hal_uart.c) - NULL sends outbyte() back to stdout
+void hal_uart_capture(FILE *out);
+
+#endif
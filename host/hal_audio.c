@@ -0,0 +1,88 @@
+/**
+*
+* @file hal_audio.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host model of the AudioInput / AudioOutput address counters. On the board
+* both modules step through their buffer one line per 16 audio clocks; on the
+* host the two pointers are derived from the monotonic clock at a fixed line
+* rate, so the application sees them advance in real time while it runs.
+*
+* The read pointer runs at the same rate with an arbitrary phase, since the
+* two counters in hardware come out of reset independently. Stopping the
+* model freezes both pointers; starting it again carries on from there, as
+* if the processor had been away, rather than from line 0.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <time.h>
+#include "hal.h"
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static double	start_time;
+static double	line_rate = 0.0;
+static u64		stopped_lines = 0;
+static u16		read_phase;
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static double hal_audio_now(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/****************************************************************************/
+/************************** HAL Functions ***********************************/
+/****************************************************************************/
+
+void hal_audio_start(double lines_per_second, u16 phase) {
+
+	line_rate  = lines_per_second;
+	start_time = hal_audio_now() - stopped_lines / line_rate;
+	read_phase = phase;
+}
+
+void hal_audio_stop(void) {
+
+	stopped_lines = hal_audio_lines();
+	line_rate = 0.0;
+}
+
+int hal_audio_running(void) {
+
+	return (line_rate != 0.0);
+}
+
+u64 hal_audio_lines(void) {
+
+	if (line_rate == 0.0) {
+		return stopped_lines;
+	}
+
+	return (u64) ((hal_audio_now() - start_time) * line_rate);
+}
+
+// the last line written, as the InputBuffer reports it
+
+u16 hal_audio_write_pointer(void) {
+
+	return (u16) (hal_audio_lines() - 1);
+}
+
+u16 hal_audio_read_pointer(void) {
+
+	return (u16) (hal_audio_lines() + read_phase);
+}
@@ -0,0 +1,274 @@
+/**
+*
+* @file hal_chorusbuffer.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host model of the ChorusBuffer IP (hdl/ChorusBuffer/ChorusBuffer_v1_0_S00_AXI.v).
+*
+* Register map, as seen from the AXI side:
+*
+*	slv_reg0 (0x00): Port A write enable (manual mode)
+*	slv_reg1 (0x04): Port A write address, also loads the stream address
+*	slv_reg2 (0x08): Port A data input, commits & advances in auto-increment mode
+*	slv_reg3 (0x0C): Port B read address
+*	slv_reg4 (0x10): write: stream read address, read: Port B data output
+*	                 (advances the stream address while it is selected)
+*	slv_reg5 (0x14): write: control word, bit 0 = auto-increment write mode
+*	slv_reg6 (0x18): write: tap offset table entry, tap in [17:16], offset in [15:0]
+*	slv_reg7 (0x1C): write: tap base address, fetches every tap
+*	slv_reg5..7    : read: tap 0..2 data, i.e. line (base - offset)
+*	slv_reg8 (0x20): chorus LFO phase increment per sample
+*	slv_reg9 (0x24): chorus base delay in [15:0], depth in [31:16] (lines)
+*	slv_reg10(0x28): chorus in gain in [15:0], voice gain in [31:16] (Q1.15)
+*	slv_reg11(0x2C): chorus control, bit 0 = triangle LFO
+*	slv_reg12(0x30): chorus LFO phase, written to load it
+*	slv_reg13(0x34): chorus history line, written to load it
+*	slv_reg14(0x38): read: chorus output for the line, then steps line & phase
+*
+* The chorus voice generator is modelled with the same integer arithmetic
+* as the hardware, so hal_chorusbuffer_voice() is bit-exact with it.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <string.h>
+#include "xparameters.h"
+#include "hal.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define NUM_TAPS		3
+#define HISTORY_MASK	0x7FFF
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static u32	slv_reg[HAL_CHORUS_SLV_REGS];
+static u16	stream_waddr;
+static u16	stream_raddr;
+static int	stream_rsel;
+static u16	tap_offset[NUM_TAPS];
+static u16	tap_data[NUM_TAPS];
+static u16	bram[HAL_BRAM_DEPTH];
+static u32	chorus_phase;
+static u16	chorus_line;
+
+// quarter wave, round(32767 * sin(pi * k / 128)) for k = 0 .. 64
+
+static const u16 quarter_sine[65] = {
+
+	    0,   804,  1608,  2410,  3212,  4011,  4808,  5602,
+	 6393,  7179,  7962,  8739,  9512, 10278, 11039, 11793,
+	12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+	18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+	23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+	27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+	30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+	32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+	32767
+};
+
+/****************************************************************************/
+/************************** Chorus Voice Model ******************************/
+/****************************************************************************/
+
+// LFO level w in Q15, 0 .. 32767
+
+static u32 chorus_level(u32 phase) {
+
+	u32 pos, t0, t1, sine, sum;
+
+	if (slv_reg[11] & 0x1) {
+		return ((phase >> 31) ? ~(phase >> 16) : (phase >> 16)) & 0x7FFF;
+	}
+
+	// second and fourth quarters run the table backwards, the second half is negative
+
+	pos = ((phase >> 30) & 0x1) ? ~(phase >> 16) & 0x3FFF : (phase >> 16) & 0x3FFF;
+
+	t0 = quarter_sine[pos >> 8];
+	t1 = quarter_sine[(pos >> 8) + 1];
+
+	sine = (t0 + ((((t1 - t0) * (pos & 0xFF)) & 0xFFFFFF) >> 8)) & 0xFFFF;
+	sum  = ((phase >> 31) ? 0x8000 - sine : 0x8000 + sine) & 0xFFFF;
+
+	return sum >> 1;
+}
+
+static s32 chorus_sample(u16 line) {
+
+	return (s16) bram[line & HISTORY_MASK];
+}
+
+/****************************************************************************/
+/************************** Register Model **********************************/
+/****************************************************************************/
+
+static u32 hal_chorusbuffer_read(u32 offset) {
+
+	unsigned int index = (offset >> 2) & 0xF;
+	u16 out;
+
+	if (index == 14) {
+
+		out = hal_chorusbuffer_voice(chorus_phase, chorus_line);
+
+		chorus_line++;
+		chorus_phase += slv_reg[8];
+
+		return out;
+	}
+
+	if (index == 12) {
+		return chorus_phase;
+	}
+
+	if (index == 13) {
+		return chorus_line;
+	}
+
+	if (index >= 8) {
+		return slv_reg[index];
+	}
+
+	if (index == 4) {
+		return stream_rsel ? bram[stream_raddr++] : bram[slv_reg[3] & 0x0000FFFF];
+	}
+
+	if (index >= 5) {
+		return tap_data[index - 5];
+	}
+
+	return slv_reg[index];
+}
+
+static void hal_chorusbuffer_write(u32 offset, u32 data) {
+
+	unsigned int index = (offset >> 2) & 0xF;
+	int auto_inc = slv_reg[5] & 0x1;
+	unsigned int tap;
+
+	slv_reg[index] = data;
+
+	if (index == 1) {
+		stream_waddr = (u16) (data & 0x0000FFFF);
+	}
+
+	if (index == 3) {
+		stream_rsel = 0;
+	}
+
+	if (index == 4) {
+		stream_raddr = (u16) (data & 0x0000FFFF);
+		stream_rsel = 1;
+	}
+
+	if ((index == 6) && (((data >> 16) & 0x3) < NUM_TAPS)) {
+		tap_offset[(data >> 16) & 0x3] = (u16) (data & 0x0000FFFF);
+	}
+
+	if (index == 12) {
+		chorus_phase = data;
+	}
+
+	if (index == 13) {
+		chorus_line = (u16) (data & 0x0000FFFF);
+	}
+
+	if (index == 7) {
+
+		for (tap = 0; tap < NUM_TAPS; tap++) {
+			tap_data[tap] = bram[(u16) (data - tap_offset[tap])];
+		}
+	}
+
+	if (auto_inc) {
+
+		// one-cycle write enable pulse at the stream address
+
+		if (index == 2) {
+			bram[stream_waddr++] = (u16) (data & 0x0000FFFF);
+		}
+	}
+
+	else if ((slv_reg[0] & 0x1) && (index <= 2)) {
+
+		// write enable held high: the Block RAM follows address & data
+
+		bram[slv_reg[1] & 0x0000FFFF] = (u16) (slv_reg[2] & 0x0000FFFF);
+	}
+}
+
+static const hal_device_t chorusbuffer_device = {
+
+	"ChorusBuffer",
+	XPAR_CHORUSBUFFER_0_S00_AXI_BASEADDR,
+	XPAR_CHORUSBUFFER_0_S00_AXI_HIGHADDR,
+	hal_chorusbuffer_read,
+	hal_chorusbuffer_write
+};
+
+/****************************************************************************/
+/************************** HAL Functions ***********************************/
+/****************************************************************************/
+
+void hal_chorusbuffer_init(void) {
+
+	memset(slv_reg, 0, sizeof(slv_reg));
+	memset(bram, 0, sizeof(bram));
+
+	memset(tap_offset, 0, sizeof(tap_offset));
+	memset(tap_data, 0, sizeof(tap_data));
+
+	stream_waddr = 0;
+	stream_raddr = 0;
+	stream_rsel = 0;
+
+	chorus_phase = 0;
+	chorus_line = 0;
+
+	hal_io_register(&chorusbuffer_device);
+}
+
+u16 *hal_chorusbuffer_bram(void) {
+
+	return bram;
+}
+
+// what the chorus voice generator returns for one line at one LFO phase
+
+u16 hal_chorusbuffer_voice(u32 phase, u16 line) {
+
+	u32 base  = slv_reg[9] & 0x0000FFFF;
+	u32 depth = slv_reg[9] >> 16;
+	u32 delay = (base << 15) + depth * chorus_level(phase);
+	u16 whole = (u16) (delay >> 15);
+	s32 frac  = (s32) (delay & 0x7FFF);
+	s32 dry, x0, x1, voice, acc;
+
+	dry = chorus_sample(line);
+	x0  = chorus_sample((u16) (line - whole));
+	x1  = chorus_sample((u16) (line - whole - 1));
+
+	voice = x0 + (((x1 - x0) * frac) >> 15);
+
+	acc = ((dry * (s32) (slv_reg[10] & 0x0000FFFF)) >> 15) +
+		  (((s64) voice * (s32) (slv_reg[10] >> 16)) >> 15);
+
+	if (acc > 32767) {
+		acc = 32767;
+	}
+
+	else if (acc < -32768) {
+		acc = -32768;
+	}
+
+	return (u16) acc;
+}
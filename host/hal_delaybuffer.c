@@ -0,0 +1,150 @@
+/**
+*
+* @file hal_delaybuffer.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host model of the DelayBuffer IP (hdl/DelayBuffer/DelayBuffer_v1_0_S00_AXI.v).
+*
+* Register map, as seen from the AXI side:
+*
+*	slv_reg0 (0x00): Port A write enable (manual mode)
+*	slv_reg1 (0x04): Port A write address, also loads the stream address
+*	slv_reg2 (0x08): Port A data input, commits & advances in auto-increment mode
+*	slv_reg3 (0x0C): echo tap word, gain in [31:16], delay in [15:0]
+*	slv_reg4 (0x10): echo tap select, a write copies slv_reg3 into that tap
+*	slv_reg5 (0x14): control word, bit 0 = auto-increment write mode
+*	slv_reg6 (0x18): echo control, [3:0] = active taps, bit 8 = enable
+*	slv_reg7 (0x1C): read: AudioOutput read pointer (hal_audio.c)
+*
+* Port B belongs to AudioOutput on the board; on the host the application
+* reads the Block RAM directly through hal_delaybuffer_bram(), and
+* hal_delaybuffer_echo() returns what the echo engine puts on doutb for a
+* line, with the same arithmetic as the Verilog.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <string.h>
+#include "xparameters.h"
+#include "hal.h"
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static u32	slv_reg[HAL_NUM_SLV_REGS];
+static u16	stream_waddr;
+static u16	bram[HAL_BRAM_DEPTH];
+static u32	echo_tap[HAL_ECHO_TAPS];
+
+/****************************************************************************/
+/************************** Register Model **********************************/
+/****************************************************************************/
+
+static u32 hal_delaybuffer_read(u32 offset) {
+
+	if (((offset >> 2) & 0x7) == 7) {
+		return hal_audio_read_pointer();
+	}
+
+	return slv_reg[(offset >> 2) & 0x7];
+}
+
+static void hal_delaybuffer_write(u32 offset, u32 data) {
+
+	unsigned int index = (offset >> 2) & 0x7;
+	int auto_inc = slv_reg[5] & 0x1;
+
+	slv_reg[index] = data;
+
+	if (index == 1) {
+		stream_waddr = (u16) (data & 0x0000FFFF);
+	}
+
+	if ((index == 4) && ((data & 0xF) < HAL_ECHO_TAPS)) {
+		echo_tap[data & 0xF] = slv_reg[3];
+	}
+
+	if (auto_inc) {
+
+		// one-cycle write enable pulse at the stream address
+
+		if (index == 2) {
+			bram[stream_waddr++] = (u16) (data & 0x0000FFFF);
+		}
+	}
+
+	else if ((slv_reg[0] & 0x1) && (index <= 2)) {
+
+		// write enable held high: the Block RAM follows address & data
+
+		bram[slv_reg[1] & 0x0000FFFF] = (u16) (slv_reg[2] & 0x0000FFFF);
+	}
+}
+
+static const hal_device_t delaybuffer_device = {
+
+	"DelayBuffer",
+	XPAR_DELAYBUFFER_0_S00_AXI_BASEADDR,
+	XPAR_DELAYBUFFER_0_S00_AXI_HIGHADDR,
+	hal_delaybuffer_read,
+	hal_delaybuffer_write
+};
+
+/****************************************************************************/
+/************************** HAL Functions ***********************************/
+/****************************************************************************/
+
+void hal_delaybuffer_init(void) {
+
+	memset(slv_reg, 0, sizeof(slv_reg));
+	memset(bram, 0, sizeof(bram));
+	memset(echo_tap, 0, sizeof(echo_tap));
+
+	stream_waddr = 0;
+
+	hal_io_register(&delaybuffer_device);
+}
+
+u16 *hal_delaybuffer_bram(void) {
+
+	return bram;
+}
+
+u16 hal_delaybuffer_echo(u16 line) {
+
+	unsigned int taps = slv_reg[6] & 0xF;
+	unsigned int k;
+	int mix = (s16) bram[line];
+
+	if (!(slv_reg[6] & 0x100)) {
+		taps = 0;
+	}
+
+	if (taps > HAL_ECHO_TAPS) {
+		taps = HAL_ECHO_TAPS;
+	}
+
+	// the line itself plus (tap line x Q1.15 gain) >> 15 per tap, saturated once
+
+	for (k = 0; k < taps; k++) {
+
+		u16 tap_line = (u16) (line - (echo_tap[k] & 0xFFFF));
+
+		mix += ((s16) bram[tap_line] * (int) (echo_tap[k] >> 16)) >> 15;
+	}
+
+	if (mix > 32767) {
+		mix = 32767;
+	}
+
+	else if (mix < -32768) {
+		mix = -32768;
+	}
+
+	return (u16) mix;
+}
@@ -0,0 +1,133 @@
+/**
+*
+* @file hal_gpio.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file implements the XGpio driver calls for the host build. Each GPIO
+* instance (buttons, switches, LEDs) is one 32-bit input latch and one 32-bit
+* output latch. The benchmarks flip the switches & buttons with
+* hal_gpio_set_input(), which raises the interrupt through the XIntc model
+* just like the IP2INTC_Irpt line does on the board.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "xparameters.h"
+#include "xgpio.h"
+#include "hal.h"
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct hal_gpio {
+
+	u32			input;
+	u32			output;
+	u32			direction;
+	u32			intr_enable;
+	u32			intr_global;
+
+} hal_gpio_t;
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static hal_gpio_t	gpio[HAL_NUM_GPIO];
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static hal_gpio_t *hal_gpio_lookup(u16 device_id) {
+
+	if (device_id >= HAL_NUM_GPIO) {
+		fprintf(stderr, "HAL: no GPIO with device ID %u\n", device_id);
+		exit(EXIT_FAILURE);
+	}
+
+	return &gpio[device_id];
+}
+
+/****************************************************************************/
+/************************** XGpio Driver ************************************/
+/****************************************************************************/
+
+int XGpio_Initialize(XGpio *InstancePtr, u16 DeviceId) {
+
+	if (DeviceId >= HAL_NUM_GPIO) {
+		return XST_DEVICE_NOT_FOUND;
+	}
+
+	InstancePtr->DeviceId = DeviceId;
+	InstancePtr->IsReady = TRUE;
+
+	return XST_SUCCESS;
+}
+
+void XGpio_SetDataDirection(XGpio *InstancePtr, unsigned Channel, u32 DirectionMask) {
+
+	(void) Channel;
+	hal_gpio_lookup(InstancePtr->DeviceId)->direction = DirectionMask;
+}
+
+u32 XGpio_DiscreteRead(XGpio *InstancePtr, unsigned Channel) {
+
+	hal_gpio_t *g = hal_gpio_lookup(InstancePtr->DeviceId);
+
+	(void) Channel;
+	return g->input & g->direction;
+}
+
+void XGpio_DiscreteWrite(XGpio *InstancePtr, unsigned Channel, u32 Data) {
+
+	(void) Channel;
+	hal_gpio_lookup(InstancePtr->DeviceId)->output = Data;
+}
+
+void XGpio_InterruptGlobalEnable(XGpio *InstancePtr) {
+
+	hal_gpio_lookup(InstancePtr->DeviceId)->intr_global = TRUE;
+}
+
+void XGpio_InterruptEnable(XGpio *InstancePtr, u32 Mask) {
+
+	hal_gpio_lookup(InstancePtr->DeviceId)->intr_enable |= Mask;
+}
+
+void XGpio_InterruptClear(XGpio *InstancePtr, u32 Mask) {
+
+	(void) InstancePtr;
+	(void) Mask;
+}
+
+/****************************************************************************/
+/************************** Model Controls **********************************/
+/****************************************************************************/
+
+void hal_gpio_set_input(u16 device_id, u32 data, u8 intr_id) {
+
+	hal_gpio_t *g = hal_gpio_lookup(device_id);
+
+	if (g->input == data) {
+		return;
+	}
+
+	g->input = data;
+
+	if (g->intr_global && g->intr_enable) {
+		hal_intc_raise(intr_id);
+	}
+}
+
+u32 hal_gpio_get_output(u16 device_id) {
+
+	return hal_gpio_lookup(device_id)->output;
+}
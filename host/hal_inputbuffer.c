@@ -0,0 +1,197 @@
+/**
+*
+* @file hal_inputbuffer.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host model of the InputBuffer IP (hdl/InputBuffer/InputBuffer_v1_0_S00_AXI.v).
+*
+* Register map, as seen from the AXI side:
+*
+*	slv_reg0 (0x00): stream address, write to start a block read
+*	slv_reg1 (0x04): stream data, read returns the line & advances the address
+*	slv_reg2 (0x08): read: AudioInput write pointer (hal_audio.c)
+*	slv_reg3 (0x0C): Port B random-access address
+*	slv_reg4 (0x10): Port B data output
+*	slv_reg5 (0x14): interrupt control, half size 2^[3:0] lines, bit 8 / 9
+*	                 enable the half-full / full interrupt
+*	slv_reg6 (0x18): read: interrupt status (bit 0 half-full, bit 1 full),
+*	                 write: clears the bits written as 1
+*	slv_reg7 (0x1C): plain read/write register (used by the self-test)
+*
+* Port A belongs to AudioInput on the board; on the host the application
+* fills the Block RAM directly through hal_inputbuffer_bram().
+*
+* The interrupts follow the AudioInput pointer in hal_audio.c. The model
+* catches up with it at every register access and whenever the processor
+* sleeps (hal_inputbuffer_poll() from mb_sleep()), and calls the connected
+* handler for any half it finds completed since the last look.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <string.h>
+#include "xparameters.h"
+#include "hal.h"
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static u32	slv_reg[HAL_NUM_SLV_REGS];
+static u16	stream_addr;
+static int	stream_sel;
+static u16	bram[HAL_BRAM_DEPTH];
+static u32	intr_status;
+static u64	intr_lines;
+static int	intr_polling;
+
+/****************************************************************************/
+/************************** Register Model **********************************/
+/****************************************************************************/
+
+static u16 hal_inputbuffer_addrb(void) {
+
+	return stream_sel ? stream_addr : (u16) (slv_reg[3] & 0x0000FFFF);
+}
+
+static u32 hal_inputbuffer_read(u32 offset) {
+
+	u32 data;
+
+	hal_inputbuffer_poll();
+
+	switch ((offset >> 2) & 0x7) {
+
+		case 0:
+			return stream_addr;
+
+		case 1:
+			data = bram[hal_inputbuffer_addrb()];
+			stream_addr++;
+			return data;
+
+		case 2:
+			return hal_audio_write_pointer();
+
+		case 4:
+			return bram[hal_inputbuffer_addrb()];
+
+		case 6:
+			return intr_status;
+
+		default:
+			return slv_reg[(offset >> 2) & 0x7];
+	}
+}
+
+static void hal_inputbuffer_write(u32 offset, u32 data) {
+
+	unsigned int index = (offset >> 2) & 0x7;
+
+	hal_inputbuffer_poll();
+
+	if (index == 6) {
+		intr_status &= ~data;
+		return;
+	}
+
+	slv_reg[index] = data;
+
+	// only lines written from now on can raise an interrupt
+
+	if (index == 5) {
+		intr_lines = hal_audio_lines();
+	}
+
+	if (index == 0) {
+		stream_addr = (u16) (data & 0x0000FFFF);
+		stream_sel = 1;
+	}
+
+	else if (index == 3) {
+		stream_sel = 0;
+	}
+}
+
+static const hal_device_t inputbuffer_device = {
+
+	"InputBuffer",
+	XPAR_INPUTBUFFER_0_S00_AXI_BASEADDR,
+	XPAR_INPUTBUFFER_0_S00_AXI_HIGHADDR,
+	hal_inputbuffer_read,
+	hal_inputbuffer_write
+};
+
+/****************************************************************************/
+/************************** HAL Functions ***********************************/
+/****************************************************************************/
+
+void hal_inputbuffer_init(void) {
+
+	memset(slv_reg, 0, sizeof(slv_reg));
+	memset(bram, 0, sizeof(bram));
+
+	stream_addr = 0;
+	stream_sel = 0;
+
+	intr_status = 0;
+	intr_lines = 0;
+	intr_polling = 0;
+
+	hal_io_register(&inputbuffer_device);
+}
+
+u16 *hal_inputbuffer_bram(void) {
+
+	return bram;
+}
+
+void hal_inputbuffer_poll(void) {
+
+	u64 lines = hal_audio_lines();
+	u32 half_bits = slv_reg[5] & 0xF;
+	u32 enable = (slv_reg[5] >> 8) & 0x3;
+	u64 first, last;
+	u32 events = 0;
+
+	// the handler reads & clears the status through this model
+
+	if (intr_polling) {
+		return;
+	}
+
+	if (lines < intr_lines) {
+		intr_lines = lines;
+	}
+
+	// half k ends on line k * 2^half_bits - 1: odd k fills the first half
+	// of a window (half-full), even k the second (full)
+
+	first = (intr_lines >> half_bits) + 1;
+	last  = lines >> half_bits;
+
+	intr_lines = lines;
+
+	if (last > first) {
+		events = 0x3;
+	}
+
+	else if (last == first) {
+		events = (last & 1) ? 0x1 : 0x2;
+	}
+
+	events &= enable;
+
+	if (events != 0) {
+
+		intr_status |= events;
+
+		intr_polling = 1;
+		hal_intc_raise(XPAR_MICROBLAZE_0_AXI_INTC_INPUTBUFFER_0_INTERRUPT_INTR);
+		intr_polling = 0;
+	}
+}
@@ -0,0 +1,213 @@
+/**
+*
+* @file hal_intc.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file implements the XIntc driver calls and the MicroBlaze interrupt
+* enable for the host build. There is no asynchronous delivery: a model that
+* raises an interrupt calls the connected handler right away, provided the
+* source is enabled, the controller is started and interrupts are enabled.
+* With interrupts disabled the request is held pending, as the controller
+* holds its line, and the handler runs when they are enabled again.
+*
+* mb_sleep() polls the models that move on their own (the InputBuffer
+* interrupts, driven by the AudioInput pointer in hal_audio.c) until one of
+* them delivers an interrupt, or one is pending: a pending interrupt wakes
+* the processor even with interrupts disabled, as the INTC irq does on the
+* board through the MicroBlaze Wakeup inputs (hdl/system_interrupts.tcl). With the audio model stopped
+* nothing can wake the processor, so it returns straight away instead of
+* hanging.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include "xparameters.h"
+#include "xintc.h"
+#include "mb_interface.h"
+#include "hal.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define SLEEP_POLL_NS		20000
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct hal_intc_vector {
+
+	XInterruptHandler	handler;
+	void				*callback_ref;
+	u32					enabled;
+	u32					pending;
+	u64					count;
+
+} hal_intc_vector_t;
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static hal_intc_vector_t	vectors[HAL_NUM_INTR];
+static u32					started = FALSE;
+static u32					cpu_enabled = FALSE;
+static u64					delivered = 0;
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static void hal_intc_deliver(hal_intc_vector_t *v) {
+
+	v->count++;
+	delivered++;
+	v->handler(v->callback_ref);
+}
+
+static u32 hal_intc_pending(void) {
+
+	unsigned int id;
+
+	for (id = 0; id < HAL_NUM_INTR; id++) {
+
+		if (vectors[id].pending) {
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/****************************************************************************/
+/************************** XIntc Driver ************************************/
+/****************************************************************************/
+
+int XIntc_Initialize(XIntc *InstancePtr, u16 DeviceId) {
+
+	InstancePtr->DeviceId = DeviceId;
+	InstancePtr->IsReady = TRUE;
+	InstancePtr->IsStarted = FALSE;
+
+	return XST_SUCCESS;
+}
+
+int XIntc_Connect(XIntc *InstancePtr, u8 Id, XInterruptHandler Handler, void *CallBackRef) {
+
+	(void) InstancePtr;
+
+	if (Id >= HAL_NUM_INTR) {
+		return XST_INVALID_PARAM;
+	}
+
+	vectors[Id].handler = Handler;
+	vectors[Id].callback_ref = CallBackRef;
+
+	return XST_SUCCESS;
+}
+
+int XIntc_Start(XIntc *InstancePtr, u8 Mode) {
+
+	(void) Mode;
+
+	InstancePtr->IsStarted = TRUE;
+	started = TRUE;
+
+	return XST_SUCCESS;
+}
+
+void XIntc_Enable(XIntc *InstancePtr, u8 Id) {
+
+	(void) InstancePtr;
+	vectors[Id].enabled = TRUE;
+}
+
+void XIntc_Disable(XIntc *InstancePtr, u8 Id) {
+
+	(void) InstancePtr;
+	vectors[Id].enabled = FALSE;
+}
+
+/****************************************************************************/
+/************************** MicroBlaze Interrupts ***************************/
+/****************************************************************************/
+
+void microblaze_enable_interrupts(void) {
+
+	unsigned int id;
+
+	cpu_enabled = TRUE;
+
+	// whatever came in while they were off is taken now
+
+	for (id = 0; id < HAL_NUM_INTR; id++) {
+
+		if (vectors[id].pending) {
+
+			vectors[id].pending = FALSE;
+			hal_intc_deliver(&vectors[id]);
+		}
+	}
+}
+
+void microblaze_disable_interrupts(void) {
+
+	cpu_enabled = FALSE;
+}
+
+void mb_sleep(void) {
+
+	struct timespec	poll = { 0, SLEEP_POLL_NS };
+	u64				woken = delivered;
+
+	while ((delivered == woken) && !hal_intc_pending()) {
+
+		if (!hal_audio_running()) {
+			return;
+		}
+
+		hal_inputbuffer_poll();
+
+		if ((delivered == woken) && !hal_intc_pending()) {
+			nanosleep(&poll, NULL);
+		}
+	}
+}
+
+/****************************************************************************/
+/************************** Model Controls **********************************/
+/****************************************************************************/
+
+void hal_intc_raise(u8 id) {
+
+	hal_intc_vector_t *v = &vectors[id];
+
+	if (!started || !v->enabled || (v->handler == NULL)) {
+		return;
+	}
+
+	if (cpu_enabled) {
+		hal_intc_deliver(v);
+	}
+
+	else {
+		v->pending = TRUE;
+	}
+}
+
+u64 hal_intc_count(u8 id) {
+
+	return vectors[id].count;
+}
+
+u64 hal_intc_total(void) {
+
+	return delivered;
+}
@@ -0,0 +1,165 @@
+/**
+*
+* @file hal_io.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file implements Xil_In32 / Xil_Out32 for the host build. Every access
+* is counted and then handed to whichever registered peripheral model owns
+* the address, just like the AXI interconnect does on the board.
+*
+* An optional busy-wait per access (hal_io_set_latency) stands in for the
+* AXI4-Lite round trip, so that throughput numbers on the host scale with the
+* number of bus transactions the way they do on the MicroBlaze.
+*
+* An optional trace (hal_io_set_trace) writes every access to one address
+* range out as it happens, one $readmemh word per line: 1 for a write or 0
+* for a read, the offset in two digits, then the data written or read. The
+* hdl/tb testbenches replay it against the Verilog.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "xil_io.h"
+#include "hal.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define HAL_MAX_DEVICES		16
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static const hal_device_t	*devices[HAL_MAX_DEVICES];
+static unsigned int			num_devices = 0;
+
+static hal_io_stats_t		stats;
+static unsigned int			latency_spins = 0;
+
+static FILE					*trace_fp = NULL;
+static UINTPTR				trace_base, trace_high;
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static const hal_device_t *hal_io_decode(UINTPTR Addr) {
+
+	unsigned int i;
+
+	for (i = 0; i < num_devices; i++) {
+
+		if ((Addr >= devices[i]->base) && (Addr <= devices[i]->high)) {
+			return devices[i];
+		}
+	}
+
+	fprintf(stderr, "HAL: bus error at address 0x%08lx\n", (unsigned long) Addr);
+	exit(EXIT_FAILURE);
+}
+
+// the bus latency: a spin loop on a volatile counter, aligned so its speed
+// does not change with where the rest of the program puts it (unaligned it
+// ran half as fast again in some builds, which moved every bench figure)
+
+__attribute__((optimize("align-loops=64")))
+static void hal_io_stall(void) {
+
+	volatile unsigned int spin;
+
+	for (spin = 0; spin < latency_spins; spin++) {
+		;
+	}
+}
+
+/****************************************************************************/
+/************************** Bus Functions ***********************************/
+/****************************************************************************/
+
+u32 Xil_In32(UINTPTR Addr) {
+
+	const hal_device_t *dev = hal_io_decode(Addr);
+	u32 data;
+
+	stats.reads++;
+	hal_io_stall();
+
+	data = dev->read((u32) (Addr - dev->base));
+
+	if ((trace_fp != NULL) && (Addr >= trace_base) && (Addr <= trace_high)) {
+		fprintf(trace_fp, "0%02x%08x\n", (unsigned int) (Addr - trace_base), data);
+	}
+
+	return data;
+}
+
+void Xil_Out32(UINTPTR Addr, u32 Value) {
+
+	const hal_device_t *dev = hal_io_decode(Addr);
+
+	stats.writes++;
+	hal_io_stall();
+
+	if ((trace_fp != NULL) && (Addr >= trace_base) && (Addr <= trace_high)) {
+		fprintf(trace_fp, "1%02x%08x\n", (unsigned int) (Addr - trace_base), Value);
+	}
+
+	dev->write((u32) (Addr - dev->base), Value);
+}
+
+/****************************************************************************/
+/************************** HAL Functions ***********************************/
+/****************************************************************************/
+
+void hal_io_register(const hal_device_t *dev) {
+
+	unsigned int i;
+
+	// re-registering a model (e.g. after a reset) is harmless
+
+	for (i = 0; i < num_devices; i++) {
+
+		if (devices[i] == dev) {
+			return;
+		}
+	}
+
+	if (num_devices >= HAL_MAX_DEVICES) {
+
+		fprintf(stderr, "HAL: too many devices registered\n");
+		exit(EXIT_FAILURE);
+	}
+
+	devices[num_devices++] = dev;
+}
+
+void hal_io_set_latency(unsigned int spins) {
+
+	latency_spins = spins;
+}
+
+void hal_io_get_stats(hal_io_stats_t *out) {
+
+	*out = stats;
+}
+
+void hal_io_clear_stats(void) {
+
+	stats.reads = 0;
+	stats.writes = 0;
+}
+
+void hal_io_set_trace(FILE *fp, UINTPTR base, UINTPTR high) {
+
+	trace_fp   = fp;
+	trace_base = base;
+	trace_high = high;
+}
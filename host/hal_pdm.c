@@ -0,0 +1,236 @@
+/**
+*
+* @file hal_pdm.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* C reference models of the PDM converters in hdl/.
+*
+* Decimator (hdl/AudioInput/AudioInput.v): CIC_BITS-wide wrapping
+* integrators and combs, the shift down to the 18-bit FIR input, the same
+* Q1.15 compensation FIR, the NORM_GAIN scaling and the 16-bit saturation.
+* Feed it one PDM bit per mic clock with hal_pdm_dec_bit(); every
+* 2 * decimation bits it returns the sample AudioInput would write to the
+* InputBuffer.
+*
+* Modulator (hdl/AudioOutput/AudioOutput.v): the second-order CIC
+* interpolator and the second-order sigma-delta loop with its saturation.
+* hal_pdm_mod_bit() takes the DelayBuffer line for the current period and
+* returns the bit PDM_out shows on the next clock.
+*
+* Both follow the Verilog bit for bit; the testbenches in hdl/tb check the
+* Verilog against vectors written from them (bench_pdm).
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <string.h>
+#include "hal.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define FIR_BITS		18
+#define NORM_SHIFT		16
+
+#define MOD_LOAD_CYCLE	3
+#define MOD_FEEDBACK	40960
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+// one half of the symmetric FIR, centre tap first (AudioInput.v fir_coef)
+
+static const s16 fir_half_order4[HAL_PDM_FIR_TAPS / 2] = {
+
+	16422, 4592, -4284, -2609, 1922, 1597, -969, -985,
+	481, 581, -216, -313, 77, 144, -12, -43
+};
+
+static const s16 fir_half_order5[HAL_PDM_FIR_TAPS / 2] = {
+
+	16975, 4450, -4788, -2748, 2163, 1721, -1091, -1072,
+	541, 636, -243, -344, 87, 159, -14, -47
+};
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+// two's complement wrap to the register width, like the Verilog does
+
+static s64 hal_pdm_wrap(s64 x, unsigned int bits) {
+
+	return (s64) ((u64) x << (64 - bits)) >> (64 - bits);
+}
+
+static unsigned int hal_pdm_clog2(unsigned int x) {
+
+	unsigned int bits = 0;
+
+	while ((1u << bits) < x) {
+		bits++;
+	}
+
+	return bits;
+}
+
+static s16 hal_pdm_fir(hal_pdm_dec_t *d) {
+
+	const s16	*half = (d->order >= 5) ? fir_half_order5 : fir_half_order4;
+	s64			acc = 0;
+	s64			pcm;
+	unsigned int k, m;
+
+	// newest sample is at fir_widx - 1, tap k reads k samples further back
+
+	for (k = 0; k < HAL_PDM_FIR_TAPS; k++) {
+
+		m = (k < HAL_PDM_FIR_TAPS / 2) ? HAL_PDM_FIR_TAPS / 2 - 1 - k : k - HAL_PDM_FIR_TAPS / 2;
+		acc += (s64) half[m] * d->fir_hist[(d->fir_widx - 1 - k) & (HAL_PDM_FIR_TAPS - 1)];
+	}
+
+	pcm = ((acc >> 15) * (s64) d->norm_gain) >> NORM_SHIFT;
+
+	return (pcm > 32767) ? 32767 : (pcm < -32768) ? -32768 : (s16) pcm;
+}
+
+/****************************************************************************/
+/************************** HAL Functions ***********************************/
+/****************************************************************************/
+
+void hal_pdm_dec_init(hal_pdm_dec_t *d, unsigned int order, unsigned int decimation) {
+
+	u64 gain = 1;
+	unsigned int i, gain_bits = 0;
+
+	memset(d, 0, sizeof(*d));
+
+	d->order      = order;
+	d->decimation = decimation;
+	d->cic_bits   = 2 + order * hal_pdm_clog2(decimation);
+
+	// shift the CIC output so that +/- gain just fits the FIR input
+
+	for (i = 0; i < order; i++) {
+		gain *= decimation;
+	}
+
+	while ((gain >> gain_bits) != 0) {
+		gain_bits++;
+	}
+
+	d->cic_shift  = gain_bits + 1 - FIR_BITS;
+
+	d->norm_gain = (u32) (((1ull << (15 + d->cic_shift + NORM_SHIFT)) + (gain >> 1)) / gain);
+}
+
+int hal_pdm_dec_bit(hal_pdm_dec_t *d, int bit, s16 *pcm) {
+
+	int		produced = 0;
+	s64		comb;
+	unsigned int i;
+
+	// FIR side, from the CIC output registered on an earlier clock
+
+	if (d->cic_valid) {
+
+		d->fir_hist[d->fir_widx] = (s32) (d->cic_out >> d->cic_shift);
+		d->fir_widx = (d->fir_widx + 1) & (HAL_PDM_FIR_TAPS - 1);
+
+		if (d->fir_phase) {
+			*pcm = hal_pdm_fir(d);
+			produced = 1;
+		}
+
+		d->fir_phase ^= 1;
+	}
+
+	// combs, on the integrator values before this clock's update
+
+	if (d->cic_count == d->decimation - 1) {
+
+		comb = d->integ[d->order - 1];
+
+		for (i = 0; i < d->order; i++) {
+
+			s64 delayed = d->comb_dly[i];
+
+			d->comb_dly[i] = comb;
+			comb = hal_pdm_wrap(comb - delayed, d->cic_bits);
+		}
+
+		d->cic_out   = comb;
+		d->cic_count = 0;
+		d->cic_valid = 1;
+	}
+
+	else {
+		d->cic_count++;
+		d->cic_valid = 0;
+	}
+
+	// integrators, each from the previous stage's old value
+
+	for (i = d->order - 1; i > 0; i--) {
+		d->integ[i] = hal_pdm_wrap(d->integ[i] + d->integ[i - 1], d->cic_bits);
+	}
+
+	d->integ[0] = hal_pdm_wrap(d->integ[0] + (bit ? 1 : -1), d->cic_bits);
+
+	return produced;
+}
+
+void hal_pdm_mod_init(hal_pdm_mod_t *m, unsigned int interp) {
+
+	memset(m, 0, sizeof(*m));
+
+	m->interp   = interp;
+	m->feedback = (s64) interp * MOD_FEEDBACK;
+	m->limit    = 8 * m->feedback;
+}
+
+int hal_pdm_mod_bit(hal_pdm_mod_t *m, s16 sample) {
+
+	int		bit = (m->mod2 >= 0);
+	s64		fb = bit ? m->feedback : -m->feedback;
+	s64		comb1, comb2 = 0;
+	s64		mod1, mod2;
+
+	// combs take the sample LOAD_CYCLE clocks into the period
+
+	if (m->sample_count == MOD_LOAD_CYCLE) {
+
+		comb1 = sample - m->comb1_dly;
+		comb2 = comb1 - m->comb2_dly;
+
+		m->comb1_dly = sample;
+		m->comb2_dly = comb1;
+	}
+
+	// modulator, on the interpolator output before this clock's update
+
+	mod1 = m->mod1 + m->interp2 - fb;
+	mod2 = m->mod2 + mod1 - fb;
+
+	m->mod1 = (mod1 > m->limit) ? m->limit : (mod1 < -m->limit) ? -m->limit : mod1;
+	m->mod2 = (mod2 > m->limit) ? m->limit : (mod2 < -m->limit) ? -m->limit : mod2;
+
+	m->interp2 += m->interp1;
+	m->interp1 += comb2;
+
+	// next period: the read address moves on
+
+	if (++m->sample_count == m->interp) {
+
+		m->sample_count = 0;
+		m->read_address++;
+	}
+
+	return bit;
+}
@@ -0,0 +1,210 @@
+/**
+*
+* @file hal_tmrctr.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host model of the AXI Timer (axi_timer_0) plus the XTmrCtr driver calls
+* the application uses. Both timers count at XPAR_TMRCTR_0_CLOCK_FREQ_HZ off
+* the host monotonic clock, so a difference of two TCR reads is in the same
+* units as on the board (CPU cycles, the timer sits on the 100 MHz AXI clock).
+*
+* Register map, per timer (timer 1 is at +0x10):
+*
+*	TCSR (0x00): control / status, ENT starts the count, LOAD copies TLR
+*	TLR  (0x04): load register
+*	TCR  (0x08): read: current count
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <string.h>
+#include <time.h>
+#include "xparameters.h"
+#include "xtmrctr.h"
+#include "hal.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define HAL_NUM_TIMERS		2
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct hal_timer {
+
+	u32			tcsr;
+	u32			tlr;
+	u32			count;		// count when the timer was last started / loaded
+	u64			since;		// host tick at that point
+
+} hal_timer_t;
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static hal_timer_t	timer[HAL_NUM_TIMERS];
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static u64 hal_tmrctr_ticks(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (u64) ts.tv_sec * XPAR_TMRCTR_0_CLOCK_FREQ_HZ +
+		(u64) ts.tv_nsec * (XPAR_TMRCTR_0_CLOCK_FREQ_HZ / 1000000) / 1000;
+}
+
+static u32 hal_tmrctr_count(const hal_timer_t *t) {
+
+	u32 elapsed;
+
+	if (!(t->tcsr & XTC_CSR_ENABLE_TMR_MASK)) {
+		return t->count;
+	}
+
+	elapsed = (u32) (hal_tmrctr_ticks() - t->since);
+
+	return (t->tcsr & XTC_CSR_DOWN_COUNT_MASK) ? t->count - elapsed : t->count + elapsed;
+}
+
+/****************************************************************************/
+/************************** Register Model **********************************/
+/****************************************************************************/
+
+static u32 hal_tmrctr_read(u32 offset) {
+
+	hal_timer_t *t = &timer[(offset / XTC_TIMER_COUNTER_OFFSET) % HAL_NUM_TIMERS];
+
+	switch (offset % XTC_TIMER_COUNTER_OFFSET) {
+
+		case XTC_TCSR_OFFSET:
+			return t->tcsr;
+
+		case XTC_TLR_OFFSET:
+			return t->tlr;
+
+		case XTC_TCR_OFFSET:
+			return hal_tmrctr_count(t);
+
+		default:
+			return 0;
+	}
+}
+
+static void hal_tmrctr_write(u32 offset, u32 data) {
+
+	hal_timer_t *t = &timer[(offset / XTC_TIMER_COUNTER_OFFSET) % HAL_NUM_TIMERS];
+
+	switch (offset % XTC_TIMER_COUNTER_OFFSET) {
+
+		case XTC_TCSR_OFFSET:
+
+			// freeze the running count, then apply the new control bits
+
+			t->count = hal_tmrctr_count(t);
+			t->since = hal_tmrctr_ticks();
+			t->tcsr  = data;
+
+			if (data & XTC_CSR_LOAD_MASK) {
+				t->count = t->tlr;
+			}
+
+			break;
+
+		case XTC_TLR_OFFSET:
+			t->tlr = data;
+			break;
+
+		default:
+			break;
+	}
+}
+
+static const hal_device_t tmrctr_device = {
+
+	"AXI Timer",
+	XPAR_TMRCTR_0_BASEADDR,
+	XPAR_TMRCTR_0_HIGHADDR,
+	hal_tmrctr_read,
+	hal_tmrctr_write
+};
+
+/****************************************************************************/
+/************************** XTmrCtr Driver **********************************/
+/****************************************************************************/
+
+int XTmrCtr_Initialize(XTmrCtr *InstancePtr, u16 DeviceId) {
+
+	if (DeviceId != XPAR_TMRCTR_0_DEVICE_ID) {
+		return XST_DEVICE_NOT_FOUND;
+	}
+
+	InstancePtr->BaseAddress = XPAR_TMRCTR_0_BASEADDR;
+	InstancePtr->IsReady = TRUE;
+
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, 0, XTC_TCSR_OFFSET, 0);
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, 1, XTC_TCSR_OFFSET, 0);
+
+	return XST_SUCCESS;
+}
+
+void XTmrCtr_SetOptions(XTmrCtr *InstancePtr, u8 TmrCtrNumber, u32 Options) {
+
+	u32 csr = XTmrCtr_ReadReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET);
+
+	csr &= XTC_CSR_ENABLE_TMR_MASK;
+	csr |= (Options & XTC_AUTO_RELOAD_OPTION) ? XTC_CSR_AUTO_RELOAD_MASK : 0;
+	csr |= (Options & XTC_DOWN_COUNT_OPTION)  ? XTC_CSR_DOWN_COUNT_MASK  : 0;
+
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET, csr);
+}
+
+void XTmrCtr_SetResetValue(XTmrCtr *InstancePtr, u8 TmrCtrNumber, u32 ResetValue) {
+
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TLR_OFFSET, ResetValue);
+}
+
+void XTmrCtr_Start(XTmrCtr *InstancePtr, u8 TmrCtrNumber) {
+
+	u32 csr = XTmrCtr_ReadReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET);
+
+	// load the reset value, then enable the count (the real driver does the same)
+
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET, csr | XTC_CSR_LOAD_MASK);
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET, csr | XTC_CSR_ENABLE_TMR_MASK);
+}
+
+void XTmrCtr_Stop(XTmrCtr *InstancePtr, u8 TmrCtrNumber) {
+
+	u32 csr = XTmrCtr_ReadReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET);
+
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET, csr & ~XTC_CSR_ENABLE_TMR_MASK);
+}
+
+u32 XTmrCtr_GetValue(XTmrCtr *InstancePtr, u8 TmrCtrNumber) {
+
+	return XTmrCtr_ReadReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCR_OFFSET);
+}
+
+/****************************************************************************/
+/************************** HAL Functions ***********************************/
+/****************************************************************************/
+
+void hal_tmrctr_init(void) {
+
+	memset(timer, 0, sizeof(timer));
+
+	hal_io_register(&tmrctr_device);
+}
@@ -0,0 +1,48 @@
+/**
+*
+* @file hal_uart.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host stand-in for the UART Lite behind outbyte(). On the board the BSP
+* sends each byte to STDOUT_BASEADDR; here the bytes go to stdout unless a
+* benchmark captures them into a file with hal_uart_capture(), which is how
+* the binary profile dumps (profile.c) reach the host decoder.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include "xil_printf.h"
+#include "hal.h"
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static FILE *uart_out = NULL;
+
+/****************************************************************************/
+/************************** BSP Functions ***********************************/
+/****************************************************************************/
+
+void outbyte(char c) {
+
+	fputc(c, uart_out ? uart_out : stdout);
+}
+
+/****************************************************************************/
+/************************** HAL Functions ***********************************/
+/****************************************************************************/
+
+void hal_uart_capture(FILE *out) {
+
+	if (uart_out) {
+		fflush(uart_out);
+	}
+
+	uart_out = out;
+}
@@ -0,0 +1,305 @@
+/**
+*
+* @file prof_decode.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Host decoder for the binary cycle profiles sent by profile_dump()
+* (software/profile.c). Point it at a raw capture of the serial port, e.g.
+*
+*	stty -F /dev/ttyUSB1 115200 raw && cat /dev/ttyUSB1 > capture.bin
+*
+* or at the profile.bin written by bench_profile. Console text around the
+* frames is skipped; every frame with a good checksum is printed as a
+* count / min / mean / max table per profiled point, the block & half-buffer
+* headroom against the real-time budget, the log2 histograms and the tail of the
+* ring of raw durations.
+*
+* Usage:
+*	prof_decode [file]	(reads stdin without a file)
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "profile.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define MAX_CAPTURE			(16 * 1024 * 1024)
+#define MAX_POINTS			16
+#define MAX_BINS			32
+#define RING_TAIL			16
+#define BAR_WIDTH			40
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+// Read cursor over one frame; any read past the end marks it bad
+
+typedef struct cursor {
+
+	const unsigned char	*data;
+	size_t				pos;
+	size_t				len;
+	int					bad;
+
+} cursor_t;
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static const char *point_names[PROF_NUM_POINTS] = {
+
+	"block", "half", "button ISR", "switch ISR", "input ISR"
+};
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static unsigned int get_u8(cursor_t *c) {
+
+	if (c->pos + 1 > c->len) {
+		c->bad = 1;
+		return 0;
+	}
+
+	return c->data[c->pos++];
+}
+
+static unsigned int get_u16(cursor_t *c) {
+
+	unsigned int lo = get_u8(c);
+
+	return lo | (get_u8(c) << 8);
+}
+
+static unsigned long get_u32(cursor_t *c) {
+
+	unsigned long lo = get_u16(c);
+
+	return lo | ((unsigned long) get_u16(c) << 16);
+}
+
+static const char *point_name(unsigned int point) {
+
+	return (point < PROF_NUM_POINTS) ? point_names[point] : "?";
+}
+
+// decode one frame starting just after the magic; returns its length or 0
+
+static size_t decode_frame(const unsigned char *data, size_t len, unsigned int frame) {
+
+	unsigned long		count[MAX_POINTS], min[MAX_POINTS], max[MAX_POINTS];
+	unsigned long long	sum[MAX_POINTS];
+	unsigned long		bins[MAX_POINTS][MAX_BINS];
+	unsigned long		timer_hz, sample_rate, entry, peak;
+	unsigned int		version, points, nbins, half_bits, block_size, overhead, entries;
+	unsigned int		sum1 = 0, sum2 = 0, check;
+	unsigned int		i, j, width;
+	double				budget, scale;
+	size_t				body;
+	cursor_t			c = { data, 0, len, 0 };
+
+	version = get_u8(&c);
+	points  = get_u8(&c);
+	nbins   = get_u8(&c);
+	half_bits = get_u8(&c);
+
+	if (c.bad || (version != PROF_DUMP_VERSION) || (points > MAX_POINTS) || (nbins > MAX_BINS)) {
+		return 0;
+	}
+
+	timer_hz    = get_u32(&c);
+	sample_rate = get_u32(&c);
+	block_size  = get_u16(&c);
+	overhead    = get_u16(&c);
+
+	for (i = 0; i < points; i++) {
+
+		count[i] = get_u32(&c);
+		min[i]   = get_u32(&c);
+		max[i]   = get_u32(&c);
+		sum[i]   = get_u32(&c);
+		sum[i]  |= (unsigned long long) get_u32(&c) << 32;
+
+		for (j = 0; j < nbins; j++) {
+			bins[i][j] = get_u32(&c);
+		}
+	}
+
+	entries = get_u16(&c);
+	c.pos += 4 * (size_t) entries;
+
+	if (c.bad || (c.pos + 2 > len)) {
+		return 0;
+	}
+
+	// Fletcher-16 over everything between the magic and the checksum
+
+	body = c.pos;
+
+	for (i = 0; i < body; i++) {
+		sum1 = (sum1 + data[i]) % 255;
+		sum2 = (sum2 + sum1) % 255;
+	}
+
+	check = get_u16(&c);
+
+	if (check != ((sum2 << 8) | sum1)) {
+
+		fprintf(stderr, "frame %u: checksum mismatch, skipped\n", frame);
+		return 0;
+	}
+
+	scale  = timer_hz ? 1e6 / timer_hz : 0.0;
+	budget = sample_rate ? (double) block_size * timer_hz / sample_rate : 0.0;
+
+	printf("\nframe %u: %lu Hz timer, %lu Hz sample rate, %u-sample blocks, %u cycles START/STOP overhead\n\n",
+		frame, timer_hz, sample_rate, block_size, overhead);
+
+	printf("  %-12s %10s %10s %12s %10s %12s %10s\n",
+		"point", "count", "min", "mean", "max", "mean (us)", "max (us)");
+
+	for (i = 0; i < points; i++) {
+
+		double mean = count[i] ? (double) sum[i] / count[i] : 0.0;
+
+		printf("  %-12s %10lu %10lu %12.1f %10lu %12.2f %10.2f\n",
+			point_name(i), count[i], min[i], mean, max[i], mean * scale, max[i] * scale);
+	}
+
+	// the blocks have to keep up with the samples arriving
+
+	if ((points > PROF_BLOCK) && count[PROF_BLOCK] && (budget > 0.0)) {
+
+		double mean = (double) sum[PROF_BLOCK] / count[PROF_BLOCK];
+
+		printf("\n  block budget %.0f cycles: mean %.1f%% used (%.1f%% headroom), worst %.1f%%\n",
+			budget, 100.0 * mean / budget, 100.0 - 100.0 * mean / budget,
+			100.0 * max[PROF_BLOCK] / budget);
+	}
+
+	// and each half buffer before the next interrupt (0 from older builds)
+
+	if ((half_bits > 0) && (points > PROF_HALF) && count[PROF_HALF] && (budget > 0.0)) {
+
+		double mean = (double) sum[PROF_HALF] / count[PROF_HALF];
+		double half = budget * (1u << half_bits) / block_size;
+
+		printf("  half budget %.0f cycles: mean %.1f%% used (%.1f%% headroom), worst %.1f%%\n",
+			half, 100.0 * mean / half, 100.0 - 100.0 * mean / half,
+			100.0 * max[PROF_HALF] / half);
+	}
+
+	// log2 histograms, bars scaled to each point's fullest bin
+
+	for (i = 0; i < points; i++) {
+
+		if (count[i] == 0) {
+			continue;
+		}
+
+		printf("\n  %s histogram (cycles)\n", point_name(i));
+
+		for (peak = 0, j = 0; j < nbins; j++) {
+			peak = (bins[i][j] > peak) ? bins[i][j] : peak;
+		}
+
+		for (j = 0; j < nbins; j++) {
+
+			if (bins[i][j] == 0) {
+				continue;
+			}
+
+			width = (unsigned int) ((bins[i][j] * BAR_WIDTH + peak - 1) / peak);
+
+			printf("    %s%9lu %10lu  %.*s\n", (j == nbins - 1) ? ">=" : "  ",
+				1ul << j, bins[i][j], width, "########################################");
+		}
+	}
+
+	// the most recent raw durations
+
+	if (entries > 0) {
+
+		printf("\n  last %u of %u ring entries (point: cycles)\n   ",
+			(entries < RING_TAIL) ? entries : RING_TAIL, entries);
+
+		for (i = (entries > RING_TAIL) ? entries - RING_TAIL : 0; i < entries; i++) {
+
+			c.pos = body - 4 * (size_t) (entries - i);
+			entry = get_u32(&c);
+
+			printf(" %s: %lu", point_name(entry >> 28), entry & 0x0FFFFFFF);
+		}
+
+		printf("\n");
+	}
+
+	return body + 2;
+}
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main(int argc, char **argv) {
+
+	FILE			*in = stdin;
+	unsigned char	*data;
+	size_t			len, pos = 0, used;
+	unsigned int	frames = 0;
+
+	if ((argc > 1) && ((in = fopen(argv[1], "rb")) == NULL)) {
+
+		perror(argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	if ((data = malloc(MAX_CAPTURE)) == NULL) {
+
+		fprintf(stderr, "out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	len = fread(data, 1, MAX_CAPTURE, in);
+
+	// scan for the magic, skipping whatever console text is in between
+
+	while (pos + 4 <= len) {
+
+		if (memcmp(&data[pos], PROF_DUMP_MAGIC, 4) != 0) {
+			pos++;
+			continue;
+		}
+
+		pos += 4;
+		used = decode_frame(&data[pos], len - pos, frames + 1);
+
+		if (used > 0) {
+			frames++;
+			pos += used;
+		}
+	}
+
+	if (frames == 0) {
+
+		fprintf(stderr, "no profile frames found\n");
+		return EXIT_FAILURE;
+	}
+
+	free(data);
+
+	return EXIT_SUCCESS;
+}
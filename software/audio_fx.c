@@ -0,0 +1,645 @@
+/* audio_fx - DSP effects for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * This file carries out the DSP for the project, one full pass over the
+ * InputBuffer at a time. Depending on sw[1:0] state, one of the following
+ * effects will apply:
+ *
+ *      00: no effects
+ *      01: chorus effect
+ *      10: delay effect
+ *      11: chorus + delay effects
+ *
+ * Values are read from the InputBuffer, processed with DSP, and stored in
+ * the DelayBuffer for playback by the hardware module AudioOutput. The
+ * ChorusBuffer holds the dry history read by the chorus (lower half, see
+ * chorus.c) and the pre-delay history read by the delay taps (upper half).
+ *
+ * The effects are Sound Tools effects (st_effect_t, see handlers.c) and each
+ * mode is a chain of them run by fx_chain.c: chorus, echo, and chorus then
+ * echo, each followed by the compand effect as a lookahead limiter
+ * (compand.c) that keeps the output under FX_LIMIT_CEILING_DB by turning
+ * loud passages down rather than clipping them. process_block() only points
+ * the chain source at the input lines and the sink at the output lines and
+ * runs the chain over them. The no-effects chain has no stages: nothing in
+ * it can add gain to lines that are already 16 bits, so process_block()
+ * copies them straight across instead of running it. The four chains share the chorus, echo and
+ * limiter instances, so switching modes keeps the effect state, and one
+ * buffer pool, as only one of them runs at a time. All three effects work
+ * in place (ST_EFF_INPLACE), so that pool is one block: every chain runs
+ * each block through its input buffer with no copies.
+ * The echo effect is the delay line below; it keeps its own line count.
+ *
+ * The delay modes use the software delay engine by default, so the limiter
+ * sees the taps mixed in (delay_line_mix()) and really is the last stage.
+ *
+ * With the hardware delay engine (set_delay_engine()) the taps are not
+ * mixed here at all: the pre-delay signal goes straight to the DelayBuffer
+ * and its echo engine adds the taps as AudioOutput plays the lines, so the
+ * delay costs no bus traffic. That is after the limiter, so bram_write()
+ * turns the limited signal down by 1 / (1 + the sum of the tap gains)
+ * while the echo is on: a line and all of its echoes then stay under the
+ * ceiling, at that cost in level (about 9 dB with the default taps). Lines
+ * written before the echo came on are at full level, so echoes of them can
+ * still saturate for one longest tap delay. The tap setters below keep the
+ * engine's tap table in step with delay_fx, which stays the one copy of
+ * the taps. The engine works on the output timeline, whose history is
+ * always there, so unlike the software line it has echoes of the past as
+ * soon as it is switched on.
+ *
+ * process_half() runs once per InputBuffer interrupt and handles the
+ * INPUT_HALF_LINES lines of the half AudioInput has just finished; the
+ * interrupt handler queues its first line (see peripherals.c), so a late
+ * call still picks the right lines.
+ * The output goes a fixed OUTPUT_LEAD lines ahead of the AudioOutput read
+ * pointer. Input-to-output latency is therefore INPUT_HALF_LINES +
+ * OUTPUT_LEAD lines, plus the limiter's lookahead. A half that never
+ * reached process_half() (the queue was full) is counted as an input
+ * overrun. process_sweep() still runs one blind pass over the whole buffer
+ * for the host benchmarks.
+ *
+ * Only the buffer drivers are used here, so the same file builds for the
+ * board and for the host models in host/.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "stdbool.h"
+#include "st_i.h"
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_types.h"
+
+#include "ChorusBuffer.h"
+#include "DelayBuffer.h"
+#include "InputBuffer.h"
+#include "audio_fx.h"
+#include "compand.h"
+#include "fx_chain.h"
+#include "profile.h"
+
+/****************************************************************************/
+/***************************** Global Variables *****************************/
+/****************************************************************************/
+
+// delay line over the ChorusBuffer, which holds the pre-delay signal
+
+static delay_line_t delay_fx;
+
+// where the delay taps are mixed, whether the DelayBuffer echo is on, and
+// the next line of the delay line and its tail still to drain
+
+static unsigned int delay_engine    = DELAY_ENGINE_DEFAULT;
+static bool         echo_on         = false;
+static unsigned int delay_pos       = 0x00;
+static unsigned int delay_fade_out  = 0x00;
+
+// the echo and limiter effect instances, the chains of the four modes,
+// their shared buffer pool (one block, as the effects work in place;
+// init_chains() fails if a chain would need more), and the chain running
+// now (none until the first block)
+
+static struct st_effect echo_effect;
+static struct st_effect limit_effect;
+
+static fx_chain_t   fx_chains[FX_NUM_CHAINS];
+static st_sample_t  fx_pool[FX_POOL_LEN];
+static fx_chain_t   *fx_running     = NULL;
+
+// the lines the running chain reads from the InputBuffer and writes to the
+// DelayBuffer next
+
+typedef struct bram_io {
+
+    unsigned int    in_line;
+    unsigned int    out_line;
+
+} bram_io_t;
+
+static bram_io_t    block_io;
+
+// positions for process_half: next input line expected, the output line
+// it goes to, how often the output had to be pulled back in line, and how
+// many halves went by unprocessed
+
+static bool         pointers_synced = false;
+static unsigned int in_line         = 0x00;
+static unsigned int out_line        = 0x00;
+static unsigned int output_resyncs  = 0x00;
+static unsigned int input_overruns  = 0x00;
+
+/****************************************************************************/
+/***************************** LOCAL FUNCTIONS ******************************/
+/****************************************************************************/
+
+// set one tap in delay_fx (which clamps it) and copy it to the echo engine
+
+static XStatus set_tap(unsigned int tap, unsigned int delay, unsigned int gain) {
+
+    XStatus status = delay_line_set_tap(&delay_fx, tap, delay, gain);
+
+    if (status == XST_SUCCESS) {
+        DelayBuffer_SetEchoTap(tap, delay_fx.tap[tap].delay, delay_fx.tap[tap].gain);
+    }
+
+    return status;
+}
+
+// the level the hardware echo needs under it, Q1.15: 1 / (1 + the tap
+// gains), rounded down, so a line plus every echo of it stays within what
+// the limiter let through
+
+static unsigned int echo_headroom(void) {
+
+    unsigned int t, sum = Q15_ONE;
+
+    for (t = 0; t < delay_fx.num_taps; t++) {
+        sum += delay_fx.tap[t].gain;
+    }
+
+    return (Q15_ONE * Q15_ONE) / sum;
+}
+
+// turn the DelayBuffer echo on or off, one bus write when it changes
+
+static void set_echo(bool on) {
+
+    if (on != echo_on) {
+
+        DelayBuffer_SetEcho(delay_fx.num_taps, on);
+        echo_on = on;
+    }
+
+    return;
+}
+
+// chain source: the next lines of the InputBuffer
+
+static st_size_t bram_read(void *io, st_sample_t *buf, st_size_t len) {
+
+    bram_io_t    *bio = (bram_io_t *) io;
+    unsigned int *lines = (unsigned int *) buf;
+    st_size_t    i;
+
+    InputBuffer_ReadBlock(bio->in_line, len, lines);
+
+    for (i = 0; i < len; i++) {
+        buf[i] = FX_LINE_TO_SAMPLE(lines[i]);
+    }
+
+    bio->in_line = (bio->in_line + len) & BUFFER_MASK;
+
+    return len;
+}
+
+// chain sink: the next lines of the DelayBuffer
+
+static void bram_write(void *io, const st_sample_t *buf, st_size_t len) {
+
+    bram_io_t    *bio = (bram_io_t *) io;
+    unsigned int lines[BLOCK_SIZE];
+    unsigned int scale;
+    st_size_t    i;
+
+    for (i = 0; i < len; i++) {
+        lines[i] = FX_SAMPLE_TO_LINE(buf[i]);
+    }
+
+    // the hardware echo adds its taps after the limiter: leave room for them
+
+    if (echo_on) {
+
+        scale = echo_headroom();
+
+        for (i = 0; i < len; i++) {
+            lines[i] = PCM_LINE(Q15_SCALE(PCM_VALUE(lines[i]), scale));
+        }
+    }
+
+    DelayBuffer_WriteStream(bio->out_line, len, lines);
+
+    bio->out_line = (bio->out_line + len) & BUFFER_MASK;
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** ECHO HANDLER *********************************/
+/****************************************************************************/
+
+// the delay taps as a Sound Tools echo: the input plus each tap's delayed
+// and scaled copy of it (st_echo_* in st_i.h, parameters from init_fx and
+// the tap setters)
+
+int st_echo_start(eff_t effp) {
+
+    unsigned int t;
+
+    delay_fade_out = 0;
+
+    for (t = 0; t < delay_fx.num_taps; t++) {
+        delay_fade_out = MAX(delay_fade_out, delay_fx.tap[t].delay);
+    }
+
+    return ST_SUCCESS;
+}
+
+int st_echo_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf,
+                 st_size_t *isamp, st_size_t *osamp) {
+
+    unsigned int in[BLOCK_SIZE];
+    unsigned int out[BLOCK_SIZE];
+    unsigned int len = MIN(*isamp, *osamp);
+    unsigned int done, chunk, i;
+
+    // with the hardware engine, the DelayBuffer adds the taps on playback
+
+    set_echo(delay_engine == DELAY_ENGINE_HARDWARE);
+
+    for (done = 0; done < len; done += chunk) {
+
+        chunk = MIN(len - done, BLOCK_SIZE);
+
+        if (delay_engine == DELAY_ENGINE_HARDWARE) {
+
+            for (i = 0; (obuf != ibuf) && (i < chunk); i++) {
+                obuf[done + i] = ibuf[done + i];
+            }
+
+            continue;
+        }
+
+        for (i = 0; i < chunk; i++) {
+            in[i]  = FX_SAMPLE_TO_LINE(ibuf[done + i]);
+            out[i] = in[i];
+        }
+
+        // overlay the delay taps (one streamed read + one multiply-
+        // accumulate per tap & sample), then keep the pre-delay signal
+
+        delay_line_mix(&delay_fx, delay_pos, chunk, out);
+        delay_line_write(&delay_fx, delay_pos, chunk, in);
+
+        delay_pos += chunk;
+
+        for (i = 0; i < chunk; i++) {
+            obuf[done + i] = FX_LINE_TO_SAMPLE(out[i]);
+        }
+    }
+
+    *isamp = len;
+    *osamp = len;
+
+    return ST_SUCCESS;
+}
+
+int st_echo_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp) {
+
+    st_sample_t  silence[BLOCK_SIZE];
+    st_size_t    len;
+    unsigned int i;
+
+    // the hardware echo plays its tail from the DelayBuffer by itself
+
+    if (delay_engine == DELAY_ENGINE_HARDWARE) {
+        delay_fade_out = 0;
+    }
+
+    len = MIN(MIN(*osamp, delay_fade_out), BLOCK_SIZE);
+
+    for (i = 0; i < len; i++) {
+        silence[i] = 0;
+    }
+
+    st_echo_flow(effp, silence, obuf, &len, &len);
+
+    delay_fade_out -= len;
+    *osamp = len;
+
+    return ST_SUCCESS;
+}
+
+int st_echo_stop(eff_t effp) {
+
+    set_echo(false);
+
+    return ST_SUCCESS;
+}
+
+/****************************************************************************/
+/***************************** INIT CHAINS **********************************/
+/****************************************************************************/
+
+// the chain of each sw[1:0] mode, all between the InputBuffer and the
+// DelayBuffer, the effect modes ending in the limiter
+
+static XStatus init_chains(void) {
+
+    eff_t        chorus = chorus_effect();
+    eff_t        echo   = &echo_effect;
+    eff_t        limit  = &limit_effect;
+    eff_t        stages[FX_NUM_CHAINS][3];
+    unsigned int mode;
+    XStatus      status;
+
+    if (fx_running != NULL) {
+
+        fx_chain_stop(fx_running);
+        fx_running = NULL;
+    }
+
+    if ((st_geteffect(chorus, "chorus") != ST_SUCCESS) ||
+        (st_geteffect(echo, "echo") != ST_SUCCESS) ||
+        (st_geteffect(limit, "compand") != ST_SUCCESS)) {
+
+        return XST_FAILURE;
+    }
+
+    // the limiter is set up afresh here, and carries on across mode changes
+
+    limit->ininfo.rate     = SAMPLE_RATE;
+    limit->ininfo.channels = 1;
+
+    if (compand_limiter(limit, FX_LIMIT_CEILING_DB, FX_LIMIT_LOOKAHEAD_MS, FX_LIMIT_RELEASE_MS) != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+
+    stages[MSK_CHORUS_FX][0]       = chorus;
+    stages[MSK_CHORUS_FX][1]       = limit;
+    stages[MSK_DELAY_FX][0]        = echo;
+    stages[MSK_DELAY_FX][1]        = limit;
+    stages[MSK_CHORUS_DELAY_FX][0] = chorus;
+    stages[MSK_CHORUS_DELAY_FX][1] = echo;
+    stages[MSK_CHORUS_DELAY_FX][2] = limit;
+
+    status  = fx_chain_init(&fx_chains[MSK_NO_FX], NULL, 0, fx_pool, FX_POOL_LEN, BLOCK_SIZE);
+    status |= fx_chain_init(&fx_chains[MSK_CHORUS_FX], stages[MSK_CHORUS_FX], 2, fx_pool, FX_POOL_LEN, BLOCK_SIZE);
+    status |= fx_chain_init(&fx_chains[MSK_DELAY_FX], stages[MSK_DELAY_FX], 2, fx_pool, FX_POOL_LEN, BLOCK_SIZE);
+    status |= fx_chain_init(&fx_chains[MSK_CHORUS_DELAY_FX], stages[MSK_CHORUS_DELAY_FX], 3, fx_pool,
+                            FX_POOL_LEN, BLOCK_SIZE);
+
+    if (status != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+
+    for (mode = 0; mode < FX_NUM_CHAINS; mode++) {
+        fx_chain_set_io(&fx_chains[mode], bram_read, bram_write, &block_io);
+    }
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/***************************** INIT EFFECTS *********************************/
+/****************************************************************************/
+
+XStatus init_fx(void) {
+
+    XStatus status;
+
+    // chorus voice, with its history in the lower half of the ChorusBuffer
+
+    status = chorus_start(CHORUS_IN_GAIN, CHORUS_OUT_GAIN, SAMPLE_RATE);
+
+    if (status == XST_SUCCESS) {
+        status = chorus_add_voice(CHORUS_DELAY_MS, CHORUS_DECAY, CHORUS_SPEED_HZ, CHORUS_DEPTH_MS, MOD_SINE);
+    }
+
+    if (status != XST_SUCCESS) {
+        return status;
+    }
+
+    // power-of-two line over the upper half of the ChorusBuffer; taps stay
+    // at least one block behind so they never read lines not yet written
+
+    status = delay_line_init(&delay_fx, ChorusBuffer_ReadBlock, ChorusBuffer_WriteStream,
+                             DELAY_LINE_BASE, DELAY_LINE_DEPTH, BLOCK_SIZE);
+
+    if (status != XST_SUCCESS) {
+        return status;
+    }
+
+    set_tap(0, DELAY_TAP_0, DELAY_GAIN_TAP_0);
+    set_tap(1, DELAY_TAP_1, DELAY_GAIN_TAP_1);
+    set_tap(2, DELAY_TAP_2, DELAY_GAIN_TAP_2);
+
+    status = set_num_taps(DELAY_NUM_TAPS);
+    delay_pos = 0;
+
+    if (status != XST_SUCCESS) {
+        return status;
+    }
+
+    return init_chains();
+}
+
+/****************************************************************************/
+/***************************** DELAY TAPS ***********************************/
+/****************************************************************************/
+
+XStatus set_num_taps(unsigned int num_taps) {
+
+    XStatus status = delay_line_set_num_taps(&delay_fx, num_taps);
+
+    if (status == XST_SUCCESS) {
+        DelayBuffer_SetEcho(num_taps, echo_on);
+    }
+
+    return status;
+}
+
+XStatus set_tap_delay(unsigned int tap, unsigned int delay) {
+
+    if (tap >= DELAY_MAX_TAPS) {
+        return XST_INVALID_PARAM;
+    }
+
+    return set_tap(tap, delay, delay_fx.tap[tap].gain);
+}
+
+XStatus set_tap_gain(unsigned int tap, unsigned int gain) {
+
+    if (tap >= DELAY_MAX_TAPS) {
+        return XST_INVALID_PARAM;
+    }
+
+    return set_tap(tap, delay_fx.tap[tap].delay, gain);
+}
+
+unsigned int get_tap_delay(unsigned int tap) {
+
+    return (tap < DELAY_MAX_TAPS) ? delay_fx.tap[tap].delay : 0;
+}
+
+unsigned int get_tap_gain(unsigned int tap) {
+
+    return (tap < DELAY_MAX_TAPS) ? delay_fx.tap[tap].gain : 0;
+}
+
+/****************************************************************************/
+/***************************** DELAY ENGINE *********************************/
+/****************************************************************************/
+
+XStatus set_delay_engine(unsigned int engine) {
+
+    if ((engine != DELAY_ENGINE_SOFTWARE) && (engine != DELAY_ENGINE_HARDWARE)) {
+        return XST_INVALID_PARAM;
+    }
+
+    // the next block turns the echo back on if it is wanted
+
+    delay_engine = engine;
+    set_echo(false);
+
+    return XST_SUCCESS;
+}
+
+unsigned int get_delay_engine(void) {
+
+    return delay_engine;
+}
+
+/****************************************************************************/
+/***************************** PROCESS BLOCK ********************************/
+/****************************************************************************/
+
+fx_chain_t *select_fx_chain(unsigned int switch_fx) {
+
+    fx_chain_t *chain = &fx_chains[switch_fx & MSK_LOWER_2_BITS];
+
+    // a mode change stops the old chain (the echo turns the DelayBuffer
+    // echo off) and starts the new one on the shared pool
+
+    if (chain != fx_running) {
+
+        if (fx_running != NULL) {
+            fx_chain_stop(fx_running);
+        }
+
+        fx_chain_start(chain);
+        fx_running = chain;
+    }
+
+    return chain;
+}
+
+static void process_block(unsigned int in_start, unsigned int out_start, unsigned int switch_fx) {
+
+    fx_chain_t   *chain;
+    unsigned int lines[BLOCK_SIZE];
+
+    PROFILE_START(PROF_BLOCK);
+
+    // one block from the InputBuffer through the effects of the mode into
+    // the DelayBuffer (one streamed read & write per sample)
+
+    chain = select_fx_chain(switch_fx);
+
+    // no stages: the lines as they are, without the runner or the
+    // conversions to samples and back
+
+    if (chain->num_stages == 0) {
+
+        InputBuffer_ReadBlock(in_start, BLOCK_SIZE, lines);
+        DelayBuffer_WriteStream(out_start, BLOCK_SIZE, lines);
+
+        PROFILE_STOP(PROF_BLOCK);
+        return;
+    }
+
+    block_io.in_line  = in_start;
+    block_io.out_line = out_start;
+
+    fx_chain_run(chain, BLOCK_SIZE);
+
+    PROFILE_STOP(PROF_BLOCK);
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** PROCESS SWEEP ********************************/
+/****************************************************************************/
+
+void process_sweep(unsigned int switch_fx) {
+
+    unsigned int blkline = 0x00;
+
+    for (blkline = 0; blkline < BUFFER_DEPTH; blkline += BLOCK_SIZE) {
+        process_block(blkline, blkline, switch_fx);
+    }
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** PROCESS HALF *********************************/
+/****************************************************************************/
+
+unsigned int process_half(unsigned int start, unsigned int switch_fx) {
+
+    unsigned int read_ptr  = 0x00;
+    unsigned int lead      = 0x00;
+    unsigned int done      = 0x00;
+
+    PROFILE_START(PROF_HALF);
+
+    // if the half is not where the last call left off, halves were missed
+
+    if (pointers_synced && (start != in_line)) {
+        input_overruns++;
+    }
+
+    in_line = start;
+    pointers_synced = true;
+
+    // keep the output a fixed distance ahead of what AudioOutput plays;
+    // if it drifted out of the window, jump back to the nominal lead
+
+    read_ptr = DelayBuffer_GetReadPointer();
+    lead = (out_line - read_ptr) & BUFFER_MASK;
+
+    if ((lead < OUTPUT_MIN_LEAD) || (lead > OUTPUT_MAX_LEAD)) {
+
+        out_line = (read_ptr + OUTPUT_LEAD) & BUFFER_MASK;
+        output_resyncs++;
+    }
+
+    // the whole half, one block at a time
+
+    for (done = 0; done < INPUT_HALF_LINES; done += BLOCK_SIZE) {
+
+        process_block(in_line, out_line, switch_fx);
+
+        in_line  = (in_line + BLOCK_SIZE) & BUFFER_MASK;
+        out_line = (out_line + BLOCK_SIZE) & BUFFER_MASK;
+    }
+
+    PROFILE_STOP(PROF_HALF);
+
+    return done;
+}
+
+unsigned int get_output_resyncs(void) {
+
+    return output_resyncs;
+}
+
+unsigned int get_input_overruns(void) {
+
+    return input_overruns;
+}
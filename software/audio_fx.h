@@ -0,0 +1,165 @@
+/* audio_fx.h - DSP effects for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Constants, structures and prototypes for the DSP effects applied by the
+ * main loop (see audio_fx.c). Nothing in here touches the GPIO or interrupt
+ * controller, so the same code runs on the board and on the host models.
+*/
+
+#ifndef AUDIO_FX_H
+#define AUDIO_FX_H
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "stdbool.h"
+#include "xil_types.h"
+#include "xstatus.h"
+#include "delay_line.h"
+#include "chorus.h"
+#include "fx_chain.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Effect selection (sw[1:0])
+
+#define MSK_NO_FX                   0x0000
+#define MSK_CHORUS_FX               0x0001
+#define MSK_DELAY_FX                0x0002
+#define MSK_CHORUS_DELAY_FX         0x0003
+#define MSK_LOWER_2_BITS            0x0003
+
+// Buffer geometry
+
+#define BUFFER_DEPTH        65536
+#define BUFFER_WIDTH        16
+#define BUFFER_MASK         (BUFFER_DEPTH - 1)
+#define BLOCK_SIZE          64
+
+// How far ahead of the AudioOutput read pointer new output is written,
+// and the window outside of which the output position is pulled back
+
+#define OUTPUT_LEAD         (2 * BLOCK_SIZE)
+#define OUTPUT_MIN_LEAD     (BLOCK_SIZE / 2)
+#define OUTPUT_MAX_LEAD     (OUTPUT_LEAD + 2 * BLOCK_SIZE)
+
+// Ping-pong window for the InputBuffer interrupts: half-full when AudioInput
+// has written the first INPUT_HALF_LINES lines of a window, full when it has
+// written the second. Each interrupt hands one half to process_half(), so
+// the input waits at most one half (8 ms at 16 kHz) before it is processed.
+// 15 would make the halves those of the whole buffer, at 2 s each.
+
+#define INPUT_HALF_BITS     7
+#define INPUT_HALF_LINES    (1 << INPUT_HALF_BITS)
+
+// First line of the half AudioInput finished last: the one before the half
+// the write pointer is in now
+
+#define INPUT_HALF_START(write_ptr) \
+    ( ((((write_ptr) + 1) & ~(INPUT_HALF_LINES - 1)) - INPUT_HALF_LINES) & BUFFER_MASK )
+
+// Effect chains, one per sw[1:0] mode, indexed by the mode
+
+#define FX_NUM_CHAINS       4
+
+// Samples of buffer pool the chains share: chorus, echo and the limiter all
+// work in place, so every chain runs in its input block
+
+#define FX_POOL_LEN         FX_CHAIN_POOL(0, BLOCK_SIZE)
+
+// Sample rate the effect timings are based on
+
+#define SAMPLE_RATE         16000
+
+// Default chorus: one sine-modulated voice, 50ms delay, 8ms depth at 5Hz.
+// in/out gains follow the Sound Tools example (0.7 / 0.9); the old 0.2 / 10
+// pair amplified by 6x and would saturate the 16-bit buffers.
+
+#define CHORUS_IN_GAIN      0.7
+#define CHORUS_OUT_GAIN     0.9
+#define CHORUS_DELAY_MS     50.0
+#define CHORUS_DECAY        0.4
+#define CHORUS_SPEED_HZ     5.0
+#define CHORUS_DEPTH_MS     8.0
+
+// The delay line history lives in the upper half of the ChorusBuffer
+// (the lower half holds the chorus history, see chorus.h)
+
+#define DELAY_LINE_BASE     32768
+#define DELAY_LINE_DEPTH    32768
+
+// Default delay taps @ 0.5s, 1.0s & 1.5s, at 80%, 60% & 45% amplitude.
+// The gains match the old float divides (/1.25, /1.66, /2.25) to 1 LSB.
+
+#define DELAY_NUM_TAPS      3
+
+#define DELAY_TAP_0         (BUFFER_DEPTH / 8)
+#define DELAY_TAP_1         (BUFFER_DEPTH / 4)
+#define DELAY_TAP_2         (BUFFER_DEPTH / 3)
+
+#define DELAY_GAIN_TAP_0    Q15_GAIN(1.0 / 1.25)
+#define DELAY_GAIN_TAP_1    Q15_GAIN(1.0 / 1.66)
+#define DELAY_GAIN_TAP_2    Q15_GAIN(1.0 / 2.25)
+
+// Limiter at the end of every effect mode (the compand effect, compand.c):
+// peaks held under -1 dBFS, 2 ms of lookahead (31 lines more latency) and a
+// 50 ms release. The no-effects mode copies the lines and has no limiter.
+
+#define FX_LIMIT_CEILING_DB     (-1.0)
+#define FX_LIMIT_LOOKAHEAD_MS   2.0
+#define FX_LIMIT_RELEASE_MS     50.0
+
+// Where the delay taps are mixed: in software over the ChorusBuffer
+// (delay_line.c), ahead of the limiter, or by the echo engine in the
+// DelayBuffer IP as the output is played, after it. Both use the same
+// taps; the hardware engine gets the limited signal turned down by
+// 1 / (1 + the tap gains) so its echoes stay under the ceiling too, and
+// frees the CPU of the delay at that cost in level. The software engine
+// is the default, so the limiter is the last stage of the delay modes.
+
+#define DELAY_ENGINE_SOFTWARE   0
+#define DELAY_ENGINE_HARDWARE   1
+#define DELAY_ENGINE_DEFAULT    DELAY_ENGINE_SOFTWARE
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+// set up effect state (call after the buffers are initialized)
+XStatus init_fx(void);
+
+// run one pass over the whole InputBuffer with the selected effect
+void    process_sweep(unsigned int switch_fx);
+
+// process the half starting at line start, returns lines processed
+unsigned int process_half(unsigned int start, unsigned int switch_fx);
+unsigned int get_output_resyncs(void);
+unsigned int get_input_overruns(void);
+
+// runtime delay taps: count, delay in lines & Q1.15 gain
+XStatus      set_num_taps(unsigned int num_taps);
+XStatus      set_tap_delay(unsigned int tap, unsigned int delay);
+XStatus      set_tap_gain(unsigned int tap, unsigned int gain);
+unsigned int get_tap_delay(unsigned int tap);
+unsigned int get_tap_gain(unsigned int tap);
+
+// delay engine: DELAY_ENGINE_SOFTWARE or DELAY_ENGINE_HARDWARE
+XStatus      set_delay_engine(unsigned int engine);
+unsigned int get_delay_engine(void);
+
+// make the chain of an sw[1:0] mode the running one (stopping the last) and
+// return it, e.g. to run it between other sources & sinks on the host;
+// init_fx() puts every chain back on the InputBuffer & DelayBuffer
+fx_chain_t  *select_fx_chain(unsigned int switch_fx);
+
+#endif
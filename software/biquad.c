@@ -0,0 +1,813 @@
+/* biquad - biquad cascade filter engine for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * One engine for the filter effects: a cascade of up to four second-order
+ * sections over up to four interleaved channels, designed once when the
+ * effect starts and then run a block at a time, each section over the
+ * whole block before the next, so a section's coefficients and history
+ * stay in registers across the block.
+ *
+ * There are two engines on the same coefficients:
+ *
+ *  o fixed point, for the MicroBlaze (no FPU): Direct Form I on 16-bit
+ *    samples, Q2.30 coefficients and 64-bit sums, with what each output
+ *    rounds off fed into the next two (second-order error feedback, a
+ *    double zero at DC), which keeps the rounding noise of low-cutoff
+ *    sections, whose poles sit next to 1, from being amplified by them
+ *  o single-precision float, for the host: Direct Form II transposed. With
+ *    SSE, four channels go through a section side by side, or one channel
+ *    goes through four sections at once, section k working on the sample
+ *    k before section 0's; the pipeline that makes holds three samples,
+ *    which the first outputs make up for and biquad_drain() gives back.
+ *    Every layout does the same sums in the same order, so all three give
+ *    the same output bit for bit.
+ *
+ * Below the engine are the Sound Tools lowp, highp, band and filter effects
+ * on top of it (st_*_getopts .. st_*_stop in st_i.h):
+ *
+ *  lowp freq [poles]           Butterworth low-pass, 1 to 8 poles (2)
+ *  highp freq [poles]          Butterworth high-pass, 1 to 8 poles (2)
+ *  band [-n] centre [width]    band-pass, 0 dB at the centre (width is
+ *                              centre / 2); -n scales it for noise, to the
+ *                              same power of white noise out as in
+ *  filter [low]-[high] [poles] Butterworth band-pass, a high-pass at low and
+ *                              a low-pass at high, 1 to 4 poles each (4)
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "xil_types.h"
+#include "xstatus.h"
+#include "st_i.h"
+
+#include "delay_line.h"
+#include "biquad.h"
+
+#if BIQUAD_HAVE_SIMD
+#include <emmintrin.h>
+#endif
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#ifndef M_PI
+#define M_PI                3.14159265358979323846
+#endif
+
+#define BIQUAD_Q_ONE        ((s64) 1 << BIQUAD_Q)
+#define BIQUAD_Q_MAX        (((s64) 2 << BIQUAD_Q) - 1)
+#define BIQUAD_PIPELINE     (BIQUAD_LANES - 1)
+
+// samples of impulse response summed for band -n
+
+#define BAND_NOISE_LEN      16384
+
+/****************************************************************************/
+/***************************** LOCAL FUNCTIONS ******************************/
+/****************************************************************************/
+
+static s32 to_q30(double c) {
+
+    double q = floor(c * BIQUAD_Q_ONE + 0.5);
+
+    return (s32) MIN(MAX(q, -(double) BIQUAD_Q_MAX), (double) BIQUAD_Q_MAX);
+}
+
+static s32 sat16(s32 x) {
+
+    return MIN(MAX(x, PCM_MIN), PCM_MAX);
+}
+
+static s32 float_to_pcm(float y) {
+
+    return (s32) lrintf(MIN(MAX(y, (float) PCM_MIN), (float) PCM_MAX));
+}
+
+// one section of the fixed-point engine over a channel of a block
+
+static void section_fixed(const s32 *q, biquad_fixed_state_t *st, s16 *x, unsigned int frames,
+                          unsigned int stride) {
+
+    s32 x1 = st->x1, x2 = st->x2, y1 = st->y1, y2 = st->y2, y;
+    s64 acc, e1 = st->e1, e2 = st->e2;
+    unsigned int n;
+
+    for (n = 0; n < frames * stride; n += stride) {
+
+        acc  = 2 * e1 - e2;
+        acc += (s64) q[0] * x[n] + (s64) q[1] * x1 + (s64) q[2] * x2;
+        acc += (s64) q[3] * y1 + (s64) q[4] * y2;
+
+        y  = (s32) (acc >> BIQUAD_Q);
+        e2 = e1;
+        e1 = acc - ((s64) y << BIQUAD_Q);
+
+        if (y != sat16(y)) {
+
+            y  = sat16(y);
+            e1 = e2 = 0;
+        }
+
+        x2 = x1;
+        x1 = x[n];
+        y2 = y1;
+        y1 = y;
+
+        x[n] = (s16) y;
+    }
+
+    st->x1  = x1;
+    st->x2  = x2;
+    st->y1  = y1;
+    st->y2  = y2;
+    st->e1  = (s32) e1;
+    st->e2  = (s32) e2;
+
+    return;
+}
+
+// one section of the float engine over a channel of a block
+
+static void section_float(const biquad_t *bq, unsigned int s, float *z1, float *z2, float *x,
+                          unsigned int frames, unsigned int stride) {
+
+    float b0 = bq->f[0][s], b1 = bq->f[1][s], b2 = bq->f[2][s];
+    float a1 = bq->f[3][s], a2 = bq->f[4][s];
+    float s1 = *z1, s2 = *z2, v, y;
+    unsigned int n;
+
+    for (n = 0; n < frames * stride; n += stride) {
+
+        v  = x[n];
+        y  = b0 * v + s1;
+        s1 = b1 * v - a1 * y + s2;
+        s2 = b2 * v - a2 * y;
+
+        x[n] = y;
+    }
+
+    *z1 = s1;
+    *z2 = s2;
+
+    return;
+}
+
+#if BIQUAD_HAVE_SIMD
+
+// the same over four channels, a lane each
+
+static void section_simd_channels(const biquad_t *bq, unsigned int s, float *x, unsigned int frames) {
+
+    __m128 b0 = _mm_set1_ps(bq->f[0][s]), b1 = _mm_set1_ps(bq->f[1][s]);
+    __m128 b2 = _mm_set1_ps(bq->f[2][s]), a1 = _mm_set1_ps(bq->f[3][s]);
+    __m128 a2 = _mm_set1_ps(bq->f[4][s]);
+    __m128 s1 = _mm_loadu_ps(bq->state.flt.z1[s]);
+    __m128 s2 = _mm_loadu_ps(bq->state.flt.z2[s]);
+    __m128 v, y;
+    unsigned int n;
+
+    for (n = 0; n < frames; n++) {
+
+        v  = _mm_loadu_ps(x + n * BIQUAD_LANES);
+        y  = _mm_add_ps(_mm_mul_ps(b0, v), s1);
+        s1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, v), _mm_mul_ps(a1, y)), s2);
+        s2 = _mm_sub_ps(_mm_mul_ps(b2, v), _mm_mul_ps(a2, y));
+
+        _mm_storeu_ps(x + n * BIQUAD_LANES, y);
+    }
+
+    _mm_storeu_ps((float *) bq->state.flt.z1[s], s1);
+    _mm_storeu_ps((float *) bq->state.flt.z2[s], s2);
+
+    return;
+}
+
+// one channel through four sections, a lane each: lane k takes what lane
+// k - 1 gave on the sample before, and lane 3 gives the output of the
+// sample three before. Returns the outputs, which go back over x.
+
+static unsigned int sections_simd(biquad_t *bq, float *x, unsigned int frames, unsigned int zeros) {
+
+    __m128 b0 = _mm_loadu_ps(bq->f[0]), b1 = _mm_loadu_ps(bq->f[1]);
+    __m128 b2 = _mm_loadu_ps(bq->f[2]), a1 = _mm_loadu_ps(bq->f[3]);
+    __m128 a2 = _mm_loadu_ps(bq->f[4]);
+    __m128 s1 = _mm_loadu_ps(bq->state.flt.z1[0]);
+    __m128 s2 = _mm_loadu_ps(bq->state.flt.z2[0]);
+    __m128 y  = _mm_loadu_ps(bq->state.flt.pipe);
+    __m128 v;
+    unsigned int n, made = 0;
+    float out[BIQUAD_LANES];
+
+    for (n = 0; n < frames; n++) {
+
+        // lanes 0..2 of the last step move up a lane, the sample goes in 0
+
+        v  = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(y), 4));
+        v  = _mm_move_ss(v, _mm_set_ss(x[n]));
+
+        y  = _mm_add_ps(_mm_mul_ps(b0, v), s1);
+        s1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, v), _mm_mul_ps(a1, y)), s2);
+        s2 = _mm_sub_ps(_mm_mul_ps(b2, v), _mm_mul_ps(a2, y));
+
+        bq->pending += !zeros;
+
+        if (bq->skip > 0) {
+            bq->skip--;
+        }
+
+        else {
+
+            _mm_storeu_ps(out, y);
+            x[made++] = out[BIQUAD_LANES - 1];
+            bq->pending--;
+        }
+    }
+
+    _mm_storeu_ps(bq->state.flt.z1[0], s1);
+    _mm_storeu_ps(bq->state.flt.z2[0], s2);
+    _mm_storeu_ps(bq->state.flt.pipe, y);
+
+    return made;
+}
+
+#endif
+
+// one block of frames through the cascade; returns the frames out
+
+static unsigned int run_block(biquad_t *bq, const st_sample_t *in, st_sample_t *out, unsigned int frames) {
+
+    unsigned int len = frames * bq->channels, s, c, i, made = frames;
+    s16          fixed[BIQUAD_CHUNK * BIQUAD_MAX_CHANNELS];
+    float        flt[BIQUAD_CHUNK * BIQUAD_MAX_CHANNELS];
+
+    if (bq->engine == BIQUAD_ENGINE_FIXED) {
+
+        for (i = 0; i < len; i++) {
+            fixed[i] = (in != NULL) ? ST_SAMPLE_TO_SIGNED_WORD(in[i]) : 0;
+        }
+
+        for (s = 0; s < bq->sections; s++) {
+            for (c = 0; c < bq->channels; c++) {
+                section_fixed(bq->q[s], &bq->state.fixed[s][c], fixed + c, frames, bq->channels);
+            }
+        }
+
+        for (i = 0; i < len; i++) {
+            out[i] = ST_SIGNED_WORD_TO_SAMPLE(fixed[i]);
+        }
+
+        return frames;
+    }
+
+    // float, in 16-bit units; no input is silence, for the drain
+
+    for (i = 0; i < len; i++) {
+        flt[i] = (in != NULL) ? (float) in[i] * (1.0f / 65536.0f) : 0.0f;
+    }
+
+    switch (bq->layout) {
+
+#if BIQUAD_HAVE_SIMD
+
+        case BIQUAD_SIMD_CHANNELS:
+
+            for (s = 0; s < bq->sections; s++) {
+                section_simd_channels(bq, s, flt, frames);
+            }
+
+            break;
+
+        case BIQUAD_SIMD_SECTIONS:
+
+            made = sections_simd(bq, flt, frames, (in == NULL));
+            break;
+
+#endif
+
+        default:
+
+            for (s = 0; s < bq->sections; s++) {
+                for (c = 0; c < bq->channels; c++) {
+                    section_float(bq, s, &bq->state.flt.z1[s][c], &bq->state.flt.z2[s][c],
+                                  flt + c, frames, bq->channels);
+                }
+            }
+
+            break;
+    }
+
+    for (i = 0; i < made * bq->channels; i++) {
+        out[i] = ST_SIGNED_WORD_TO_SAMPLE((s16) float_to_pcm(flt[i]));
+    }
+
+    return made;
+}
+
+/****************************************************************************/
+/***************************** BIQUAD INIT **********************************/
+/****************************************************************************/
+
+XStatus biquad_init(biquad_t *bq, unsigned int channels, unsigned int engine) {
+
+    if ((channels == 0) || (channels > BIQUAD_MAX_CHANNELS) ||
+        ((engine != BIQUAD_ENGINE_FIXED) && (engine != BIQUAD_ENGINE_FLOAT))) {
+
+        return XST_INVALID_PARAM;
+    }
+
+    memset(bq, 0, sizeof(*bq));
+
+    bq->channels = channels;
+    bq->engine   = engine;
+
+    biquad_reset(bq);
+
+    return XST_SUCCESS;
+}
+
+XStatus biquad_add(biquad_t *bq, double b0, double b1, double b2, double a1, double a2) {
+
+    unsigned int s = bq->sections;
+
+    if (s == BIQUAD_MAX_SECTIONS) {
+        return XST_FAILURE;
+    }
+
+    // a1 & a2 go in negated for the fixed point sums, as is for the float
+
+    bq->q[s][0] = to_q30(b0);
+    bq->q[s][1] = to_q30(b1);
+    bq->q[s][2] = to_q30(b2);
+    bq->q[s][3] = to_q30(-a1);
+    bq->q[s][4] = to_q30(-a2);
+
+    bq->f[0][s] = (float) b0;
+    bq->f[1][s] = (float) b1;
+    bq->f[2][s] = (float) b2;
+    bq->f[3][s] = (float) a1;
+    bq->f[4][s] = (float) a2;
+
+    bq->sections++;
+
+    return XST_SUCCESS;
+}
+
+XStatus biquad_scale(biquad_t *bq, double gain) {
+
+    unsigned int i;
+
+    if (bq->sections == 0) {
+        return XST_FAILURE;
+    }
+
+    // on the first section's zeros
+
+    for (i = 0; i < 3; i++) {
+
+        bq->q[0][i] = to_q30(bq->q[0][i] * gain / BIQUAD_Q_ONE);
+        bq->f[i][0] = (float) (bq->f[i][0] * gain);
+    }
+
+    return XST_SUCCESS;
+}
+
+void biquad_reset(biquad_t *bq) {
+
+    memset(&bq->state, 0, sizeof(bq->state));
+
+    bq->layout  = BIQUAD_SCALAR;
+    bq->pending = 0;
+    bq->skip    = 0;
+
+#if BIQUAD_HAVE_SIMD
+
+    if (bq->engine == BIQUAD_ENGINE_FLOAT) {
+
+        unsigned int s;
+
+        if (bq->channels == BIQUAD_LANES) {
+            bq->layout = BIQUAD_SIMD_CHANNELS;
+        }
+
+        else if ((bq->channels == 1) && (bq->sections > 1)) {
+
+            // the lanes past the last section pass their input on
+
+            for (s = bq->sections; s < BIQUAD_LANES; s++) {
+
+                bq->f[0][s] = 1.0f;
+                bq->f[1][s] = bq->f[2][s] = bq->f[3][s] = bq->f[4][s] = 0.0f;
+            }
+
+            bq->layout = BIQUAD_SIMD_SECTIONS;
+            bq->skip   = BIQUAD_PIPELINE;
+        }
+    }
+
+#endif
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** BIQUAD DESIGN ********************************/
+/****************************************************************************/
+
+// bilinear transform designs after R. Bristow-Johnson's Audio EQ Cookbook
+
+XStatus biquad_butterworth(biquad_t *bq, unsigned int type, double rate, double freq, unsigned int poles) {
+
+    double w0 = 2.0 * M_PI * freq / rate;
+    double cosw = cos(w0), k = tan(w0 / 2.0);
+    double q, alpha, a0;
+    unsigned int i;
+
+    if ((freq <= 0.0) || (freq >= rate / 2.0) || (poles == 0) ||
+        (bq->sections + (poles + 1) / 2 > BIQUAD_MAX_SECTIONS)) {
+
+        return XST_INVALID_PARAM;
+    }
+
+    // the pole pairs, each a section with its Butterworth Q
+
+    for (i = 0; i < poles / 2; i++) {
+
+        q     = 1.0 / (2.0 * cos((2 * i + 1) * M_PI / (2.0 * poles)));
+        alpha = sin(w0) / (2.0 * q);
+        a0    = 1.0 + alpha;
+
+        if (type == BIQUAD_LOWPASS) {
+            biquad_add(bq, (1.0 - cosw) / 2.0 / a0, (1.0 - cosw) / a0, (1.0 - cosw) / 2.0 / a0,
+                       -2.0 * cosw / a0, (1.0 - alpha) / a0);
+        }
+
+        else {
+            biquad_add(bq, (1.0 + cosw) / 2.0 / a0, -(1.0 + cosw) / a0, (1.0 + cosw) / 2.0 / a0,
+                       -2.0 * cosw / a0, (1.0 - alpha) / a0);
+        }
+    }
+
+    // and the real pole of an odd order
+
+    if (poles & 1) {
+
+        if (type == BIQUAD_LOWPASS) {
+            biquad_add(bq, k / (1.0 + k), k / (1.0 + k), 0.0, (k - 1.0) / (k + 1.0), 0.0);
+        }
+
+        else {
+            biquad_add(bq, 1.0 / (1.0 + k), -1.0 / (1.0 + k), 0.0, (k - 1.0) / (k + 1.0), 0.0);
+        }
+    }
+
+    return XST_SUCCESS;
+}
+
+XStatus biquad_bandpass(biquad_t *bq, double rate, double centre, double width) {
+
+    double w0 = 2.0 * M_PI * centre / rate;
+    double alpha, a0;
+
+    if ((centre <= 0.0) || (centre >= rate / 2.0) || (width <= 0.0)) {
+        return XST_INVALID_PARAM;
+    }
+
+    // Q = centre / width
+
+    alpha = sin(w0) * width / (2.0 * centre);
+    a0    = 1.0 + alpha;
+
+    return biquad_add(bq, alpha / a0, 0.0, -alpha / a0, -2.0 * cos(w0) / a0, (1.0 - alpha) / a0);
+}
+
+/****************************************************************************/
+/***************************** BIQUAD FLOW **********************************/
+/****************************************************************************/
+
+st_size_t biquad_flow(biquad_t *bq, const st_sample_t *in, st_sample_t *out, st_size_t len) {
+
+    st_size_t frames = len / bq->channels, done = 0, made = 0, chunk;
+
+    // a block at a time; out never gets ahead of in, so they may be one
+
+    while (done < frames) {
+
+        chunk = MIN(frames - done, BIQUAD_CHUNK);
+        made += run_block(bq, in + done * bq->channels, out + made * bq->channels, chunk);
+        done += chunk;
+    }
+
+    return made * bq->channels;
+}
+
+st_size_t biquad_drain(biquad_t *bq, st_sample_t *out, st_size_t len) {
+
+    unsigned int made = 0;
+
+    // silence through the section pipeline until its samples are all out
+
+    while ((bq->pending > 0) && (made < len)) {
+        made += run_block(bq, NULL, out + made, 1);
+    }
+
+    if (bq->pending == 0) {
+        bq->skip = BIQUAD_PIPELINE;
+    }
+
+    return made;
+}
+
+/****************************************************************************/
+/***************************** ST HANDLERS **********************************/
+/****************************************************************************/
+
+// private data of the filter effects, in effp->priv
+
+typedef struct filterstuff {
+
+    biquad_t        bq;
+    double          low, high;          // Hz, 0 for none
+    unsigned int    poles;
+    unsigned int    noise;              // band -n
+
+} *filter_t;
+
+// a frequency argument; 0 for an empty one
+
+static int get_freq(const char *arg, double *freq) {
+
+    char *end;
+
+    *freq = (*arg == '\0') ? 0.0 : strtod(arg, &end);
+
+    return ((*arg == '\0') || ((*end == '\0') && (*freq > 0.0))) ? ST_SUCCESS : ST_EOF;
+}
+
+static int get_poles(int argc, char **argv, unsigned int max, unsigned int *poles) {
+
+    if (argc > 0) {
+        *poles = (unsigned int) atoi(argv[0]);
+    }
+
+    return ((*poles >= 1) && (*poles <= max)) ? ST_SUCCESS : ST_EOF;
+}
+
+// the cascade designed by start, on the effect's channels & the default
+// engine
+
+static int filter_start(eff_t effp, filter_t f) {
+
+    XStatus status = biquad_init(&f->bq, effp->ininfo.channels ? effp->ininfo.channels : 1,
+                                 BIQUAD_ENGINE_DEFAULT);
+    double  rate = effp->ininfo.rate;
+
+    if ((status == XST_SUCCESS) && (f->low > 0.0)) {
+        status = biquad_butterworth(&f->bq, BIQUAD_HIGHPASS, rate, f->low, f->poles);
+    }
+
+    if ((status == XST_SUCCESS) && (f->high > 0.0)) {
+        status = biquad_butterworth(&f->bq, BIQUAD_LOWPASS, rate, f->high, f->poles);
+    }
+
+    if (status != XST_SUCCESS) {
+
+        st_warn("%s: can not design the filter for %lu Hz", effp->name, (unsigned long) effp->ininfo.rate);
+        return ST_EOF;
+    }
+
+    biquad_reset(&f->bq);
+
+    return ST_SUCCESS;
+}
+
+int st_lowp_getopts(eff_t effp, int argc, char **argv) {
+
+    filter_t f = (filter_t) effp->priv;
+
+    f->low   = 0.0;
+    f->poles = 2;
+
+    if ((argc < 1) || (argc > 2) || (get_freq(argv[0], &f->high) != ST_SUCCESS) || (f->high == 0.0) ||
+        (get_poles(argc - 1, argv + 1, 2 * BIQUAD_MAX_SECTIONS, &f->poles) != ST_SUCCESS)) {
+
+        st_warn("Usage: lowp freq [poles]");
+        return ST_EOF;
+    }
+
+    return ST_SUCCESS;
+}
+
+int st_lowp_start(eff_t effp) {
+
+    return filter_start(effp, (filter_t) effp->priv);
+}
+
+int st_lowp_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf,
+                 st_size_t *isamp, st_size_t *osamp) {
+
+    filter_t f = (filter_t) effp->priv;
+
+    *isamp = MIN(*isamp, *osamp);
+    *osamp = biquad_flow(&f->bq, ibuf, obuf, *isamp);
+
+    return ST_SUCCESS;
+}
+
+int st_lowp_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp) {
+
+    filter_t f = (filter_t) effp->priv;
+
+    *osamp = biquad_drain(&f->bq, obuf, *osamp);
+
+    return ST_SUCCESS;
+}
+
+int st_lowp_stop(eff_t effp) {
+
+    return ST_SUCCESS;
+}
+
+int st_highp_getopts(eff_t effp, int argc, char **argv) {
+
+    filter_t f = (filter_t) effp->priv;
+
+    f->high  = 0.0;
+    f->poles = 2;
+
+    if ((argc < 1) || (argc > 2) || (get_freq(argv[0], &f->low) != ST_SUCCESS) || (f->low == 0.0) ||
+        (get_poles(argc - 1, argv + 1, 2 * BIQUAD_MAX_SECTIONS, &f->poles) != ST_SUCCESS)) {
+
+        st_warn("Usage: highp freq [poles]");
+        return ST_EOF;
+    }
+
+    return ST_SUCCESS;
+}
+
+int st_highp_start(eff_t effp) {
+
+    return filter_start(effp, (filter_t) effp->priv);
+}
+
+int st_highp_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf,
+                  st_size_t *isamp, st_size_t *osamp) {
+
+    return st_lowp_flow(effp, ibuf, obuf, isamp, osamp);
+}
+
+int st_highp_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp) {
+
+    return st_lowp_drain(effp, obuf, osamp);
+}
+
+int st_highp_stop(eff_t effp) {
+
+    return ST_SUCCESS;
+}
+
+int st_band_getopts(eff_t effp, int argc, char **argv) {
+
+    filter_t f = (filter_t) effp->priv;
+
+    f->noise = 0;
+    f->high  = 0.0;
+
+    if ((argc > 0) && !strcmp(argv[0], "-n")) {
+
+        f->noise = 1;
+        argc--;
+        argv++;
+    }
+
+    if ((argc < 1) || (argc > 2) || (get_freq(argv[0], &f->low) != ST_SUCCESS) || (f->low == 0.0) ||
+        ((argc == 2) && ((get_freq(argv[1], &f->high) != ST_SUCCESS) || (f->high == 0.0)))) {
+
+        st_warn("Usage: band [ -n ] center [ width ]");
+        return ST_EOF;
+    }
+
+    // low is the centre and high the width here
+
+    if (f->high == 0.0) {
+        f->high = f->low / 2.0;
+    }
+
+    return ST_SUCCESS;
+}
+
+int st_band_start(eff_t effp) {
+
+    filter_t    f = (filter_t) effp->priv;
+    float       (*c)[BIQUAD_MAX_SECTIONS] = f->bq.f;
+    double      y1 = 0.0, y2 = 0.0, x1 = 0.0, x2 = 0.0, x, y, power = 0.0;
+    unsigned int n;
+
+    if ((biquad_init(&f->bq, effp->ininfo.channels ? effp->ininfo.channels : 1,
+                     BIQUAD_ENGINE_DEFAULT) != XST_SUCCESS) ||
+        (biquad_bandpass(&f->bq, effp->ininfo.rate, f->low, f->high) != XST_SUCCESS)) {
+
+        st_warn("band: can not design the filter for %lu Hz", (unsigned long) effp->ininfo.rate);
+        return ST_EOF;
+    }
+
+    // for noise, the power gain from the impulse response, made up to 1
+
+    if (f->noise) {
+
+        for (n = 0; n < BAND_NOISE_LEN; n++) {
+
+            x = (n == 0) ? 1.0 : 0.0;
+            y = c[0][0] * x + c[1][0] * x1 + c[2][0] * x2 - c[3][0] * y1 - c[4][0] * y2;
+
+            x2 = x1; x1 = x;
+            y2 = y1; y1 = y;
+            power += y * y;
+        }
+
+        biquad_scale(&f->bq, 1.0 / sqrt(power));
+    }
+
+    biquad_reset(&f->bq);
+
+    return ST_SUCCESS;
+}
+
+int st_band_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf,
+                 st_size_t *isamp, st_size_t *osamp) {
+
+    return st_lowp_flow(effp, ibuf, obuf, isamp, osamp);
+}
+
+int st_band_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp) {
+
+    return st_lowp_drain(effp, obuf, osamp);
+}
+
+int st_band_stop(eff_t effp) {
+
+    return ST_SUCCESS;
+}
+
+int st_filter_getopts(eff_t effp, int argc, char **argv) {
+
+    filter_t f = (filter_t) effp->priv;
+    char     *dash, low[32];
+
+    f->poles = 4;
+
+    // [low]-[high], at least one of them
+
+    if ((argc < 1) || (argc > 2) || ((dash = strchr(argv[0], '-')) == NULL) ||
+        ((size_t) (dash - argv[0]) >= sizeof(low))) {
+
+        st_warn("Usage: filter [low]-[high] [poles]");
+        return ST_EOF;
+    }
+
+    memcpy(low, argv[0], dash - argv[0]);
+    low[dash - argv[0]] = '\0';
+
+    if ((get_freq(low, &f->low) != ST_SUCCESS) || (get_freq(dash + 1, &f->high) != ST_SUCCESS) ||
+        ((f->low == 0.0) && (f->high == 0.0)) || ((f->high > 0.0) && (f->low >= f->high)) ||
+        (get_poles(argc - 1, argv + 1, BIQUAD_MAX_SECTIONS, &f->poles) != ST_SUCCESS)) {
+
+        st_warn("Usage: filter [low]-[high] [poles]");
+        return ST_EOF;
+    }
+
+    return ST_SUCCESS;
+}
+
+int st_filter_start(eff_t effp) {
+
+    return filter_start(effp, (filter_t) effp->priv);
+}
+
+int st_filter_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf,
+                   st_size_t *isamp, st_size_t *osamp) {
+
+    return st_lowp_flow(effp, ibuf, obuf, isamp, osamp);
+}
+
+int st_filter_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp) {
+
+    return st_lowp_drain(effp, obuf, osamp);
+}
+
+int st_filter_stop(eff_t effp) {
+
+    return ST_SUCCESS;
+}
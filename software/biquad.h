@@ -0,0 +1,139 @@
+/* biquad.h - biquad cascade filter engine for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Constants, structures and prototypes for the biquad cascade engine (see
+ * biquad.c) behind the Sound Tools lowp, highp, band and filter effects.
+*/
+
+#ifndef BIQUAD_H
+#define BIQUAD_H
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "st.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Sections (two poles each) and interleaved channels per cascade, and the
+// frames run through one section at a time
+
+#define BIQUAD_MAX_SECTIONS     4
+#define BIQUAD_MAX_CHANNELS     4
+#define BIQUAD_CHUNK            64
+
+// Fixed-point coefficients are Q2.30
+
+#define BIQUAD_Q                30
+
+// Engines: fixed point (DF1, 64-bit sums, error feedback), the one for the
+// MicroBlaze, or single-precision float (DF2T), the one for the host
+
+#define BIQUAD_ENGINE_FIXED     0
+#define BIQUAD_ENGINE_FLOAT     1
+
+#ifdef __MICROBLAZE__
+#define BIQUAD_ENGINE_DEFAULT   BIQUAD_ENGINE_FIXED
+#else
+#define BIQUAD_ENGINE_DEFAULT   BIQUAD_ENGINE_FLOAT
+#endif
+
+// The float engine runs four lanes of SSE on the host: four channels side
+// by side, or one channel through four sections at once
+
+#if defined(__SSE2__)
+#define BIQUAD_HAVE_SIMD        1
+#else
+#define BIQUAD_HAVE_SIMD        0
+#endif
+
+#define BIQUAD_LANES            4
+
+// Float engine layouts, picked by biquad_reset()
+
+#define BIQUAD_SCALAR           0       // a section & channel at a time
+#define BIQUAD_SIMD_CHANNELS    1       // four channels a lane each
+#define BIQUAD_SIMD_SECTIONS    2       // one channel, four sections a lane each
+
+// Butterworth responses
+
+#define BIQUAD_LOWPASS          0
+#define BIQUAD_HIGHPASS         1
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct biquad_fixed_state {
+
+    s32             x1, x2;             // DF1 history, 16-bit
+    s32             y1, y2;
+    s32             e1, e2;             // what the last two outputs rounded off
+
+} biquad_fixed_state_t;
+
+typedef struct biquad {
+
+    unsigned int    sections;
+    unsigned int    channels;
+    unsigned int    engine;
+    unsigned int    layout;             // float engine, see above
+    unsigned int    pending;            // samples in the section pipeline
+    unsigned int    skip;               // outputs ahead of them to drop
+
+    s32             q[BIQUAD_MAX_SECTIONS][5];          // b0 b1 b2 -a1 -a2, Q2.30
+    float           f[5][BIQUAD_MAX_SECTIONS];          // b0 b1 b2 a1 a2, by term
+
+    union {
+
+        biquad_fixed_state_t fixed[BIQUAD_MAX_SECTIONS][BIQUAD_MAX_CHANNELS];
+
+        struct {
+            float   z1[BIQUAD_MAX_SECTIONS][BIQUAD_MAX_CHANNELS];
+            float   z2[BIQUAD_MAX_SECTIONS][BIQUAD_MAX_CHANNELS];
+            float   pipe[BIQUAD_LANES];                 // last output of each lane
+        } flt;
+
+    } state;
+
+} biquad_t;
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+// an empty cascade (it passes its input through) on an engine
+XStatus   biquad_init(biquad_t *bq, unsigned int channels, unsigned int engine);
+
+// append a section, a0 normalised to 1
+XStatus   biquad_add(biquad_t *bq, double b0, double b1, double b2, double a1, double a2);
+
+// append sections for a Butterworth low- or high-pass of 1 to 8 poles, a
+// band-pass of 0 dB at its centre, or scale the whole cascade
+XStatus   biquad_butterworth(biquad_t *bq, unsigned int type, double rate, double freq, unsigned int poles);
+XStatus   biquad_bandpass(biquad_t *bq, double rate, double centre, double width);
+XStatus   biquad_scale(biquad_t *bq, double gain);
+
+// clear the history & pick the float layout; call after the sections are in
+void      biquad_reset(biquad_t *bq);
+
+// len interleaved samples in (out may be in); returns the samples out,
+// fewer than in while the section pipeline fills
+st_size_t biquad_flow(biquad_t *bq, const st_sample_t *in, st_sample_t *out, st_size_t len);
+
+// the samples still in the section pipeline, at most len; 0 when empty
+st_size_t biquad_drain(biquad_t *bq, st_sample_t *out, st_size_t len);
+
+#endif
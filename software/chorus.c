@@ -0,0 +1,434 @@
+/* chorus - chorus effect for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Chorus effect after the Sound Tools chorus (credits below), reworked to
+ * run block-by-block on the MicroBlaze:
+ *
+ *  - The dry input history lives in the lower half of the ChorusBuffer
+ *    Block RAM instead of a float buffer (chorusbuf is unused).
+ *  - Each voice's delay comes from a precomputed st_sine / st_triangle
+ *    table (lookup_tab), stepped one entry per sample through phase.
+ *  - Gains are unsigned Q1.15 (delay_line.h), so there is no float math
+ *    per sample.
+ *
+ * Per block and voice, the delays for every sample are looked up first;
+ * they span at most depth_samples lines, so one streamed read of
+ * count + depth_samples lines covers them all. Each sample then costs one
+ * table lookup and one multiply-accumulate per voice, plus about one bus
+ * read per voice, independent of the delay settings.
+ *
+ * With a single voice and the hardware engine (the default), the voice
+ * generator in the ChorusBuffer IP does all of that instead: it runs its own
+ * phase-accumulator LFO, reads the history at a fractional delay with linear
+ * interpolation, and mixes and saturates the output. Voice 0 is copied to
+ * it as it is added; each block is then one history write plus one bus read
+ * per sample and no arithmetic on the MicroBlaze. The LFO period matches the
+ * lookup table, and the software phase is kept in step, so switching engines
+ * does not jump. More voices fall back to the software path.
+ *
+ * st_chorus_flow() and st_chorus_drain() wrap Apply_Chorus() as a Sound
+ * Tools effect for the chain runner (fx_chain.c). The chorus keeps its own
+ * line count for the history there, and drains by playing silence until
+ * the longest voice has faded out. Each chunk is read before it is written
+ * back, so the flow works in place (ST_EFF_INPLACE).
+*/
+
+/*  
+* August 24, 1998
+* Copyright (C) 1998 Juergen Mueller And Sundry Contributors
+* This source code is freely redistributable and may be used for
+* any purpose.  This copyright notice must be maintained.
+* Juergen Mueller And Sundry Contributors are not responsible for
+* the consequences of using this software.
+*
+* Chorus effect
+*
+* Flow diagram scheme for n delays ( 1 <= n <= MAX_CHORUS ):
+*
+*        * gain-in                                           ___
+* ibuff -----+--------------------------------------------->|   |
+*            |      _________                               |   |
+*            |     |         |                   * decay 1  |   |
+*            +---->| delay 1 |----------------------------->|   |
+*            |     |_________|                              |   |
+*            |        /|\                                   |   |
+*            :         |                                    |   |
+*            : +-----------------+   +--------------+       | + |
+*            : | Delay control 1 |<--| mod. speed 1 |       |   |
+*            : +-----------------+   +--------------+       |   |
+*            |      _________                               |   |
+*            |     |         |                   * decay n  |   |
+*            +---->| delay n |----------------------------->|   |
+*                  |_________|                              |   |
+*                     /|\                                   |___|
+*                      |                                      |
+*              +-----------------+   +--------------+         | * gain-out
+*              | Delay control n |<--| mod. speed n |         |
+*              +-----------------+   +--------------+         +----->obuff
+*
+*
+* The delay i is controled by a sine or triangle modulation i ( 1 <= i <= n).
+*
+* Usage:
+*   chorus gain-in gain-out delay-1 decay-1 speed-1 depth-1 -s1|t1 [
+*       delay-2 decay-2 speed-2 depth-2 -s2|-t2 ... ]
+*
+* Where:
+*   gain-in, decay-1 ... decay-n :  0.0 ... 1.0      volume
+*   gain-out :  0.0 ...      volume
+*   delay-1 ... delay-n :  20.0 ... 100.0 msec
+*   speed-1 ... speed-n :  0.1 ... 5.0 Hz       modulation 1 ... n
+*   depth-1 ... depth-n :  0.0 ... 10.0 msec    modulated delay 1 ... n
+*   -s1 ... -sn : modulation by sine 1 ... n
+*   -t1 ... -tn : modulation by triangle 1 ... n
+*
+* Note:
+*   when decay is close to 1.0, the samples can begin clipping and the output
+*   can saturate!
+*
+* Hint:
+*   1 / out-gain < gain-in ( 1 + decay-1 + ... + decay-n )
+*
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include "stdbool.h"
+#include "st_i.h"
+
+#include "xstatus.h"
+#include "xil_types.h"
+
+#include "ChorusBuffer.h"
+#include "delay_line.h"
+#include "fx_chain.h"
+#include "chorus.h"
+
+/****************************************************************************/
+/***************************** Global Variables *****************************/
+/****************************************************************************/
+
+static struct st_effect chorus_eff;
+static eff_t            effp = &chorus_eff;
+
+// modulation tables, handed out to the voices from one pool
+
+static int              tab_pool[CHORUS_TAB_POOL];
+
+// dry input history in the ChorusBuffer (no taps, just read & write)
+
+static delay_line_t     history;
+
+static unsigned int     chorus_engine = CHORUS_ENGINE_DEFAULT;
+
+/****************************************************************************/
+/***************************** CHORUS START *********************************/
+/****************************************************************************/
+
+XStatus chorus_start(float in_gain, float out_gain, unsigned int rate) {
+
+    chorus_t chorus = (chorus_t) effp->priv;
+
+    if (sizeof(struct chorusparams) > ST_MAX_EFFECT_PRIVSIZE) {
+        return XST_FAILURE;
+    }
+
+    effp->ininfo.rate = rate;
+
+    chorus->num_chorus = 0;
+    chorus->counter    = 0;
+    chorus->chorusbuf  = NULL;
+    chorus->in_gain    = in_gain;
+    chorus->out_gain   = out_gain;
+    chorus->maxsamples = 0;
+    chorus->fade_out   = 0;
+    chorus->tab_used   = 0;
+    chorus->in_gain_q  = MIN(Q15_GAIN(in_gain * out_gain), Q15_GAIN_MAX);
+
+    return delay_line_init(&history, ChorusBuffer_ReadBlock, ChorusBuffer_WriteStream,
+                           CHORUS_HISTORY_BASE, CHORUS_HISTORY_DEPTH, 0);
+}
+
+/****************************************************************************/
+/***************************** CHORUS ADD VOICE *****************************/
+/****************************************************************************/
+
+XStatus chorus_add_voice(float delay, float decay, float speed, float depth, int modulation) {
+
+    chorus_t chorus = (chorus_t) effp->priv;
+    float    rate   = (float) effp->ininfo.rate;
+    int      i      = chorus->num_chorus;
+
+    if ((i >= MAX_CHORUS) || (speed <= 0.0) || (delay < 0.0) || (depth < 0.0)) {
+        return XST_INVALID_PARAM;
+    }
+
+    chorus->delay[i]      = delay;
+    chorus->decay[i]      = decay;
+    chorus->speed[i]      = speed;
+    chorus->depth[i]      = depth;
+    chorus->modulation[i] = modulation;
+
+    chorus->samples[i]       = (int) ((delay + depth) * rate / 1000.0);
+    chorus->depth_samples[i] = (int) (depth * rate / 1000.0);
+    chorus->length[i]        = (long) (rate / speed);
+
+    // the history has to cover the longest delay plus one block, and the
+    // depth bounds the window read per block
+
+    if ((chorus->depth_samples[i] > CHORUS_MAX_DEPTH) ||
+        (chorus->samples[i] + CHORUS_CHUNK > CHORUS_HISTORY_DEPTH) ||
+        (chorus->length[i] < 1) ||
+        (chorus->tab_used + chorus->length[i] > CHORUS_TAB_POOL)) {
+
+        return XST_INVALID_PARAM;
+    }
+
+    chorus->lookup_tab[i] = &tab_pool[chorus->tab_used];
+    chorus->tab_used     += chorus->length[i];
+
+    if (modulation == MOD_SINE) {
+        st_sine(chorus->lookup_tab[i], chorus->length[i], chorus->samples[i] - 1, chorus->depth_samples[i]);
+    }
+
+    else {
+        st_triangle(chorus->lookup_tab[i], chorus->length[i], chorus->samples[i] - 1, chorus->depth_samples[i]);
+    }
+
+    chorus->phase[i]   = 0;
+    chorus->decay_q[i] = MIN(Q15_GAIN(decay * chorus->out_gain), Q15_GAIN_MAX);
+
+    // the hardware voice sweeps the same delays as the table, from the
+    // same starting point (the LFO wraps after 2^32 / length samples)
+
+    if (i == 0) {
+
+        chorus->lfo_inc = (u32) ((((u64) 1 << 32) + (chorus->length[i] / 2)) / chorus->length[i]);
+
+        ChorusBuffer_SetChorusLFO(chorus->lfo_inc, (modulation != MOD_SINE));
+        ChorusBuffer_SetChorus(chorus->samples[i] - 1 - chorus->depth_samples[i],
+                               chorus->depth_samples[i], chorus->in_gain_q, chorus->decay_q[i]);
+        ChorusBuffer_SetChorusPhase(0);
+    }
+
+    if (chorus->samples[i] > chorus->maxsamples) {
+        chorus->maxsamples = chorus->samples[i];
+    }
+
+    chorus->num_chorus++;
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/******************************* CHORUS EFFECT ******************************/
+/****************************************************************************/
+
+static void chorus_chunk(chorus_t chorus, unsigned int bufline, unsigned int *buf, unsigned int count) {
+
+    int          acc[CHORUS_CHUNK];
+    unsigned int dly[CHORUS_CHUNK];
+    unsigned int window[CHORUS_CHUNK + CHORUS_MAX_DEPTH + 1];
+    unsigned int lo, hi, gain, j;
+    long         ph, len;
+    int          *tab;
+    int          i;
+
+    // keep the dry block first, so even the shortest delay finds its line
+
+    delay_line_write(&history, bufline, count, buf);
+
+    for (j = 0; j < count; j++) {
+        acc[j] = Q15_SCALE(PCM_VALUE(buf[j]), chorus->in_gain_q);
+    }
+
+    for (i = 0; i < chorus->num_chorus; i++) {
+
+        tab  = chorus->lookup_tab[i];
+        len  = chorus->length[i];
+        ph   = chorus->phase[i];
+        gain = chorus->decay_q[i];
+
+        // look up this voice's delay for every sample in the chunk
+
+        lo = hi = tab[ph];
+
+        for (j = 0; j < count; j++) {
+
+            dly[j] = tab[ph];
+            lo = MIN(lo, dly[j]);
+            hi = MAX(hi, dly[j]);
+
+            if (++ph == len) {
+                ph = 0;
+            }
+        }
+
+        chorus->phase[i] = ph;
+
+        // one streamed read covers lines bufline - hi .. bufline + count - 1 - lo
+
+        delay_line_read(&history, bufline - hi, count + hi - lo, window);
+
+        for (j = 0; j < count; j++) {
+            acc[j] += Q15_SCALE(PCM_VALUE(window[j + hi - dly[j]]), gain);
+        }
+    }
+
+    // saturate to the 16-bit buffer width
+
+    for (j = 0; j < count; j++) {
+        buf[j] = PCM_LINE(acc[j]);
+    }
+
+    chorus->counter = (bufline + count) & (CHORUS_HISTORY_DEPTH - 1);
+
+    return;
+}
+
+void Apply_Chorus(unsigned int bufline, unsigned int *buf, unsigned int count) {
+
+    chorus_t     chorus = (chorus_t) effp->priv;
+    unsigned int done, chunk;
+
+    if ((chorus_engine == CHORUS_ENGINE_HARDWARE) && (chorus->num_chorus == 1)) {
+
+        // the dry block goes in first, then the generator plays it back
+
+        delay_line_write(&history, bufline, count, buf);
+        ChorusBuffer_ReadChorus(bufline, count, buf);
+
+        chorus->phase[0] = (chorus->phase[0] + count) % chorus->length[0];
+        chorus->counter  = (bufline + count) & (CHORUS_HISTORY_DEPTH - 1);
+
+        return;
+    }
+
+    for (done = 0; done < count; done += chunk) {
+
+        chunk = MIN(count - done, CHORUS_CHUNK);
+        chorus_chunk(chorus, bufline + done, buf + done, chunk);
+    }
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** CHORUS HANDLER *******************************/
+/****************************************************************************/
+
+eff_t chorus_effect(void) {
+
+    return effp;
+}
+
+int st_chorus_start(eff_t effp) {
+
+    chorus_t chorus = (chorus_t) effp->priv;
+
+    chorus->fade_out = chorus->maxsamples;
+
+    return (chorus->num_chorus > 0) ? ST_SUCCESS : ST_EOF;
+}
+
+int st_chorus_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf,
+                   st_size_t *isamp, st_size_t *osamp) {
+
+    chorus_t     chorus = (chorus_t) effp->priv;
+    unsigned int buf[CHORUS_CHUNK];
+    unsigned int len = MIN(*isamp, *osamp);
+    unsigned int done, chunk, j;
+
+    for (done = 0; done < len; done += chunk) {
+
+        chunk = MIN(len - done, CHORUS_CHUNK);
+
+        for (j = 0; j < chunk; j++) {
+            buf[j] = FX_SAMPLE_TO_LINE(ibuf[done + j]);
+        }
+
+        Apply_Chorus(chorus->counter, buf, chunk);
+
+        for (j = 0; j < chunk; j++) {
+            obuf[done + j] = FX_LINE_TO_SAMPLE(buf[j]);
+        }
+    }
+
+    *isamp = len;
+    *osamp = len;
+
+    return ST_SUCCESS;
+}
+
+int st_chorus_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp) {
+
+    chorus_t     chorus = (chorus_t) effp->priv;
+    unsigned int buf[CHORUS_CHUNK];
+    unsigned int len = MIN(*osamp, (unsigned int) chorus->fade_out);
+    unsigned int done, chunk, j;
+
+    // silence in, the voices' tails out
+
+    for (done = 0; done < len; done += chunk) {
+
+        chunk = MIN(len - done, CHORUS_CHUNK);
+
+        for (j = 0; j < chunk; j++) {
+            buf[j] = 0;
+        }
+
+        Apply_Chorus(chorus->counter, buf, chunk);
+
+        for (j = 0; j < chunk; j++) {
+            obuf[done + j] = FX_LINE_TO_SAMPLE(buf[j]);
+        }
+    }
+
+    chorus->fade_out -= len;
+    *osamp = len;
+
+    return ST_SUCCESS;
+}
+
+int st_chorus_stop(eff_t effp) {
+
+    return ST_SUCCESS;
+}
+
+/****************************************************************************/
+/***************************** CHORUS ENGINE ********************************/
+/****************************************************************************/
+
+XStatus chorus_set_engine(unsigned int engine) {
+
+    chorus_t chorus = (chorus_t) effp->priv;
+
+    if ((engine != CHORUS_ENGINE_SOFTWARE) && (engine != CHORUS_ENGINE_HARDWARE)) {
+        return XST_INVALID_PARAM;
+    }
+
+    // pick up the LFO where the software voice left it
+
+    if ((engine == CHORUS_ENGINE_HARDWARE) && (chorus->num_chorus > 0)) {
+        ChorusBuffer_SetChorusPhase((u32) chorus->phase[0] * chorus->lfo_inc);
+    }
+
+    chorus_engine = engine;
+
+    return XST_SUCCESS;
+}
+
+unsigned int chorus_get_engine(void) {
+
+    return chorus_engine;
+}
@@ -0,0 +1,108 @@
+/* chorus.h - chorus effect for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Constants, structures and prototypes for the chorus effect (see chorus.c).
+*/
+
+#ifndef CHORUS_H
+#define CHORUS_H
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "st.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Chorus parameters
+
+#define MOD_SINE            0   
+#define MOD_TRIANGLE        1   
+#define MAX_CHORUS          7  
+#define MAX_RPT             3
+
+// Modulation tables for all voices share one pool of entries (one entry
+// per sample of the modulation period, i.e. rate / speed per voice)
+
+#define CHORUS_TAB_POOL     4096
+
+// Largest modulation depth in samples; bounds the history window read
+// per block to CHORUS_CHUNK + CHORUS_MAX_DEPTH lines
+
+#define CHORUS_MAX_DEPTH    256
+#define CHORUS_CHUNK        64
+
+// Dry input history kept in the lower half of the ChorusBuffer
+
+#define CHORUS_HISTORY_BASE     0
+#define CHORUS_HISTORY_DEPTH    32768
+
+// Chorus engines: the software voices below, or the voice generator in the
+// ChorusBuffer IP, which takes over when there is a single voice
+
+#define CHORUS_ENGINE_SOFTWARE  0
+#define CHORUS_ENGINE_HARDWARE  1
+#define CHORUS_ENGINE_DEFAULT   CHORUS_ENGINE_HARDWARE
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+/* Private data for SKEL file (Chorus.c) */ 
+
+typedef struct  chorusparams {  
+
+    int         num_chorus;   
+    int         modulation[MAX_CHORUS];   
+    int         counter;               
+    long        phase[MAX_CHORUS];   
+    float       *chorusbuf;   
+    float       in_gain, out_gain;   
+    float       delay[MAX_CHORUS], decay[MAX_CHORUS];   
+    float       speed[MAX_CHORUS], depth[MAX_CHORUS];   
+    long        length[MAX_CHORUS];   
+    int         *lookup_tab[MAX_CHORUS];   
+    int         depth_samples[MAX_CHORUS], samples[MAX_CHORUS];   
+    int         maxsamples, fade_out;   
+
+    // Q1.15 gains, in_gain & decay each scaled by out_gain
+    unsigned int    in_gain_q, decay_q[MAX_CHORUS];
+    unsigned int    tab_used;
+
+    // LFO phase increment of voice 0 for the hardware (2^32 = one period)
+    u32             lfo_inc;
+
+} *chorus_t;
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+// reset the chorus, then add 1..MAX_CHORUS voices
+XStatus chorus_start(float in_gain, float out_gain, unsigned int rate);
+XStatus chorus_add_voice(float delay, float decay, float speed, float depth, int modulation);
+
+// chorus a block of consecutive input lines in place
+void    Apply_Chorus(unsigned int bufline, unsigned int *buf, unsigned int count);
+
+// the chorus as a Sound Tools effect (st_chorus_* in st_i.h) for fx_chain.c,
+// set up by chorus_start / chorus_add_voice rather than getopts
+eff_t   chorus_effect(void);
+
+// chorus engine: CHORUS_ENGINE_SOFTWARE or CHORUS_ENGINE_HARDWARE
+XStatus      chorus_set_engine(unsigned int engine);
+unsigned int chorus_get_engine(void);
+
+#endif
@@ -0,0 +1,333 @@
+/* compand - lookahead peak limiter for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * A brick-wall limiter that sits at the end of every effect mode, so what
+ * goes into the DelayBuffer stays under a ceiling and loud passages are
+ * turned down smoothly rather than clipped. The output is the input delayed
+ * by a window less one frame, times a gain worked out over the window:
+ *
+ *  1. the peak of the window (the largest magnitude over its frames, the
+ *     channels of a frame taken together) from a monotonic deque: a frame
+ *     goes in at the back after every frame it beats is dropped from the
+ *     back, and leaves the front once it is out of the window, so the front
+ *     is always the window's peak. Every frame goes in & out once, so the
+ *     cost is O(1) a frame whatever the window.
+ *  2. the gain that peak needs, ceiling / peak (Q1.15, rounded down); one
+ *     divide, and only when the peak changes
+ *  3. released: down to it at once, back up as a one-pole (Q1.30 state,
+ *     rounded up to Q1.15, so it gets all the way back to 1)
+ *  4. averaged over the window (a running sum and a shift)
+ *
+ * Each frame's gain is the average of gains held at or under what the
+ * frame the output is on needs, so the output never passes the ceiling,
+ * and the average ramps the gain down over the whole lookahead rather than
+ * stepping it. The window is a power of two frames; the default, 32 at
+ * 16 kHz, is 2 ms of lookahead & delay. A frame costs a few compares, a
+ * multiply & two shifts for the release, and one multiply a channel.
+ *
+ * Below the engine is the Sound Tools compand effect (st_compand_* in
+ * st_i.h) with the limiter as its one mode; sox's transfer-function
+ * compander is not carried:
+ *
+ *  compand -l [ ceiling-dB [ lookahead-ms [ release-ms ] ] ]
+ *
+ *      ceiling-dB      -24 to 0, the largest peak out (-1)
+ *      lookahead-ms    how far ahead the gain comes down (2)
+ *      release-ms      how fast it goes back up (50)
+ *
+ * The effect works in place and drains the lookahead. Starting it again
+ * carries on with the gain & lookahead it had, as the board's chains share
+ * one limiter across mode switches; getopts (or compand_limiter()) sets it
+ * up afresh.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "xil_types.h"
+#include "xstatus.h"
+#include "st_i.h"
+
+#include "delay_line.h"
+#include "compand.h"
+
+/****************************************************************************/
+/***************************** LIMITER ENGINE *******************************/
+/****************************************************************************/
+
+XStatus limiter_init(limiter_t *lm, st_rate_t rate, unsigned int channels,
+                     double ceiling_db, double lookahead_ms, double release_ms) {
+
+    unsigned int frames;
+
+    if ((lm == NULL) || (channels == 0) || (channels > LIMITER_MAX_CHANNELS) ||
+        (ceiling_db < LIMITER_MIN_CEILING_DB) || (ceiling_db > 0.0) || (lookahead_ms <= 0.0) ||
+        (release_ms <= 0.0) || (release_ms > LIMITER_MAX_RELEASE_MS)) {
+
+        return XST_INVALID_PARAM;
+    }
+
+    frames = (unsigned int) (lookahead_ms * rate / 1000.0);
+
+    if (frames == 0) {
+        return XST_INVALID_PARAM;
+    }
+
+    // the largest power of two window that holds the lookahead & one frame
+
+    for (lm->window = 2, lm->shift = 1; (lm->window * 2 <= frames + 1) && (lm->window < LIMITER_MAX_WINDOW);
+         lm->window *= 2, lm->shift++) {
+    }
+
+    lm->rate     = rate;
+    lm->channels = channels;
+    lm->ceiling  = MIN((unsigned int) (Q15_ONE * pow(10.0, ceiling_db / 20.0)), PCM_MAX);
+    lm->release  = MAX((unsigned int) (Q15_ONE * (1.0 - exp(-1000.0 / (release_ms * rate))) + 0.5), 1);
+
+    limiter_reset(lm);
+
+    return XST_SUCCESS;
+}
+
+void limiter_reset(limiter_t *lm) {
+
+    unsigned int i;
+
+    lm->frame   = 0;
+    lm->head    = 0;
+    lm->count   = 0;
+    lm->peak    = 0;
+    lm->hold    = Q15_ONE;
+    lm->gain    = Q15_ONE << 15;
+    lm->sum     = Q15_ONE << lm->shift;
+    lm->limited = 0;
+
+    for (i = 0; i < LIMITER_MAX_WINDOW; i++) {
+        lm->gains[i] = Q15_ONE;
+    }
+
+    memset(lm->delay, 0, sizeof(lm->delay));
+
+    return;
+}
+
+st_size_t limiter_flow(limiter_t *lm, const st_sample_t *in, st_sample_t *out, st_size_t len) {
+
+    unsigned int    mask = lm->window - 1, ch = lm->channels;
+    unsigned int    a, c, g, slot, back;
+    st_size_t       i;
+    s32             x, y;
+    u32             d;
+
+    for (i = 0; i + ch <= len; i += ch) {
+
+        // the frame's peak, and the frame into the lookahead
+
+        slot = (lm->frame & mask) * ch;
+
+        for (c = 0, a = 0; c < ch; c++) {
+
+            x = in ? ST_SAMPLE_TO_SIGNED_WORD(in[i + c]) : 0;
+            a = MAX(a, (unsigned int) ((x < 0) ? -x : x));
+
+            lm->delay[slot + c] = (s16) x;
+        }
+
+        // the oldest out of the deque once it is a window behind, then this
+        // frame in past every peak it beats
+
+        if ((lm->count > 0) && ((u16) (lm->frame - lm->dq_frame[lm->head]) >= lm->window)) {
+
+            lm->head = (lm->head + 1) & mask;
+            lm->count--;
+        }
+
+        while (lm->count > 0) {
+
+            back = (lm->head + lm->count - 1) & mask;
+
+            if (lm->dq_peak[back] > a) {
+                break;
+            }
+
+            lm->count--;
+        }
+
+        back = (lm->head + lm->count) & mask;
+        lm->dq_peak[back]  = (u16) a;
+        lm->dq_frame[back] = lm->frame;
+        lm->count++;
+
+        // the gain the window's peak needs, down at once & up released
+
+        if (lm->dq_peak[lm->head] != lm->peak) {
+
+            lm->peak = lm->dq_peak[lm->head];
+            lm->hold = (lm->peak > lm->ceiling) ? (lm->ceiling << 15) / lm->peak : Q15_ONE;
+        }
+
+        if ((lm->hold << 15) <= lm->gain) {
+            lm->gain = lm->hold << 15;
+        }
+
+        else {
+
+            d         = (lm->hold << 15) - lm->gain;
+            lm->gain += (d >> 15) * lm->release + (((d & 0x7FFF) * lm->release) >> 15);
+        }
+
+        // averaged over the window
+
+        g   = (lm->gain + 0x7FFF) >> 15;
+        lm->sum += g - lm->gains[lm->frame & mask];
+        lm->gains[lm->frame & mask] = (u16) g;
+        g   = lm->sum >> lm->shift;
+
+        lm->limited += (g < Q15_ONE);
+
+        // out: the frame a window less one back
+
+        slot = ((lm->frame + 1) & mask) * ch;
+
+        for (c = 0; c < ch; c++) {
+
+            y = (lm->delay[slot + c] * (s32) g + (1 << (Q15_SHIFT - 1))) >> Q15_SHIFT;
+            out[i + c] = ST_SIGNED_WORD_TO_SAMPLE((s16) y);
+        }
+
+        lm->frame++;
+    }
+
+    return i;
+}
+
+st_size_t limiter_delay(const limiter_t *lm) {
+
+    return lm->window - 1;
+}
+
+/****************************************************************************/
+/***************************** ST HANDLERS **********************************/
+/****************************************************************************/
+
+// private data of the compand effect, in effp->priv
+
+typedef struct compandstuff {
+
+    unsigned int    mode;
+    double          ceiling_db;
+    double          lookahead_ms;
+    double          release_ms;
+    unsigned int    started;            // limiter set up for these settings
+    st_size_t       left;               // samples in the lookahead to drain
+
+    limiter_t       lm;
+
+} *compand_t;
+
+XStatus compand_limiter(eff_t effp, double ceiling_db, double lookahead_ms, double release_ms) {
+
+    compand_t r = (compand_t) effp->priv;
+
+    if (sizeof(struct compandstuff) > ST_MAX_EFFECT_PRIVSIZE) {
+        return XST_FAILURE;
+    }
+
+    if ((ceiling_db < LIMITER_MIN_CEILING_DB) || (ceiling_db > 0.0) || (lookahead_ms <= 0.0) ||
+        (release_ms <= 0.0) || (release_ms > LIMITER_MAX_RELEASE_MS)) {
+
+        return XST_INVALID_PARAM;
+    }
+
+    r->mode         = COMPAND_LIMITER;
+    r->ceiling_db   = ceiling_db;
+    r->lookahead_ms = lookahead_ms;
+    r->release_ms   = release_ms;
+    r->started      = 0;
+
+    return XST_SUCCESS;
+}
+
+int st_compand_getopts(eff_t effp, int argc, char **argv) {
+
+    double value[3] = { LIMITER_DEFAULT_CEILING_DB, LIMITER_DEFAULT_LOOKAHEAD, LIMITER_DEFAULT_RELEASE };
+    char   *end = "";
+    int    i;
+
+    if ((argc >= 1) && (argc <= 4) && !strcmp(argv[0], "-l")) {
+
+        for (i = 1; (i < argc) && (*end == '\0'); i++) {
+            value[i - 1] = strtod(argv[i], &end);
+        }
+
+        if ((*end == '\0') && (compand_limiter(effp, value[0], value[1], value[2]) == XST_SUCCESS)) {
+            return ST_SUCCESS;
+        }
+    }
+
+    st_warn("Usage: compand -l [ ceiling-dB [ lookahead-ms [ release-ms ] ] ]");
+    return ST_EOF;
+}
+
+int st_compand_start(eff_t effp) {
+
+    compand_t    r = (compand_t) effp->priv;
+    unsigned int channels = effp->ininfo.channels ? effp->ininfo.channels : 1;
+
+    // started before with these settings: carry on from where it was
+
+    if (r->started) {
+        return ST_SUCCESS;
+    }
+
+    if (limiter_init(&r->lm, effp->ininfo.rate, channels, r->ceiling_db, r->lookahead_ms,
+                     r->release_ms) != XST_SUCCESS) {
+
+        st_warn("%s: can not limit %u channels at %lu Hz with %g ms of lookahead", effp->name, channels,
+                (unsigned long) effp->ininfo.rate, r->lookahead_ms);
+        return ST_EOF;
+    }
+
+    r->started = 1;
+    r->left    = limiter_delay(&r->lm) * channels;
+
+    return ST_SUCCESS;
+}
+
+int st_compand_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf,
+                    st_size_t *isamp, st_size_t *osamp) {
+
+    compand_t r = (compand_t) effp->priv;
+
+    *isamp = *osamp = limiter_flow(&r->lm, ibuf, obuf, MIN(*isamp, *osamp));
+
+    return ST_SUCCESS;
+}
+
+int st_compand_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp) {
+
+    compand_t r = (compand_t) effp->priv;
+
+    // silence in until the lookahead is out
+
+    *osamp   = limiter_flow(&r->lm, NULL, obuf, MIN(*osamp, r->left));
+    r->left -= *osamp;
+
+    return ST_SUCCESS;
+}
+
+int st_compand_stop(eff_t effp) {
+
+    return ST_SUCCESS;
+}
@@ -0,0 +1,105 @@
+/* compand.h - lookahead peak limiter for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Constants, structures and prototypes for the lookahead peak limiter (see
+ * compand.c), the limiter mode of the Sound Tools compand effect.
+*/
+
+#ifndef COMPAND_H
+#define COMPAND_H
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "st.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Compand modes: only the limiter is carried
+
+#define COMPAND_LIMITER         0
+
+// Lookahead window in frames, a power of two (the gain is averaged over it
+// with a shift), and interleaved channels, which share one gain. Both size
+// the limiter, which lives in the effect's private area.
+
+#define LIMITER_MAX_WINDOW      64
+#define LIMITER_MAX_CHANNELS    2
+
+// Settings: ceiling in dBFS, lookahead and release in ms
+
+#define LIMITER_MIN_CEILING_DB  (-24.0)
+#define LIMITER_MAX_RELEASE_MS  5000.0
+
+#define LIMITER_DEFAULT_CEILING_DB  (-1.0)
+#define LIMITER_DEFAULT_LOOKAHEAD   2.0
+#define LIMITER_DEFAULT_RELEASE     50.0
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct limiter {
+
+    st_rate_t       rate;
+    unsigned int    channels;
+    unsigned int    window;             // frames of lookahead + 1, 2^shift
+    unsigned int    shift;
+    unsigned int    ceiling;            // largest magnitude out
+    unsigned int    release;            // Q1.15 one-pole coefficient
+
+    u16             frame;              // frames in, mod 2^16
+
+    // monotonic deque of the window's peaks: frames whose peak is not
+    // beaten by a later one, oldest (the window's largest) first
+
+    unsigned int    head;
+    unsigned int    count;
+    u16             dq_peak[LIMITER_MAX_WINDOW];
+    u16             dq_frame[LIMITER_MAX_WINDOW];
+
+    unsigned int    peak;               // the window's, and the gain it needs
+    unsigned int    hold;               // Q1.15
+    u32             gain;               // released, Q1.30
+    u32             sum;                // of the last window gains, Q1.15
+    u16             gains[LIMITER_MAX_WINDOW];
+    s16             delay[LIMITER_MAX_WINDOW * LIMITER_MAX_CHANNELS];
+
+    st_size_t       limited;            // frames out with the gain under 1
+
+} limiter_t;
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+// ceiling in dBFS (-24 to 0), lookahead in ms (rounded down to a power of
+// two frames less one, from 1 to LIMITER_MAX_WINDOW - 1), release in ms
+XStatus   limiter_init(limiter_t *lm, st_rate_t rate, unsigned int channels,
+                       double ceiling_db, double lookahead_ms, double release_ms);
+
+// empty the lookahead, gain back at 1
+void      limiter_reset(limiter_t *lm);
+
+// len interleaved samples in (NULL for silence, out may be in), as many
+// out, limiter_delay() frames later
+st_size_t limiter_flow(limiter_t *lm, const st_sample_t *in, st_sample_t *out, st_size_t len);
+st_size_t limiter_delay(const limiter_t *lm);
+
+// set a compand effect (effp->ininfo filled in) up as a limiter without a
+// command line, as the board's chains do
+XStatus   compand_limiter(eff_t effp, double ceiling_db, double lookahead_ms, double release_ms);
+
+#endif
@@ -0,0 +1,188 @@
+/* delay_line - multi-tap delay line engine for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * A delay line is a power-of-two circular buffer in one of the Block RAM
+ * peripherals (a whole buffer or an aligned part of one, starting at base)
+ * plus a table of up to DELAY_MAX_TAPS taps, each with its own
+ * delay (in lines) and Q1.15 gain. Both can be changed at runtime.
+ *
+ * Positions are free-running line numbers; the line for pos is at
+ * base + (pos & mask), and runs that cross the end of the line are split
+ * into two block transfers. Tap addresses are (pos - delay) & mask, so a tap that reaches back past
+ * line 0 simply wraps to the end of the buffer instead of being skipped.
+ * delay_line_mix() works a block at a time: every tap is one streamed block
+ * read (one bus read per sample) followed by one multiply-accumulate per
+ * sample, whatever the tap delay or the position in the sweep. The lines
+ * are signed PCM; the taps are summed at full precision and the result is
+ * saturated to 16 bits once.
+ *
+ * Taps shorter than min_delay are clamped to it. The caller sets min_delay
+ * to its block size, so a tap never reaches into lines of the current block
+ * that have not been written back yet.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include "xil_types.h"
+#include "xstatus.h"
+
+#include "delay_line.h"
+
+/****************************************************************************/
+/***************************** DELAY LINE INIT ******************************/
+/****************************************************************************/
+
+XStatus delay_line_init(delay_line_t *dl, delay_read_t read_block,
+                        delay_write_t write_block, unsigned int base,
+                        unsigned int depth, unsigned int min_delay) {
+
+    // circular addressing relies on masking, so the depth must be 2^n
+
+    if ((depth == 0) || (depth & (depth - 1)) || (min_delay >= depth)) {
+        return XST_INVALID_PARAM;
+    }
+
+    dl->read_block  = read_block;
+    dl->write_block = write_block;
+    dl->base        = base;
+    dl->depth       = depth;
+    dl->mask        = depth - 1;
+    dl->min_delay   = min_delay;
+    dl->num_taps    = 0;
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/***************************** SET TAP **************************************/
+/****************************************************************************/
+
+XStatus delay_line_set_tap(delay_line_t *dl, unsigned int tap,
+                           unsigned int delay, unsigned int gain) {
+
+    if (tap >= DELAY_MAX_TAPS) {
+        return XST_INVALID_PARAM;
+    }
+
+    // keep the tap inside the buffer and behind the current block
+
+    if (delay < dl->min_delay) {
+        delay = dl->min_delay;
+    }
+
+    dl->tap[tap].delay = MIN(delay, dl->mask);
+    dl->tap[tap].gain  = MIN(gain, Q15_GAIN_MAX);
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/***************************** SET NUM TAPS *********************************/
+/****************************************************************************/
+
+XStatus delay_line_set_num_taps(delay_line_t *dl, unsigned int num_taps) {
+
+    if (num_taps > DELAY_MAX_TAPS) {
+        return XST_INVALID_PARAM;
+    }
+
+    dl->num_taps = num_taps;
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/***************************** DELAY LINE READ ******************************/
+/****************************************************************************/
+
+void delay_line_read(const delay_line_t *dl, unsigned int pos,
+                     unsigned int count, unsigned int *dst) {
+
+    unsigned int start = pos & dl->mask;
+    unsigned int first = MIN(count, dl->depth - start);
+
+    // one streamed read per line, split where the line wraps
+
+    dl->read_block(dl->base + start, first, dst);
+
+    if (first < count) {
+        dl->read_block(dl->base, count - first, dst + first);
+    }
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** DELAY LINE WRITE *****************************/
+/****************************************************************************/
+
+void delay_line_write(const delay_line_t *dl, unsigned int pos,
+                      unsigned int count, const unsigned int *src) {
+
+    unsigned int start = pos & dl->mask;
+    unsigned int first = MIN(count, dl->depth - start);
+
+    // one streamed write per line, split where the line wraps
+
+    dl->write_block(dl->base + start, first, src);
+
+    if (first < count) {
+        dl->write_block(dl->base, count - first, src + first);
+    }
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** DELAY LINE MIX *******************************/
+/****************************************************************************/
+
+void delay_line_mix(const delay_line_t *dl, unsigned int pos,
+                    unsigned int count, unsigned int *acc) {
+
+    unsigned int tapbuf[DELAY_CHUNK];
+    int          sum[DELAY_CHUNK];
+    unsigned int done, chunk, gain, t, i;
+
+    for (done = 0; done < count; done += chunk) {
+
+        chunk = MIN(count - done, DELAY_CHUNK);
+
+        for (i = 0; i < chunk; i++) {
+            sum[i] = PCM_VALUE(acc[done + i]);
+        }
+
+        for (t = 0; t < dl->num_taps; t++) {
+
+            gain = dl->tap[t].gain;
+
+            // one streamed read per sample
+
+            delay_line_read(dl, pos + done - dl->tap[t].delay, chunk, tapbuf);
+
+            // one multiply-accumulate per sample
+
+            for (i = 0; i < chunk; i++) {
+                sum[i] += Q15_SCALE(PCM_VALUE(tapbuf[i]), gain);
+            }
+        }
+
+        // saturate once, after all the taps
+
+        for (i = 0; i < chunk; i++) {
+            acc[done + i] = PCM_LINE(sum[i]);
+        }
+    }
+
+    return;
+}
@@ -0,0 +1,121 @@
+/* delay_line.h - multi-tap delay line engine for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Constants, structures and prototypes for the delay line engine
+ * (see delay_line.c), plus the Q1.15 helpers used for tap gains.
+*/
+
+#ifndef DELAY_LINE_H
+#define DELAY_LINE_H
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define DELAY_MAX_TAPS      8
+#define DELAY_CHUNK         64
+
+// Tap gains, unsigned Q1.15 (0x8000 = 1.0)
+
+#define Q15_SHIFT           15
+#define Q15_ONE             (1u << Q15_SHIFT)
+#define Q15_GAIN_MAX        0xFFFF
+#define Q15_GAIN(x)         ((unsigned int) ((x) * Q15_ONE + 0.5))
+
+// 16-bit PCM range
+
+#define PCM_MIN             (-32768)
+#define PCM_MAX             32767
+
+/****************************************************************************/
+/***************** Macros (Inline Functions) Definitions ********************/
+/****************************************************************************/
+
+// Scale a 16-bit sample by a Q1.15 gain: one 32-bit multiply and a shift,
+// which the MicroBlaze does in hardware (vs. a soft-float divide)
+
+#define Q15_SCALE(x, gain)  ( ((int) (x) * (int) (gain)) >> Q15_SHIFT )
+
+// Buffer lines are 16-bit two's complement PCM (AudioInput / AudioOutput).
+// PCM_VALUE sign-extends a line read from a buffer, PCM_LINE saturates a
+// sum back into one.
+
+#define PCM_VALUE(x)        ( (int) (s16) (x) )
+#define PCM_LINE(x)         ( (unsigned int) (u16) (((x) > PCM_MAX) ? PCM_MAX : \
+                                                    (((x) < PCM_MIN) ? PCM_MIN : (x))) )
+
+#ifndef MIN
+#define MIN(a, b)           ( ((a) <= (b)) ? (a) : (b) )
+#endif
+
+#ifndef MAX
+#define MAX(a, b)           ( ((a) >= (b)) ? (a) : (b) )
+#endif
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+// Block read & write on the buffer backing the line, e.g.
+// ChorusBuffer_ReadBlock & ChorusBuffer_WriteStream
+
+typedef void (*delay_read_t)(unsigned int start, unsigned int count, unsigned int *dst);
+typedef void (*delay_write_t)(unsigned int start, unsigned int count, const unsigned int *src);
+
+typedef struct delay_tap {
+
+    unsigned int    delay;          // lines behind the write position
+    unsigned int    gain;           // Q1.15
+
+} delay_tap_t;
+
+typedef struct delay_line {
+
+    delay_read_t    read_block;
+    delay_write_t   write_block;
+    unsigned int    base;           // first buffer line of the line
+    unsigned int    depth;          // power of two
+    unsigned int    mask;           // depth - 1
+    unsigned int    min_delay;
+    unsigned int    num_taps;
+    delay_tap_t     tap[DELAY_MAX_TAPS];
+
+} delay_line_t;
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+XStatus delay_line_init(delay_line_t *dl, delay_read_t read_block,
+                        delay_write_t write_block, unsigned int base,
+                        unsigned int depth, unsigned int min_delay);
+
+XStatus delay_line_set_tap(delay_line_t *dl, unsigned int tap,
+                           unsigned int delay, unsigned int gain);
+
+XStatus delay_line_set_num_taps(delay_line_t *dl, unsigned int num_taps);
+
+void    delay_line_read(const delay_line_t *dl, unsigned int pos,
+                        unsigned int count, unsigned int *dst);
+
+void    delay_line_write(const delay_line_t *dl, unsigned int pos,
+                         unsigned int count, const unsigned int *src);
+
+void    delay_line_mix(const delay_line_t *dl, unsigned int pos,
+                       unsigned int count, unsigned int *acc);
+
+#endif
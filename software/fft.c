@@ -0,0 +1,710 @@
+/* fft - shared FFT engine for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * One FFT for everything spectral (pitch & time-stretch, analysis): in
+ * place, decimation in time, on power-of-two sizes from 64 to 4096. The
+ * input is put in bit-reversed order, then goes through radix-4 stages (a
+ * radix-2 one first when the size is an odd power of two). A radix-4
+ * butterfly does the work of four radix-2 ones with three complex
+ * multiplies instead of four, and half the passes over the data.
+ *
+ * The twiddles come from one table of a quarter sine wave at 4096 points,
+ * built the first time a transform runs and shared by every size: 1025
+ * entries, 2 KB as Q15, read by symmetry for the other three quarters.
+ *
+ * There are two variants on the same stages:
+ *
+ *  o Q15, for the MicroBlaze (no FPU): 16-bit points, 32-bit products
+ *    rounded back to 16 bits. The forward transform takes a bit of headroom
+ *    a radix-2 stage and two a radix-4 one, so it scales by 1/n and can't
+ *    overflow; the inverse doesn't scale, and saturates
+ *  o single-precision float, for the host: the inverse scales by 1/n. With
+ *    SSE2, a radix-4 stage runs the butterflies of two twiddles side by
+ *    side; the sums are the C butterfly's in the same order, so the output
+ *    is the same bit for bit.
+ *
+ * A real transform of n points runs as a complex one of n/2 (even samples
+ * real, odd ones imaginary) and a pass that splits the result into the
+ * even & odd halves' spectra and puts them back together as n/2 + 1 bins.
+ * The inverse does the same backwards.
+ *
+ * host/bench_fft times every size against a plain DFT and checks the
+ * output against a double-precision one. On noise at -12 dBFS the float
+ * bins are good to 138 dB or better; the Q15 ones to 64 dB at 64 points,
+ * 3 dB less a doubling (45 dB at 4096), as the 1/n scaling shifts the low
+ * bits out, and a Q15 round trip (forward, then inverse) is only as good.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <math.h>
+#include "xil_types.h"
+#include "xstatus.h"
+
+#include "delay_line.h"
+#include "fft.h"
+
+#if FFT_HAVE_SIMD
+#include <emmintrin.h>
+#endif
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define FFT_QUARTER             (FFT_MAX_SIZE / 4)
+
+/****************************************************************************/
+/***************** Macros (Inline Functions) Definitions ********************/
+/****************************************************************************/
+
+// Q15 complex multiply, one part at a time; two products of 16 bits by
+// Q15 can't overflow 32 bits. The real transform's split multiplies sums
+// of two points, 17 bits, and needs the 64-bit one.
+
+#define CMUL_RE(ar, ai, wr, wi) ( ((ar) * (wr) - (ai) * (wi) + (1 << (Q15_SHIFT - 1))) >> Q15_SHIFT )
+#define CMUL_IM(ar, ai, wr, wi) ( ((ar) * (wi) + (ai) * (wr) + (1 << (Q15_SHIFT - 1))) >> Q15_SHIFT )
+
+#define CMUL64_RE(ar, ai, wr, wi) \
+    ( (int) (((s64) (ar) * (wr) - (s64) (ai) * (wi) + (1 << (Q15_SHIFT - 1))) >> Q15_SHIFT) )
+#define CMUL64_IM(ar, ai, wr, wi) \
+    ( (int) (((s64) (ar) * (wi) + (s64) (ai) * (wr) + (1 << (Q15_SHIFT - 1))) >> Q15_SHIFT) )
+
+// a sum back to 16 bits, shifted down (rounded) and saturated
+
+#define Q15_STORE(x, shift)     ( (s16) MIN(MAX(((x) + ((1 << (shift)) >> 1)) >> (shift), PCM_MIN), PCM_MAX) )
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+// sin(2 pi i / FFT_MAX_SIZE) for i from 0 to a quarter turn
+
+static s16   sin_q15[FFT_QUARTER + 1];
+static float sin_float[FFT_QUARTER + 1];
+static int   tables_built = 0;
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+// e^(-2 pi i m / FFT_MAX_SIZE), m below three quarters of a turn
+
+static void twiddle_q15(unsigned int m, int *wr, int *wi) {
+
+    unsigned int r = m & (FFT_QUARTER - 1);
+
+    switch (m / FFT_QUARTER) {
+
+        case 0:  *wr =  sin_q15[FFT_QUARTER - r]; *wi = -sin_q15[r];               break;
+        case 1:  *wr = -sin_q15[r];               *wi = -sin_q15[FFT_QUARTER - r]; break;
+        default: *wr = -sin_q15[FFT_QUARTER - r]; *wi =  sin_q15[r];               break;
+    }
+
+    return;
+}
+
+static void twiddle_float(unsigned int m, float *wr, float *wi) {
+
+    unsigned int r = m & (FFT_QUARTER - 1);
+
+    switch (m / FFT_QUARTER) {
+
+        case 0:  *wr =  sin_float[FFT_QUARTER - r]; *wi = -sin_float[r];               break;
+        case 1:  *wr = -sin_float[r];               *wi = -sin_float[FFT_QUARTER - r]; break;
+        default: *wr = -sin_float[FFT_QUARTER - r]; *wi =  sin_float[r];               break;
+    }
+
+    return;
+}
+
+static int valid_size(unsigned int n) {
+
+    return (n >= FFT_MIN_SIZE) && (n <= FFT_MAX_SIZE) && !(n & (n - 1));
+}
+
+// log2 of a power of two
+
+static unsigned int size_bits(unsigned int n) {
+
+    unsigned int bits = 0;
+
+    while ((1u << bits) < n) {
+        bits++;
+    }
+
+    return bits;
+}
+
+/****************************************************************************/
+/***************************** Q15 TRANSFORM ********************************/
+/****************************************************************************/
+
+static void bit_reverse_q15(fft_cpx_q15_t *x, unsigned int n) {
+
+    unsigned int  i, j, k;
+    fft_cpx_q15_t t;
+
+    for (i = 1, j = 0; i < n; i++) {
+
+        for (k = n >> 1; j & k; k >>= 1) {
+            j ^= k;
+        }
+
+        j |= k;
+
+        if (i < j) {
+            t = x[i]; x[i] = x[j]; x[j] = t;
+        }
+    }
+
+    return;
+}
+
+// pairs of points, no twiddles
+
+static void stage2_q15(fft_cpx_q15_t *x, unsigned int n, unsigned int shift) {
+
+    unsigned int i;
+    int          ar, ai, br, bi;
+
+    for (i = 0; i < n; i += 2) {
+
+        ar = x[i].re;     ai = x[i].im;
+        br = x[i + 1].re; bi = x[i + 1].im;
+
+        x[i].re     = Q15_STORE(ar + br, shift);
+        x[i].im     = Q15_STORE(ai + bi, shift);
+        x[i + 1].re = Q15_STORE(ar - br, shift);
+        x[i + 1].im = Q15_STORE(ai - bi, shift);
+    }
+
+    return;
+}
+
+// groups of 4h points from four transforms of h; in bit-reversed order the
+// quarters hold the residues 0, 2, 1 & 3 (mod 4) of the group's input
+
+static void stage4_q15(fft_cpx_q15_t *x, unsigned int n, unsigned int h, unsigned int inverse,
+                       unsigned int shift) {
+
+    unsigned int  stride = FFT_MAX_SIZE / (4 * h);
+    unsigned int  k, b;
+    int           w1r, w1i, w2r, w2i, w3r, w3i;
+    int           t1r, t1i, t2r, t2i, t3r, t3i;
+    int           s0r, s0i, s1r, s1i, s2r, s2i, s3r, s3i;
+    fft_cpx_q15_t *p;
+
+    for (k = 0; k < h; k++) {
+
+        twiddle_q15(k * stride, &w1r, &w1i);
+        twiddle_q15(2 * k * stride, &w2r, &w2i);
+        twiddle_q15(3 * k * stride, &w3r, &w3i);
+
+        if (inverse) {
+
+            w1i = -w1i;
+            w2i = -w2i;
+            w3i = -w3i;
+        }
+
+        for (b = k; b < n; b += 4 * h) {
+
+            p = x + b;
+
+            t1r = CMUL_RE(p[2 * h].re, p[2 * h].im, w1r, w1i);
+            t1i = CMUL_IM(p[2 * h].re, p[2 * h].im, w1r, w1i);
+            t2r = CMUL_RE(p[h].re, p[h].im, w2r, w2i);
+            t2i = CMUL_IM(p[h].re, p[h].im, w2r, w2i);
+            t3r = CMUL_RE(p[3 * h].re, p[3 * h].im, w3r, w3i);
+            t3i = CMUL_IM(p[3 * h].re, p[3 * h].im, w3r, w3i);
+
+            s0r = p[0].re + t2r; s0i = p[0].im + t2i;
+            s1r = p[0].re - t2r; s1i = p[0].im - t2i;
+            s2r = t1r + t3r;     s2i = t1i + t3i;
+            s3r = t1r - t3r;     s3i = t1i - t3i;
+
+            // the odd outputs turn s3 a quarter, -j forward & +j inverse
+
+            if (inverse) {
+                s3r = -s3r;
+                s3i = -s3i;
+            }
+
+            p[0].re     = Q15_STORE(s0r + s2r, shift);
+            p[0].im     = Q15_STORE(s0i + s2i, shift);
+            p[h].re     = Q15_STORE(s1r + s3i, shift);
+            p[h].im     = Q15_STORE(s1i - s3r, shift);
+            p[2 * h].re = Q15_STORE(s0r - s2r, shift);
+            p[2 * h].im = Q15_STORE(s0i - s2i, shift);
+            p[3 * h].re = Q15_STORE(s1r - s3i, shift);
+            p[3 * h].im = Q15_STORE(s1i + s3r, shift);
+        }
+    }
+
+    return;
+}
+
+// any power of two from 2 up, unchecked
+
+static void transform_q15(fft_cpx_q15_t *x, unsigned int n, unsigned int inverse) {
+
+    unsigned int h = 1;
+
+    bit_reverse_q15(x, n);
+
+    if (size_bits(n) & 1) {
+
+        stage2_q15(x, n, inverse ? 0 : 1);
+        h = 2;
+    }
+
+    for (; h < n; h *= 4) {
+        stage4_q15(x, n, h, inverse, inverse ? 0 : 2);
+    }
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** FLOAT TRANSFORM ******************************/
+/****************************************************************************/
+
+static void bit_reverse_float(fft_cpx_t *x, unsigned int n) {
+
+    unsigned int i, j, k;
+    fft_cpx_t    t;
+
+    for (i = 1, j = 0; i < n; i++) {
+
+        for (k = n >> 1; j & k; k >>= 1) {
+            j ^= k;
+        }
+
+        j |= k;
+
+        if (i < j) {
+            t = x[i]; x[i] = x[j]; x[j] = t;
+        }
+    }
+
+    return;
+}
+
+static void stage2_float(fft_cpx_t *x, unsigned int n) {
+
+    unsigned int i;
+    float        ar, ai, br, bi;
+
+    for (i = 0; i < n; i += 2) {
+
+        ar = x[i].re;     ai = x[i].im;
+        br = x[i + 1].re; bi = x[i + 1].im;
+
+        x[i].re     = ar + br;
+        x[i].im     = ai + bi;
+        x[i + 1].re = ar - br;
+        x[i + 1].im = ai - bi;
+    }
+
+    return;
+}
+
+// the butterflies of twiddles k to k_end - 1 (see stage4_q15)
+
+static void stage4_float(fft_cpx_t *x, unsigned int n, unsigned int h, unsigned int inverse,
+                         unsigned int k, unsigned int k_end) {
+
+    unsigned int stride = FFT_MAX_SIZE / (4 * h);
+    unsigned int b;
+    float        w1r, w1i, w2r, w2i, w3r, w3i;
+    float        t1r, t1i, t2r, t2i, t3r, t3i;
+    float        s0r, s0i, s1r, s1i, s2r, s2i, s3r, s3i;
+    fft_cpx_t    *p;
+
+    for (; k < k_end; k++) {
+
+        twiddle_float(k * stride, &w1r, &w1i);
+        twiddle_float(2 * k * stride, &w2r, &w2i);
+        twiddle_float(3 * k * stride, &w3r, &w3i);
+
+        if (inverse) {
+
+            w1i = -w1i;
+            w2i = -w2i;
+            w3i = -w3i;
+        }
+
+        for (b = k; b < n; b += 4 * h) {
+
+            p = x + b;
+
+            t1r = p[2 * h].re * w1r - p[2 * h].im * w1i;
+            t1i = p[2 * h].re * w1i + p[2 * h].im * w1r;
+            t2r = p[h].re * w2r - p[h].im * w2i;
+            t2i = p[h].re * w2i + p[h].im * w2r;
+            t3r = p[3 * h].re * w3r - p[3 * h].im * w3i;
+            t3i = p[3 * h].re * w3i + p[3 * h].im * w3r;
+
+            s0r = p[0].re + t2r; s0i = p[0].im + t2i;
+            s1r = p[0].re - t2r; s1i = p[0].im - t2i;
+            s2r = t1r + t3r;     s2i = t1i + t3i;
+            s3r = t1r - t3r;     s3i = t1i - t3i;
+
+            if (inverse) {
+                s3r = -s3r;
+                s3i = -s3i;
+            }
+
+            p[0].re     = s0r + s2r;
+            p[0].im     = s0i + s2i;
+            p[h].re     = s1r + s3i;
+            p[h].im     = s1i - s3r;
+            p[2 * h].re = s0r - s2r;
+            p[2 * h].im = s0i - s2i;
+            p[3 * h].re = s1r - s3i;
+            p[3 * h].im = s1i + s3r;
+        }
+    }
+
+    return;
+}
+
+#if FFT_HAVE_SIMD
+
+// (re, im) x2 times (wr, wi) x2, as the C butterfly does it: re * wr plus
+// -(im * wi), and re * wi plus im * wr
+
+static inline __m128 cmul_simd(__m128 a, __m128 w, __m128 sign_re) {
+
+    __m128 wr = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 wi = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128 as = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+
+    return _mm_add_ps(_mm_mul_ps(a, wr), _mm_xor_ps(_mm_mul_ps(as, wi), sign_re));
+}
+
+// a radix-4 stage two twiddles at a time, h even
+
+static void stage4_simd(fft_cpx_t *x, unsigned int n, unsigned int h, unsigned int inverse) {
+
+    unsigned int stride = FFT_MAX_SIZE / (4 * h);
+    unsigned int k, j, b;
+    float        w[3][4];
+    float        *p;
+    __m128       sign_re = _mm_castsi128_ps(_mm_set_epi32(0, (int) 0x80000000, 0, (int) 0x80000000));
+    __m128       sign_im = _mm_castsi128_ps(_mm_set_epi32((int) 0x80000000, 0, (int) 0x80000000, 0));
+    __m128       w1, w2, w3, a0, t1, t2, t3, s0, s1, s2, s3;
+
+    for (k = 0; k < h; k += 2) {
+
+        for (j = 0; j < 2; j++) {
+
+            twiddle_float((k + j) * stride, &w[0][2 * j], &w[0][2 * j + 1]);
+            twiddle_float(2 * (k + j) * stride, &w[1][2 * j], &w[1][2 * j + 1]);
+            twiddle_float(3 * (k + j) * stride, &w[2][2 * j], &w[2][2 * j + 1]);
+
+            if (inverse) {
+
+                w[0][2 * j + 1] = -w[0][2 * j + 1];
+                w[1][2 * j + 1] = -w[1][2 * j + 1];
+                w[2][2 * j + 1] = -w[2][2 * j + 1];
+            }
+        }
+
+        w1 = _mm_loadu_ps(w[0]);
+        w2 = _mm_loadu_ps(w[1]);
+        w3 = _mm_loadu_ps(w[2]);
+
+        for (b = k; b < n; b += 4 * h) {
+
+            p = (float *) (x + b);
+
+            a0 = _mm_loadu_ps(p);
+            t1 = cmul_simd(_mm_loadu_ps(p + 4 * h), w1, sign_re);
+            t2 = cmul_simd(_mm_loadu_ps(p + 2 * h), w2, sign_re);
+            t3 = cmul_simd(_mm_loadu_ps(p + 6 * h), w3, sign_re);
+
+            s0 = _mm_add_ps(a0, t2);
+            s1 = _mm_sub_ps(a0, t2);
+            s2 = _mm_add_ps(t1, t3);
+            s3 = _mm_sub_ps(t1, t3);
+
+            if (inverse) {
+                s3 = _mm_xor_ps(s3, _mm_or_ps(sign_re, sign_im));
+            }
+
+            // s3 turned: (s3i, -s3r), added to s1 for output h and taken
+            // away for output 3h
+
+            s3 = _mm_xor_ps(_mm_shuffle_ps(s3, s3, _MM_SHUFFLE(2, 3, 0, 1)), sign_im);
+
+            _mm_storeu_ps(p,         _mm_add_ps(s0, s2));
+            _mm_storeu_ps(p + 2 * h, _mm_add_ps(s1, s3));
+            _mm_storeu_ps(p + 4 * h, _mm_sub_ps(s0, s2));
+            _mm_storeu_ps(p + 6 * h, _mm_sub_ps(s1, s3));
+        }
+    }
+
+    return;
+}
+
+#endif
+
+static void transform_float(fft_cpx_t *x, unsigned int n, unsigned int flags) {
+
+    unsigned int inverse = flags & FFT_INVERSE;
+    unsigned int h = 1, i;
+    float        scale;
+
+    bit_reverse_float(x, n);
+
+    if (size_bits(n) & 1) {
+
+        stage2_float(x, n);
+        h = 2;
+    }
+
+    for (; h < n; h *= 4) {
+
+#if FFT_HAVE_SIMD
+        if (!(flags & FFT_NO_SIMD) && (h >= 2)) {
+
+            stage4_simd(x, n, h, inverse);
+            continue;
+        }
+#endif
+
+        stage4_float(x, n, h, inverse, 0, h);
+    }
+
+    if (inverse) {
+
+        scale = 1.0f / n;
+
+        for (i = 0; i < n; i++) {
+
+            x[i].re *= scale;
+            x[i].im *= scale;
+        }
+    }
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** FFT INIT *************************************/
+/****************************************************************************/
+
+void fft_init(void) {
+
+    unsigned int i;
+    double       s;
+
+    for (i = 0; i <= FFT_QUARTER; i++) {
+
+        s = sin(2.0 * M_PI * i / FFT_MAX_SIZE);
+
+        sin_q15[i]   = (s16) MIN(lrint(s * Q15_ONE), PCM_MAX);
+        sin_float[i] = (float) s;
+    }
+
+    tables_built = 1;
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** COMPLEX FFT **********************************/
+/****************************************************************************/
+
+XStatus fft_q15(fft_cpx_q15_t *x, unsigned int n, unsigned int flags) {
+
+    if (!valid_size(n)) {
+        return XST_INVALID_PARAM;
+    }
+
+    if (!tables_built) {
+        fft_init();
+    }
+
+    transform_q15(x, n, flags & FFT_INVERSE);
+
+    return XST_SUCCESS;
+}
+
+XStatus fft_float(fft_cpx_t *x, unsigned int n, unsigned int flags) {
+
+    if (!valid_size(n)) {
+        return XST_INVALID_PARAM;
+    }
+
+    if (!tables_built) {
+        fft_init();
+    }
+
+    transform_float(x, n, flags);
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/***************************** REAL FFT *************************************/
+/****************************************************************************/
+
+// With Z the n/2-point transform of z[m] = x[2m] + i x[2m+1], and N = n/2:
+//
+//  E[k] = (Z[k] + Z*[N-k]) / 2         the even samples' spectrum
+//  O[k] = (Z[k] - Z*[N-k]) / 2i        the odd samples'
+//  X[k] = E[k] + w^k O[k],  X[N-k] = (E[k] - w^k O[k])*,  w = e^(-2 pi i / n)
+//
+// and backwards, Z[k] = E[k] + i O[k] with E[k] = (X[k] + X*[N-k]) / 2 and
+// O[k] = (X[k] - X*[N-k]) w^-k / 2.
+
+XStatus fft_real_q15(s16 *x, unsigned int n, unsigned int flags) {
+
+    fft_cpx_q15_t *z = (fft_cpx_q15_t *) x;
+    unsigned int  half = n / 2, stride = FFT_MAX_SIZE / n, k;
+    int           ar, ai, br, bi, er, ei, or_, oi, wr, wi, tr, ti;
+
+    if (!valid_size(n)) {
+        return XST_INVALID_PARAM;
+    }
+
+    if (!tables_built) {
+        fft_init();
+    }
+
+    if (!(flags & FFT_INVERSE)) {
+
+        // Z comes out scaled by 1/N: E & O take two more bits, for 1/n
+
+        transform_q15(z, half, 0);
+
+        for (k = 0; k <= half / 2; k++) {
+
+            ar = z[k].re;                       ai = z[k].im;
+            br = z[(half - k) & (half - 1)].re; bi = z[(half - k) & (half - 1)].im;
+
+            er  = ar + br;  ei  = ai - bi;
+            or_ = ai + bi;  oi  = br - ar;
+
+            twiddle_q15(k * stride, &wr, &wi);
+
+            tr = CMUL64_RE(or_, oi, wr, wi);
+            ti = CMUL64_IM(or_, oi, wr, wi);
+
+            z[half - k].re = Q15_STORE(er - tr, 2);
+            z[half - k].im = Q15_STORE(ti - ei, 2);
+            z[k].re        = Q15_STORE(er + tr, 2);
+            z[k].im        = Q15_STORE(ei + ti, 2);
+        }
+
+        return XST_SUCCESS;
+    }
+
+    // the unscaled inverse gives N z for Z, so Z is taken twice over: E & O
+    // without the halves
+
+    for (k = 0; k <= half / 2; k++) {
+
+        ar = z[k].re;        ai = z[k].im;
+        br = z[half - k].re; bi = z[half - k].im;
+
+        er = ar + br;  ei = ai - bi;
+
+        twiddle_q15(k * stride, &wr, &wi);
+
+        or_ = CMUL64_RE(ar - br, ai + bi, wr, -wi);
+        oi  = CMUL64_IM(ar - br, ai + bi, wr, -wi);
+
+        if (k > 0) {
+
+            z[half - k].re = Q15_STORE(er + oi, 0);
+            z[half - k].im = Q15_STORE(or_ - ei, 0);
+        }
+
+        z[k].re = Q15_STORE(er - oi, 0);
+        z[k].im = Q15_STORE(ei + or_, 0);
+    }
+
+    transform_q15(z, half, FFT_INVERSE);
+
+    return XST_SUCCESS;
+}
+
+XStatus fft_real_float(float *x, unsigned int n, unsigned int flags) {
+
+    fft_cpx_t    *z = (fft_cpx_t *) x;
+    unsigned int half = n / 2, stride = FFT_MAX_SIZE / n, k;
+    float        ar, ai, br, bi, er, ei, or_, oi, wr, wi, tr, ti;
+
+    if (!valid_size(n)) {
+        return XST_INVALID_PARAM;
+    }
+
+    if (!tables_built) {
+        fft_init();
+    }
+
+    if (!(flags & FFT_INVERSE)) {
+
+        transform_float(z, half, flags);
+
+        for (k = 0; k <= half / 2; k++) {
+
+            ar = z[k].re;                       ai = z[k].im;
+            br = z[(half - k) & (half - 1)].re; bi = z[(half - k) & (half - 1)].im;
+
+            er  = 0.5f * (ar + br);  ei = 0.5f * (ai - bi);
+            or_ = 0.5f * (ai + bi);  oi = 0.5f * (br - ar);
+
+            twiddle_float(k * stride, &wr, &wi);
+
+            tr = or_ * wr - oi * wi;
+            ti = or_ * wi + oi * wr;
+
+            z[half - k].re = er - tr;
+            z[half - k].im = ti - ei;
+            z[k].re        = er + tr;
+            z[k].im        = ei + ti;
+        }
+
+        return XST_SUCCESS;
+    }
+
+    for (k = 0; k <= half / 2; k++) {
+
+        ar = z[k].re;        ai = z[k].im;
+        br = z[half - k].re; bi = z[half - k].im;
+
+        er = 0.5f * (ar + br);  ei = 0.5f * (ai - bi);
+
+        twiddle_float(k * stride, &wr, &wi);
+
+        or_ = 0.5f * ((ar - br) * wr + (ai + bi) * wi);
+        oi  = 0.5f * ((ai + bi) * wr - (ar - br) * wi);
+
+        if (k > 0) {
+
+            z[half - k].re = er + oi;
+            z[half - k].im = or_ - ei;
+        }
+
+        z[k].re = er - oi;
+        z[k].im = ei + or_;
+    }
+
+    transform_float(z, half, flags);
+
+    return XST_SUCCESS;
+}
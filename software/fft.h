@@ -0,0 +1,88 @@
+/* fft.h - shared FFT engine for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Constants, structures and prototypes for the in-place radix-4 / radix-2
+ * FFT (see fft.c) the spectral effects and analysis share.
+*/
+
+#ifndef FFT_H
+#define FFT_H
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Transform sizes, powers of two; one twiddle table (a quarter wave at the
+// largest size) serves them all
+
+#define FFT_MIN_BITS            6
+#define FFT_MAX_BITS            12
+#define FFT_MIN_SIZE            (1u << FFT_MIN_BITS)
+#define FFT_MAX_SIZE            (1u << FFT_MAX_BITS)
+
+// Transform flags: the direction, and (float, host) the C butterflies
+// rather than the SSE2 ones, e.g. to compare the two
+
+#define FFT_FORWARD             0
+#define FFT_INVERSE             1
+#define FFT_NO_SIMD             2
+
+#if defined(__SSE2__)
+#define FFT_HAVE_SIMD           1
+#else
+#define FFT_HAVE_SIMD           0
+#endif
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct fft_cpx_q15 {
+
+    s16             re;
+    s16             im;
+
+} fft_cpx_q15_t;
+
+typedef struct fft_cpx {
+
+    float           re;
+    float           im;
+
+} fft_cpx_t;
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+// build the twiddle tables; the transforms do it themselves the first time
+void    fft_init(void);
+
+// n complex points in place, bins in natural order. Q15: the forward
+// transform scales by 1/n (a shift a stage), so it can't overflow; the
+// inverse doesn't, and saturates. Float: the inverse scales by 1/n.
+XStatus fft_q15(fft_cpx_q15_t *x, unsigned int n, unsigned int flags);
+XStatus fft_float(fft_cpx_t *x, unsigned int n, unsigned int flags);
+
+// n real points in place, through an n/2-point complex transform. x holds
+// n + 2 values: n samples in, bins 0 to n/2 out (re, im pairs; the imaginary
+// parts of bins 0 and n/2 are 0), or the other way round for FFT_INVERSE.
+// Scaled as the complex transforms are.
+XStatus fft_real_q15(s16 *x, unsigned int n, unsigned int flags);
+XStatus fft_real_float(float *x, unsigned int n, unsigned int flags);
+
+#endif
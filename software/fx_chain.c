@@ -0,0 +1,335 @@
+/* fx_chain - effect chain runner for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Runs blocks of samples through an ordered list of Sound Tools effects,
+ * the way sox drives its effects: every stage has one output buffer
+ * (effp->obuf, with odone of its olen samples taken by the next stage) and
+ * its flow() is called whenever its output is empty and there is input
+ * for it. flow() may take less than it was offered or give back less than
+ * there is room for; the runner keeps calling round the stages until the
+ * input block has gone all the way through to the sink, so effects that
+ * buffer or change the rate fit in as well as the sample-by-sample ones.
+ * drain() works the same way at the end of the input, one stage at a time.
+ *
+ * The buffers are carved out of a pool the caller hands in once; nothing is
+ * allocated. fx_chain_start() points each stage's obuf at its part of the
+ * pool, so chains that share stages or a pool each take them over in turn.
+ * A stage whose handler has ST_EFF_INPLACE gets no buffer of its own: it
+ * flows over its input where it lies and the next stage reads it from
+ * there. A chain of in-place effects then runs every block through the one
+ * input buffer, with no copies between the stages and a pool of a single
+ * block. A stage may only overwrite a buffer once every stage sharing it
+ * has passed its samples on.
+ *
+ * The source and sink are callbacks, so the same chain runs from the
+ * InputBuffer to the DelayBuffer on the board (audio_fx.c) and from file to
+ * file on the host. Adding an effect means writing its st_effect_t handler
+ * (see handlers.c) and putting it in a chain, not another branch in the
+ * per-sample loop.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include "xil_types.h"
+#include "xstatus.h"
+#include "st_i.h"
+
+#include "delay_line.h"
+#include "fx_chain.h"
+
+/****************************************************************************/
+/***************************** LOCAL FUNCTIONS ******************************/
+/****************************************************************************/
+
+// true while stage i, or an in-place stage after it sharing its buffer,
+// still holds samples the stage after it has not taken
+
+static int fx_chain_busy(fx_chain_t *chain, unsigned int i) {
+
+    do {
+
+        if (chain->stage[i]->odone < chain->stage[i]->olen) {
+            return 1;
+        }
+
+        i++;
+
+    } while ((i < chain->num_stages) && (chain->inplace & (1u << i)));
+
+    return 0;
+}
+
+// move everything waiting at the input of stage first on to the sink
+
+static XStatus fx_chain_push(fx_chain_t *chain, unsigned int first) {
+
+    unsigned int i, last = chain->num_stages;
+    st_sample_t  *ibuf, *obuf;
+    st_size_t    *idone, *ilen, *odone, *olen;
+    st_size_t    isamp, osamp;
+    int          progress;
+    eff_t        e;
+
+    do {
+
+        progress = 0;
+
+        for (i = first; i < last; i++) {
+
+            e = chain->stage[i];
+
+            // the input of stage i is the output of stage i - 1
+
+            ibuf  = (i == 0) ? chain->ibuf   : chain->stage[i - 1]->obuf;
+            idone = (i == 0) ? &chain->idone : &chain->stage[i - 1]->odone;
+            ilen  = (i == 0) ? &chain->ilen  : &chain->stage[i - 1]->olen;
+
+            if ((*idone >= *ilen) || fx_chain_busy(chain, i)) {
+                continue;
+            }
+
+            isamp = *ilen - *idone;
+
+            if (chain->inplace & (1u << i)) {
+
+                // over the input where it lies, no more out than in
+
+                osamp = isamp;
+
+                if (e->h->flow(e, ibuf + *idone, ibuf + *idone, &isamp, &osamp) != ST_SUCCESS) {
+                    return XST_FAILURE;
+                }
+
+                e->odone = *idone;
+                e->olen  = *idone + osamp;
+            }
+
+            else {
+
+                osamp = chain->block;
+
+                if (e->h->flow(e, ibuf + *idone, e->obuf, &isamp, &osamp) != ST_SUCCESS) {
+                    return XST_FAILURE;
+                }
+
+                e->odone = 0;
+                e->olen  = osamp;
+            }
+
+            *idone += isamp;
+
+            progress |= ((isamp | osamp) != 0);
+        }
+
+        // the sink takes whatever the last stage gave
+
+        obuf  = (last == 0) ? chain->ibuf   : chain->stage[last - 1]->obuf;
+        odone = (last == 0) ? &chain->idone : &chain->stage[last - 1]->odone;
+        olen  = (last == 0) ? &chain->ilen  : &chain->stage[last - 1]->olen;
+
+        if (*odone < *olen) {
+
+            chain->write(chain->io, obuf + *odone, *olen - *odone);
+            *odone = *olen;
+            progress = 1;
+        }
+
+    } while (progress);
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/***************************** FX CHAIN INIT ********************************/
+/****************************************************************************/
+
+XStatus fx_chain_init(fx_chain_t *chain, eff_t *stages, unsigned int num_stages,
+                      st_sample_t *pool, st_size_t pool_len, st_size_t block) {
+
+    unsigned int i, inplace = 0, num_buffers = 1;
+
+    if ((num_stages > FX_CHAIN_MAX_STAGES) || (pool == NULL) || (block == 0)) {
+        return XST_INVALID_PARAM;
+    }
+
+    for (i = 0; i < num_stages; i++) {
+
+        if ((stages[i] == NULL) || (stages[i]->h == NULL) || (stages[i]->h->flow == NULL)) {
+            return XST_INVALID_PARAM;
+        }
+
+        // the buffer layout is fixed here, from the handlers' flags
+
+        if (stages[i]->h->flags & ST_EFF_INPLACE) {
+            inplace |= (1u << i);
+        }
+
+        else {
+            num_buffers++;
+        }
+
+        chain->stage[i] = stages[i];
+    }
+
+    if (pool_len < num_buffers * block) {
+        return XST_INVALID_PARAM;
+    }
+
+    chain->num_stages  = num_stages;
+    chain->inplace     = inplace;
+    chain->num_buffers = num_buffers;
+    chain->block       = block;
+    chain->pool        = pool;
+    chain->ibuf        = pool;
+    chain->idone       = 0;
+    chain->ilen        = 0;
+    chain->read        = NULL;
+    chain->write       = NULL;
+    chain->io          = NULL;
+
+    return XST_SUCCESS;
+}
+
+void fx_chain_set_io(fx_chain_t *chain, fx_read_t read, fx_write_t write, void *io) {
+
+    chain->read  = read;
+    chain->write = write;
+    chain->io    = io;
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** FX CHAIN START *******************************/
+/****************************************************************************/
+
+XStatus fx_chain_start(fx_chain_t *chain) {
+
+    st_sample_t  *buf = chain->ibuf;
+    unsigned int i, next = 1;
+    eff_t        e;
+
+    chain->idone = 0;
+    chain->ilen  = 0;
+
+    for (i = 0; i < chain->num_stages; i++) {
+
+        e = chain->stage[i];
+
+        // in-place stages keep the buffer they read
+
+        if (!(chain->inplace & (1u << i))) {
+            buf = chain->pool + (next++) * chain->block;
+        }
+
+        e->obuf  = buf;
+        e->odone = 0;
+        e->olen  = 0;
+
+        if ((e->h->start != NULL) && (e->h->start(e) != ST_SUCCESS)) {
+            return XST_FAILURE;
+        }
+    }
+
+    return XST_SUCCESS;
+}
+
+XStatus fx_chain_stop(fx_chain_t *chain) {
+
+    XStatus      status = XST_SUCCESS;
+    unsigned int i;
+    eff_t        e;
+
+    for (i = 0; i < chain->num_stages; i++) {
+
+        e = chain->stage[i];
+
+        if ((e->h->stop != NULL) && (e->h->stop(e) != ST_SUCCESS)) {
+            status = XST_FAILURE;
+        }
+    }
+
+    return status;
+}
+
+/****************************************************************************/
+/***************************** FX CHAIN RUN *********************************/
+/****************************************************************************/
+
+st_size_t fx_chain_run(fx_chain_t *chain, st_size_t len) {
+
+    st_size_t done = 0, count;
+
+    // one block of input at a time, each pushed all the way through
+
+    while (done < len) {
+
+        count = chain->read(chain->io, chain->ibuf, MIN(len - done, chain->block));
+
+        if (count == 0) {
+            break;
+        }
+
+        chain->idone = 0;
+        chain->ilen  = count;
+
+        if (fx_chain_push(chain, 0) != XST_SUCCESS) {
+            break;
+        }
+
+        done += count;
+    }
+
+    return done;
+}
+
+/****************************************************************************/
+/***************************** FX CHAIN DRAIN *******************************/
+/****************************************************************************/
+
+XStatus fx_chain_drain(fx_chain_t *chain) {
+
+    unsigned int i;
+    st_size_t    osamp;
+    eff_t        e;
+
+    // each stage in turn empties its tail into the stages after it
+
+    for (i = 0; i < chain->num_stages; i++) {
+
+        e = chain->stage[i];
+
+        if (e->h->drain == NULL) {
+            continue;
+        }
+
+        do {
+
+            osamp = chain->block;
+
+            if (e->h->drain(e, e->obuf, &osamp) != ST_SUCCESS) {
+                return XST_FAILURE;
+            }
+
+            e->odone = 0;
+            e->olen  = osamp;
+
+            if (fx_chain_push(chain, i + 1) != XST_SUCCESS) {
+                return XST_FAILURE;
+            }
+
+        } while (osamp > 0);
+    }
+
+    return XST_SUCCESS;
+}
@@ -0,0 +1,108 @@
+/* fx_chain.h - effect chain runner for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Constants, structures and prototypes for the effect chain runner
+ * (see fx_chain.c): an ordered list of Sound Tools effects (st_effect_t
+ * handlers, st.h) between a sample source and a sample sink.
+*/
+
+#ifndef FX_CHAIN_H
+#define FX_CHAIN_H
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "st.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Stages a chain can have: the longest board chain (chorus, echo and the
+// limiter) with a resampler either side on the host (fx_render)
+
+#define FX_CHAIN_MAX_STAGES     5
+
+// Samples of buffer pool a chain with n stages that do not work in place
+// (ST_EFF_INPLACE, st.h) needs for block-sample buffers: the chain input
+// plus one output per such stage. In-place stages write over their input
+// and need none. Chains that never run at the same time can share one pool.
+
+#define FX_CHAIN_POOL(n, block) ( ((n) + 1) * (block) )
+
+/****************************************************************************/
+/***************** Macros (Inline Functions) Definitions ********************/
+/****************************************************************************/
+
+// Buffer lines are 16-bit PCM, the effects work on 32-bit st_sample_t
+// with the PCM in the upper half
+
+#define FX_LINE_TO_SAMPLE(x)    ( ST_SIGNED_WORD_TO_SAMPLE((s16) (x)) )
+#define FX_SAMPLE_TO_LINE(x)    ( (unsigned int) (u16) ST_SAMPLE_TO_SIGNED_WORD(x) )
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+// Where the chain gets its input and puts its output, e.g. the InputBuffer
+// and DelayBuffer on the board or files on the host. The source returns
+// the samples it read, 0 at the end of the input.
+
+typedef st_size_t (*fx_read_t)(void *io, st_sample_t *buf, st_size_t len);
+typedef void      (*fx_write_t)(void *io, const st_sample_t *buf, st_size_t len);
+
+typedef struct fx_chain {
+
+    unsigned int    num_stages;
+    eff_t           stage[FX_CHAIN_MAX_STAGES];
+    st_size_t       block;              // samples per buffer
+
+    // chain input, then each stage's output in stage[i]->obuf; a stage
+    // with its bit set in inplace shares the buffer it reads
+
+    st_sample_t     *pool;
+    unsigned int    inplace;
+    unsigned int    num_buffers;
+    st_sample_t     *ibuf;
+    st_size_t       idone, ilen;
+
+    fx_read_t       read;
+    fx_write_t      write;
+    void            *io;
+
+} fx_chain_t;
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+// stages in order, each with its handler in h; pool holds pool_len
+// samples, at least FX_CHAIN_POOL(stages not in place, block)
+XStatus   fx_chain_init(fx_chain_t *chain, eff_t *stages, unsigned int num_stages,
+                        st_sample_t *pool, st_size_t pool_len, st_size_t block);
+
+void      fx_chain_set_io(fx_chain_t *chain, fx_read_t read, fx_write_t write, void *io);
+
+// start / stop every stage; a chain is started before it runs, and stopped
+// before another chain sharing its stages or pool takes over
+XStatus   fx_chain_start(fx_chain_t *chain);
+XStatus   fx_chain_stop(fx_chain_t *chain);
+
+// take up to len samples from the source through to the sink, returns the
+// samples read
+st_size_t fx_chain_run(fx_chain_t *chain, st_size_t len);
+
+// at the end of the input: play out what each stage still holds
+XStatus   fx_chain_drain(fx_chain_t *chain);
+
+#endif
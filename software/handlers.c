@@ -0,0 +1,137 @@
+/*
+ * Originally created: July 5, 1991
+ * Copyright 1991 Lance Norskog And Sundry Contributors
+ * This source code is freely redistributable and may be used for
+ * any purpose.  This copyright notice must be maintained.
+ * Lance Norskog And Sundry Contributors are not responsible for
+ * the consequences of using this software.
+ */
+
+/*
+ * Sound Tools format and effect handler tables.
+ *
+ * Only the formats and effects this project carries are listed. Below,
+ * st_gettype() finds a format here by its file type and st_geteffect() an
+ * effect by name, for fx_chain.c to run. Effects whose
+ * parameters come from the application rather than a command line have no
+ * getopts. Effects that can flow with obuf == ibuf say so with
+ * ST_EFF_INPLACE, and the chain runner then gives them no buffer of their
+ * own.
+ */
+
+#include <string.h>
+#include "st_i.h"
+
+static char *rawnames[] = {
+    "raw",
+    (char *) 0
+};
+
+static char *wavnames[] = {
+    "wav",
+    (char *) 0
+};
+
+st_format_t st_formats[] = {
+
+    {rawnames, ST_FILE_STEREO | ST_FILE_SEEK,
+     st_rawstartread, st_rawread, st_rawstopread,
+     st_rawstartwrite, st_rawwrite, st_rawstopwrite, st_rawseek},
+
+    {wavnames, ST_FILE_STEREO | ST_FILE_SEEK,
+     st_wavstartread, st_wavread, st_format_nothing,
+     st_wavstartwrite, st_wavwrite, st_wavstopwrite, st_wavseek},
+
+    {0, 0, 0, 0, 0, 0, 0, 0, 0}
+};
+
+st_effect_t st_effects[] = {
+
+    {"chorus", ST_EFF_INPLACE,
+     NULL, st_chorus_start, st_chorus_flow, st_chorus_drain, st_chorus_stop},
+
+    {"compand", ST_EFF_INPLACE,
+     st_compand_getopts, st_compand_start, st_compand_flow, st_compand_drain, st_compand_stop},
+
+    {"band", ST_EFF_INPLACE,
+     st_band_getopts, st_band_start, st_band_flow, st_band_drain, st_band_stop},
+
+    {"echo", ST_EFF_INPLACE,
+     NULL, st_echo_start, st_echo_flow, st_echo_drain, st_echo_stop},
+
+    {"filter", ST_EFF_INPLACE,
+     st_filter_getopts, st_filter_start, st_filter_flow, st_filter_drain, st_filter_stop},
+
+    {"highp", ST_EFF_INPLACE,
+     st_highp_getopts, st_highp_start, st_highp_flow, st_highp_drain, st_highp_stop},
+
+    {"lowp", ST_EFF_INPLACE,
+     st_lowp_getopts, st_lowp_start, st_lowp_flow, st_lowp_drain, st_lowp_stop},
+
+    {"pitch", ST_EFF_INPLACE,
+     st_pitch_getopts, st_pitch_start, st_pitch_flow, st_pitch_drain, st_pitch_stop},
+
+    {"rate", ST_EFF_RATE,
+     st_rate_getopts, st_rate_start, st_rate_flow, st_rate_drain, st_rate_stop},
+
+    {"resample", ST_EFF_RATE,
+     st_resample_getopts, st_resample_start, st_resample_flow, st_resample_drain, st_resample_stop},
+
+    {"reverb", ST_EFF_INPLACE,
+     st_reverb_getopts, st_reverb_start, st_reverb_flow, st_reverb_drain, st_reverb_stop},
+
+    {"stretch", 0,
+     st_stretch_getopts, st_stretch_start, st_stretch_flow, st_stretch_drain, st_stretch_stop},
+
+    {0, 0, 0, 0, 0, 0, 0}
+};
+
+/*
+ * Look up an effect by name in st_effects[] and attach its handler to effp.
+ */
+int st_geteffect(eff_t effp, char *effect_name)
+{
+    int i;
+
+    for (i = 0; st_effects[i].name; i++) {
+        if (!strcmp(st_effects[i].name, effect_name)) {
+            effp->name = st_effects[i].name;
+            effp->h = &st_effects[i];
+            return ST_SUCCESS;
+        }
+    }
+
+    return ST_EOF;
+}
+
+/*
+ * Check that we have a known format suffix string and attach its handler
+ * from st_formats[] to ft.
+ */
+int st_gettype(ft_t formp)
+{
+    char **list;
+    int i;
+
+    if (!formp->filetype)
+    {
+        st_fail_errno(formp, ST_EFMT, "must give file type for %s file", formp->filename);
+        return (ST_EFMT);
+    }
+
+    for (i = 0; st_formats[i].names; i++)
+    {
+        for (list = st_formats[i].names; *list; list++)
+        {
+            if (!strcasecmp(*list, formp->filetype))
+            {
+                formp->h = &st_formats[i];
+                return ST_SUCCESS;
+            }
+        }
+    }
+
+    st_fail_errno(formp, ST_EFMT, "file type '%s' of %s file is not known", formp->filetype,
+                  formp->filename);
+    return ST_EFMT;
+}
@@ -0,0 +1,220 @@
+/*
+ * July 5, 1991
+ * Copyright 1991 Lance Norskog And Sundry Contributors
+ * This source code is freely redistributable and may be used for
+ * any purpose.  This copyright notice must be maintained.
+ * Lance Norskog And Sundry Contributors are not responsible for
+ * the consequences of using this software.
+ */
+
+/*
+ * Sound Tools miscellaneous stuff.
+ *
+ * Only the routines the effects and format handlers in this project use
+ * are carried over (see st_i.h for the declarations).
+ */
+
+#include <math.h>
+#include <string.h>
+#include <errno.h>
+#include "st_i.h"
+
+#ifndef M_PI
+#define M_PI    3.14159265358979323846
+#endif
+
+/* clip a sample to the 24-bit range the effects work in */
+st_sample_t st_clip24(st_sample_t l)
+{
+    if (l >= ((st_sample_t)1 << 23))
+        return ((st_sample_t)1 << 23) - 1;
+    else if (l <= -((st_sample_t)1 << 23))
+        return -((st_sample_t)1 << 23) + 1;
+    else
+        return l;
+}
+
+/* greatest common divisor by Euclid's algorithm */
+st_sample_t st_gcd(st_sample_t a, st_sample_t b)
+{
+    if (b == 0)
+        return a;
+    else
+        return st_gcd(b, a % b);
+}
+
+/* least common multiple; divide first so it overflows later */
+st_sample_t st_lcm(st_sample_t a, st_sample_t b)
+{
+    return a * (b / st_gcd(a, b));
+}
+
+/*
+ * Generate one period of a sine modulation table. Entries swing between
+ * max - depth and max, starting at the midpoint.
+ */
+void st_sine(int *buf, st_ssize_t len, int max, int depth)
+{
+    st_ssize_t i;
+    int offset;
+    double val;
+
+    offset = max - depth;
+    for (i = 0; i < len; i++) {
+        val = (1.0 + sin((double)i / (double)len * 2.0 * M_PI)) / 2.0;
+        buf[i] = offset + (int) (val * (double)depth + 0.5);
+    }
+}
+
+/*
+ * Generate one period of a triangle modulation table. Entries ramp from
+ * max - depth up to max and back down.
+ */
+void st_triangle(int *buf, st_ssize_t len, int max, int depth)
+{
+    st_ssize_t i;
+    int offset;
+    double val;
+
+    offset = max - depth;
+    for (i = 0; i < len / 2; i++) {
+        val = i * 2.0 / len;
+        buf[i] = offset + (int) (val * (double)depth + 0.5);
+    }
+    for (i = len / 2; i < len; i++) {
+        val = (len - i) * 2.0 / len;
+        buf[i] = offset + (int) (val * (double)depth + 0.5);
+    }
+}
+
+/* Read len items of size bytes each from the file. */
+st_ssize_t st_read(ft_t ft, void *buf, size_t size, st_ssize_t len)
+{
+    return fread(buf, size, len, ft->fp);
+}
+
+/* Write len items of size bytes each to the file. */
+st_ssize_t st_write(ft_t ft, void *buf, size_t size, st_ssize_t len)
+{
+    return fwrite(buf, size, len, ft->fp);
+}
+
+/* Read exactly len characters, and terminate them. */
+int st_reads(ft_t ft, char *c, st_ssize_t len)
+{
+    if (st_read(ft, c, 1, len) != len)
+    {
+        st_fail_errno(ft, errno, "readfail");
+        return (ST_EOF);
+    }
+    c[len] = 0;
+    return (ST_SUCCESS);
+}
+
+/* Write a string, without its terminator. */
+int st_writes(ft_t ft, char *c)
+{
+    if (st_write(ft, c, 1, strlen(c)) != (st_ssize_t) strlen(c))
+    {
+        st_fail_errno(ft, errno, "writefail");
+        return (ST_EOF);
+    }
+    return (ST_SUCCESS);
+}
+
+/* Read word. */
+int st_readw(ft_t ft, uint16_t *uw)
+{
+    if (st_read(ft, uw, 2, 1) != 1)
+    {
+        return (ST_EOF);
+    }
+    if (ft->swap)
+        *uw = st_swapw(*uw);
+    return ST_SUCCESS;
+}
+
+/* Write word. */
+int st_writew(ft_t ft, uint16_t uw)
+{
+    if (ft->swap)
+        uw = st_swapw(uw);
+    if (st_write(ft, &uw, 2, 1) != 1)
+    {
+        st_fail_errno(ft, errno, "writefail");
+        return (ST_EOF);
+    }
+    return ST_SUCCESS;
+}
+
+/* Read double word. */
+int st_readdw(ft_t ft, uint32_t *udw)
+{
+    if (st_read(ft, udw, 4, 1) != 1)
+    {
+        return (ST_EOF);
+    }
+    if (ft->swap)
+        *udw = st_swapdw(*udw);
+    return ST_SUCCESS;
+}
+
+/* Write double word. */
+int st_writedw(ft_t ft, uint32_t udw)
+{
+    if (ft->swap)
+        udw = st_swapdw(udw);
+    if (st_write(ft, &udw, 4, 1) != 1)
+    {
+        st_fail_errno(ft, errno, "writefail");
+        return (ST_EOF);
+    }
+    return ST_SUCCESS;
+}
+
+/* Seek in the file; only files opened on a seekable stream can. */
+int st_seek(ft_t ft, st_size_t offset, int whence)
+{
+    if (!ft->seekable)
+    {
+        st_fail_errno(ft, ST_EPERM, "file not seekable");
+        return (ST_EOF);
+    }
+    if (fseek(ft->fp, offset, whence) == -1)
+    {
+        st_fail_errno(ft, errno, strerror(errno));
+        return (ST_EOF);
+    }
+    return (ST_SUCCESS);
+}
+
+#ifndef HAVE_BYTESWAP_H
+/* Byte swappers, use libc optimized macro's if possible */
+uint16_t st_swapw(uint16_t uw)
+{
+    return ((uw >> 8) | (uw << 8)) & 0xffff;
+}
+
+uint32_t st_swapdw(uint32_t udw)
+{
+    return (udw >> 24) | ((udw >> 8) & 0xff00) | ((udw << 8) & 0xff0000L) | (udw << 24);
+}
+#endif
+
+int st_is_bigendian(void)
+{
+    int b;
+    char *p;
+
+    b = 1;
+    p = (char *) &b;
+    if (!*p)
+        return 1;
+    else
+        return 0;
+}
+
+int st_is_littleendian(void)
+{
+    return !st_is_bigendian();
+}
@@ -0,0 +1,340 @@
+/* peripherals - board peripherals for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Initialization and interrupt handlers for the board peripherals.
+ * 
+ * The handlers talk to the main loop through lock-free single-producer /
+ * single-consumer rings (spsc_ring.c) rather than bare globals, so nothing
+ * handed over can tear and neither side has to mask the interrupts.
+ * 
+ * The InputBuffer handler runs when AudioInput has filled one half of the
+ * ping-pong window (INPUT_HALF_LINES lines, see audio_fx.h). It clears the
+ * interrupt and queues the first line of that half on input_ring; the main
+ * loop sleeps until there is a half to pop and then processes it. A main
+ * loop held up for a while finds the halves it missed queued in order.
+ * 
+ * The button handler and switch handler read the GPIO and queue the new
+ * value as an event on event_ring. poll_events(), called from the main
+ * loop, applies the events to button_state and switch_state, which only
+ * the main loop writes. The main loop then writes these values to the LEDs.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include "stdbool.h"
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_types.h"
+#include "xil_printf.h"
+
+#include "xgpio.h"
+#include "xintc.h"
+
+#include "PMod544IOR2.h" 
+#include "ChorusBuffer.h"
+#include "DelayBuffer.h"
+#include "InputBuffer.h"
+#include "audio_fx.h"
+#include "peripherals.h"
+#include "profile.h"
+#include "spsc_ring.h"
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+XGpio       BTNInst;
+XGpio       SWInst;
+XGpio       LEDInst;
+
+XIntc       IntrptCtlrInst;
+
+spsc_ring_t event_ring;                 // button & switch events
+spsc_ring_t input_ring;                 // finished InputBuffer halves
+
+/****************************************************************************/
+/***************************** Global Variables *****************************/
+/****************************************************************************/
+
+unsigned int button_state;              // holds button values
+unsigned int switch_state;              // holds switch values
+
+static u32   event_storage[EVENT_RING_SIZE];
+static u32   input_storage[INPUT_RING_SIZE];
+
+volatile unsigned int event_drops;      // events lost to a full event_ring
+                  int rotcnt;           // holds rotary count
+
+/****************************************************************************/
+/************************** BUTTON HANDLER **********************************/
+/****************************************************************************/
+
+void button_handler(void) {
+
+    PROFILE_START(PROF_BUTTON_ISR);
+
+    u32 buttons;
+
+    // queue the new value for the main loop
+    buttons = XGpio_DiscreteRead(&BTNInst, GPIO_CHANNEL_1) & MSK_PBTNS_5BIT_INPUT;
+
+    if (!spsc_ring_push(&event_ring, EVENT_WORD(EVENT_BUTTON, buttons))) {
+        event_drops++;
+    }
+
+    // acknowledge & clear interrupt flag
+    XGpio_InterruptClear(&BTNInst, MSK_CLEAR_INTR_CH1);
+
+    PROFILE_STOP(PROF_BUTTON_ISR);
+
+    return;
+}
+
+/****************************************************************************/
+/************************** SWITCH HANDLER **********************************/
+/****************************************************************************/
+
+void switch_handler(void) {
+
+    PROFILE_START(PROF_SWITCH_ISR);
+
+    u32 switches;
+
+    // queue the new value for the main loop
+    switches = XGpio_DiscreteRead(&SWInst, GPIO_CHANNEL_1) & MSK_SW_16BIT_INPUT;
+
+    if (!spsc_ring_push(&event_ring, EVENT_WORD(EVENT_SWITCH, switches))) {
+        event_drops++;
+    }
+
+    // acknowledge & clear interrupt flag
+    XGpio_InterruptClear(&SWInst, MSK_CLEAR_INTR_CH1);
+
+    PROFILE_STOP(PROF_SWITCH_ISR);
+
+    return;
+}
+
+/****************************************************************************/
+/*************************** INPUT HANDLER **********************************/
+/****************************************************************************/
+
+void input_handler(void) {
+
+    PROFILE_START(PROF_INPUT_ISR);
+
+    u32 start;
+
+    // acknowledge & clear the interrupt, then queue the half AudioInput
+    // just finished; a full ring drops it, which process_half() then
+    // counts as an overrun
+    InputBuffer_AckInterrupts();
+    start = INPUT_HALF_START(InputBuffer_GetWritePointer());
+
+    spsc_ring_push(&input_ring, start);
+
+    PROFILE_STOP(PROF_INPUT_ISR);
+
+    return;
+}
+
+/****************************************************************************/
+/*************************** POLL EVENTS ************************************/
+/****************************************************************************/
+
+void poll_events(void) {
+
+    u32 event;
+
+    // apply the queued events in order; the last one of each kind wins
+
+    while (spsc_ring_pop(&event_ring, &event)) {
+
+        switch (EVENT_SOURCE(event)) {
+
+            case EVENT_BUTTON:  button_state = EVENT_VALUE(event);   break;
+            case EVENT_SWITCH:  switch_state = EVENT_VALUE(event);   break;
+            default:                                                 break;
+        }
+    }
+
+    return;
+}
+
+/****************************************************************************/
+/************************* INIT PERIPHERALS *********************************/
+/****************************************************************************/
+
+XStatus init_peripherals(void) {
+
+    int status = 0x00;
+
+    // the rings the handlers hand over through, empty before any interrupt
+
+    spsc_ring_init(&event_ring, event_storage, EVENT_RING_SIZE);
+    spsc_ring_init(&input_ring, input_storage, INPUT_RING_SIZE);
+
+    // initialize the button GPIO instance
+
+    status = XGpio_Initialize(&BTNInst, BTN_GPIO_DEVICE_ID);
+
+    if (status != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+
+    // make sure button interrupts are enabled
+    
+    XGpio_InterruptGlobalEnable(&BTNInst);
+    XGpio_InterruptEnable(&BTNInst, MSK_ENABLE_INTR_CH1);
+
+    XGpio_SetDataDirection(&BTNInst, GPIO_CHANNEL_1, MSK_PBTNS_5BIT_INPUT);
+
+    // initialize the switches GPIO instance
+
+    status = XGpio_Initialize(&SWInst, SW_GPIO_DEVICE_ID);
+
+    if (status != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+
+    // make sure switch interrupts are enabled
+
+    XGpio_InterruptGlobalEnable(&SWInst);
+    XGpio_InterruptEnable(&SWInst, MSK_ENABLE_INTR_CH1);
+
+    XGpio_SetDataDirection(&SWInst, GPIO_CHANNEL_1, MSK_SW_16BIT_INPUT);
+
+    // initialize the LEDs GPIO instance
+
+    status = XGpio_Initialize(&LEDInst, LED_GPIO_DEVICE_ID);
+
+    if (status != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+
+    XGpio_SetDataDirection(&LEDInst, GPIO_CHANNEL_1, MSK_LED_16BIT_OUTPUT);
+
+    // initialize the PMod544IO
+    // rotary encoder is set to increment from 0 by 1% 
+
+    status = PMDIO_initialize(PMD544IO_BASEADDR);
+
+    if (status != XST_SUCCESS) {
+        print("INIT_PERIPH: Failed to initialize PMOD544!\r\n");
+        return XST_FAILURE;
+    }
+
+    PMDIO_ROT_init(1, true);
+    PMDIO_ROT_clear();
+
+    // initialize the ChorusBuffer
+
+    status = ChorusBuffer_initialize(CHORUSBUFFER_BASEADDR);
+
+    if (status != XST_SUCCESS) {
+        print("INIT_PERIPH: Failed to initialize ChorusBuffer!\r\n");
+        return XST_FAILURE;
+    }
+
+    // initialize the DelayBuffer
+
+    status = DelayBuffer_initialize(DELAYBUFFER_BASEADDR);
+
+    if (status != XST_SUCCESS) {
+        print("INIT_PERIPH: Failed to initialize DelayBuffer!\r\n");
+        return XST_FAILURE;
+    }
+    // initialize the InputBuffer
+
+    status = InputBuffer_initialize(INPUTBUFFER_BASEADDR);
+
+    if (status != XST_SUCCESS) {
+        print("INIT_PERIPH: Failed to initialize InputBuffer!\r\n");
+        return XST_FAILURE;
+    }
+
+#ifdef PROFILE_ENABLE
+
+    // start the AXI timer for the cycle profiling (see profile.c)
+
+    status = profile_init();
+
+    if (status != XST_SUCCESS) {
+        print("INIT_PERIPH: Failed to initialize the profiling timer!\r\n");
+        return XST_FAILURE;
+    }
+
+#endif
+
+    // initialize the interrupt controller
+
+    status = XIntc_Initialize(&IntrptCtlrInst,INTC_DEVICE_ID);
+    
+    if (status != XST_SUCCESS) {
+        print("INIT_PERIPH: Failed to initialize interrupt controller!\r\n");
+        return XST_FAILURE;
+    }
+
+    // connect the button handler to the interrupt
+    
+    status = XIntc_Connect(&IntrptCtlrInst, BTN_INTERRUPT_ID, (XInterruptHandler)button_handler, (void *)0);
+
+    if (status != XST_SUCCESS) {
+        print("INIT_PERIPH: Failed to connect button handler as interrupt!\r\n");
+        return XST_FAILURE;
+    }
+ 
+    // connect the switch handler to the interrupt
+    
+    status = XIntc_Connect(&IntrptCtlrInst, SW_INTERRUPT_ID, (XInterruptHandler)switch_handler, (void *)0);
+
+    if (status != XST_SUCCESS) {
+        print("INIT_PERIPH: Failed to connect switch handler as interrupt!\r\n");
+        return XST_FAILURE;
+    }
+
+    // connect the InputBuffer handler to the interrupt
+    
+    status = XIntc_Connect(&IntrptCtlrInst, INPUT_INTERRUPT_ID, (XInterruptHandler)input_handler, (void *)0);
+
+    if (status != XST_SUCCESS) {
+        print("INIT_PERIPH: Failed to connect InputBuffer handler as interrupt!\r\n");
+        return XST_FAILURE;
+    }
+
+    // start the interrupt controller such that interrupts are enabled for
+    // all devices that cause interrupts, specifically real mode so that
+    // the they can cause interrupts thru the interrupt controller.
+
+    status = XIntc_Start(&IntrptCtlrInst, XIN_REAL_MODE);
+
+    if (status != XST_SUCCESS) {
+        print("INIT_PERIPH: Failed to start interrupt controller!\r\n");
+        return XST_FAILURE;
+    } 
+      
+    // enable the button, switch & InputBuffer interrupts; the InputBuffer
+    // raises one at the end of each half of the ping-pong window
+
+    XIntc_Enable(&IntrptCtlrInst, BTN_INTERRUPT_ID);
+    XIntc_Enable(&IntrptCtlrInst, SW_INTERRUPT_ID);
+    XIntc_Enable(&IntrptCtlrInst, INPUT_INTERRUPT_ID);
+
+    InputBuffer_SetInterrupts(INPUT_HALF_BITS, MSK_INTR_HALF_FULL | MSK_INTR_FULL);
+
+    // successfully initialized... time to return
+
+    return XST_SUCCESS;
+}
+
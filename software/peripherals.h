@@ -0,0 +1,136 @@
+/* peripherals.h - board peripherals for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Device IDs, bit masks and handler prototypes for the GPIO, interrupt
+ * controller, PMod544IO and the three audio buffers, and the rings the
+ * handlers feed (see peripherals.c).
+*/
+
+#ifndef PERIPHERALS_H
+#define PERIPHERALS_H
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_types.h"
+#include "xgpio.h"
+#include "xintc.h"
+#include "spsc_ring.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Device ID
+
+#define TIMER_DEVICE_ID             XPAR_TMRCTR_0_DEVICE_ID
+#define BTN_GPIO_DEVICE_ID          XPAR_BTN_5BIT_DEVICE_ID
+#define SW_GPIO_DEVICE_ID           XPAR_SW_16BIT_DEVICE_ID
+#define LED_GPIO_DEVICE_ID          XPAR_LED_16BIT_DEVICE_ID
+#define INTC_DEVICE_ID              XPAR_INTC_0_DEVICE_ID
+
+// Interrupt numbers
+
+#define INPUT_INTERRUPT_ID          XPAR_MICROBLAZE_0_AXI_INTC_INPUTBUFFER_0_INTERRUPT_INTR
+#define BTN_INTERRUPT_ID            XPAR_MICROBLAZE_0_AXI_INTC_BTN_5BIT_IP2INTC_IRPT_INTR
+#define SW_INTERRUPT_ID             XPAR_MICROBLAZE_0_AXI_INTC_SW_16BIT_IP2INTC_IRPT_INTR
+
+// Pmod544 addresses
+
+#define PMD544IO_DEVICE_ID          XPAR_PMOD544IOR2_0_DEVICE_ID
+#define PMD544IO_BASEADDR           XPAR_PMOD544IOR2_0_S00_AXI_BASEADDR
+#define PMD544IO_HIGHADDR           XPAR_PMOD544IOR2_0_S00_AXI_HIGHADDR
+
+// ChorusBuffer addresses
+
+#define CHORUSBUFFER_DEVICE_ID      XPAR_CHORUSBUFFER_0_DEVICE_ID
+#define CHORUSBUFFER_BASEADDR       XPAR_CHORUSBUFFER_0_S00_AXI_BASEADDR
+#define CHORUSBUFFER_HIGHADDR       XPAR_CHORUSBUFFER_0_S00_AXI_HIGHADDR
+
+// InputBuffer addresses
+
+#define INPUTBUFFER_DEVICE_ID       XPAR_INPUTBUFFER_0_DEVICE_ID
+#define INPUTBUFFER_BASEADDR        XPAR_INPUTBUFFER_0_S00_AXI_BASEADDR
+#define INPUTBUFFER_HIGHADDR        XPAR_INPUTBUFFER_0_S00_AXI_HIGHADDR
+
+// DelayBuffer addresses
+
+#define DELAYBUFFER_DEVICE_ID       XPAR_DELAYBUFFER_0_DEVICE_ID
+#define DELAYBUFFER_BASEADDR        XPAR_DELAYBUFFER_0_S00_AXI_BASEADDR
+#define DELAYBUFFER_HIGHADDR        XPAR_DELAYBUFFER_0_S00_AXI_HIGHADDR
+
+// Bit masks
+
+#define MSK_CLEAR_INTR_CH1          0x00000001
+#define MSK_ENABLE_INTR_CH1         0x00000001
+#define MSK_LED_16BIT_OUTPUT        0x0000
+#define MSK_SW_16BIT_INPUT          0xFFFF
+#define MSK_PBTNS_5BIT_INPUT        0x1F
+#define MSK_SW_FORCE_CRASH          0x00008000
+#define MSK_SW_LOWER_HALF           0x000080FF
+#define MSK_SW_REMOVE               0x00003E00
+#define MSK_PBTNS_REMOVE            0x0000C1FF
+#define MSK_PMOD_MIC_SS             0x00000001
+
+// Rings between the handlers and the main loop (powers of two). An event
+// is one word, source in the upper half and the GPIO value in the lower;
+// an input half is its first line. 16 halves cover a 128 ms stall.
+
+#define EVENT_RING_SIZE             16
+#define INPUT_RING_SIZE             16
+
+#define EVENT_BUTTON                1
+#define EVENT_SWITCH                2
+#define EVENT_SOURCE_SHIFT          16
+#define EVENT_VALUE_MASK            0xFFFF
+
+#define EVENT_WORD(source, value)   ( ((u32) (source) << EVENT_SOURCE_SHIFT) | ((value) & EVENT_VALUE_MASK) )
+#define EVENT_SOURCE(event)         ( (event) >> EVENT_SOURCE_SHIFT )
+#define EVENT_VALUE(event)          ( (event) & EVENT_VALUE_MASK )
+
+// Miscellaneous
+
+#define GPIO_CHANNEL_1              1
+#define CPU_CLOCK_FREQ_HZ           XPAR_CPU_CORE_CLOCK_FREQ_HZ
+#define TIMER_CLOCK_FREQ_HZ         XPAR_TMRCTR_0_CLOCK_FREQ_HZ
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+extern XGpio    BTNInst;
+extern XGpio    SWInst;
+extern XGpio    LEDInst;
+
+extern XIntc    IntrptCtlrInst;
+
+extern spsc_ring_t event_ring;                  // button & switch events
+extern spsc_ring_t input_ring;                  // finished InputBuffer halves
+
+extern unsigned int button_state;               // holds button values
+extern unsigned int switch_state;               // holds switch values
+
+extern volatile unsigned int event_drops;       // events lost to a full event_ring
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+void    button_handler(void);
+void    switch_handler(void);
+void    input_handler(void);
+void    poll_events(void);
+
+XStatus init_peripherals(void);
+
+#endif
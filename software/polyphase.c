@@ -0,0 +1,644 @@
+/* polyphase - polyphase FIR resampler for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Changes the sample rate by a rational ratio: the input is (notionally)
+ * upsampled by L = lcm / in_rate, low-pass filtered at the lower of the
+ * two Nyquist rates, and every M = lcm / out_rate-th sample kept, with
+ * lcm = st_lcm(in_rate, out_rate). Only the kept samples are worked out,
+ * each from one of the L phases of the filter, so an output costs one dot
+ * product of taps input samples, e.g. L = 441, M = 160 for 16 -> 44.1 kHz.
+ *
+ * The filter is a Kaiser-windowed sinc, designed per quality tier for its
+ * stop-band attenuation with the stop band starting at the lower Nyquist
+ * rate, so nothing above it folds back. Decimating takes proportionally
+ * more taps per phase, so the transition band stays the same width. The
+ * coefficients are 16-bit fixed point with as many fraction bits as the
+ * largest tap leaves (Q1.15 upsampling, up to 17 bits when decimating),
+ * each phase rounded to a DC gain of exactly 1.0, and the sums integer: on
+ * the host the inner loop is SSE2 (pmaddwd, eight taps an instruction) and
+ * gives the same result as the C loop, bit for bit. The 16-bit
+ * coefficients put a floor under the high tier where the filter has few
+ * phases.
+ *
+ * A table is built on the first use of a rate pair & tier and kept in a
+ * small cache, so starting the effect again or a second resampler on the
+ * same ratio costs nothing. A full cache frees its least recently used
+ * table to make room, never one a resampler still holds (from
+ * polyphase_init() to polyphase_release(), i.e. the effect's start to its
+ * stop). Tables are allocated (the board never uses one: it runs at one
+ * rate); a resampler itself is a fixed-size struct that fits an effect's
+ * private area.
+ *
+ * At the bottom are the Sound Tools rate and resample effects on top of it
+ * (st_rate_* and st_resample_* in st_i.h), taking the rates from the
+ * effect's ininfo and outinfo: rate is the low tier and resample takes
+ * sox's -qs, -q and -ql for low, medium (the default) and high.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "xil_types.h"
+#include "xstatus.h"
+#include "st_i.h"
+
+#include "delay_line.h"
+#include "polyphase.h"
+
+#if POLYPHASE_HAVE_SIMD
+#include <emmintrin.h>
+#endif
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#ifndef M_PI
+#define M_PI                3.14159265358979323846
+#endif
+
+#define KAISER_EPSILON      1e-12
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct polyphase_tier {
+
+    unsigned int    taps;               // per phase, up to 1:1
+    double          atten_db;           // stop band
+
+} polyphase_tier_t;
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static const polyphase_tier_t tiers[POLYPHASE_NUM_TIERS] = {
+
+    { 16, 50.0 },
+    { 32, 70.0 },
+    { 64, 90.0 }
+};
+
+static polyphase_table_t cache[POLYPHASE_CACHE_SIZE];
+static u32               cache_clock;
+
+/****************************************************************************/
+/***************************** LOCAL FUNCTIONS ******************************/
+/****************************************************************************/
+
+// zeroth-order modified Bessel function, for the Kaiser window
+
+static double bessel_i0(double x) {
+
+    double sum = 1.0, term = 1.0, k;
+
+    for (k = 1.0; term > KAISER_EPSILON * sum; k += 1.0) {
+
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum  += term;
+    }
+
+    return sum;
+}
+
+// Kaiser's beta for a stop-band attenuation
+
+static double kaiser_beta(double atten_db) {
+
+    if (atten_db > 50.0) {
+        return 0.1102 * (atten_db - 8.7);
+    }
+
+    return 0.5842 * pow(atten_db - 21.0, 0.4) + 0.07886 * (atten_db - 21.0);
+}
+
+// the prototype filter: a Kaiser-windowed sinc with its stop band from the
+// lower Nyquist rate up, Kaiser's transition width for its length (in
+// cycles per upsampled sample), and a gain of L for the zeros put in
+
+typedef struct prototype {
+
+    double          cutoff;
+    double          centre;
+    double          beta;
+    double          i0_beta;
+    double          gain;
+
+} prototype_t;
+
+static void prototype_init(prototype_t *f, const polyphase_table_t *t) {
+
+    unsigned int    length = t->up * t->taps;
+    double          atten = tiers[t->tier].atten_db;
+    double          width = (atten - 8.0) / (2.285 * 2.0 * M_PI * (length - 1));
+
+    f->cutoff  = 0.5 / MAX(t->up, t->down) - width / 2.0;
+    f->centre  = (length - 1) / 2.0;
+    f->beta    = kaiser_beta(atten);
+    f->i0_beta = bessel_i0(f->beta);
+    f->gain    = t->up;
+
+    return;
+}
+
+// tap j of phase p's row: row[j] takes the input sample taps - 1 - j back
+
+static double prototype_tap(const prototype_t *f, const polyphase_table_t *t, unsigned int p, unsigned int j) {
+
+    double x = (p + (t->taps - 1 - j) * t->up) - f->centre;
+    double r = x / f->centre;
+    double h;
+
+    h  = 2.0 * f->cutoff;
+    h *= (x == 0.0) ? 1.0 : sin(2.0 * M_PI * f->cutoff * x) / (2.0 * M_PI * f->cutoff * x);
+    h *= bessel_i0(f->beta * sqrt(MAX(0.0, 1.0 - r * r))) / f->i0_beta;
+
+    return h * f->gain;
+}
+
+// design the prototype filter and split it into the table's phases
+
+static XStatus build_table(polyphase_table_t *t) {
+
+    unsigned int    p, j, best;
+    double          h, peak = 0.0, lane[POLYPHASE_LANES], worst = 0.0;
+    double          exact[POLYPHASE_MAX_TAPS];
+    s32             one, sum, step;
+    s16             *row;
+    prototype_t     f;
+
+    prototype_init(&f, t);
+
+    // the largest tap, and the largest sum of tap magnitudes going into one
+    // of the 32-bit lanes of the dot product (taps 2l and 2l + 1 of every 8)
+
+    for (p = 0; p < t->up; p++) {
+
+        memset(lane, 0, sizeof(lane));
+
+        for (j = 0; j < t->taps; j++) {
+
+            h    = fabs(prototype_tap(&f, t, p, j));
+            peak = MAX(peak, h);
+            lane[(j >> 1) % POLYPHASE_LANES] += h;
+        }
+
+        for (j = 0; j < POLYPHASE_LANES; j++) {
+            worst = MAX(worst, lane[j]);
+        }
+    }
+
+    // as many fraction bits as fit: the largest tap (plus the LSB the DC
+    // rounding below may add) in 16 bits, and a lane of full-scale input
+    // in 32
+
+    for (t->shift = POLYPHASE_MAX_SHIFT; t->shift > Q15_SHIFT / 2; t->shift--) {
+
+        one = 1 << t->shift;
+
+        if ((peak * one < PCM_MAX - 1) && (worst * one + t->taps < 2.0 * Q15_ONE)) {
+            break;
+        }
+    }
+
+    if (t->shift == Q15_SHIFT / 2) {
+        return XST_FAILURE;
+    }
+
+    t->coefs = malloc(t->up * t->taps * sizeof(s16));
+
+    if (t->coefs == NULL) {
+        return XST_FAILURE;
+    }
+
+    for (p = 0; p < t->up; p++) {
+
+        row = &t->coefs[p * t->taps];
+        sum = 0;
+
+        for (j = 0; j < t->taps; j++) {
+
+            exact[j] = prototype_tap(&f, t, p, j) * one;
+            row[j]   = (s16) lrint(MIN(MAX(exact[j], PCM_MIN), PCM_MAX));
+            sum     += row[j];
+        }
+
+        // each phase passes DC at exactly 1.0: the taps rounded furthest
+        // the other way take the difference, an LSB each
+
+        for (step = (sum < one) ? 1 : -1; sum != one; sum += step) {
+
+            for (best = 0, j = 1; j < t->taps; j++) {
+
+                if ((exact[j] - row[j]) * step > (exact[best] - row[best]) * step) {
+                    best = j;
+                }
+            }
+
+            row[best] += step;
+        }
+    }
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/***************************** TABLE CACHE **********************************/
+/****************************************************************************/
+
+const polyphase_table_t *polyphase_table(st_rate_t in_rate, st_rate_t out_rate, unsigned int tier) {
+
+    polyphase_table_t *t, *slot = NULL;
+    st_sample_t lcm;
+    unsigned int i, taps;
+
+    if ((in_rate == 0) || (out_rate == 0) || (tier >= POLYPHASE_NUM_TIERS) ||
+        (in_rate > POLYPHASE_MAX_RATIO * out_rate) || (out_rate > POLYPHASE_MAX_RATIO * in_rate)) {
+
+        return NULL;
+    }
+
+    cache_clock++;
+
+    for (i = 0; i < POLYPHASE_CACHE_SIZE; i++) {
+
+        t = &cache[i];
+
+        if ((t->coefs != NULL) && (t->in_rate == in_rate) && (t->out_rate == out_rate) && (t->tier == tier)) {
+
+            t->used = cache_clock;
+            return t;
+        }
+    }
+
+    // not cached: an empty slot, else the least recently used table no
+    // resampler holds (only that many resamplers at once can fill it)
+
+    for (i = 0; i < POLYPHASE_CACHE_SIZE; i++) {
+
+        t = &cache[i];
+
+        if (t->coefs == NULL) {
+
+            slot = t;
+            break;
+        }
+
+        if ((t->users == 0) && ((slot == NULL) || (cache_clock - t->used > cache_clock - slot->used))) {
+            slot = t;
+        }
+    }
+
+    if (slot == NULL) {
+        return NULL;
+    }
+
+    free(slot->coefs);
+    slot->coefs = NULL;
+
+    // L and M from the rate both divide into
+
+    lcm   = st_lcm((st_sample_t) in_rate, (st_sample_t) out_rate);
+    t     = slot;
+
+
+    t->in_rate  = in_rate;
+    t->out_rate = out_rate;
+    t->tier     = tier;
+    t->up       = (unsigned int) (lcm / (st_sample_t) in_rate);
+    t->down     = (unsigned int) (lcm / (st_sample_t) out_rate);
+
+    // decimating by M / L takes that many times the taps for the same
+    // filter, rounded up to the SIMD width
+
+    taps    = (tiers[tier].taps * MAX(t->up, t->down) + t->up - 1) / t->up;
+    t->taps = (taps + 7) & ~7u;
+
+    if ((t->taps > POLYPHASE_MAX_TAPS) || (t->up * t->taps > POLYPHASE_MAX_COEFS)) {
+        return NULL;
+    }
+
+    if (build_table(t) != XST_SUCCESS) {
+        return NULL;
+    }
+
+    t->users = 0;
+    t->used  = cache_clock;
+
+    return t;
+}
+
+void polyphase_flush_cache(void) {
+
+    unsigned int i;
+
+    for (i = 0; i < POLYPHASE_CACHE_SIZE; i++) {
+
+        free(cache[i].coefs);
+        cache[i].coefs = NULL;
+        cache[i].users = 0;
+    }
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** POLYPHASE INIT *******************************/
+/****************************************************************************/
+
+XStatus polyphase_init(polyphase_t *pp, st_rate_t in_rate, st_rate_t out_rate, unsigned int tier) {
+
+    polyphase_table_t *t = (polyphase_table_t *) polyphase_table(in_rate, out_rate, tier);
+    unsigned int delay;
+
+    if (t == NULL) {
+        return XST_INVALID_PARAM;
+    }
+
+    // silence before the first sample, so the first output has its taps,
+    // and the output clock started on by the filter's delay, so output 0
+    // lines up with input 0
+
+    delay = (t->up * t->taps - 1) / 2;
+
+    memset(pp->hist, 0, sizeof(pp->hist));
+
+    t->users++;
+
+    pp->table = t;
+    pp->phase = delay % t->up;
+    pp->fill  = t->taps - 1;
+    pp->base  = t->taps - 1 + delay / t->up;
+    pp->simd  = POLYPHASE_HAVE_SIMD;
+
+    return XST_SUCCESS;
+}
+
+void polyphase_release(polyphase_t *pp) {
+
+    polyphase_table_t *t = (polyphase_table_t *) pp->table;
+
+    // the cache may evict the table once no resampler holds it
+
+    if ((t != NULL) && (t->users > 0)) {
+        t->users--;
+    }
+
+    pp->table = NULL;
+
+    return;
+}
+
+st_size_t polyphase_delay(const polyphase_t *pp) {
+
+    const polyphase_table_t *t = pp->table;
+
+    return (t->up * t->taps - 1) / 2 / t->up + 1;
+}
+
+/****************************************************************************/
+/***************************** POLYPHASE DOT ********************************/
+/****************************************************************************/
+
+s64 polyphase_dot(const s16 *x, const s16 *h, unsigned int taps, unsigned int simd) {
+
+    s64 acc = 0;
+    unsigned int k;
+
+#if POLYPHASE_HAVE_SIMD
+
+    // eight 16 x 16 multiplies summed in pairs per pmaddwd into four lanes
+    // of 32-bit sums (which the table keeps from overflowing), the lanes
+    // then added in 64 bits; integer, so the order does not change the
+    // result
+
+    if (simd) {
+
+        __m128i sum = _mm_setzero_si128();
+        s32     lanes[POLYPHASE_LANES];
+
+        for (k = 0; k < taps; k += 8) {
+
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128((const __m128i *) (x + k)),
+                                                    _mm_loadu_si128((const __m128i *) (h + k))));
+        }
+
+        _mm_storeu_si128((__m128i *) lanes, sum);
+
+        return (s64) lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+
+#endif
+
+    for (k = 0; k < taps; k++) {
+        acc += (s32) x[k] * h[k];
+    }
+
+    return acc;
+}
+
+/****************************************************************************/
+/***************************** POLYPHASE FLOW *******************************/
+/****************************************************************************/
+
+void polyphase_flow(polyphase_t *pp, const st_sample_t *in, st_size_t *isamp,
+                    st_sample_t *out, st_size_t *osamp) {
+
+    const polyphase_table_t *t = pp->table;
+    st_size_t   taken = 0, made = 0, count, i, keep;
+    s64         acc;
+
+    while (made < *osamp) {
+
+        // the next output needs input up to hist[base]
+
+        if (pp->base >= pp->fill) {
+
+            if (taken == *isamp) {
+                break;
+            }
+
+            // full: move the taps still needed down to the start
+
+            if (pp->fill == POLYPHASE_HIST) {
+
+                keep = pp->base - (t->taps - 1);
+                keep = MIN(keep, pp->fill);
+
+                memmove(pp->hist, pp->hist + keep, (pp->fill - keep) * sizeof(s16));
+                pp->fill -= keep;
+                pp->base -= keep;
+            }
+
+            count = MIN(*isamp - taken, POLYPHASE_HIST - pp->fill);
+
+            for (i = 0; i < count; i++) {
+                pp->hist[pp->fill + i] = ST_SAMPLE_TO_SIGNED_WORD(in[taken + i]);
+            }
+
+            pp->fill += count;
+            taken    += count;
+            continue;
+        }
+
+        acc = polyphase_dot(&pp->hist[pp->base - (t->taps - 1)], &t->coefs[pp->phase * t->taps],
+                            t->taps, pp->simd);
+
+        // back to 16 bits, rounded and saturated
+
+        acc = (acc + ((s64) 1 << (t->shift - 1))) >> t->shift;
+        out[made++] = ST_SIGNED_WORD_TO_SAMPLE((s16) MIN(MAX(acc, PCM_MIN), PCM_MAX));
+
+        // on by M upsampled samples: the phase, and whole input samples
+
+        pp->phase += t->down;
+        pp->base  += pp->phase / t->up;
+        pp->phase %= t->up;
+    }
+
+    *isamp = taken;
+    *osamp = made;
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** ST HANDLERS **********************************/
+/****************************************************************************/
+
+// private data of the rate and resample effects, in effp->priv
+
+typedef struct resamplestuff {
+
+    polyphase_t     pp;
+    unsigned int    tier;
+    st_size_t       drain;              // silence still to feed in
+
+} *resample_t;
+
+int st_resample_getopts(eff_t effp, int argc, char **argv) {
+
+    resample_t r = (resample_t) effp->priv;
+
+    r->tier = POLYPHASE_MEDIUM;
+
+    if (argc == 0) {
+        return ST_SUCCESS;
+    }
+
+    if ((argc == 1) && !strcmp(argv[0], "-qs")) {
+        r->tier = POLYPHASE_LOW;
+    }
+
+    else if ((argc == 1) && !strcmp(argv[0], "-q")) {
+        r->tier = POLYPHASE_MEDIUM;
+    }
+
+    else if ((argc == 1) && !strcmp(argv[0], "-ql")) {
+        r->tier = POLYPHASE_HIGH;
+    }
+
+    else {
+        st_warn("Usage: resample [ -qs | -q | -ql ]");
+        return ST_EOF;
+    }
+
+    return ST_SUCCESS;
+}
+
+int st_resample_start(eff_t effp) {
+
+    resample_t r = (resample_t) effp->priv;
+
+    if (polyphase_init(&r->pp, effp->ininfo.rate, effp->outinfo.rate, r->tier) != XST_SUCCESS) {
+
+        st_warn("%s: can not convert %lu Hz to %lu Hz", effp->name,
+                (unsigned long) effp->ininfo.rate, (unsigned long) effp->outinfo.rate);
+        return ST_EOF;
+    }
+
+    r->drain = polyphase_delay(&r->pp);
+
+    return ST_SUCCESS;
+}
+
+int st_resample_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf,
+                     st_size_t *isamp, st_size_t *osamp) {
+
+    resample_t r = (resample_t) effp->priv;
+
+    polyphase_flow(&r->pp, ibuf, isamp, obuf, osamp);
+
+    return ST_SUCCESS;
+}
+
+int st_resample_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp) {
+
+    resample_t  r = (resample_t) effp->priv;
+    st_sample_t silence[POLYPHASE_MAX_TAPS] = { 0 };
+    st_size_t   isamp = r->drain;
+
+    // the filter's delay worth of silence in, the last of the input out
+
+    polyphase_flow(&r->pp, silence, &isamp, obuf, osamp);
+    r->drain -= isamp;
+
+    return ST_SUCCESS;
+}
+
+int st_resample_stop(eff_t effp) {
+
+    resample_t r = (resample_t) effp->priv;
+
+    polyphase_release(&r->pp);
+
+    return ST_SUCCESS;
+}
+
+int st_rate_getopts(eff_t effp, int argc, char **argv) {
+
+    resample_t r = (resample_t) effp->priv;
+
+    r->tier = POLYPHASE_LOW;
+
+    if (argc != 0) {
+        st_warn("Usage: rate");
+        return ST_EOF;
+    }
+
+    return ST_SUCCESS;
+}
+
+int st_rate_start(eff_t effp) {
+
+    return st_resample_start(effp);
+}
+
+int st_rate_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf,
+                 st_size_t *isamp, st_size_t *osamp) {
+
+    return st_resample_flow(effp, ibuf, obuf, isamp, osamp);
+}
+
+int st_rate_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp) {
+
+    return st_resample_drain(effp, obuf, osamp);
+}
+
+int st_rate_stop(eff_t effp) {
+
+    return st_resample_stop(effp);
+}
@@ -0,0 +1,130 @@
+/* polyphase.h - polyphase FIR resampler for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Constants, structures and prototypes for the polyphase resampler engine
+ * (see polyphase.c) behind the Sound Tools rate and resample effects.
+*/
+
+#ifndef POLYPHASE_H
+#define POLYPHASE_H
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "st.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Quality tiers: taps per phase at ratios up to 1 (more when decimating)
+// and the stop-band attenuation the filter is designed for
+
+#define POLYPHASE_LOW           0       // 16 taps, 50 dB
+#define POLYPHASE_MEDIUM        1       // 32 taps, 70 dB
+#define POLYPHASE_HIGH          2       // 64 taps, 90 dB
+#define POLYPHASE_NUM_TIERS     3
+
+// Largest in : out (or out : in) rate ratio, taps per phase at that ratio,
+// and the history kept per resampler (in samples): the taps of one output
+// plus room to take input in blocks
+
+#define POLYPHASE_MAX_RATIO     4
+#define POLYPHASE_MAX_TAPS      (64 * POLYPHASE_MAX_RATIO)
+#define POLYPHASE_HIST          (POLYPHASE_MAX_TAPS + 128)
+
+// Coefficients per table (phases x taps), tables kept at once, the most
+// fraction bits a coefficient gets and the 32-bit sums a dot product is
+// split over (as SSE2 does)
+
+#define POLYPHASE_MAX_COEFS     65536
+#define POLYPHASE_CACHE_SIZE    8
+#define POLYPHASE_MAX_SHIFT     20
+#define POLYPHASE_LANES         4
+
+// The inner loop is SSE2 on the host; the board and anything else run the
+// same sums in C
+
+#if defined(__SSE2__)
+#define POLYPHASE_HAVE_SIMD     1
+#else
+#define POLYPHASE_HAVE_SIMD     0
+#endif
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+// Coefficients for one rate pair & tier, built once and shared by every
+// resampler on that ratio. Phase p's row holds its taps last to first, so
+// it lines up with the history oldest to newest.
+
+typedef struct polyphase_table {
+
+    st_rate_t       in_rate;
+    st_rate_t       out_rate;
+    unsigned int    tier;
+
+    unsigned int    up;                 // L: phases, lcm / in_rate
+    unsigned int    down;               // M: phase step, lcm / out_rate
+    unsigned int    taps;               // per phase, a multiple of 8
+    unsigned int    shift;              // fraction bits of the coefficients
+    s16             *coefs;             // up rows of taps
+
+    unsigned int    users;              // resamplers holding it
+    u32             used;               // cache clock at its last lookup
+
+} polyphase_table_t;
+
+typedef struct polyphase {
+
+    const polyphase_table_t *table;
+
+    unsigned int    phase;              // of the next output
+    unsigned int    base;               // its newest input in hist
+    unsigned int    fill;               // samples in hist
+    unsigned int    simd;               // inner loop on SSE2 (host)
+
+    s16             hist[POLYPHASE_HIST];
+
+} polyphase_t;
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+// the table for a rate pair & tier, built on first use; when the cache is
+// full the least recently used table no resampler holds makes way for it
+const polyphase_table_t *polyphase_table(st_rate_t in_rate, st_rate_t out_rate, unsigned int tier);
+
+// drop every cached table; no resampler may be using one
+void      polyphase_flush_cache(void);
+
+// polyphase_init() holds its table until polyphase_release()
+XStatus   polyphase_init(polyphase_t *pp, st_rate_t in_rate, st_rate_t out_rate, unsigned int tier);
+void      polyphase_release(polyphase_t *pp);
+
+// take up to *isamp samples in and give up to *osamp out; both come back
+// as the counts done
+void      polyphase_flow(polyphase_t *pp, const st_sample_t *in, st_size_t *isamp,
+                         st_sample_t *out, st_size_t *osamp);
+
+// input samples of delay through the filter, i.e. the silence to feed in
+// at the end to get all of the input out (the output is not delayed)
+st_size_t polyphase_delay(const polyphase_t *pp);
+
+// one output before the shift: the dot product of taps history samples
+// and a row
+s64       polyphase_dot(const s16 *x, const s16 *h, unsigned int taps, unsigned int simd);
+
+#endif
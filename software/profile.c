@@ -0,0 +1,303 @@
+/* profile - cycle profiling for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Timer 0 of the AXI timer (TIMER_DEVICE_ID) free-runs as an up counter on
+ * the AXI clock, which is also the MicroBlaze clock, so the difference of
+ * two TCR reads is a cycle count. PROFILE_START() latches the count for one
+ * profiled point and PROFILE_STOP() folds the elapsed cycles into that
+ * point's count / min / max / sum and its log2 histogram, and pushes the raw
+ * value into a PROF_RING_SIZE ring of the most recent durations. Everything
+ * lives in static RAM; nothing is allocated.
+ *
+ * A timestamp is a single AXI read. The cost of an empty START / STOP pair
+ * is measured at init and sent with the dump, so it can be taken off the
+ * short ISR figures. A PROF_BLOCK figure includes any ISR that interrupted
+ * the block, which is what the headroom has to cover anyway.
+ *
+ * profile_dump() writes one binary frame straight to the UART with
+ * outbyte(). All multi-byte fields are little-endian:
+ *
+ *      "PRF1"                      magic
+ *      u8  version, points, bins, log2 of the half-buffer size
+ *      u32 timer clock in Hz
+ *      u32 sample rate in Hz
+ *      u16 block size in samples
+ *      u16 START / STOP overhead in cycles
+ *      per point:
+ *          u32 count, min, max
+ *          u32 sum (low), sum (high)
+ *          u32 bins[bins]
+ *      u16 ring entries, then that many u32, oldest first:
+ *          point in bits [31:28], cycles (saturated) in bits [27:0]
+ *      u16 Fletcher-16 of every byte after the magic
+ *
+ * host/prof_decode.c finds the frames in a capture of the serial port and
+ * prints the tables. The frame is about 1.1 KB, so at 115200 baud the dump
+ * stalls the main loop for about 100 ms; the halves that come in meanwhile
+ * wait on input_ring and process_half() resyncs the output afterwards.
+ *
+ * Without PROFILE_ENABLE this file compiles to nothing.
+*/
+
+#ifdef PROFILE_ENABLE
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <string.h>
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_types.h"
+#include "xil_printf.h"
+#include "xtmrctr.h"
+
+#include "audio_fx.h"
+#include "peripherals.h"
+#include "profile.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define PROFILE_TIMER               0
+#define PROF_RING_MASK              (PROF_RING_SIZE - 1)
+#define PROF_RING_CYCLES            0x0FFFFFFF
+#define PROF_RING_POINT_SHIFT       28
+#define PROF_CALIBRATE_PASSES       16
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct prof_hist {
+
+    u32 count;
+    u32 min;
+    u32 max;
+    u64 sum;
+    u32 bins[PROF_NUM_BINS];
+
+} prof_hist_t;
+
+/****************************************************************************/
+/***************************** Global Variables *****************************/
+/****************************************************************************/
+
+static XTmrCtr      ProfileTimerInst;
+static UINTPTR      timer_base;
+
+static u32          start_stamp[PROF_NUM_POINTS];
+static prof_hist_t  hist[PROF_NUM_POINTS];
+
+static u32          ring[PROF_RING_SIZE];
+static u32          ring_count;
+
+static u16          overhead;
+static u16          dump_sum1, dump_sum2;
+
+/****************************************************************************/
+/***************************** LOCAL FUNCTIONS ******************************/
+/****************************************************************************/
+
+static inline u32 profile_timestamp(void) {
+
+    return XTmrCtr_ReadReg(timer_base, PROFILE_TIMER, XTC_TCR_OFFSET);
+}
+
+static inline unsigned int profile_bin(u32 cycles) {
+
+    unsigned int bin = (cycles != 0) ? 31 - __builtin_clz(cycles) : 0;
+
+    return (bin < PROF_NUM_BINS) ? bin : PROF_NUM_BINS - 1;
+}
+
+// send one byte and fold it into the running Fletcher-16
+
+static void dump_u8(u8 data) {
+
+    outbyte((char) data);
+
+    dump_sum1 = (dump_sum1 + data) % 255;
+    dump_sum2 = (dump_sum2 + dump_sum1) % 255;
+}
+
+static void dump_u16(u16 data) {
+
+    dump_u8((u8) data);
+    dump_u8((u8) (data >> 8));
+}
+
+static void dump_u32(u32 data) {
+
+    dump_u16((u16) data);
+    dump_u16((u16) (data >> 16));
+}
+
+/****************************************************************************/
+/****************************** PROFILE INIT ********************************/
+/****************************************************************************/
+
+XStatus profile_init(void) {
+
+    unsigned int i;
+    u32 cycles;
+
+    if (XTmrCtr_Initialize(&ProfileTimerInst, TIMER_DEVICE_ID) != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+
+    // free-running up counter from 0, wrapping every 2^32 cycles
+
+    XTmrCtr_SetOptions(&ProfileTimerInst, PROFILE_TIMER, XTC_AUTO_RELOAD_OPTION);
+    XTmrCtr_SetResetValue(&ProfileTimerInst, PROFILE_TIMER, 0);
+    XTmrCtr_Start(&ProfileTimerInst, PROFILE_TIMER);
+
+    timer_base = ProfileTimerInst.BaseAddress;
+
+    // the cheapest empty START / STOP pair is the measurement overhead
+
+    overhead = 0xFFFF;
+
+    for (i = 0; i < PROF_CALIBRATE_PASSES; i++) {
+
+        start_stamp[PROF_BLOCK] = profile_timestamp();
+        cycles = profile_timestamp() - start_stamp[PROF_BLOCK];
+
+        if (cycles < overhead) {
+            overhead = (u16) cycles;
+        }
+    }
+
+    profile_reset();
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/****************************** PROFILE START *******************************/
+/****************************************************************************/
+
+void profile_start(unsigned int point) {
+
+    start_stamp[point] = profile_timestamp();
+}
+
+/****************************************************************************/
+/****************************** PROFILE STOP ********************************/
+/****************************************************************************/
+
+void profile_stop(unsigned int point) {
+
+    u32 cycles = profile_timestamp() - start_stamp[point];
+    prof_hist_t *h = &hist[point];
+    u32 slot;
+
+    h->count++;
+    h->sum += cycles;
+    h->bins[profile_bin(cycles)]++;
+
+    if (cycles < h->min) {
+        h->min = cycles;
+    }
+
+    if (cycles > h->max) {
+        h->max = cycles;
+    }
+
+    // the ring is shared with the ISRs; one landing between these two lines
+    // can at worst overwrite a single entry, which is fine for a trace
+
+    slot = ring_count++;
+    ring[slot & PROF_RING_MASK] = ((u32) point << PROF_RING_POINT_SHIFT) |
+        ((cycles < PROF_RING_CYCLES) ? cycles : PROF_RING_CYCLES);
+
+    return;
+}
+
+/****************************************************************************/
+/****************************** PROFILE RESET *******************************/
+/****************************************************************************/
+
+void profile_reset(void) {
+
+    unsigned int i;
+
+    memset(hist, 0, sizeof(hist));
+
+    for (i = 0; i < PROF_NUM_POINTS; i++) {
+        hist[i].min = 0xFFFFFFFF;
+    }
+
+    ring_count = 0;
+
+    return;
+}
+
+/****************************************************************************/
+/****************************** PROFILE DUMP ********************************/
+/****************************************************************************/
+
+void profile_dump(void) {
+
+    const char *magic = PROF_DUMP_MAGIC;
+    unsigned int i, j, entries;
+    u32 first;
+    u16 check;
+
+    for (i = 0; i < 4; i++) {
+        outbyte(magic[i]);
+    }
+
+    dump_sum1 = 0;
+    dump_sum2 = 0;
+
+    dump_u8(PROF_DUMP_VERSION);
+    dump_u8(PROF_NUM_POINTS);
+    dump_u8(PROF_NUM_BINS);
+    dump_u8(INPUT_HALF_BITS);
+
+    dump_u32(TIMER_CLOCK_FREQ_HZ);
+    dump_u32(SAMPLE_RATE);
+    dump_u16(BLOCK_SIZE);
+    dump_u16(overhead);
+
+    for (i = 0; i < PROF_NUM_POINTS; i++) {
+
+        dump_u32(hist[i].count);
+        dump_u32(hist[i].count ? hist[i].min : 0);
+        dump_u32(hist[i].max);
+        dump_u32((u32) hist[i].sum);
+        dump_u32((u32) (hist[i].sum >> 32));
+
+        for (j = 0; j < PROF_NUM_BINS; j++) {
+            dump_u32(hist[i].bins[j]);
+        }
+    }
+
+    // ring, oldest entry first
+
+    entries = (ring_count < PROF_RING_SIZE) ? ring_count : PROF_RING_SIZE;
+    first = ring_count - entries;
+
+    dump_u16((u16) entries);
+
+    for (i = 0; i < entries; i++) {
+        dump_u32(ring[(first + i) & PROF_RING_MASK]);
+    }
+
+    check = (u16) ((dump_sum2 << 8) | dump_sum1);
+    dump_u16(check);
+
+    return;
+}
+
+#endif
@@ -0,0 +1,85 @@
+/* profile.h - cycle profiling for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Timestamps the processing blocks and the interrupt handlers with the AXI
+ * timer (see profile.c). Build with PROFILE_ENABLE defined (add it to the
+ * compiler symbols in the SDK, or -DPROFILE_ENABLE on the host) to turn the
+ * profiling on. Without it every PROFILE_* macro expands to nothing and
+ * profile.c compiles to an empty file.
+*/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Profiled code, one histogram each
+
+#define PROF_BLOCK                  0   // process_block(): one BLOCK_SIZE block
+#define PROF_HALF                   1   // process_half(): one half of the ping-pong window
+#define PROF_BUTTON_ISR             2   // button_handler()
+#define PROF_SWITCH_ISR             3   // switch_handler()
+#define PROF_INPUT_ISR              4   // input_handler()
+#define PROF_NUM_POINTS             5
+
+// Histogram bin k counts durations of [2^k, 2^(k+1)) cycles, bin 0 also
+// counts 0; the last bin takes everything from 2^(PROF_NUM_BINS-1) up
+
+#define PROF_NUM_BINS               24
+
+// Most recent raw durations, oldest overwritten first (power of two)
+
+#define PROF_RING_SIZE              128
+
+// Dump format (all fields little-endian, see profile.c and host/prof_decode.c)
+
+#define PROF_DUMP_MAGIC             "PRF1"
+#define PROF_DUMP_VERSION           1
+
+/****************************************************************************/
+/***************************** Macro Definitions ****************************/
+/****************************************************************************/
+
+#ifdef PROFILE_ENABLE
+
+#define PROFILE_START(point)        profile_start(point)
+#define PROFILE_STOP(point)         profile_stop(point)
+
+#else
+
+#define PROFILE_START(point)
+#define PROFILE_STOP(point)
+
+#endif
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+#ifdef PROFILE_ENABLE
+
+XStatus profile_init(void);
+void    profile_start(unsigned int point);
+void    profile_stop(unsigned int point);
+void    profile_reset(void);
+void    profile_dump(void);
+
+#endif
+
+#endif
@@ -0,0 +1,165 @@
+/*
+ * July 5, 1991
+ * Copyright 1991 Lance Norskog And Sundry Contributors
+ * This source code is freely redistributable and may be used for
+ * any purpose.  This copyright notice must be maintained.
+ * Lance Norskog And Sundry Contributors are not responsible for
+ * the consequences of using this software.
+ */
+
+/*
+ * Sound Tools raw format file.
+ *
+ * Only the linear 8- and 16-bit encodings are carried over: 16-bit signed
+ * is what the board's buffers hold, and 8-bit unsigned is the other one
+ * WAV files use. The caller fills in ft->info (rate, size, encoding,
+ * channels) and ft->swap before starting; a size or encoding of 0 means
+ * 16-bit signed and 0 channels means mono. wav.c reads and writes its data
+ * through these routines too.
+ */
+
+#include <errno.h>
+#include "st_i.h"
+
+/* samples converted per st_read() / st_write() */
+#define RAW_CHUNK   (ST_BUFSIZ / ST_SIZE_WORD)
+
+typedef union {
+    uint8_t  bytes[ST_BUFSIZ];
+    uint16_t words[RAW_CHUNK];
+} rawbuf_t;
+
+static int rawcheck(ft_t ft)
+{
+    if (ft->info.size == 0)
+        ft->info.size = ST_SIZE_WORD;
+    if (ft->info.encoding == 0)
+        ft->info.encoding = ST_ENCODING_SIGN2;
+    if (ft->info.channels == 0)
+        ft->info.channels = 1;
+
+    if ((ft->info.size != ST_SIZE_BYTE && ft->info.size != ST_SIZE_WORD) ||
+        (ft->info.encoding != ST_ENCODING_SIGN2 && ft->info.encoding != ST_ENCODING_UNSIGNED))
+    {
+        st_fail_errno(ft, ST_EFMT, "only linear 8- and 16-bit data is supported");
+        return (ST_EOF);
+    }
+
+    return (ST_SUCCESS);
+}
+
+int st_rawseek(ft_t ft, st_size_t offset)
+{
+    return st_seek(ft, offset * ft->info.size, SEEK_SET);
+}
+
+int st_rawstartread(ft_t ft)
+{
+    return rawcheck(ft);
+}
+
+int st_rawstartwrite(ft_t ft)
+{
+    return rawcheck(ft);
+}
+
+/*
+ * Read up to nsamp samples, channels interleaved. Returns the samples
+ * read, 0 at the end of the file.
+ */
+st_ssize_t st_rawread(ft_t ft, st_sample_t *buf, st_ssize_t nsamp)
+{
+    rawbuf_t   raw;
+    st_ssize_t done = 0, chunk, count, i;
+    int        sign = (ft->info.encoding == ST_ENCODING_SIGN2);
+
+    while (done < nsamp)
+    {
+        chunk = nsamp - done;
+        if (chunk > RAW_CHUNK)
+            chunk = RAW_CHUNK;
+
+        count = st_read(ft, raw.bytes, ft->info.size, chunk);
+
+        if (ft->info.size == ST_SIZE_BYTE)
+        {
+            for (i = 0; i < count; i++)
+                buf[done + i] = sign ? ST_SIGNED_BYTE_TO_SAMPLE((int8_t) raw.bytes[i]) :
+                                       ST_UNSIGNED_BYTE_TO_SAMPLE(raw.bytes[i]);
+        }
+        else
+        {
+            for (i = 0; i < count; i++)
+            {
+                uint16_t uw = ft->swap ? st_swapw(raw.words[i]) : raw.words[i];
+
+                buf[done + i] = sign ? ST_SIGNED_WORD_TO_SAMPLE((int16_t) uw) :
+                                       ST_UNSIGNED_WORD_TO_SAMPLE(uw);
+            }
+        }
+
+        done += count;
+
+        if (count < chunk)
+            break;
+    }
+
+    return done;
+}
+
+int st_rawstopread(ft_t ft)
+{
+    return (ST_SUCCESS);
+}
+
+/*
+ * Write nsamp samples, channels interleaved. Samples are truncated to the
+ * file's size. Returns the samples written.
+ */
+st_ssize_t st_rawwrite(ft_t ft, st_sample_t *buf, st_ssize_t nsamp)
+{
+    rawbuf_t   raw;
+    st_ssize_t done = 0, chunk, count, i;
+    int        sign = (ft->info.encoding == ST_ENCODING_SIGN2);
+
+    while (done < nsamp)
+    {
+        chunk = nsamp - done;
+        if (chunk > RAW_CHUNK)
+            chunk = RAW_CHUNK;
+
+        if (ft->info.size == ST_SIZE_BYTE)
+        {
+            for (i = 0; i < chunk; i++)
+                raw.bytes[i] = sign ? (uint8_t) ST_SAMPLE_TO_SIGNED_BYTE(buf[done + i]) :
+                                      ST_SAMPLE_TO_UNSIGNED_BYTE(buf[done + i]);
+        }
+        else
+        {
+            for (i = 0; i < chunk; i++)
+            {
+                uint16_t uw = sign ? (uint16_t) ST_SAMPLE_TO_SIGNED_WORD(buf[done + i]) :
+                                     ST_SAMPLE_TO_UNSIGNED_WORD(buf[done + i]);
+
+                raw.words[i] = ft->swap ? st_swapw(uw) : uw;
+            }
+        }
+
+        count = st_write(ft, raw.bytes, ft->info.size, chunk);
+        done += count;
+
+        if (count < chunk)
+        {
+            st_fail_errno(ft, errno, "writefail");
+            break;
+        }
+    }
+
+    return done;
+}
+
+int st_rawstopwrite(ft_t ft)
+{
+    fflush(ft->fp);
+    return (ST_SUCCESS);
+}
@@ -0,0 +1,554 @@
+/* reverb - feedback delay network reverb for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * A reverb that fits the memory the MicroBlaze has left: eight delay lines
+ * of 16-bit samples fed back into each other through an 8x8 Householder
+ * matrix, H = I - (2/8) * ones. H is orthogonal, so the network loses no
+ * energy but what the per-line gains take out, and H * v costs one sum and
+ * a shift (v - sum(v) / 4) rather than 64 multiplies.
+ *
+ * The lines are laid out in a byte budget: eight prime lengths spaced
+ * evenly in octaves over a 2.5 : 1 range, as long as the budget allows.
+ * Every line is at least a chunk long, so a chunk is read out of every line,
+ * run through the network a sample at a time and written back in one
+ * streamed access per line, which also suits lines kept in the ChorusBuffer
+ * BRAM (ChorusBuffer_ReadBlock / ChorusBuffer_WriteStream) rather than RAM.
+ *
+ * Each line's gain, 10^(-3 * length / (T60 * rate)), brings everything down
+ * 60 dB in the decay time whatever way it goes round. The damped presets run
+ * each line's output through a one-pole low-pass as well, so the highs die
+ * away first. The input goes into the lines with alternating signs and the
+ * output is taken with another row of signs per channel (orthogonal rows of
+ * an 8x8 Hadamard matrix), so channels get decorrelated tails.
+ *
+ * Quality presets, at 16 kHz (host/bench_reverb reports the figures for a
+ * build; the cycles are the host's, x86 with the lines in RAM):
+ *
+ *  preset  budget  lines          RAM, lines in RAM / BRAM   multiplies   cycles
+ *  low      4 KB    9.4 - 23.9 ms  4.2 KB / 0.3 KB             8 + 3/ch    ~100
+ *  medium   8 KB   19.2 - 48.3 ms  8.3 KB / 0.3 KB            16 + 3/ch    ~140
+ *  high    16 KB   38.7 - 96.4 ms 16.2 KB / 0.3 KB            16 + 3/ch    ~140
+ *
+ * (per sample; the multiplies are per frame.) Lines in the BRAM cost about
+ * 17 AXI transactions a sample on top, one read & one write per line plus
+ * the wraps, and take no RAM: the RAM storage is a static pool of
+ * REVERB_POOL_BYTES, which a board build that keeps its lines in the BRAM
+ * can shrink to a token size.
+ *
+ * Below the engine is the Sound Tools reverb effect (st_reverb_getopts ..
+ * st_reverb_stop in st_i.h):
+ *
+ *  reverb [ -qs | -q | -ql ] [ -m bytes ] [ -b ] reverb-time [ damping [ wet ] ]
+ *
+ *      -qs, -q, -ql    low, medium (the default) or high preset
+ *      -m bytes        lay the lines out in bytes rather than the preset's
+ *      -b              keep the lines in the ChorusBuffer BRAM
+ *      reverb-time     ms to -60 dB
+ *      damping         0 to 1, of the highs taken out each trip (0.3)
+ *      wet             0 to 1, the reverb in the mix (0.3)
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "xil_types.h"
+#include "xstatus.h"
+#include "st_i.h"
+
+#include "ChorusBuffer.h"
+#include "delay_line.h"
+#include "reverb.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Into the network per channel, and out of it: 1 / sqrt(8) sums the eight
+// lines at about the level of one
+
+#define REVERB_IN_GAIN          0.25
+#define REVERB_OUT_GAIN         0.35355
+
+#define REVERB_DEFAULT_TIME     1000.0
+#define REVERB_DEFAULT_DAMPING  0.3
+#define REVERB_DEFAULT_WET      0.3
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+static const unsigned int preset_budget[REVERB_NUM_PRESETS] = {
+
+    REVERB_BUDGET_LOW, REVERB_BUDGET_MEDIUM, REVERB_BUDGET_HIGH
+};
+
+static const unsigned int preset_damped[REVERB_NUM_PRESETS] = { 0, 1, 1 };
+
+// Hadamard rows: row 1 takes the input in, rows 2 to 5 the channels out
+
+static const int in_sign[REVERB_LINES] = { 1, -1, 1, -1, 1, -1, 1, -1 };
+
+static const int out_sign[REVERB_MAX_CHANNELS][REVERB_LINES] = {
+
+    { 1,  1, -1, -1,  1,  1, -1, -1 },
+    { 1, -1, -1,  1,  1, -1, -1,  1 },
+    { 1,  1,  1,  1, -1, -1, -1, -1 },
+    { 1, -1,  1, -1, -1,  1, -1,  1 }
+};
+
+static s16 line_pool[REVERB_POOL_BYTES / sizeof(s16)];
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+static int is_prime(unsigned int n) {
+
+    unsigned int d;
+
+    if (n < 2) {
+        return 0;
+    }
+
+    for (d = 2; d * d <= n; d++) {
+        if ((n % d) == 0) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+// count samples of a line from its position, split where it wraps
+
+static void line_read(const reverb_line_t *l, unsigned int count, unsigned int *dst) {
+
+    unsigned int first = MIN(count, l->length - l->pos);
+    unsigned int i;
+
+    if (l->ram == NULL) {
+
+        ChorusBuffer_ReadBlock(l->base + l->pos, first, dst);
+
+        if (first < count) {
+            ChorusBuffer_ReadBlock(l->base, count - first, dst + first);
+        }
+
+        return;
+    }
+
+    for (i = 0; i < first; i++) {
+        dst[i] = (u16) l->ram[l->pos + i];
+    }
+
+    for (; i < count; i++) {
+        dst[i] = (u16) l->ram[i - first];
+    }
+
+    return;
+}
+
+// count samples back over the ones just read, and move past them
+
+static void line_write(reverb_line_t *l, unsigned int count, const unsigned int *src) {
+
+    unsigned int first = MIN(count, l->length - l->pos);
+    unsigned int i;
+
+    if (l->ram == NULL) {
+
+        ChorusBuffer_WriteStream(l->base + l->pos, first, src);
+
+        if (first < count) {
+            ChorusBuffer_WriteStream(l->base, count - first, src + first);
+        }
+    }
+
+    else {
+
+        for (i = 0; i < first; i++) {
+            l->ram[l->pos + i] = (s16) src[i];
+        }
+
+        for (; i < count; i++) {
+            l->ram[i - first] = (s16) src[i];
+        }
+    }
+
+    l->pos += count;
+
+    if (l->pos >= l->length) {
+        l->pos -= l->length;
+    }
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** REVERB INIT **********************************/
+/****************************************************************************/
+
+XStatus reverb_init(reverb_t *rv, st_rate_t rate, unsigned int channels,
+                    unsigned int preset, unsigned int budget, unsigned int storage) {
+
+    unsigned int i, target, length, offset = 0, last = 0;
+    double       ratio, sum = 0.0;
+
+    if ((rate == 0) || (channels == 0) || (channels > REVERB_MAX_CHANNELS) ||
+        (preset >= REVERB_NUM_PRESETS) ||
+        ((storage != REVERB_STORAGE_RAM) && (storage != REVERB_STORAGE_BRAM))) {
+
+        return XST_INVALID_PARAM;
+    }
+
+    if (budget == 0) {
+        budget = preset_budget[preset];
+    }
+
+    if (budget > ((storage == REVERB_STORAGE_RAM) ? REVERB_POOL_BYTES : REVERB_BRAM_LINES * sizeof(s16))) {
+        return XST_INVALID_PARAM;
+    }
+
+    // line i at SPREAD^(i/7) of the shortest, all of them in the budget
+
+    for (i = 0; i < REVERB_LINES; i++) {
+        sum += pow(REVERB_SPREAD, (double) i / (REVERB_LINES - 1));
+    }
+
+    ratio = (budget / sizeof(s16)) / sum;
+
+    for (i = 0; i < REVERB_LINES; i++) {
+
+        // the largest prime that fits, longer than the last line's
+
+        target = (unsigned int) (ratio * pow(REVERB_SPREAD, (double) i / (REVERB_LINES - 1)));
+
+        for (length = target; (length > last) && !is_prime(length); length--) {
+        }
+
+        if ((length <= last) || (length < REVERB_CHUNK)) {
+            return XST_INVALID_PARAM;
+        }
+
+        rv->line[i].ram    = (storage == REVERB_STORAGE_RAM) ? line_pool + offset : NULL;
+        rv->line[i].base   = REVERB_BRAM_BASE + offset;
+        rv->line[i].length = length;
+
+        offset += length;
+        last    = length;
+    }
+
+    rv->rate     = rate;
+    rv->channels = channels;
+    rv->storage  = storage;
+    rv->bytes    = offset * sizeof(s16);
+    rv->damped   = preset_damped[preset];
+
+    reverb_set(rv, REVERB_DEFAULT_TIME, REVERB_DEFAULT_DAMPING, REVERB_DEFAULT_WET);
+    reverb_reset(rv);
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/***************************** REVERB SET ***********************************/
+/****************************************************************************/
+
+XStatus reverb_set(reverb_t *rv, double time_ms, double damping, double wet) {
+
+    unsigned int i;
+    double       gain;
+
+    if ((time_ms <= 0.0) || (damping < 0.0) || (damping >= 1.0) || (wet < 0.0) || (wet > 1.0)) {
+        return XST_INVALID_PARAM;
+    }
+
+    // -60 dB in time_ms, each line by its length
+
+    for (i = 0; i < REVERB_LINES; i++) {
+
+        gain = pow(10.0, -3.0 * rv->line[i].length * 1000.0 / (time_ms * rv->rate));
+        rv->line[i].gain = MIN(Q15_GAIN(gain), Q15_ONE - 1);
+    }
+
+    rv->damping = rv->damped ? Q15_GAIN(1.0 - damping) : Q15_ONE;
+    rv->in_gain = Q15_GAIN(REVERB_IN_GAIN / rv->channels);
+    rv->dry     = Q15_GAIN(1.0 - wet);
+    rv->wet     = Q15_GAIN(wet * REVERB_OUT_GAIN);
+    rv->tail    = (st_size_t) ceil(time_ms * rv->rate / 1000.0) + rv->line[REVERB_LINES - 1].length;
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/***************************** REVERB RESET *********************************/
+/****************************************************************************/
+
+void reverb_reset(reverb_t *rv) {
+
+    unsigned int zero[REVERB_CHUNK] = { 0 };
+    unsigned int i, done, chunk;
+
+    for (i = 0; i < REVERB_LINES; i++) {
+
+        if (rv->line[i].ram != NULL) {
+            memset(rv->line[i].ram, 0, rv->line[i].length * sizeof(s16));
+        }
+
+        else {
+
+            for (done = 0; done < rv->line[i].length; done += chunk) {
+
+                chunk = MIN(rv->line[i].length - done, REVERB_CHUNK);
+                ChorusBuffer_WriteStream(rv->line[i].base + done, chunk, zero);
+            }
+        }
+
+        rv->line[i].pos = 0;
+        rv->line[i].lp  = 0;
+    }
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** REVERB FLOW **********************************/
+/****************************************************************************/
+
+st_size_t reverb_flow(reverb_t *rv, const st_sample_t *in, st_sample_t *out, st_size_t len) {
+
+    unsigned int buf[REVERB_LINES][REVERB_CHUNK];
+    int          dry[REVERB_MAX_CHANNELS];
+    int          d[REVERB_LINES], v[REVERB_LINES];
+    unsigned int channels = rv->channels;
+    st_size_t    frames = len / channels, done, chunk, k;
+    unsigned int i, c;
+    int          x, sum, y;
+
+    for (done = 0; done < frames; done += chunk) {
+
+        chunk = MIN(frames - done, REVERB_CHUNK);
+
+        // what comes out of the lines this chunk went in a line length ago
+
+        for (i = 0; i < REVERB_LINES; i++) {
+            line_read(&rv->line[i], chunk, buf[i]);
+        }
+
+        for (k = 0; k < chunk; k++) {
+
+            // the channels in, mixed down to the network's one input
+
+            x = 0;
+
+            for (c = 0; c < channels; c++) {
+
+                dry[c] = (in == NULL) ? 0 : ST_SAMPLE_TO_SIGNED_WORD(in[(done + k) * channels + c]);
+                x     += dry[c] * (int) rv->in_gain;
+            }
+
+            x = (x + (1 << (Q15_SHIFT - 1))) >> Q15_SHIFT;
+
+            // damp & decay each line's output. The low-pass keeps 15
+            // fraction bits and the gain rounds toward zero, so neither can
+            // hold a small value up in the loop for good.
+
+            sum = 0;
+
+            for (i = 0; i < REVERB_LINES; i++) {
+
+                d[i] = PCM_VALUE(buf[i][k]);
+
+                if (rv->damping < Q15_ONE) {
+
+                    rv->line[i].lp += (d[i] - (rv->line[i].lp >> Q15_SHIFT)) * (int) rv->damping;
+                    d[i] = rv->line[i].lp >> Q15_SHIFT;
+                }
+
+                v[i] = (d[i] * (int) rv->line[i].gain) / (int) Q15_ONE;
+                sum += v[i];
+            }
+
+            // Householder feedback, v - sum(v) / 4, and the input, back in
+
+            sum = (sum + 2) >> 2;
+
+            for (i = 0; i < REVERB_LINES; i++) {
+                buf[i][k] = PCM_LINE(v[i] - sum + in_sign[i] * x);
+            }
+
+            // each channel its own row of signs over the lines' outputs
+
+            for (c = 0; c < channels; c++) {
+
+                y = 0;
+
+                for (i = 0; i < REVERB_LINES; i++) {
+                    y += out_sign[c][i] * d[i];
+                }
+
+                // eight lines' worth of y times the wet gain would overflow
+                // 32 bits, so it loses a bit first
+
+                y = ((dry[c] * (int) rv->dry) >> Q15_SHIFT) + (((y >> 1) * (int) rv->wet) >> (Q15_SHIFT - 1));
+
+                out[(done + k) * channels + c] = ST_SIGNED_WORD_TO_SAMPLE(MIN(MAX(y, PCM_MIN), PCM_MAX));
+            }
+        }
+
+        for (i = 0; i < REVERB_LINES; i++) {
+            line_write(&rv->line[i], chunk, buf[i]);
+        }
+    }
+
+    return frames * channels;
+}
+
+/****************************************************************************/
+/***************************** ST HANDLERS **********************************/
+/****************************************************************************/
+
+// private data of the reverb effect, in effp->priv
+
+typedef struct reverbstuff {
+
+    reverb_t        rv;
+    unsigned int    preset;
+    unsigned int    budget;             // bytes, 0 for the preset's
+    unsigned int    storage;
+    double          time, damping, wet;
+    st_size_t       left;               // samples of tail still to drain
+
+} *reverb_stuff_t;
+
+int st_reverb_getopts(eff_t effp, int argc, char **argv) {
+
+    reverb_stuff_t r = (reverb_stuff_t) effp->priv;
+    char           *end = "";
+    int            bad = 0;
+
+    r->preset  = REVERB_MEDIUM;
+    r->budget  = 0;
+    r->storage = REVERB_STORAGE_RAM;
+    r->damping = REVERB_DEFAULT_DAMPING;
+    r->wet     = REVERB_DEFAULT_WET;
+
+    for (; (argc > 0) && (argv[0][0] == '-'); argc--, argv++) {
+
+        if (!strcmp(argv[0], "-qs")) {
+            r->preset = REVERB_LOW;
+        }
+
+        else if (!strcmp(argv[0], "-q")) {
+            r->preset = REVERB_MEDIUM;
+        }
+
+        else if (!strcmp(argv[0], "-ql")) {
+            r->preset = REVERB_HIGH;
+        }
+
+        else if (!strcmp(argv[0], "-b")) {
+            r->storage = REVERB_STORAGE_BRAM;
+        }
+
+        else if (!strcmp(argv[0], "-m") && (argc > 1)) {
+
+            r->budget = (unsigned int) strtoul(argv[1], &end, 10);
+            argc--;
+            argv++;
+
+            if ((*end != '\0') || (r->budget == 0)) {
+
+                bad = 1;
+                break;
+            }
+        }
+
+        else {
+            break;
+        }
+    }
+
+    if ((argc >= 1) && (argc <= 3) && (argv[0][0] != '-')) {
+
+        r->time = strtod(argv[0], &end);
+
+        if ((*end == '\0') && (argc > 1)) {
+            r->damping = strtod(argv[1], &end);
+        }
+
+        if ((*end == '\0') && (argc > 2)) {
+            r->wet = strtod(argv[2], &end);
+        }
+    }
+
+    if (bad || (argc < 1) || (argc > 3) || (argv[0][0] == '-') || (*end != '\0') || (r->time <= 0.0) ||
+        (r->damping < 0.0) || (r->damping >= 1.0) || (r->wet < 0.0) || (r->wet > 1.0)) {
+
+        st_warn("Usage: reverb [ -qs | -q | -ql ] [ -m bytes ] [ -b ] reverb-time [ damping [ wet ] ]");
+        return ST_EOF;
+    }
+
+    return ST_SUCCESS;
+}
+
+int st_reverb_start(eff_t effp) {
+
+    reverb_stuff_t r = (reverb_stuff_t) effp->priv;
+    unsigned int   channels = effp->ininfo.channels ? effp->ininfo.channels : 1;
+
+    if ((reverb_init(&r->rv, effp->ininfo.rate, channels, r->preset, r->budget, r->storage) != XST_SUCCESS) ||
+        (reverb_set(&r->rv, r->time, r->damping, r->wet) != XST_SUCCESS)) {
+
+        st_warn("%s: can not lay out the lines in %u bytes of %s for %u channels", effp->name,
+                r->budget ? r->budget : preset_budget[r->preset],
+                (r->storage == REVERB_STORAGE_RAM) ? "RAM" : "BRAM", channels);
+        return ST_EOF;
+    }
+
+    r->left = r->rv.tail * channels;
+
+    return ST_SUCCESS;
+}
+
+int st_reverb_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf,
+                   st_size_t *isamp, st_size_t *osamp) {
+
+    reverb_stuff_t r = (reverb_stuff_t) effp->priv;
+    st_size_t      len = MIN(*isamp, *osamp);
+
+    len   -= len % r->rv.channels;
+    *isamp = *osamp = reverb_flow(&r->rv, ibuf, obuf, len);
+
+    return ST_SUCCESS;
+}
+
+int st_reverb_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp) {
+
+    reverb_stuff_t r = (reverb_stuff_t) effp->priv;
+    st_size_t      len = MIN(*osamp, r->left);
+
+    // the tail: silence in until it has died away
+
+    len     -= len % r->rv.channels;
+    *osamp   = reverb_flow(&r->rv, NULL, obuf, len);
+    r->left -= *osamp;
+
+    return ST_SUCCESS;
+}
+
+int st_reverb_stop(eff_t effp) {
+
+    return ST_SUCCESS;
+}
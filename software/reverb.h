@@ -0,0 +1,129 @@
+/* reverb.h - feedback delay network reverb for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Constants, structures and prototypes for the FDN reverb engine (see
+ * reverb.c) behind the Sound Tools reverb effect.
+*/
+
+#ifndef REVERB_H
+#define REVERB_H
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "st.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Delay lines in the network (the Householder matrix is REVERB_LINES
+// square), interleaved channels, and the frames run at a time. No line is
+// shorter than a chunk, so a whole chunk can be read out of every line
+// before any of it is written back.
+
+#define REVERB_LINES            8
+#define REVERB_MAX_CHANNELS     4
+#define REVERB_CHUNK            32
+
+// Longest line over shortest, the lines spaced evenly (in octaves) between
+
+#define REVERB_SPREAD           2.5
+
+// Quality presets: the bytes of 16-bit delay line the network is laid out
+// in, and whether the lines are damped (a one-pole low-pass each)
+
+#define REVERB_LOW              0       //  4 KB, undamped
+#define REVERB_MEDIUM           1       //  8 KB, damped
+#define REVERB_HIGH             2       // 16 KB, damped
+#define REVERB_NUM_PRESETS      3
+
+#define REVERB_BUDGET_LOW       4096
+#define REVERB_BUDGET_MEDIUM    8192
+#define REVERB_BUDGET_HIGH      16384
+
+// Where the lines live: a static pool in CPU RAM, or the ChorusBuffer BRAM.
+// The pool is the one network's at a time; override its size with
+// -DREVERB_POOL_BYTES (the board default holds the medium preset, the
+// high one goes in the BRAM).
+
+#define REVERB_STORAGE_RAM      0
+#define REVERB_STORAGE_BRAM     1
+
+#ifndef REVERB_POOL_BYTES
+#ifdef __MICROBLAZE__
+#define REVERB_POOL_BYTES       REVERB_BUDGET_MEDIUM
+#else
+#define REVERB_POOL_BYTES       REVERB_BUDGET_HIGH
+#endif
+#endif
+
+// The BRAM lines go in the upper half of the ChorusBuffer, the one the
+// board's delay line uses (see audio_fx.h): the reverb and the delay modes
+// don't run at the same time
+
+#define REVERB_BRAM_BASE        32768
+#define REVERB_BRAM_LINES       32768
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct reverb_line {
+
+    s16             *ram;               // RAM storage, NULL in BRAM
+    unsigned int    base;               // first BRAM line, BRAM storage
+    unsigned int    length;             // samples, prime
+    unsigned int    pos;                // next sample out (and in)
+    unsigned int    gain;               // Q1.15 decay per trip round
+    int             lp;                 // damping filter state, Q16.15
+
+} reverb_line_t;
+
+typedef struct reverb {
+
+    st_rate_t       rate;
+    unsigned int    channels;
+    unsigned int    storage;
+    unsigned int    bytes;              // of delay line laid out
+    unsigned int    damped;
+
+    unsigned int    damping;            // Q1.15 low-pass coefficient
+    unsigned int    in_gain;            // Q1.15 per channel into the network
+    unsigned int    dry;                // Q1.15
+    unsigned int    wet;                // Q1.15, with the output tap scaling
+    st_size_t       tail;               // frames to -60 dB and out of the lines
+
+    reverb_line_t   line[REVERB_LINES];
+
+} reverb_t;
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+// lay out a network for a preset in budget bytes (0 for the preset's) of
+// storage; the lines start empty, with a 1 s decay
+XStatus   reverb_init(reverb_t *rv, st_rate_t rate, unsigned int channels,
+                      unsigned int preset, unsigned int budget, unsigned int storage);
+
+// decay time to -60 dB in ms, high-frequency damping and wet mix (0 to 1)
+XStatus   reverb_set(reverb_t *rv, double time_ms, double damping, double wet);
+
+// empty the lines
+void      reverb_reset(reverb_t *rv);
+
+// len interleaved samples in (NULL for silence, out may be in), as many out
+st_size_t reverb_flow(reverb_t *rv, const st_sample_t *in, st_sample_t *out, st_size_t len);
+
+#endif
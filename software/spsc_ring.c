@@ -0,0 +1,108 @@
+/* spsc_ring - lock-free single-producer / single-consumer ring for the
+ *             ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * The producer only ever stores the head and the consumer only the tail,
+ * each after it is done with the words in between (release), and each side
+ * loads the other's index before touching those words (acquire). So a word
+ * is never read before it is written or overwritten before it is read, and
+ * neither side has to turn the interrupts off or spin on the other: a full
+ * ring fails the write, an empty one comes back with nothing.
+ *
+ * Block transfers are split in two where they cross the end of the storage,
+ * like the delay line runs, and publish the whole block with one index
+ * store. The rings hold whatever the two sides agree on: events from the
+ * button and switch handlers, and the lines of each finished InputBuffer
+ * half for the main loop (see peripherals.c).
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <string.h>
+#include "xil_types.h"
+#include "xstatus.h"
+
+#include "delay_line.h"
+#include "spsc_ring.h"
+
+/****************************************************************************/
+/***************************** SPSC RING INIT *******************************/
+/****************************************************************************/
+
+XStatus spsc_ring_init(spsc_ring_t *ring, u32 *storage, unsigned int size) {
+
+    // the indices wrap by masking, so the size must be 2^n
+
+    if ((storage == NULL) || (size == 0) || (size & (size - 1))) {
+        return XST_INVALID_PARAM;
+    }
+
+    ring->data = storage;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/***************************** SPSC RING WRITE ******************************/
+/****************************************************************************/
+
+unsigned int spsc_ring_write(spsc_ring_t *ring, const u32 *src, unsigned int count) {
+
+    u32 head  = SPSC_LOAD_RELAXED(&ring->head);
+    u32 space = ring->mask + 1 - (head - SPSC_LOAD_ACQUIRE(&ring->tail));
+    u32 start = head & ring->mask;
+    u32 first = MIN(count, ring->mask + 1 - start);
+
+    // a block is only any use whole, so it either fits or is refused
+
+    if (count > space) {
+        return 0;
+    }
+
+    memcpy(&ring->data[start], src, first * sizeof(u32));
+
+    if (first < count) {
+        memcpy(&ring->data[0], src + first, (count - first) * sizeof(u32));
+    }
+
+    SPSC_STORE_RELEASE(&ring->head, head + count);
+
+    return count;
+}
+
+/****************************************************************************/
+/***************************** SPSC RING READ *******************************/
+/****************************************************************************/
+
+unsigned int spsc_ring_read(spsc_ring_t *ring, u32 *dst, unsigned int count) {
+
+    u32 tail  = SPSC_LOAD_RELAXED(&ring->tail);
+    u32 used  = SPSC_LOAD_ACQUIRE(&ring->head) - tail;
+    u32 start = tail & ring->mask;
+    u32 first = 0;
+
+    count = MIN(count, used);
+    first = MIN(count, ring->mask + 1 - start);
+
+    memcpy(dst, &ring->data[start], first * sizeof(u32));
+
+    if (first < count) {
+        memcpy(dst + first, &ring->data[0], (count - first) * sizeof(u32));
+    }
+
+    SPSC_STORE_RELEASE(&ring->tail, tail + count);
+
+    return count;
+}
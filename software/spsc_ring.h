@@ -0,0 +1,142 @@
+/* spsc_ring.h - lock-free single-producer / single-consumer ring for the
+ *               ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * A ring of 32-bit words with one writer and one reader, e.g. an interrupt
+ * handler and the main loop, or two threads on the host. Neither side ever
+ * waits for or locks out the other (see spsc_ring.c).
+ *
+ * The size is a power of two and the head & tail are free-running counts,
+ * so the fill level is head - tail and every word of the storage is used.
+ * Only the producer writes the head and only the consumer the tail; each
+ * sits on its own cache line, so on the host the two cores do not bounce a
+ * shared line on every push & pop.
+*/
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "stdbool.h"
+#include "xil_types.h"
+#include "xstatus.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Padding of the head & tail: the 32-byte (8-word) MicroBlaze cache line,
+// the 64-byte line of the host
+
+#ifdef __MICROBLAZE__
+#define SPSC_CACHE_LINE     32
+#else
+#define SPSC_CACHE_LINE     64
+#endif
+
+/****************************************************************************/
+/***************** Macros (Inline Functions) Definitions ********************/
+/****************************************************************************/
+
+// The data a push writes has to land before the head that publishes it,
+// and a pop has to read it before the tail gives the slot back. A single
+// in-order MicroBlaze with an interrupting producer only needs the compiler
+// to keep that order; the host needs acquire / release between the cores.
+
+#ifdef __MICROBLAZE__
+#define SPSC_LOAD_ACQUIRE(p)        ( __extension__ ({ u32 v_ = *(volatile u32 *) (p); \
+                                      __asm__ __volatile__ ("" ::: "memory"); v_; }) )
+#define SPSC_STORE_RELEASE(p, v)    do { __asm__ __volatile__ ("" ::: "memory"); \
+                                         *(volatile u32 *) (p) = (v); } while (0)
+#else
+#define SPSC_LOAD_ACQUIRE(p)        __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define SPSC_STORE_RELEASE(p, v)    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+#define SPSC_LOAD_RELAXED(p)        ( *(volatile u32 *) (p) )
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct spsc_ring {
+
+    // set once by spsc_ring_init(), read by both sides
+
+    u32             *data;
+    u32             mask;           // size - 1
+
+    // written by the producer only
+
+    u32             head __attribute__ ((aligned (SPSC_CACHE_LINE)));
+
+    // written by the consumer only
+
+    u32             tail __attribute__ ((aligned (SPSC_CACHE_LINE)));
+
+} __attribute__ ((aligned (SPSC_CACHE_LINE))) spsc_ring_t;
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+// size words of storage, size a power of two; the ring starts empty
+XStatus      spsc_ring_init(spsc_ring_t *ring, u32 *storage, unsigned int size);
+
+// producer side: all of src or nothing, returns the words written
+unsigned int spsc_ring_write(spsc_ring_t *ring, const u32 *src, unsigned int count);
+
+// consumer side: up to count words, returns the words read
+unsigned int spsc_ring_read(spsc_ring_t *ring, u32 *dst, unsigned int count);
+
+/****************************************************************************/
+/************************** Inline Functions ********************************/
+/****************************************************************************/
+
+// one word each way, inline as they sit in the interrupt handlers
+
+static inline bool spsc_ring_push(spsc_ring_t *ring, u32 word) {
+
+    u32 head = SPSC_LOAD_RELAXED(&ring->head);
+
+    if ((head - SPSC_LOAD_ACQUIRE(&ring->tail)) > ring->mask) {
+        return false;
+    }
+
+    ring->data[head & ring->mask] = word;
+    SPSC_STORE_RELEASE(&ring->head, head + 1);
+
+    return true;
+}
+
+static inline bool spsc_ring_pop(spsc_ring_t *ring, u32 *word) {
+
+    u32 tail = SPSC_LOAD_RELAXED(&ring->tail);
+
+    if (tail == SPSC_LOAD_ACQUIRE(&ring->head)) {
+        return false;
+    }
+
+    *word = ring->data[tail & ring->mask];
+    SPSC_STORE_RELEASE(&ring->tail, tail + 1);
+
+    return true;
+}
+
+// words waiting at the time of the call
+static inline unsigned int spsc_ring_count(spsc_ring_t *ring) {
+
+    return SPSC_LOAD_ACQUIRE(&ring->head) - SPSC_LOAD_RELAXED(&ring->tail);
+}
+
+#endif
@@ -204,6 +204,7 @@ extern const char *st_encodings_str[];
 #define ST_EFF_RATE     2               /* Effect can alter data rate */
 #define ST_EFF_MCHAN    4               /* Effect can handle multi-channel */
 #define ST_EFF_REPORT   8               /* Effect does nothing */
+#define ST_EFF_INPLACE  16              /* Effect can flow with obuf == ibuf */
 
 /*
  * Handler structure for each effect.
@@ -370,6 +370,7 @@ int st_band_getopts(eff_t effp, int argc, char **argv);
 int st_band_start(eff_t effp); 
 int st_band_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf, 
                  st_size_t *isamp, st_size_t *osamp); 
+int st_band_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp); 
 int st_band_stop(eff_t effp); 
 int st_bandpass_getopts(eff_t effp, int argc, char **argv); 
 int st_bandpass_start(eff_t effp); 
@@ -455,6 +456,7 @@ int st_highp_getopts(eff_t effp, int argc, char **argv);
 int st_highp_start(eff_t effp); 
 int st_highp_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf, 
                   st_size_t *isamp, st_size_t *osamp); 
+int st_highp_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp); 
 int st_highp_stop(eff_t effp); 
  
 int st_highpass_getopts(eff_t effp, int argc, char **argv); 
@@ -464,6 +466,7 @@ int st_lowp_getopts(eff_t effp, int argc, char **argv);
 int st_lowp_start(eff_t effp); 
 int st_lowp_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf, 
                  st_size_t *isamp, st_size_t *osamp); 
+int st_lowp_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp); 
 int st_lowp_stop(eff_t effp); 
  
 int st_lowpass_getopts(eff_t effp, int argc, char **argv); 
@@ -509,6 +512,7 @@ int st_rate_getopts(eff_t effp, int argc, char **argv);
 int st_rate_start(eff_t effp); 
 int st_rate_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf, 
                  st_size_t *isamp, st_size_t *osamp); 
+int st_rate_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp); 
 int st_rate_stop(eff_t effp); 
  
 int st_resample_getopts(eff_t effp, int argc, char **argv); 
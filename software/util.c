@@ -0,0 +1,67 @@
+/*
+ * July 5, 1991
+ * Copyright 1991 Lance Norskog And Sundry Contributors
+ * This source code is freely redistributable and may be used for
+ * any purpose.  This copyright notice must be maintained.
+ * Lance Norskog And Sundry Contributors are not responsible for
+ * the consequences of using this software.
+ */
+
+/*
+ * Sound Tools utilities.
+ *
+ * Only the warnings, the error reporting and the do-nothing handlers the
+ * format handlers in this project use are carried over (see st_i.h for the
+ * declarations).
+ */
+
+#include <string.h>
+#include <stdarg.h>
+#include "st_i.h"
+
+/*
+ * Warn on stderr; the format handlers use it for what they work around.
+ */
+void st_warn(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+}
+
+/*
+ * Record an error on a file, for the caller to report from ft->st_errno
+ * and ft->st_errstr.
+ */
+void st_fail_errno(ft_t ft, int st_errno, const char *fmt, ...)
+{
+    va_list args;
+
+    ft->st_errno = st_errno;
+
+    va_start(args, fmt);
+    vsnprintf(ft->st_errstr, sizeof(ft->st_errstr), fmt, args);
+    va_end(args);
+}
+
+/*
+ * Format handler helpers for a format that has nothing to do there.
+ */
+int st_format_nothing(ft_t ft)
+{
+    return (ST_SUCCESS);
+}
+
+st_ssize_t st_format_nothing_io(ft_t ft, st_sample_t *buf, st_ssize_t len)
+{
+    return (0);
+}
+
+int st_format_nothing_seek(ft_t ft, st_size_t offset)
+{
+    st_fail_errno(ft, ST_ENOTSUP, "operation not supported");
+    return (ST_EOF);
+}
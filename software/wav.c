@@ -0,0 +1,243 @@
+/*
+ * Microsoft's WAVE sound format handler
+ *
+ * Copyright 1998-2001 Chris Bagwell
+ * Copyright 1997 Graeme W. Gill, 93/5/17
+ * Copyright 1992 Rick Richardson
+ *
+ * This source code is freely redistributable and may be used for
+ * any purpose.  This copyright notice must be maintained.
+ * The authors are not responsible for the consequences of using
+ * this software.
+ */
+
+/*
+ * Only uncompressed PCM (WAVE_FORMAT_PCM) in 8 or 16 bits is carried over,
+ * the data going through raw.c. Chunks other than "fmt " and "data" are
+ * skipped on read. On write the header goes out with the data length left
+ * open and is written again with the real lengths by st_wavstopwrite() when
+ * the file can seek.
+ */
+
+#include <string.h>
+#include "st_i.h"
+
+#define WAVE_FORMAT_PCM     0x0001
+#define WAV_HEADER_LEN      44              /* RIFF + fmt + data headers */
+#define WAV_OPEN_LENGTH     0x7ffff000L     /* data length until known */
+
+/* Private data for .wav file */
+typedef struct wavstuff {
+    st_size_t numSamples;       /* samples left to read / written so far */
+    st_size_t dataStart;        /* file offset of the first sample */
+} *wav_t;
+
+/* find the next chunk called label, skipping any others; returns its length */
+static int findChunk(ft_t ft, const char *label, uint32_t *len)
+{
+    char magic[5];
+
+    for (;;)
+    {
+        if (st_reads(ft, magic, 4) == ST_EOF)
+        {
+            st_fail_errno(ft, ST_EHDR, "WAVE file has no %s chunk", label);
+            return ST_EOF;
+        }
+
+        st_readdw(ft, len);
+
+        if (strncmp(label, magic, 4) == 0)
+            return ST_SUCCESS;
+
+        /* chunks are word aligned */
+        if (st_seek(ft, *len + (*len & 1), SEEK_CUR) == ST_EOF)
+            return ST_EOF;
+    }
+}
+
+/*
+ * Do anything required before you start reading samples.
+ * Read file header.
+ *      Find out sampling rate,
+ *      size and encoding of samples,
+ *      mono/stereo/quad.
+ */
+int st_wavstartread(ft_t ft)
+{
+    wav_t    wav = (wav_t) ft->priv;
+    char     magic[5];
+    uint32_t len, dwRate, dwAvgBytesPerSec;
+    uint16_t wFormatTag, wChannels, wBlockAlign, wBitsPerSample;
+
+    /* WAVE is little-endian */
+    ft->swap = ST_IS_BIGENDIAN;
+
+    if (st_reads(ft, magic, 4) == ST_EOF || strncmp("RIFF", magic, 4))
+    {
+        st_fail_errno(ft, ST_EHDR, "WAVE: RIFF header not found");
+        return ST_EOF;
+    }
+
+    st_readdw(ft, &len);
+
+    if (st_reads(ft, magic, 4) == ST_EOF || strncmp("WAVE", magic, 4))
+    {
+        st_fail_errno(ft, ST_EHDR, "WAVE header not found");
+        return ST_EOF;
+    }
+
+    if (findChunk(ft, "fmt ", &len) == ST_EOF)
+        return ST_EOF;
+
+    if (len < 16)
+    {
+        st_fail_errno(ft, ST_EHDR, "WAVE file fmt chunk is too short");
+        return ST_EOF;
+    }
+
+    st_readw(ft, &wFormatTag);
+    st_readw(ft, &wChannels);
+    st_readdw(ft, &dwRate);
+    st_readdw(ft, &dwAvgBytesPerSec);
+    st_readw(ft, &wBlockAlign);
+    st_readw(ft, &wBitsPerSample);
+
+    if (len > 16 && st_seek(ft, len - 16 + (len & 1), SEEK_CUR) == ST_EOF)
+        return ST_EOF;
+
+    if (wFormatTag != WAVE_FORMAT_PCM || (wBitsPerSample != 8 && wBitsPerSample != 16))
+    {
+        st_fail_errno(ft, ST_EFMT, "WAVE format %d, %d bits is not supported",
+                      wFormatTag, wBitsPerSample);
+        return ST_EOF;
+    }
+
+    if (findChunk(ft, "data", &len) == ST_EOF)
+        return ST_EOF;
+
+    ft->info.rate     = dwRate;
+    ft->info.channels = wChannels;
+    ft->info.size     = wBitsPerSample / 8;
+    ft->info.encoding = (wBitsPerSample == 8) ? ST_ENCODING_UNSIGNED : ST_ENCODING_SIGN2;
+
+    wav->numSamples = len / ft->info.size;
+    wav->dataStart  = ftell(ft->fp);
+    ft->length      = wav->numSamples;
+
+    return st_rawstartread(ft);
+}
+
+/*
+ * Read up to len samples from file, channels interleaved.
+ * Stops at the end of the data chunk.
+ */
+st_ssize_t st_wavread(ft_t ft, st_sample_t *buf, st_ssize_t len)
+{
+    wav_t      wav = (wav_t) ft->priv;
+    st_ssize_t done;
+
+    if ((st_size_t) len > wav->numSamples)
+        len = wav->numSamples;
+
+    done = st_rawread(ft, buf, len);
+    wav->numSamples -= done;
+
+    return done;
+}
+
+static int wavwritehdr(ft_t ft, st_size_t dataLength)
+{
+    uint16_t wBlockAlign = ft->info.channels * ft->info.size;
+
+    if (st_writes(ft, "RIFF") == ST_EOF ||
+        st_writedw(ft, dataLength + WAV_HEADER_LEN - 8) == ST_EOF ||
+        st_writes(ft, "WAVEfmt ") == ST_EOF ||
+        st_writedw(ft, 16) == ST_EOF ||
+        st_writew(ft, WAVE_FORMAT_PCM) == ST_EOF ||
+        st_writew(ft, ft->info.channels) == ST_EOF ||
+        st_writedw(ft, ft->info.rate) == ST_EOF ||
+        st_writedw(ft, ft->info.rate * wBlockAlign) == ST_EOF ||
+        st_writew(ft, wBlockAlign) == ST_EOF ||
+        st_writew(ft, ft->info.size * 8) == ST_EOF ||
+        st_writes(ft, "data") == ST_EOF ||
+        st_writedw(ft, dataLength) == ST_EOF)
+    {
+        return ST_EOF;
+    }
+
+    return ST_SUCCESS;
+}
+
+int st_wavstartwrite(ft_t ft)
+{
+    wav_t wav = (wav_t) ft->priv;
+
+    /* WAVE is little-endian; 8-bit data is unsigned, 16-bit signed */
+    ft->swap = ST_IS_BIGENDIAN;
+
+    if (ft->info.size == 0)
+        ft->info.size = ST_SIZE_WORD;
+    if (ft->info.channels == 0)
+        ft->info.channels = 1;
+
+    ft->info.encoding = (ft->info.size == ST_SIZE_BYTE) ? ST_ENCODING_UNSIGNED : ST_ENCODING_SIGN2;
+
+    if (st_rawstartwrite(ft) == ST_EOF)
+        return ST_EOF;
+
+    wav->numSamples = 0;
+    wav->dataStart  = WAV_HEADER_LEN;
+
+    return wavwritehdr(ft, WAV_OPEN_LENGTH);
+}
+
+st_ssize_t st_wavwrite(ft_t ft, st_sample_t *buf, st_ssize_t len)
+{
+    wav_t      wav = (wav_t) ft->priv;
+    st_ssize_t done;
+
+    done = st_rawwrite(ft, buf, len);
+    wav->numSamples += done;
+
+    return done;
+}
+
+int st_wavstopwrite(ft_t ft)
+{
+    wav_t wav = (wav_t) ft->priv;
+
+    if (st_rawstopwrite(ft) == ST_EOF)
+        return ST_EOF;
+
+    /* Now that we know the length, go back and write the header again */
+    if (!ft->seekable)
+    {
+        st_warn("WAVE: length in header not updated, output is not seekable");
+        return ST_SUCCESS;
+    }
+
+    if (st_seek(ft, 0, SEEK_SET) == ST_EOF)
+        return ST_EOF;
+
+    return wavwritehdr(ft, wav->numSamples * ft->info.size);
+}
+
+int st_wavseek(ft_t ft, st_size_t offset)
+{
+    wav_t wav = (wav_t) ft->priv;
+    st_size_t pos = (ftell(ft->fp) - wav->dataStart) / ft->info.size;
+
+    if (offset > pos + wav->numSamples)
+    {
+        st_fail_errno(ft, ST_EINVAL, "seek past the end of the data");
+        return ST_EOF;
+    }
+
+    if (st_seek(ft, wav->dataStart + offset * ft->info.size, SEEK_SET) == ST_EOF)
+        return ST_EOF;
+
+    wav->numSamples = pos + wav->numSamples - offset;
+
+    return ST_SUCCESS;
+}
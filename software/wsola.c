@@ -0,0 +1,527 @@
+/* wsola - WSOLA time-stretch & pitch-shift engine for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Waveform-similarity overlap-add: the output is built a hop (one overlap,
+ * 16 ms) at a time, each hop a linear cross-fade from the second half of
+ * the last input segment into the first half of the next. The next segment
+ * is nominally a hop's worth of input times the speed on from the last,
+ * but is taken from wherever within the seek (8 ms) either side of there
+ * its first half looks most like what followed the last segment in the
+ * input, so the cross-fade joins two stretches of waveform that are in
+ * phase and a pitched sound keeps its period. Playing the segments back
+ * faster or slower than they were taken changes the speed, not the pitch.
+ *
+ * The likeness is the normalized cross-correlation c * |c| / energy, and
+ * the search is decimated to keep its cost fixed: every WSOLA_DECIM-th
+ * position is tried on every WSOLA_DECIM-th sample, then the positions
+ * around the best one on every sample. Samples lose WSOLA_CORR_SHIFT bits
+ * first, so the sums fit 32 bits; each position's energy is the last one's
+ * with a sample in and one out.
+ *
+ * Pitch shifting is a stretch by the pitch ratio followed by reading the
+ * stretched output back that much faster, with linear interpolation (Q16
+ * position), so the length comes back to the input's. A pitch ratio of 1
+ * reads every sample as is.
+ *
+ * Cost, at 16 kHz (256-sample overlap, 128-sample seek): one search is
+ * 65 coarse positions of 64 samples and 7 fine ones of 256, about 6,400
+ * multiply-adds with the energies, plus 72 64-bit divides, and the hop's
+ * cross-fade another 512 multiplies. A hop falls in at most one 64-sample
+ * block (it gives 256 samples out, a block reads at most 128), so that
+ * block is the worst case. Counting ~5 cycles a multiply-add and ~100 a
+ * divide, the MicroBlaze takes about 39,000 cycles for the search and
+ * 44,000 for the whole block: 11% of the 400,000 (64 x 6250) a block has
+ * at 100 MHz. The other blocks are the interpolation alone, under 30
+ * cycles a sample. host/bench_wsola prints these figures and measures the
+ * worst block on the host (~15,000 cycles on an idle x86).
+ *
+ * At the bottom are the Sound Tools pitch and stretch effects on top of it
+ * (st_pitch_* and st_stretch_* in st_i.h), mono only:
+ *
+ *  pitch cents         -1200 to 1200, the same length out; works in place
+ *  stretch factor      0.5 to 2, the output that many times as long
+ *
+ * Both drain the engine with silence until the output is as long as the
+ * input (times the factor). The engine's buffers are static, so one of the
+ * two effects runs at a time.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "xil_types.h"
+#include "xstatus.h"
+#include "st_i.h"
+
+#include "delay_line.h"
+#include "wsola.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+#define Q16_ONE                 (1u << 16)
+
+#define WSOLA_MAX_CENTS         1200.0
+
+/****************************************************************************/
+/************************** Local Functions *********************************/
+/****************************************************************************/
+
+// drop the history before the earliest sample the next search can take
+
+static void compact(wsola_t *ws) {
+
+    unsigned int t = ws->target >> 16;
+    unsigned int drop = (t > ws->seek) ? t - ws->seek : 0;
+
+    if (drop == 0) {
+        return;
+    }
+
+    memmove(ws->hist, ws->hist + drop, (ws->fill - drop) * sizeof(s16));
+
+    ws->fill   -= drop;
+    ws->target -= drop << 16;
+
+    return;
+}
+
+// the likeness of a segment with correlation c and energy e: c * |c| / e,
+// which orders segments as c / sqrt(e) does
+
+static s64 likeness(s32 c, s32 e) {
+
+    return (s64) c * ((c < 0) ? -c : c) / ((s64) e + 1);
+}
+
+// the start of the segment most like the tail, within the seek of t
+
+static unsigned int search(wsola_t *ws, unsigned int t) {
+
+    const s16       *x = ws->hist;
+    unsigned int    len = ws->overlap, n = ws->overlap / WSOLA_DECIM;
+    unsigned int    lo = (t > ws->seek) ? t - ws->seek : 0, hi = t + ws->seek;
+    unsigned int    p, j, best = lo, first, last;
+    s32             c, e;
+    s64             like, best_like = 0;
+    int             v;
+
+    // coarse: every DECIM-th position on every DECIM-th sample
+
+    for (j = 0, e = 0; j < n; j++) {
+
+        v  = x[lo + j * WSOLA_DECIM] >> WSOLA_CORR_SHIFT;
+        e += v * v;
+    }
+
+    for (p = lo; p <= hi; p += WSOLA_DECIM) {
+
+        for (j = 0, c = 0; j < n; j++) {
+            c += ws->ref[j] * (x[p + j * WSOLA_DECIM] >> WSOLA_CORR_SHIFT);
+        }
+
+        like = likeness(c, e);
+
+        if ((p == lo) || (like > best_like)) {
+
+            best      = p;
+            best_like = like;
+        }
+
+        v  = x[p + len] >> WSOLA_CORR_SHIFT;
+        e += v * v;
+        v  = x[p] >> WSOLA_CORR_SHIFT;
+        e -= v * v;
+    }
+
+    // fine: every position & sample either side of the best
+
+    first = (best >= lo + WSOLA_DECIM - 1) ? best - (WSOLA_DECIM - 1) : lo;
+    last  = MIN(best + (WSOLA_DECIM - 1), hi);
+
+    for (j = 0, e = 0; j < len; j++) {
+
+        v  = x[first + j] >> WSOLA_CORR_SHIFT;
+        e += v * v;
+    }
+
+    for (p = first; p <= last; p++) {
+
+        for (j = 0, c = 0; j < len; j++) {
+            c += (ws->tail[j] >> WSOLA_CORR_SHIFT) * (x[p + j] >> WSOLA_CORR_SHIFT);
+        }
+
+        like = likeness(c, e);
+
+        if ((p == first) || (like > best_like)) {
+
+            best      = p;
+            best_like = like;
+        }
+
+        v  = x[p + len] >> WSOLA_CORR_SHIFT;
+        e += v * v;
+        v  = x[p] >> WSOLA_CORR_SHIFT;
+        e -= v * v;
+    }
+
+    return best;
+}
+
+// one hop: the next segment found and faded in after what is left queued
+
+static void hop(wsola_t *ws) {
+
+    unsigned int    len = ws->overlap, t = ws->target >> 16;
+    unsigned int    p, i, done = MIN(ws->pos >> 16, ws->queued);
+    u32             w = ws->fade_step / 2;
+    s16             *q;
+
+    memmove(ws->queue, ws->queue + done, (ws->queued - done) * sizeof(s16));
+    ws->queued -= done;
+    ws->pos    -= done << 16;
+
+    q = ws->queue + ws->queued;
+
+    if (ws->first) {
+
+        // nothing to fade from: the first segment as it is
+
+        p = t;
+        memcpy(q, ws->hist + p, len * sizeof(s16));
+        ws->first = 0;
+    }
+
+    else {
+
+        p = search(ws, t);
+
+        for (i = 0; i < len; i++, w += ws->fade_step) {
+
+            q[i] = (s16) ((ws->tail[i] * (s32) (Q15_ONE - (w >> 16)) + ws->hist[p + i] * (s32) (w >> 16) +
+                           (1 << (Q15_SHIFT - 1))) >> Q15_SHIFT);
+        }
+    }
+
+    ws->queued += len;
+
+    // what followed the segment: the next one fades from it & is matched
+    // against it
+
+    memcpy(ws->tail, ws->hist + p + len, len * sizeof(s16));
+
+    for (i = 0; i < len / WSOLA_DECIM; i++) {
+        ws->ref[i] = ws->tail[i * WSOLA_DECIM] >> WSOLA_CORR_SHIFT;
+    }
+
+    ws->target += ws->hop;
+
+    return;
+}
+
+/****************************************************************************/
+/***************************** WSOLA ENGINE *********************************/
+/****************************************************************************/
+
+XStatus wsola_init(wsola_t *ws, st_rate_t rate, double speed, double pitch) {
+
+    double stretch;
+
+    if ((ws == NULL) || (pitch < WSOLA_MIN_PITCH) || (pitch > WSOLA_MAX_PITCH)) {
+        return XST_INVALID_PARAM;
+    }
+
+    // the overlap-add runs at the speed over the pitch ratio, and the read
+    // back at the pitch ratio
+
+    stretch = speed / pitch;
+
+    if ((stretch < WSOLA_MIN_SPEED - 1e-9) || (stretch > WSOLA_MAX_SPEED + 1e-9)) {
+        return XST_INVALID_PARAM;
+    }
+
+    ws->rate    = rate;
+    ws->overlap = (rate * WSOLA_OVERLAP_MS / 1000) & ~(WSOLA_DECIM - 1);
+    ws->seek    = (rate * WSOLA_SEEK_MS / 1000) & ~(WSOLA_DECIM - 1);
+
+    if ((ws->overlap < 4 * WSOLA_DECIM) || (ws->overlap > WSOLA_MAX_OVERLAP) || (ws->seek > WSOLA_MAX_SEEK)) {
+        return XST_INVALID_PARAM;
+    }
+
+    ws->fade_step = (Q15_ONE << 16) / ws->overlap;
+    ws->hop       = (u32) (ws->overlap * stretch * Q16_ONE + 0.5);
+    ws->step      = (u32) (pitch * Q16_ONE + 0.5);
+
+    wsola_reset(ws);
+
+    return XST_SUCCESS;
+}
+
+void wsola_reset(wsola_t *ws) {
+
+    ws->target = 0;
+    ws->fill   = 0;
+    ws->first  = 1;
+    ws->pos    = 0;
+    ws->queued = 0;
+
+    memset(ws->tail, 0, sizeof(ws->tail));
+    memset(ws->ref, 0, sizeof(ws->ref));
+
+    return;
+}
+
+void wsola_flow(wsola_t *ws, const st_sample_t *in, st_size_t *isamp,
+                st_sample_t *out, st_size_t *osamp) {
+
+    st_size_t       taken = 0, made = 0, count, k;
+    unsigned int    i, frac, need;
+    int             alias = (in != NULL) && (in == (const st_sample_t *) out);
+    s16             *q = ws->queue;
+
+    while (made < *osamp) {
+
+        i = ws->pos >> 16;
+
+        // the next output, read between two queued samples; in place, only
+        // over input already taken
+
+        if ((i + 1 < ws->queued) && !(alias && (made == taken))) {
+
+            frac        = (ws->pos & 0xFFFF) >> 1;
+            out[made++] = ST_SIGNED_WORD_TO_SAMPLE((s16) (q[i] + (((q[i + 1] - q[i]) * (s32) frac) >> 15)));
+            ws->pos    += ws->step;
+            continue;
+        }
+
+        // the queue ran out: a hop, once the input for its search is in
+
+        need = (ws->target >> 16) + ws->seek + 2 * ws->overlap;
+
+        if ((i + 1 >= ws->queued) && (ws->fill >= need)) {
+
+            hop(ws);
+            continue;
+        }
+
+        if (taken == *isamp) {
+            break;
+        }
+
+        if (ws->fill == WSOLA_HIST) {
+            compact(ws);
+        }
+
+        count = MIN(*isamp - taken, WSOLA_HIST - ws->fill);
+
+        if (count == 0) {
+            break;
+        }
+
+        for (k = 0; k < count; k++) {
+            ws->hist[ws->fill + k] = in ? ST_SAMPLE_TO_SIGNED_WORD(in[taken + k]) : 0;
+        }
+
+        ws->fill += count;
+        taken    += count;
+    }
+
+    *isamp = taken;
+    *osamp = made;
+
+    return;
+}
+
+unsigned int wsola_search_cost(const wsola_t *ws) {
+
+    unsigned int n = ws->overlap / WSOLA_DECIM, coarse = 2 * ws->seek / WSOLA_DECIM + 1;
+    unsigned int fine = 2 * WSOLA_DECIM - 1;
+
+    // the correlations, then the energies (a full sum & two a position)
+
+    return (coarse * n + fine * ws->overlap) + (n + 2 * coarse) + (ws->overlap + 2 * fine);
+}
+
+/****************************************************************************/
+/***************************** ST HANDLERS **********************************/
+/****************************************************************************/
+
+// private data of the pitch and stretch effects, in effp->priv; the
+// engine is static, one effect's at a time
+
+typedef struct wsolastuff {
+
+    double          speed;
+    double          pitch;
+    st_size_t       in;                 // samples taken in
+    st_size_t       out;                // and given out
+
+} *wsola_stuff_t;
+
+static wsola_t      engine;
+static eff_t        engine_user = NULL;
+
+static int wsola_start(eff_t effp) {
+
+    wsola_stuff_t r = (wsola_stuff_t) effp->priv;
+
+    if (effp->ininfo.channels > 1) {
+
+        st_warn("%s: can only handle mono", effp->name);
+        return ST_EOF;
+    }
+
+    if ((engine_user != NULL) && (engine_user != effp)) {
+
+        st_warn("%s: the pitch & stretch engine is in use", effp->name);
+        return ST_EOF;
+    }
+
+    if (wsola_init(&engine, effp->ininfo.rate, r->speed, r->pitch) != XST_SUCCESS) {
+
+        st_warn("%s: can not run at %lu Hz", effp->name, (unsigned long) effp->ininfo.rate);
+        return ST_EOF;
+    }
+
+    engine_user = effp;
+    r->in       = 0;
+    r->out      = 0;
+
+    return ST_SUCCESS;
+}
+
+static int wsola_effect_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf,
+                             st_size_t *isamp, st_size_t *osamp) {
+
+    wsola_stuff_t r = (wsola_stuff_t) effp->priv;
+
+    wsola_flow(&engine, ibuf, isamp, obuf, osamp);
+
+    r->in  += *isamp;
+    r->out += *osamp;
+
+    return ST_SUCCESS;
+}
+
+static int wsola_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp) {
+
+    wsola_stuff_t r = (wsola_stuff_t) effp->priv;
+    st_size_t     want = (st_size_t) (r->in / r->speed + 0.5);
+    st_size_t     isamp = ~(st_size_t) 0;
+
+    // silence in until the output is as long as the input makes it
+
+    *osamp = (want > r->out) ? MIN(*osamp, want - r->out) : 0;
+
+    wsola_flow(&engine, NULL, &isamp, obuf, osamp);
+    r->out += *osamp;
+
+    return ST_SUCCESS;
+}
+
+static int wsola_stop(eff_t effp) {
+
+    if (engine_user == effp) {
+        engine_user = NULL;
+    }
+
+    return ST_SUCCESS;
+}
+
+int st_pitch_getopts(eff_t effp, int argc, char **argv) {
+
+    wsola_stuff_t r = (wsola_stuff_t) effp->priv;
+    char          *end = "";
+    double        cents = 0.0;
+
+    if (argc == 1) {
+        cents = strtod(argv[0], &end);
+    }
+
+    if ((argc != 1) || (*end != '\0') || (fabs(cents) > WSOLA_MAX_CENTS)) {
+
+        st_warn("Usage: pitch cents (-1200 to 1200)");
+        return ST_EOF;
+    }
+
+    r->speed = 1.0;
+    r->pitch = pow(2.0, cents / 1200.0);
+
+    return ST_SUCCESS;
+}
+
+int st_pitch_start(eff_t effp) {
+
+    return wsola_start(effp);
+}
+
+int st_pitch_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf,
+                  st_size_t *isamp, st_size_t *osamp) {
+
+    return wsola_effect_flow(effp, ibuf, obuf, isamp, osamp);
+}
+
+int st_pitch_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp) {
+
+    return wsola_drain(effp, obuf, osamp);
+}
+
+int st_pitch_stop(eff_t effp) {
+
+    return wsola_stop(effp);
+}
+
+int st_stretch_getopts(eff_t effp, int argc, char **argv) {
+
+    wsola_stuff_t r = (wsola_stuff_t) effp->priv;
+    char          *end = "";
+    double        factor = 0.0;
+
+    if (argc == 1) {
+        factor = strtod(argv[0], &end);
+    }
+
+    if ((argc != 1) || (*end != '\0') || (factor < 1.0 / WSOLA_MAX_SPEED) || (factor > 1.0 / WSOLA_MIN_SPEED)) {
+
+        st_warn("Usage: stretch factor (0.5 to 2)");
+        return ST_EOF;
+    }
+
+    r->speed = 1.0 / factor;
+    r->pitch = 1.0;
+
+    return ST_SUCCESS;
+}
+
+int st_stretch_start(eff_t effp) {
+
+    return wsola_start(effp);
+}
+
+int st_stretch_flow(eff_t effp, st_sample_t *ibuf, st_sample_t *obuf,
+                    st_size_t *isamp, st_size_t *osamp) {
+
+    return wsola_effect_flow(effp, ibuf, obuf, isamp, osamp);
+}
+
+int st_stretch_drain(eff_t effp, st_sample_t *obuf, st_size_t *osamp) {
+
+    return wsola_drain(effp, obuf, osamp);
+}
+
+int st_stretch_stop(eff_t effp) {
+
+    return wsola_stop(effp);
+}
@@ -0,0 +1,121 @@
+/* wsola.h - WSOLA time-stretch & pitch-shift engine for the ECE 544 Final Project
+ *
+ * Copyright: 2016 Portland State University
+ *
+ * Author: Rehan Iqbal, Chad Klingbeil, Neil Roberts
+ * Date: March 4, 2016
+ *
+ *  Description:
+ *  ------------
+ *
+ * Constants, structures and prototypes for the waveform-similarity
+ * overlap-add engine (see wsola.c) behind the Sound Tools pitch and
+ * stretch effects.
+*/
+
+#ifndef WSOLA_H
+#define WSOLA_H
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "st.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Segment timing: each hop puts out one overlap of samples, cross-faded
+// from the last segment into the next, and looks for the next segment up
+// to the seek either side of where the speed puts it
+
+#define WSOLA_OVERLAP_MS        16
+#define WSOLA_SEEK_MS           8
+
+// The search: every WSOLA_DECIM-th sample and position first, then every
+// position around the best; samples lose WSOLA_CORR_SHIFT bits so the
+// sums fit 32 bits
+
+#define WSOLA_DECIM             4
+#define WSOLA_CORR_SHIFT        5
+
+// Speed (input over output) of the overlap-add, and pitch ratio, limits;
+// the buffers are sized for the fastest overlap-add
+
+#define WSOLA_MIN_SPEED         0.5
+#define WSOLA_MAX_SPEED         2.0
+#define WSOLA_MIN_PITCH         0.5
+#define WSOLA_MAX_PITCH         2.0
+
+// Highest sample rate the buffers are sized for: the board's rate on the
+// board, any the host resamples to otherwise; override with
+// -DWSOLA_MAX_RATE
+
+#ifndef WSOLA_MAX_RATE
+#ifdef __MICROBLAZE__
+#define WSOLA_MAX_RATE          16000
+#else
+#define WSOLA_MAX_RATE          48000
+#endif
+#endif
+
+#define WSOLA_MAX_OVERLAP       (WSOLA_MAX_RATE / 1000 * WSOLA_OVERLAP_MS)
+#define WSOLA_MAX_SEEK          (WSOLA_MAX_RATE / 1000 * WSOLA_SEEK_MS)
+
+// Input history: the seek either side of the next segment and two overlaps
+// of it, plus room to take input in blocks
+
+#define WSOLA_HIST              (2 * WSOLA_MAX_SEEK + 4 * WSOLA_MAX_OVERLAP)
+
+/****************************************************************************/
+/*************************** Typdefs & Structures ***************************/
+/****************************************************************************/
+
+typedef struct wsola {
+
+    st_rate_t       rate;
+    unsigned int    overlap;            // samples a hop, a multiple of DECIM
+    unsigned int    seek;               // either side, a multiple of DECIM
+    unsigned int    fade_step;          // Q16 of the Q15 cross-fade a sample
+
+    u32             hop;                // input a hop, Q16
+    u32             step;               // pitch ratio, Q16
+    u32             target;             // next segment in hist, Q16
+    unsigned int    fill;               // samples in hist
+    unsigned int    first;              // no segment yet to fade from
+
+    u32             pos;                // next output in queue, Q16
+    unsigned int    queued;             // samples in queue
+
+    s16             hist[WSOLA_HIST];
+    s16             tail[WSOLA_MAX_OVERLAP];    // last segment's second half
+    s16             ref[WSOLA_MAX_OVERLAP / WSOLA_DECIM];
+    s16             queue[WSOLA_MAX_OVERLAP + 2];
+
+} wsola_t;
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+// speed: input over output (2 plays twice as fast); pitch: ratio of the
+// output's pitch to the input's
+XStatus wsola_init(wsola_t *ws, st_rate_t rate, double speed, double pitch);
+
+// forget the input, keeping the settings
+void    wsola_reset(wsola_t *ws);
+
+// take up to *isamp samples in (NULL for silence) and give up to *osamp
+// out; both come back as the counts done. out may be in, and then no more
+// is given out than is taken in.
+void    wsola_flow(wsola_t *ws, const st_sample_t *in, st_size_t *isamp,
+                   st_sample_t *out, st_size_t *osamp);
+
+// multiply-adds a search takes, correlations & energies, for the cost
+// figures
+unsigned int wsola_search_cost(const wsola_t *ws);
+
+#endif